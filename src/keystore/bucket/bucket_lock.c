@@ -0,0 +1,223 @@
+#include <sched.h>
+#include "bucket_lock.h"
+#include "core/operation_counters.h"
+#include "core/latency_histogram.h"
+
+#pragma region Private Type Definitions
+#define BUCKET_SPIN_WRITER (1u << 31) // Held for writing
+#define BUCKET_SPIN_WRITER_WAITING (1u << 30) // A writer waits, new readers hold back so it is not starved
+
+#define BUCKET_TICKET_WRITE_SHIFT 0 // Ticket served next for writing, advanced by every release
+#define BUCKET_TICKET_READ_SHIFT 16 // Ticket served next for reading, advanced when a reader or writer enters
+#define BUCKET_TICKET_NEXT_SHIFT 32 // Ticket handed to the next arriving thread
+#define BUCKET_TICKET_FIELD_MASK 0xFFFFull
+
+#define BUCKET_LOCK_SPINS_BEFORE_YIELD 64 // Busy-wait rounds before a waiter starts yielding the CPU
+
+#pragma endregion
+
+#pragma region Private Function Declarations
+static int _acquire_spin_lock(bucket_lock *lock_ptr, bool is_exclusive);
+static int _try_acquire_spin_lock(bucket_lock *lock_ptr, bool is_exclusive);
+static int _acquire_ticket_lock(bucket_lock *lock_ptr, bool is_exclusive);
+static int _try_acquire_ticket_lock(bucket_lock *lock_ptr, bool is_exclusive);
+static void _advance_ticket_fields(bucket_lock *lock_ptr, unsigned int first_shift, unsigned int second_shift);
+static unsigned int _get_ticket_field(uint64_t ticket_state, unsigned int shift);
+static uint64_t _increment_ticket_field(uint64_t ticket_state, unsigned int shift);
+static void _backoff(unsigned int *spin_count_ptr);
+
+#pragma endregion
+
+#pragma region Public Function Definitions
+
+int initialise_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type, pthread_rwlock_t *rwlock_ptr)
+{
+    switch (lock_type) {
+        case BUCKET_LOCK_SPIN:
+            atomic_init(&lock_ptr->spin, 0);
+            return 0;
+        case BUCKET_LOCK_TICKET:
+            atomic_init(&lock_ptr->ticket, 0);
+            return 0;
+        default:
+            if (pthread_rwlock_init(rwlock_ptr, NULL) != 0) return -11; // Error handling: lock initialization failed
+            lock_ptr->rwlock_ptr = rwlock_ptr;
+            return 0;
+    }
+}
+
+void destroy_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type)
+{
+    if (lock_type == BUCKET_LOCK_RWLOCK && lock_ptr->rwlock_ptr != NULL) pthread_rwlock_destroy(lock_ptr->rwlock_ptr);
+}
+
+int acquire_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type, bool is_exclusive, sharded_latency_histograms *histograms_ptr)
+{
+    if (lock_type == BUCKET_LOCK_RWLOCK) return lock_rwlock_recording_wait(lock_ptr->rwlock_ptr, is_exclusive, histograms_ptr);
+
+    bool is_timed = OPERATION_COUNTERS_ENABLED && histograms_ptr != NULL;
+    if (is_timed && try_acquire_bucket_lock(lock_ptr, lock_type, is_exclusive) == 0) {
+        record_latency(histograms_ptr, KEY_STORE_LATENCY_LOCK_WAIT, 0);
+        return 0;
+    }
+
+    unsigned long long start_ns = is_timed ? start_latency_timer() : 0;
+    int lock_result = (lock_type == BUCKET_LOCK_SPIN) ? _acquire_spin_lock(lock_ptr, is_exclusive) : _acquire_ticket_lock(lock_ptr, is_exclusive);
+    if (is_timed) record_latency_since(histograms_ptr, KEY_STORE_LATENCY_LOCK_WAIT, start_ns);
+    return lock_result;
+}
+
+int try_acquire_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type, bool is_exclusive)
+{
+    switch (lock_type) {
+        case BUCKET_LOCK_SPIN:
+            return _try_acquire_spin_lock(lock_ptr, is_exclusive);
+        case BUCKET_LOCK_TICKET:
+            return _try_acquire_ticket_lock(lock_ptr, is_exclusive);
+        default:
+            return is_exclusive ? pthread_rwlock_trywrlock(lock_ptr->rwlock_ptr) : pthread_rwlock_tryrdlock(lock_ptr->rwlock_ptr);
+    }
+}
+
+int release_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type, bool is_exclusive)
+{
+    switch (lock_type) {
+        case BUCKET_LOCK_SPIN:
+            if (is_exclusive) atomic_fetch_and_explicit(&lock_ptr->spin, ~BUCKET_SPIN_WRITER, memory_order_release); // Keeps the bit of a waiting writer
+            else atomic_fetch_sub_explicit(&lock_ptr->spin, 1, memory_order_release);
+            return 0;
+        case BUCKET_LOCK_TICKET:
+            // A writer lets the next ticket in for either mode, a reader only counts towards the next writer's turn
+            if (is_exclusive) _advance_ticket_fields(lock_ptr, BUCKET_TICKET_WRITE_SHIFT, BUCKET_TICKET_READ_SHIFT);
+            else _advance_ticket_fields(lock_ptr, BUCKET_TICKET_WRITE_SHIFT, BUCKET_TICKET_WRITE_SHIFT);
+            return 0;
+        default:
+            return pthread_rwlock_unlock(lock_ptr->rwlock_ptr);
+    }
+}
+
+#pragma endregion
+
+#pragma region Private Function Definitions
+
+/**
+ * @fn _acquire_spin_lock
+ * @brief Spins until the reader-writer spinlock is acquired.
+ *
+ * Readers enter while neither a writer holds the lock nor one is waiting. A writer that finds
+ * the lock taken announces itself with BUCKET_SPIN_WRITER_WAITING and enters once the readers drain.
+ */
+static int _acquire_spin_lock(bucket_lock *lock_ptr, bool is_exclusive)
+{
+    unsigned int spin_count = 0;
+    for (;;) {
+        unsigned int state = atomic_load_explicit(&lock_ptr->spin, memory_order_relaxed);
+        if (is_exclusive) {
+            if ((state & ~BUCKET_SPIN_WRITER_WAITING) == 0) {
+                if (atomic_compare_exchange_weak_explicit(&lock_ptr->spin, &state, BUCKET_SPIN_WRITER, memory_order_acquire, memory_order_relaxed)) return 0;
+            } else if ((state & BUCKET_SPIN_WRITER_WAITING) == 0) {
+                atomic_fetch_or_explicit(&lock_ptr->spin, BUCKET_SPIN_WRITER_WAITING, memory_order_relaxed);
+            }
+        } else if ((state & (BUCKET_SPIN_WRITER | BUCKET_SPIN_WRITER_WAITING)) == 0) {
+            if (atomic_compare_exchange_weak_explicit(&lock_ptr->spin, &state, state + 1, memory_order_acquire, memory_order_relaxed)) return 0;
+        }
+        _backoff(&spin_count);
+    }
+}
+
+/**
+ * @fn _try_acquire_spin_lock
+ * @brief Acquires the reader-writer spinlock if it is available right now.
+ */
+static int _try_acquire_spin_lock(bucket_lock *lock_ptr, bool is_exclusive)
+{
+    unsigned int state = atomic_load_explicit(&lock_ptr->spin, memory_order_relaxed);
+    if (is_exclusive) {
+        if ((state & ~BUCKET_SPIN_WRITER_WAITING) != 0) return -30;
+        return atomic_compare_exchange_strong_explicit(&lock_ptr->spin, &state, BUCKET_SPIN_WRITER, memory_order_acquire, memory_order_relaxed) ? 0 : -30;
+    }
+
+    if ((state & (BUCKET_SPIN_WRITER | BUCKET_SPIN_WRITER_WAITING)) != 0) return -30;
+    return atomic_compare_exchange_strong_explicit(&lock_ptr->spin, &state, state + 1, memory_order_acquire, memory_order_relaxed) ? 0 : -30;
+}
+
+/**
+ * @fn _acquire_ticket_lock
+ * @brief Draws a ticket and waits for its turn.
+ *
+ * A writer waits until every earlier ticket has released the lock. A reader only waits until
+ * every earlier ticket has entered and no writer holds the lock, then lets the next ticket in,
+ * so a run of consecutive readers shares the lock.
+ */
+static int _acquire_ticket_lock(bucket_lock *lock_ptr, bool is_exclusive)
+{
+    uint64_t state = atomic_fetch_add_explicit(&lock_ptr->ticket, 1ull << BUCKET_TICKET_NEXT_SHIFT, memory_order_relaxed);
+    unsigned int ticket = _get_ticket_field(state, BUCKET_TICKET_NEXT_SHIFT);
+    unsigned int turn_shift = is_exclusive ? BUCKET_TICKET_WRITE_SHIFT : BUCKET_TICKET_READ_SHIFT;
+
+    unsigned int spin_count = 0;
+    while (_get_ticket_field(atomic_load_explicit(&lock_ptr->ticket, memory_order_acquire), turn_shift) != ticket) _backoff(&spin_count);
+
+    if (!is_exclusive) _advance_ticket_fields(lock_ptr, BUCKET_TICKET_READ_SHIFT, BUCKET_TICKET_READ_SHIFT);
+    return 0;
+}
+
+/**
+ * @fn _try_acquire_ticket_lock
+ * @brief Draws a ticket only if it would be served immediately.
+ */
+static int _try_acquire_ticket_lock(bucket_lock *lock_ptr, bool is_exclusive)
+{
+    uint64_t state = atomic_load_explicit(&lock_ptr->ticket, memory_order_relaxed);
+    unsigned int turn_shift = is_exclusive ? BUCKET_TICKET_WRITE_SHIFT : BUCKET_TICKET_READ_SHIFT;
+    if (_get_ticket_field(state, turn_shift) != _get_ticket_field(state, BUCKET_TICKET_NEXT_SHIFT)) return -30;
+
+    uint64_t new_state = _increment_ticket_field(state, BUCKET_TICKET_NEXT_SHIFT);
+    if (!is_exclusive) new_state = _increment_ticket_field(new_state, BUCKET_TICKET_READ_SHIFT);
+    return atomic_compare_exchange_strong_explicit(&lock_ptr->ticket, &state, new_state, memory_order_acquire, memory_order_relaxed) ? 0 : -30;
+}
+
+/**
+ * @fn _advance_ticket_fields
+ * @brief Increments one or two 16-bit ticket fields in a single atomic update.
+ * @note Pass the same shift twice to advance a single field. Fields wrap around without carrying into their neighbour.
+ */
+static void _advance_ticket_fields(bucket_lock *lock_ptr, unsigned int first_shift, unsigned int second_shift)
+{
+    uint64_t state = atomic_load_explicit(&lock_ptr->ticket, memory_order_relaxed);
+    uint64_t new_state;
+    do {
+        new_state = _increment_ticket_field(state, first_shift);
+        if (second_shift != first_shift) new_state = _increment_ticket_field(new_state, second_shift);
+    } while (!atomic_compare_exchange_weak_explicit(&lock_ptr->ticket, &state, new_state, memory_order_acq_rel, memory_order_relaxed));
+}
+
+static unsigned int _get_ticket_field(uint64_t ticket_state, unsigned int shift)
+{
+    return (unsigned int)((ticket_state >> shift) & BUCKET_TICKET_FIELD_MASK);
+}
+
+static uint64_t _increment_ticket_field(uint64_t ticket_state, unsigned int shift)
+{
+    uint64_t field = ((ticket_state >> shift) + 1) & BUCKET_TICKET_FIELD_MASK;
+    return (ticket_state & ~(BUCKET_TICKET_FIELD_MASK << shift)) | (field << shift);
+}
+
+/**
+ * @fn _backoff
+ * @brief Waits a little before a lock is checked again, yielding the CPU once a waiter has spun for a while.
+ */
+static void _backoff(unsigned int *spin_count_ptr)
+{
+    if (++*spin_count_ptr < BUCKET_LOCK_SPINS_BEFORE_YIELD) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif
+        return;
+    }
+    sched_yield();
+}
+
+#pragma endregion
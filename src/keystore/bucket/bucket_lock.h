@@ -0,0 +1,66 @@
+/**
+ * @file bucket_lock.h
+ * @brief Interchangeable reader-writer locks of the hash buckets.
+ *
+ * A table picks one bucket_lock_type_t for all of its buckets:
+ * - BUCKET_LOCK_RWLOCK uses a pthread rwlock. The rwlocks live in an array beside the bucket
+ *   table and the bucket only keeps a pointer, so all three types fit into 8 bytes per bucket.
+ * - BUCKET_LOCK_SPIN packs a reader count and two writer bits into 4 bytes. Acquiring and releasing
+ *   it is a single atomic operation, which suits the short critical sections of list buckets.
+ * - BUCKET_LOCK_TICKET is a reader-writer ticket lock: every waiter draws a ticket and is served in
+ *   order, consecutive readers share the lock. It stays fair when many threads hit the same bucket.
+ *
+ * Spinning waiters pause briefly and then yield the CPU, so an oversubscribed machine still makes progress.
+ */
+#ifndef BUCKET_LOCK_H
+#define BUCKET_LOCK_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include "core/type_definition.h"
+
+#define BUCKET_LOCK_TICKET_MAX_WAITERS 65535 // Ticket counters are 16 bits, at most this many threads may wait on one bucket
+
+/**
+ * @fn initialise_bucket_lock
+ * @brief Initializes the lock of a bucket.
+ * @param lock_ptr Pointer to the lock word of the bucket.
+ * @param lock_type The lock type of the bucket's table.
+ * @param rwlock_ptr BUCKET_LOCK_RWLOCK: the bucket's slot in the table's rwlock array, ignored otherwise.
+ * @return 0 on success, -11 if the rwlock could not be initialized.
+ */
+int initialise_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type, pthread_rwlock_t *rwlock_ptr);
+
+/**
+ * @fn destroy_bucket_lock
+ * @brief Releases the resources of an unlocked bucket lock.
+ */
+void destroy_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type);
+
+/**
+ * @fn acquire_bucket_lock
+ * @brief Acquires a bucket lock, waiting until it is available.
+ * @param lock_ptr Pointer to the lock word of the bucket.
+ * @param lock_type The lock type of the bucket's table.
+ * @param is_exclusive Whether to take the lock for writing.
+ * @param histograms_ptr Histograms the lock wait is recorded in (see lock_rwlock_recording_wait), NULL skips timing.
+ * @return 0 on success, or the error of the pthread call. Spin and ticket locks cannot fail.
+ */
+int acquire_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type, bool is_exclusive, sharded_latency_histograms *histograms_ptr);
+
+/**
+ * @fn try_acquire_bucket_lock
+ * @brief Acquires a bucket lock only if that needs no waiting.
+ * @return 0 if the lock was acquired, non-zero if it is held (or a ticket waiter is queued).
+ */
+int try_acquire_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type, bool is_exclusive);
+
+/**
+ * @fn release_bucket_lock
+ * @brief Releases a bucket lock.
+ * @param is_exclusive Must match the mode the lock was acquired with.
+ * @return 0 on success, or the error of the pthread call.
+ */
+int release_bucket_lock(bucket_lock *lock_ptr, bucket_lock_type_t lock_type, bool is_exclusive);
+
+#endif // BUCKET_LOCK_H
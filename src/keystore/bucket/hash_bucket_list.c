@@ -3,85 +3,69 @@
 #include <stdlib.h>
 #include "hash_bucket_list.h"
 #include "core/data_node.h"
-#include "utils/memory_manager.h"
 
 
-list_node* create_new_list_node(uint32_t key_hash, data_node *data);
-bool list_node_hash_equals(list_node *node, uint32_t key_hash, const char *key);
+bool list_node_hash_equals(data_node *node, uint32_t key_hash, const char *key, size_t key_len);
+static atomic_list_node_ptr* _find_list_link(atomic_list_node_ptr *node_header_ptr, const char *key, size_t key_len, uint32_t key_hash);
 
-int insert_list_node(list_node **node_header_ptr, list_node* new_list_node)
+int insert_list_node(atomic_list_node_ptr *node_header_ptr, data_node *new_node)
 {
-    if(new_list_node == NULL) {
+    if(new_node == NULL) {
         return -20; // Invalid data or key
     }
 
     if(node_header_ptr != NULL)
     {
-        new_list_node->next = *node_header_ptr;
+        new_node->next = *node_header_ptr;
     }
 
-    *node_header_ptr = new_list_node;
+    *node_header_ptr = new_node;
     return 0;
 }
 
-int delete_list_node(list_node **node_header_ptr, const char *key, uint32_t key_hash, data_node **deleted_node_out)
+int delete_list_node(atomic_list_node_ptr *node_header_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node **deleted_node_out)
 {
     if (!node_header_ptr || !key || !deleted_node_out) return -21;
 
-    if(!*node_header_ptr)
+    atomic_list_node_ptr *link_ptr = _find_list_link(node_header_ptr, key, key_len, key_hash);
+
+    if(link_ptr == NULL)
     {
-        return -41; // List is empty, node not found
+        return -41; // Node with specified key and hash not found
     }
 
-    list_node *current_node_ptr = *node_header_ptr;
-    list_node *previous_node_ptr = NULL;
-    bool node_found = false;
+    // Node found, unlink it but leave its next pointer for readers still standing on it
+    data_node *current_node_ptr = *link_ptr;
+    *link_ptr = current_node_ptr->next;
+    *deleted_node_out = current_node_ptr;
 
-    while (current_node_ptr != NULL)
-    {
-        if(list_node_hash_equals(current_node_ptr, key_hash, key))
-        {
-            node_found = true;
-            break;
-        }
-
-        previous_node_ptr = current_node_ptr;
-        current_node_ptr = current_node_ptr->next;
-    }
+    return 0; // Success
+}
 
-    if(!node_found)
-    {
-        return -41; // Node with specified key and hash not found
-    }
+data_node* replace_list_node(atomic_list_node_ptr *node_header_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node *new_node)
+{
+    if (!node_header_ptr || !key || !new_node) return NULL;
 
-    // Node found, perform deletion
-    if(previous_node_ptr == NULL)
-    {
-        *node_header_ptr = current_node_ptr->next;
-    }
-    else
-    {
-        previous_node_ptr->next = current_node_ptr->next;
-    }
+    atomic_list_node_ptr *link_ptr = _find_list_link(node_header_ptr, key, key_len, key_hash);
 
-    
-    *deleted_node_out = current_node_ptr->data;
+    if(link_ptr == NULL) return NULL; // Node with specified key and hash not found
 
-    // Free the list node structure but not the data node
-    free_memory(current_node_ptr, LIST_POOL);
+    data_node *old_node_ptr = *link_ptr;
+    new_node->next = old_node_ptr->next;
+    *link_ptr = new_node;
 
-    return 0; // Success
+    return old_node_ptr;
 }
 
-list_node *find_list_node(list_node *node_header_ptr, const char *key, uint32_t key_hash)
+data_node *find_list_node(data_node *node_header_ptr, const char *key, size_t key_len, uint32_t key_hash)
 {
-    list_node *found_node = NULL;
+    data_node *found_node = NULL;
 
-    list_node *current_node_ptr = node_header_ptr;
+    data_node *current_node_ptr = node_header_ptr;
 
     while (current_node_ptr != NULL)
     {
-        if(list_node_hash_equals(current_node_ptr, key_hash, key))
+        if(list_node_hash_equals(current_node_ptr, key_hash, key, key_len))
         {
             found_node = current_node_ptr;
             break;
@@ -93,48 +77,50 @@ list_node *find_list_node(list_node *node_header_ptr, const char *key, uint32_t
     return found_node;
 }
 
-int delete_all_list_nodes(list_node *node_header_ptr)
+int delete_all_list_nodes(const bucket_node_context *context_ptr, data_node *node_header_ptr)
 {
-    if(node_header_ptr == NULL) {
-        return 0;
-    }
-
-    list_node *current_node_ptr = node_header_ptr;
-    list_node *next_node_ptr = NULL;
+    data_node *current_node_ptr = node_header_ptr;
 
     while (current_node_ptr != NULL)
     {
-        next_node_ptr = current_node_ptr->next;
-        delete_data_node(current_node_ptr->data);
-        free_memory(current_node_ptr, LIST_POOL);
+        data_node *next_node_ptr = current_node_ptr->next;
+        delete_data_node(context_ptr->data_node_counters_ptr, current_node_ptr);
         current_node_ptr = next_node_ptr;
     }
 
     return 0; // Success
 }
 
-list_node* create_new_list_node(uint32_t key_hash, data_node *data)
+/**
+ * @brief Finds the link that points to the node matching the key and key hash.
+ *
+ * @param node_header_ptr Pointer to the pointer of the list's head node.
+ * @param key The key to search for in the list.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key to match.
+ * @return The head pointer or the next pointer of the preceding node, or NULL if no node matches.
+ */
+static atomic_list_node_ptr* _find_list_link(atomic_list_node_ptr *node_header_ptr, const char *key, size_t key_len, uint32_t key_hash)
 {
-    list_node *new_node = (list_node *)allocate_memory_from_pool(LIST_POOL);
+    atomic_list_node_ptr *link_ptr = node_header_ptr;
 
-    if (new_node == NULL) {
-        return NULL; // Handle memory allocation failure
-    }
+    while (*link_ptr != NULL)
+    {
+        if(list_node_hash_equals(*link_ptr, key_hash, key, key_len)) return link_ptr;
 
-    new_node->key_hash = key_hash;
-    new_node->data = data;
-    new_node->next = NULL;
+        link_ptr = &(*link_ptr)->next;
+    }
 
-    return new_node;
+    return NULL;
 }
 
-bool list_node_hash_equals(list_node *node, uint32_t key_hash, const char *key)
+bool list_node_hash_equals(data_node *node, uint32_t key_hash, const char *key, size_t key_len)
 {
     bool result = false;
 
     if(node->key_hash == key_hash)
     {
-        result = (strcmp(node->data->key, key) == 0);
+        result = (node->key_size == key_len && memcmp(node->key, key, key_len) == 0);
     }
 
     return result;
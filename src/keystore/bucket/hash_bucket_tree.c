@@ -0,0 +1,446 @@
+#include <string.h>
+#include <stdlib.h>
+#include "hash_bucket_tree.h"
+#include "hash_bucket_list.h"
+#include "core/data_node.h"
+#include "utils/memory_manager.h"
+
+#pragma region Private Function Declarations
+static int _compare_tree_node(uint32_t key_hash, const char *key, size_t key_len, tree_node *node);
+static bool _is_black(tree_node *node);
+static void _rotate_left(tree_node **tree_root_ptr, tree_node *node);
+static void _rotate_right(tree_node **tree_root_ptr, tree_node *node);
+static void _transplant(tree_node **tree_root_ptr, tree_node *old_node, tree_node *new_node);
+static tree_node* _tree_minimum(tree_node *node);
+static tree_node* _tree_successor(tree_node *node);
+static void _insert_fixup(tree_node **tree_root_ptr, tree_node *node);
+static void _delete_fixup(tree_node **tree_root_ptr, tree_node *node, tree_node *parent);
+static void _release_tree_nodes(const bucket_node_context *context_ptr, tree_node *node, bool is_data_deleted);
+
+#pragma endregion
+
+#pragma region Public Function Definitions
+
+tree_node* create_new_tree_node(const bucket_node_context *context_ptr, uint32_t key_hash, data_node *data)
+{
+    tree_node *new_node = (tree_node *)allocate_memory_from_pool(context_ptr->memory_manager_ptr, TREE_POOL);
+
+    if (new_node == NULL) {
+        return NULL; // Handle memory allocation failure
+    }
+
+    new_node->color = RED;
+    new_node->key_hash = key_hash;
+    new_node->data = data;
+    new_node->left = NULL;
+    new_node->right = NULL;
+    new_node->parent = NULL;
+
+    return new_node;
+}
+
+int insert_tree_node(tree_node **tree_root_ptr, tree_node *new_tree_node)
+{
+    if (tree_root_ptr == NULL || new_tree_node == NULL || new_tree_node->data == NULL) return -20; // Invalid data or key
+
+    tree_node *parent_ptr = NULL;
+    tree_node **link_ptr = tree_root_ptr;
+
+    while (*link_ptr != NULL)
+    {
+        parent_ptr = *link_ptr;
+        int comparison = _compare_tree_node(new_tree_node->key_hash, new_tree_node->data->key, new_tree_node->data->key_size, parent_ptr);
+        if (comparison == 0) return -42; // Duplicate key
+
+        link_ptr = (comparison < 0) ? &parent_ptr->left : &parent_ptr->right;
+    }
+
+    new_tree_node->color = RED;
+    new_tree_node->left = NULL;
+    new_tree_node->right = NULL;
+    new_tree_node->parent = parent_ptr;
+    *link_ptr = new_tree_node;
+
+    _insert_fixup(tree_root_ptr, new_tree_node);
+    return 0;
+}
+
+int delete_tree_node(const bucket_node_context *context_ptr, tree_node **tree_root_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node **deleted_node_out)
+{
+    if (!context_ptr || !tree_root_ptr || !key || !deleted_node_out) return -21;
+
+    tree_node *target_ptr = find_tree_node(*tree_root_ptr, key, key_len, key_hash);
+    if (target_ptr == NULL) return -41; // Node with specified key and hash not found
+
+    // Standard red-black deletion: removed_color is the color of the node that actually leaves its position
+    tree_node *child_ptr = NULL;
+    tree_node *child_parent_ptr = NULL;
+    rb_tree_color_t removed_color = target_ptr->color;
+
+    if (target_ptr->left == NULL)
+    {
+        child_ptr = target_ptr->right;
+        child_parent_ptr = target_ptr->parent;
+        _transplant(tree_root_ptr, target_ptr, target_ptr->right);
+    }
+    else if (target_ptr->right == NULL)
+    {
+        child_ptr = target_ptr->left;
+        child_parent_ptr = target_ptr->parent;
+        _transplant(tree_root_ptr, target_ptr, target_ptr->left);
+    }
+    else
+    {
+        tree_node *successor_ptr = _tree_minimum(target_ptr->right);
+        removed_color = successor_ptr->color;
+        child_ptr = successor_ptr->right;
+
+        if (successor_ptr->parent == target_ptr)
+        {
+            child_parent_ptr = successor_ptr;
+        }
+        else
+        {
+            child_parent_ptr = successor_ptr->parent;
+            _transplant(tree_root_ptr, successor_ptr, successor_ptr->right);
+            successor_ptr->right = target_ptr->right;
+            successor_ptr->right->parent = successor_ptr;
+        }
+
+        _transplant(tree_root_ptr, target_ptr, successor_ptr);
+        successor_ptr->left = target_ptr->left;
+        successor_ptr->left->parent = successor_ptr;
+        successor_ptr->color = target_ptr->color;
+    }
+
+    if (removed_color == BLACK) _delete_fixup(tree_root_ptr, child_ptr, child_parent_ptr);
+
+    *deleted_node_out = target_ptr->data;
+
+    // Free the tree node structure but not the data node
+    free_memory(context_ptr->memory_manager_ptr, target_ptr, TREE_POOL);
+
+    return 0; // Success
+}
+
+tree_node* find_tree_node(tree_node *tree_root, const char *key, size_t key_len, uint32_t key_hash)
+{
+    if (key == NULL) return NULL;
+
+    tree_node *current_node_ptr = tree_root;
+
+    while (current_node_ptr != NULL)
+    {
+        int comparison = _compare_tree_node(key_hash, key, key_len, current_node_ptr);
+        if (comparison == 0) break;
+
+        current_node_ptr = (comparison < 0) ? current_node_ptr->left : current_node_ptr->right;
+    }
+
+    return current_node_ptr;
+}
+
+int delete_all_tree_nodes(const bucket_node_context *context_ptr, tree_node *tree_root)
+{
+    _release_tree_nodes(context_ptr, tree_root, true);
+    return 0; // Success
+}
+
+int convert_list_to_tree(const bucket_node_context *context_ptr, atomic_list_node_ptr *list_head_ptr, tree_node **tree_root_out)
+{
+    if (context_ptr == NULL || list_head_ptr == NULL || tree_root_out == NULL) return -20; // Invalid arguments
+
+    tree_node *tree_root = NULL;
+
+    for (data_node *current_node_ptr = *list_head_ptr; current_node_ptr != NULL; current_node_ptr = current_node_ptr->next)
+    {
+        tree_node *new_tree_node = create_new_tree_node(context_ptr, current_node_ptr->key_hash, current_node_ptr);
+        int result = (new_tree_node != NULL) ? insert_tree_node(&tree_root, new_tree_node) : -10;
+
+        if (result != 0) {
+            if (new_tree_node != NULL) free_memory(context_ptr->memory_manager_ptr, new_tree_node, TREE_POOL);
+            _release_tree_nodes(context_ptr, tree_root, false);
+            return result; // The list is left untouched
+        }
+    }
+
+    // The data nodes now belong to the tree, their stale next pointers are only followed by readers of the detached list
+    *list_head_ptr = NULL;
+
+    *tree_root_out = tree_root;
+    return 0;
+}
+
+int convert_tree_to_list(const bucket_node_context *context_ptr, tree_node **tree_root_ptr, data_node **list_head_out)
+{
+    if (context_ptr == NULL || tree_root_ptr == NULL || list_head_out == NULL) return -20; // Invalid arguments
+
+    atomic_list_node_ptr list_head = NULL;
+
+    for (tree_node *current_node_ptr = _tree_minimum(*tree_root_ptr); current_node_ptr != NULL; current_node_ptr = _tree_successor(current_node_ptr))
+    {
+        insert_list_node(&list_head, current_node_ptr->data);
+    }
+
+    // Free the tree node structures but not the data nodes, which now belong to the list
+    _release_tree_nodes(context_ptr, *tree_root_ptr, false);
+
+    *tree_root_ptr = NULL;
+    *list_head_out = list_head;
+    return 0;
+}
+
+#pragma endregion
+
+#pragma region Private Function Definitions
+
+/**
+ * @fn _compare_tree_node
+ * @brief Orders a key against a tree node by key hash first, key length second and key bytes last.
+ * @return Negative if the key sorts before the node, positive if after, 0 if it matches.
+ */
+static int _compare_tree_node(uint32_t key_hash, const char *key, size_t key_len, tree_node *node)
+{
+    if (key_hash != node->key_hash) return (key_hash < node->key_hash) ? -1 : 1;
+
+    if (key_len != node->data->key_size) return (key_len < node->data->key_size) ? -1 : 1;
+
+    return memcmp(key, node->data->key, key_len);
+}
+
+/**
+ * @fn _is_black
+ * @brief Returns the color of a node, treating NULL leaves as black.
+ */
+static bool _is_black(tree_node *node)
+{
+    return node == NULL || node->color == BLACK;
+}
+
+/**
+ * @fn _rotate_left
+ * @brief Rotates the subtree rooted at node to the left, making its right child the new subtree root.
+ */
+static void _rotate_left(tree_node **tree_root_ptr, tree_node *node)
+{
+    tree_node *pivot_ptr = node->right;
+
+    node->right = pivot_ptr->left;
+    if (pivot_ptr->left != NULL) pivot_ptr->left->parent = node;
+
+    _transplant(tree_root_ptr, node, pivot_ptr);
+
+    pivot_ptr->left = node;
+    node->parent = pivot_ptr;
+}
+
+/**
+ * @fn _rotate_right
+ * @brief Rotates the subtree rooted at node to the right, making its left child the new subtree root.
+ */
+static void _rotate_right(tree_node **tree_root_ptr, tree_node *node)
+{
+    tree_node *pivot_ptr = node->left;
+
+    node->left = pivot_ptr->right;
+    if (pivot_ptr->right != NULL) pivot_ptr->right->parent = node;
+
+    _transplant(tree_root_ptr, node, pivot_ptr);
+
+    pivot_ptr->right = node;
+    node->parent = pivot_ptr;
+}
+
+/**
+ * @fn _transplant
+ * @brief Replaces the subtree rooted at old_node with the one rooted at new_node in old_node's parent.
+ */
+static void _transplant(tree_node **tree_root_ptr, tree_node *old_node, tree_node *new_node)
+{
+    if (old_node->parent == NULL) {
+        *tree_root_ptr = new_node;
+    } else if (old_node == old_node->parent->left) {
+        old_node->parent->left = new_node;
+    } else {
+        old_node->parent->right = new_node;
+    }
+
+    if (new_node != NULL) new_node->parent = old_node->parent;
+}
+
+/**
+ * @fn _tree_minimum
+ * @brief Returns the left-most node of the subtree, or NULL for an empty subtree.
+ */
+static tree_node* _tree_minimum(tree_node *node)
+{
+    if (node == NULL) return NULL;
+
+    while (node->left != NULL) node = node->left;
+    return node;
+}
+
+/**
+ * @fn _tree_successor
+ * @brief Returns the in-order successor of node, or NULL if node is the last one.
+ */
+static tree_node* _tree_successor(tree_node *node)
+{
+    if (node->right != NULL) return _tree_minimum(node->right);
+
+    tree_node *parent_ptr = node->parent;
+    while (parent_ptr != NULL && node == parent_ptr->right)
+    {
+        node = parent_ptr;
+        parent_ptr = parent_ptr->parent;
+    }
+
+    return parent_ptr;
+}
+
+/**
+ * @fn _insert_fixup
+ * @brief Restores the red-black properties after inserting the red node.
+ */
+static void _insert_fixup(tree_node **tree_root_ptr, tree_node *node)
+{
+    tree_node *parent_ptr;
+
+    while ((parent_ptr = node->parent) != NULL && parent_ptr->color == RED)
+    {
+        // A red parent is never the root, so the grandparent exists
+        tree_node *grandparent_ptr = parent_ptr->parent;
+        bool is_parent_left = (parent_ptr == grandparent_ptr->left);
+        tree_node *uncle_ptr = is_parent_left ? grandparent_ptr->right : grandparent_ptr->left;
+
+        if (!_is_black(uncle_ptr))
+        {
+            // Red uncle: recolor and continue from the grandparent
+            parent_ptr->color = BLACK;
+            uncle_ptr->color = BLACK;
+            grandparent_ptr->color = RED;
+            node = grandparent_ptr;
+            continue;
+        }
+
+        if (is_parent_left)
+        {
+            if (node == parent_ptr->right) {
+                _rotate_left(tree_root_ptr, parent_ptr);
+                parent_ptr = node;
+            }
+            _rotate_right(tree_root_ptr, grandparent_ptr);
+        }
+        else
+        {
+            if (node == parent_ptr->left) {
+                _rotate_right(tree_root_ptr, parent_ptr);
+                parent_ptr = node;
+            }
+            _rotate_left(tree_root_ptr, grandparent_ptr);
+        }
+
+        parent_ptr->color = BLACK;
+        grandparent_ptr->color = RED;
+        break;
+    }
+
+    (*tree_root_ptr)->color = BLACK;
+}
+
+/**
+ * @fn _delete_fixup
+ * @brief Restores the red-black properties after a black node was removed above node.
+ *
+ * node may be NULL (a leaf), which is why its parent is passed explicitly.
+ */
+static void _delete_fixup(tree_node **tree_root_ptr, tree_node *node, tree_node *parent)
+{
+    while (node != *tree_root_ptr && _is_black(node))
+    {
+        if (node == parent->left)
+        {
+            tree_node *sibling_ptr = parent->right;
+
+            if (!_is_black(sibling_ptr)) {
+                sibling_ptr->color = BLACK;
+                parent->color = RED;
+                _rotate_left(tree_root_ptr, parent);
+                sibling_ptr = parent->right;
+            }
+
+            if (_is_black(sibling_ptr->left) && _is_black(sibling_ptr->right)) {
+                sibling_ptr->color = RED;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+
+            if (_is_black(sibling_ptr->right)) {
+                sibling_ptr->left->color = BLACK;
+                sibling_ptr->color = RED;
+                _rotate_right(tree_root_ptr, sibling_ptr);
+                sibling_ptr = parent->right;
+            }
+
+            sibling_ptr->color = parent->color;
+            parent->color = BLACK;
+            sibling_ptr->right->color = BLACK;
+            _rotate_left(tree_root_ptr, parent);
+        }
+        else
+        {
+            tree_node *sibling_ptr = parent->left;
+
+            if (!_is_black(sibling_ptr)) {
+                sibling_ptr->color = BLACK;
+                parent->color = RED;
+                _rotate_right(tree_root_ptr, parent);
+                sibling_ptr = parent->left;
+            }
+
+            if (_is_black(sibling_ptr->left) && _is_black(sibling_ptr->right)) {
+                sibling_ptr->color = RED;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+
+            if (_is_black(sibling_ptr->left)) {
+                sibling_ptr->right->color = BLACK;
+                sibling_ptr->color = RED;
+                _rotate_left(tree_root_ptr, sibling_ptr);
+                sibling_ptr = parent->left;
+            }
+
+            sibling_ptr->color = parent->color;
+            parent->color = BLACK;
+            sibling_ptr->left->color = BLACK;
+            _rotate_right(tree_root_ptr, parent);
+        }
+
+        node = *tree_root_ptr;
+        break;
+    }
+
+    if (node != NULL) node->color = BLACK;
+}
+
+/**
+ * @fn _release_tree_nodes
+ * @brief Frees every tree node of the subtree, optionally deleting the data nodes as well.
+ *
+ * The recursion depth is bounded by the tree height, which is O(log n) for a red-black tree.
+ */
+static void _release_tree_nodes(const bucket_node_context *context_ptr, tree_node *node, bool is_data_deleted)
+{
+    if (node == NULL) return;
+
+    _release_tree_nodes(context_ptr, node->left, is_data_deleted);
+    _release_tree_nodes(context_ptr, node->right, is_data_deleted);
+
+    if (is_data_deleted) delete_data_node(context_ptr->data_node_counters_ptr, node->data);
+    free_memory(context_ptr->memory_manager_ptr, node, TREE_POOL);
+}
+
+#pragma endregion
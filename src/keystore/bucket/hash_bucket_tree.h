@@ -0,0 +1,110 @@
+#ifndef HASH_BUCKET_TREE_H
+#define HASH_BUCKET_TREE_H
+
+#include "core/type_definition.h"
+#include <stdbool.h>
+
+/**
+ * @file hash_bucket_tree.h
+ * @brief Red-black tree container for hash buckets with long collision chains.
+ *
+ * Nodes are ordered by key hash first and by key length and bytes (memcmp) second, so lookups, inserts and
+ * deletes are O(log n) in the number of keys in the bucket regardless of how skewed the
+ * hashes are.
+ */
+
+/**
+ * @fn create_new_tree_node
+ * @brief Creates a new tree node with the specified key hash and data.
+ *
+ * This function allocates memory for a new tree_node from the tree pool, initializes it with
+ * the provided key hash and data node, and clears its links.
+ *
+ * @param context_ptr Pointer to the node context of the key store instance (memory, epoch manager, counters).
+ * @param key_hash The hash value of the key to be stored in the new node.
+ * @param data Pointer to the data_node to be associated with the new tree node.
+ * @return Pointer to the newly created tree_node, or NULL if memory allocation fails.
+ */
+tree_node* create_new_tree_node(const bucket_node_context *context_ptr, uint32_t key_hash, data_node *data);
+
+/**
+ * @fn insert_tree_node
+ * @brief Inserts a node into the red-black tree and rebalances it.
+ *
+ * @param tree_root_ptr Pointer to the root pointer of the tree.
+ * @param new_tree_node Pointer to the tree_node to be inserted.
+ * @return int Returns 0 on success, -20 on invalid arguments, or -42 if the key already exists.
+ * @note On failure the caller keeps ownership of new_tree_node.
+ */
+int insert_tree_node(tree_node **tree_root_ptr, tree_node *new_tree_node);
+
+/**
+ * @fn delete_tree_node
+ * @brief Deletes a node from the red-black tree based on the provided key and key hash.
+ *
+ * This function searches for the node whose key matches the given key and key_hash,
+ * unlinks it, rebalances the tree and frees the tree node.
+ *
+ * @param context_ptr Pointer to the node context of the key store instance (memory, epoch manager, counters).
+ * @param tree_root_ptr Pointer to the root pointer of the tree.
+ * @param key The key to search for in the tree.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key.
+ * @param deleted_node_out Pointer to a data_node pointer to receive the deleted node's data.
+ * @return int Returns 0 on successful deletion, -21 on invalid arguments, or -41 if the node was not found.
+ * @note The caller is responsible for managing the memory of the deleted data_node.
+ */
+int delete_tree_node(const bucket_node_context *context_ptr, tree_node **tree_root_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node **deleted_node_out);
+
+/**
+ * @fn find_tree_node
+ * @brief Finds a node in the red-black tree matching the specified key and key hash.
+ *
+ * @param tree_root Pointer to the root of the tree.
+ * @param key The key to search for in the tree.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key to match.
+ * @return Pointer to the matching tree_node if found, otherwise NULL.
+ */
+tree_node* find_tree_node(tree_node *tree_root, const char *key, size_t key_len, uint32_t key_hash);
+
+/**
+ * @fn delete_all_tree_nodes
+ * @brief Deletes all nodes in the tree, including their data nodes.
+ *
+ * @param context_ptr Pointer to the node context of the key store instance (memory, epoch manager, counters).
+ * @param tree_root Pointer to the root of the tree to be deleted.
+ * @return int Returns 0 on success.
+ */
+int delete_all_tree_nodes(const bucket_node_context *context_ptr, tree_node *tree_root);
+
+/**
+ * @fn convert_list_to_tree
+ * @brief Moves every data node of a linked list into a new red-black tree.
+ *
+ * All tree nodes are allocated before the list is touched, so on failure the list is left
+ * unchanged. On success *list_head_ptr is set to NULL. The data nodes keep their next pointers,
+ * so lock-free readers still walking the detached list can finish.
+ *
+ * @param context_ptr Pointer to the node context of the key store instance (memory, epoch manager, counters).
+ * @param list_head_ptr Pointer to the head pointer of the linked list.
+ * @param tree_root_out Pointer to receive the root of the new tree.
+ * @return int Returns 0 on success, -20 on invalid arguments, -10 on allocation failure, or -42 on duplicate keys.
+ */
+int convert_list_to_tree(const bucket_node_context *context_ptr, atomic_list_node_ptr *list_head_ptr, tree_node **tree_root_out);
+
+/**
+ * @fn convert_tree_to_list
+ * @brief Moves every data node of a red-black tree into a new linked list.
+ *
+ * The data nodes are chained through their next pointers, so no allocation is needed. The
+ * tree nodes are freed and *tree_root_ptr is set to NULL.
+ *
+ * @param context_ptr Pointer to the node context of the key store instance (memory, epoch manager, counters).
+ * @param tree_root_ptr Pointer to the root pointer of the tree.
+ * @param list_head_out Pointer to receive the head of the new linked list.
+ * @return int Returns 0 on success, or -20 on invalid arguments.
+ */
+int convert_tree_to_list(const bucket_node_context *context_ptr, tree_node **tree_root_ptr, data_node **list_head_out);
+
+#endif // HASH_BUCKET_TREE_H
@@ -5,7 +5,11 @@
  * 
  * @note The hash bucket expects bucket size to be a power of two.
  * @note Concurrency control is optional and can be enabled or disabled during initialization.
- * @note This implementation currently supports only linked list based buckets.
+ * @note Buckets start as linked lists; a list that reaches the treeify threshold is converted to a red-black
+ *       tree (see hash_bucket_tree.c), and a tree holding fewer than half of that threshold back to a list.
+ * @note Lookups can optionally skip the bucket and resize locks; deleted nodes and drained tables are then reclaimed through the epoch manager.
+ * @note The bucket table can grow or shrink by a factor of two based on its load factor. Buckets of the
+ *       old table are migrated incrementally by subsequent operations (see hash_buckets_resize.c).
  * @note This module encapsulates all operations related to hash buckets, including adding, finding, and deleting nodes.
  *
  */
@@ -15,163 +19,485 @@
 #include <math.h>
 #include "hash_buckets.h"
 #include "hash_bucket_list.h"
+#include "hash_bucket_tree.h"
+#include "bucket_lock.h"
 #include "core/type_definition.h"
 #include "core/data_node.h"
+#include "core/operation_counters.h"
 #include "utils/memory_manager.h"
+#include "utils/epoch_manager.h"
 #include "hash_buckets_operation.c"
 #include "hash_buckets_stats.c"
-
-#pragma region Private Global Variables
-static hash_bucket_memory_pool g_hash_bucket_pool = {0};
-#pragma endregion
+#include "hash_buckets_resize.c"
 
 #pragma region Private Function declarations
 static bool _is_power_of_two(unsigned int n);
-static int _initialise_hash_bucket(hash_bucket *hash_bucket_ptr);
-static void _delete_hash_bucket(unsigned int index);
-int _add_node_to_bucket(unsigned int index,  const char *key, uint32_t key_hash, key_store_value* new_value);
+static bool _is_valid_lock_type(bucket_lock_type_t lock_type);
+static bool _has_bucket_locks(const hash_bucket_memory_pool* pool_ptr);
+static void _free_lock_storage_and_reset(hash_bucket_memory_pool* pool_ptr);
+static int _initialise_hash_bucket(hash_bucket_memory_pool* pool_ptr, hash_bucket *hash_bucket_ptr, pthread_rwlock_t *rwlock_ptr);
+static void _delete_hash_bucket(hash_bucket_memory_pool* pool_ptr, hash_bucket *hash_bucket_ptr);
+static int _begin_bucket_operation(hash_bucket_memory_pool* pool_ptr, uint32_t key_hash, hash_bucket **hash_bucket_out, bool *is_migration_complete_out);
+static void _end_bucket_operation(hash_bucket_memory_pool* pool_ptr, bool is_migration_complete, bool is_key_count_changed);
+static int _begin_node_read(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node **data_node_out);
+static void _end_node_read(hash_bucket_memory_pool* pool_ptr, data_node *data_node_ptr);
+static int _find_node_in_tables(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node **data_node_out);
+static void _find_nodes_in_tables(hash_bucket_memory_pool* pool_ptr, const key_store_prepared_key *keys, size_t key_count, data_node **data_nodes_out, int *results_out);
+static int _begin_batch_operation(hash_bucket_memory_pool* pool_ptr, const key_store_prepared_key *keys, size_t key_count, hash_bucket **hash_buckets_out, size_t *order_out, int *results_out, bool *is_migration_complete_out);
+static void _run_batch_by_bucket(hash_bucket_memory_pool* pool_ptr, bucket_operation_type_t operation_type, const key_store_prepared_key *keys, size_t key_count, hash_bucket **hash_buckets, const size_t *order, data_node **new_data_nodes, data_node **data_nodes_out, int *results_out);
+static int _first_batch_error(const int *results, size_t count);
+static void _reclaim_data_node(void *data_node_ptr, void *context);
 #pragma endregion
 
 #pragma region Public Function Definitions
 
-int initialise_hash_buckets(unsigned int bucket_size, bool is_concurrency_enabled) 
+int initialise_hash_buckets(hash_bucket_memory_pool* pool_ptr, unsigned int bucket_size, bool is_concurrency_enabled, memory_manager* memory_manager_ptr) 
+{
+    return initialise_hash_buckets_with_lock_config(pool_ptr, bucket_size, is_concurrency_enabled, (bucket_lock_config){ BUCKET_LOCK_RWLOCK, 0 }, memory_manager_ptr);
+}
+
+int initialise_hash_buckets_with_lock_config(hash_bucket_memory_pool* pool_ptr, unsigned int bucket_size, bool is_concurrency_enabled, bucket_lock_config lock_config, memory_manager* memory_manager_ptr)
 {    
+    if (pool_ptr == NULL) return -20; // Error handling: invalid input
     if (!_is_power_of_two(bucket_size))  return -21; // Error handling: bucket_size must be a power of two
+    if (!_is_valid_lock_type(lock_config.lock_type)) return -21; // Error handling: unknown lock type
+    if (!is_concurrency_enabled && (lock_config.lock_type != BUCKET_LOCK_RWLOCK || lock_config.stripe_count != 0)) return -21; // Error handling: buckets are unlocked without concurrency
+    if (lock_config.stripe_count != 0 && !_is_power_of_two(lock_config.stripe_count)) return -21; // Error handling: stripes are selected by the low bits of the bucket index
+
+    if (pool_ptr->is_initialized) return 0; // Already initialized
+
+    // A stripe covers at least one bucket; the table never shrinks below bucket_size, so stripes stay valid across resizes
+    unsigned int stripe_count = (lock_config.stripe_count < bucket_size) ? lock_config.stripe_count : bucket_size;
+    bool has_bucket_rwlocks = is_concurrency_enabled && stripe_count == 0 && lock_config.lock_type == BUCKET_LOCK_RWLOCK;
+
+    pool_ptr->block_size = sizeof(hash_bucket) + (has_bucket_rwlocks ? sizeof(pthread_rwlock_t) : 0);
+    pool_ptr->is_initialized = false;
+    pool_ptr->total_blocks = bucket_size;
+    pool_ptr->min_total_blocks = bucket_size;
+    pool_ptr->lock_type = lock_config.lock_type;
+    pool_ptr->lock_stripe_count = stripe_count;
+    _update_resize_thresholds(pool_ptr);
+
+    pool_ptr->hash_buckets_ptr = calloc(bucket_size, sizeof(hash_bucket));
+    pool_ptr->bucket_rwlocks_ptr = has_bucket_rwlocks ? calloc(bucket_size, sizeof(pthread_rwlock_t)) : NULL;
+    pool_ptr->lock_stripes_ptr = (stripe_count != 0) ? aligned_alloc(BUCKET_LOCK_STRIPE_ALIGNMENT, stripe_count * sizeof(bucket_lock_stripe)) : NULL;
+
+    if (pool_ptr->hash_buckets_ptr == NULL || (has_bucket_rwlocks && pool_ptr->bucket_rwlocks_ptr == NULL) || (stripe_count != 0 && pool_ptr->lock_stripes_ptr == NULL)) {
+        _free_lock_storage_and_reset(pool_ptr);
+        return -10; // Error handling: memory allocation failed
+    }
 
-    if (g_hash_bucket_pool.is_initialized) return 0; // Already initialized
-
-    g_hash_bucket_pool.block_size = sizeof(hash_bucket);
-    g_hash_bucket_pool.is_initialized = false;
-    g_hash_bucket_pool.total_blocks = bucket_size;
-
-    g_hash_bucket_pool.hash_buckets_ptr = calloc(bucket_size, sizeof(hash_bucket));
+    if (is_concurrency_enabled && pthread_rwlock_init(&pool_ptr->resize_lock, NULL) != 0) {
+        _free_lock_storage_and_reset(pool_ptr);
+        return -11; // Error handling: lock initialization failed
+    }
 
-    if (g_hash_bucket_pool.hash_buckets_ptr == NULL)  return -10; // Error handling: memory allocation failed
+    for (unsigned int i = 0; i < stripe_count; ++i) {
+        if (initialise_bucket_lock(&pool_ptr->lock_stripes_ptr[i].lock, lock_config.lock_type, &pool_ptr->lock_stripes_ptr[i].rwlock) != 0) {
+            for (unsigned int j = 0; j < i; ++j) destroy_bucket_lock(&pool_ptr->lock_stripes_ptr[j].lock, lock_config.lock_type);
+            pthread_rwlock_destroy(&pool_ptr->resize_lock);
+            _free_lock_storage_and_reset(pool_ptr);
+            return -11; // Error handling: lock initialization failed
+        }
+    }
 
-    g_hash_bucket_pool.is_initialized = true;
-    g_hash_bucket_pool.is_concurrency_enabled = is_concurrency_enabled;
+    pool_ptr->is_initialized = true;
+    pool_ptr->is_concurrency_enabled = is_concurrency_enabled;
+    pool_ptr->node_sync_mode = is_concurrency_enabled ? DATA_NODE_SYNC_MUTEX : DATA_NODE_SYNC_NONE;
+    pool_ptr->node_context = (bucket_node_context){ memory_manager_ptr, NULL, &pool_ptr->data_node_counters };
 
     // Eager initialization of hash buckets if concurrency is enabled or else lazy initialization will be done
     int init_result = 0;
     if (is_concurrency_enabled) {
         for (unsigned int i = 0; i < bucket_size; ++i) {
-            init_result = _initialise_hash_bucket(&g_hash_bucket_pool.hash_buckets_ptr[i]);
+            init_result = _initialise_hash_bucket(pool_ptr, &pool_ptr->hash_buckets_ptr[i], has_bucket_rwlocks ? &pool_ptr->bucket_rwlocks_ptr[i] : NULL);
             if (init_result != 0) {
-                cleanup_hash_buckets();
+                cleanup_hash_buckets(pool_ptr);
                 return init_result; // Error handling: failed to initialize hash bucket
             }
         }
+        _record_bucket_presence(pool_ptr, 0, bucket_size);
+    }
+
+    return 0;
+}
+
+int configure_hash_bucket_resize(hash_bucket_memory_pool* pool_ptr, double grow_load_factor, double shrink_load_factor)
+{
+    if (pool_ptr == NULL) return -20; // Error handling: invalid input
+    if (grow_load_factor < 0 || shrink_load_factor < 0) return -21; // Error handling: invalid load factors
+    if (grow_load_factor > 0 && shrink_load_factor * 2 >= grow_load_factor) return -21; // Error handling: a halved table would immediately grow again
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+
+    pool_ptr->grow_load_factor = grow_load_factor;
+    pool_ptr->shrink_load_factor = shrink_load_factor;
+    _update_resize_thresholds(pool_ptr);
+    return 0;
+}
+
+int configure_hash_bucket_tree(hash_bucket_memory_pool* pool_ptr, unsigned int treeify_threshold)
+{
+    if (pool_ptr == NULL) return -20; // Error handling: invalid input
+    if (treeify_threshold == 1) return -21; // Error handling: a tree bucket would never convert back to a list
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+
+    pool_ptr->treeify_threshold = treeify_threshold;
+    return 0;
+}
+
+int configure_hash_bucket_lock_free_read(hash_bucket_memory_pool* pool_ptr, epoch_manager* epoch_manager_ptr)
+{
+    if (pool_ptr == NULL) return -20; // Error handling: invalid input
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+    if (epoch_manager_ptr != NULL && !pool_ptr->is_concurrency_enabled) return -21; // Error handling: lock-free reads need the concurrent write path
+
+    pool_ptr->is_lock_free_read_enabled = (epoch_manager_ptr != NULL);
+    pool_ptr->node_context.epoch_manager_ptr = epoch_manager_ptr;
+    if (pool_ptr->is_concurrency_enabled) pool_ptr->node_sync_mode = pool_ptr->is_lock_free_read_enabled ? DATA_NODE_SYNC_SEQLOCK : DATA_NODE_SYNC_MUTEX;
+    return 0;
+}
+
+int configure_hash_bucket_node_sync(hash_bucket_memory_pool* pool_ptr, data_node_sync_t sync_mode)
+{
+    if (pool_ptr == NULL) return -20; // Error handling: invalid input
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+    if (sync_mode != DATA_NODE_SYNC_NONE && sync_mode != DATA_NODE_SYNC_MUTEX && sync_mode != DATA_NODE_SYNC_SEQLOCK) return -21; // Error handling: unknown mode
+    if ((sync_mode != DATA_NODE_SYNC_NONE) != pool_ptr->is_concurrency_enabled) return -21; // Error handling: concurrent buckets need synchronized nodes and vice versa
+    if (sync_mode == DATA_NODE_SYNC_MUTEX && pool_ptr->is_lock_free_read_enabled) return -21; // Error handling: lock-free readers never take the node mutex
+
+    pool_ptr->node_sync_mode = sync_mode;
+    return 0;
+}
+
+int configure_hash_bucket_inline_values(hash_bucket_memory_pool* pool_ptr, unsigned int inline_value_threshold)
+{
+    if (pool_ptr == NULL) return -20; // Error handling: invalid input
+    if (inline_value_threshold > DATA_NODE_MAX_INLINE_VALUE_SIZE) return -21; // Error handling: threshold too large
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+
+    pool_ptr->inline_value_threshold = inline_value_threshold;
+    return 0;
+}
+
+int configure_hash_bucket_latency_histograms(hash_bucket_memory_pool* pool_ptr, sharded_latency_histograms* histograms_ptr)
+{
+    if (pool_ptr == NULL) return -20; // Error handling: invalid input
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+
+    pool_ptr->latency_histograms_ptr = histograms_ptr;
+    return 0;
+}
+
+int configure_hash_bucket_lock_type(hash_bucket_memory_pool* pool_ptr, bucket_lock_type_t lock_type)
+{
+    if (pool_ptr == NULL) return -20; // Error handling: invalid input
+    if (!_is_valid_lock_type(lock_type)) return -21; // Error handling: unknown lock type
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+    if (lock_type == pool_ptr->lock_type) return 0;
+    if (!pool_ptr->is_concurrency_enabled || pool_ptr->old_hash_buckets_ptr != NULL) return -21; // Error handling: buckets are unlocked without concurrency, a resize must finish first
+
+    // Stripes keep the storage of their rwlock, buckets get a new rwlock array
+    bool is_striped = (pool_ptr->lock_stripes_ptr != NULL);
+    unsigned int lock_count = is_striped ? pool_ptr->lock_stripe_count : pool_ptr->total_blocks;
+
+    // Prepare every new lock before the current ones are released, so a failure leaves the table untouched
+    bucket_lock *new_locks_ptr = calloc(lock_count, sizeof(bucket_lock));
+    pthread_rwlock_t *new_rwlocks_ptr = (!is_striped && lock_type == BUCKET_LOCK_RWLOCK) ? calloc(lock_count, sizeof(pthread_rwlock_t)) : NULL;
+    if (new_locks_ptr == NULL || (!is_striped && lock_type == BUCKET_LOCK_RWLOCK && new_rwlocks_ptr == NULL)) {
+        free(new_locks_ptr);
+        free(new_rwlocks_ptr);
+        return -10; // Error handling: memory allocation failed
+    }
+
+    for (unsigned int i = 0; i < lock_count; ++i) {
+        pthread_rwlock_t *rwlock_ptr = is_striped ? &pool_ptr->lock_stripes_ptr[i].rwlock : ((new_rwlocks_ptr != NULL) ? &new_rwlocks_ptr[i] : NULL);
+        if (initialise_bucket_lock(&new_locks_ptr[i], lock_type, rwlock_ptr) != 0) {
+            for (unsigned int j = 0; j < i; ++j) destroy_bucket_lock(&new_locks_ptr[j], lock_type);
+            free(new_locks_ptr);
+            free(new_rwlocks_ptr);
+            return -11; // Error handling: lock initialization failed
+        }
+    }
+
+    for (unsigned int i = 0; i < lock_count; ++i) {
+        bucket_lock *lock_ptr = is_striped ? &pool_ptr->lock_stripes_ptr[i].lock : &pool_ptr->hash_buckets_ptr[i].lock;
+        destroy_bucket_lock(lock_ptr, pool_ptr->lock_type);
+        *lock_ptr = new_locks_ptr[i];
     }
 
+    free(new_locks_ptr);
+    if (!is_striped) {
+        free(pool_ptr->bucket_rwlocks_ptr);
+        pool_ptr->bucket_rwlocks_ptr = new_rwlocks_ptr;
+        pool_ptr->block_size = sizeof(hash_bucket) + ((lock_type == BUCKET_LOCK_RWLOCK) ? sizeof(pthread_rwlock_t) : 0);
+    }
+    pool_ptr->lock_type = lock_type;
     return 0;
 }
 
-int cleanup_hash_buckets(void) 
+int cleanup_hash_buckets(hash_bucket_memory_pool* pool_ptr) 
 {
-    if (!g_hash_bucket_pool.is_initialized) return 0; // Nothing to clean up
+    if (pool_ptr == NULL || !pool_ptr->is_initialized) return 0; // Nothing to clean up
+
+    // Clean up each hash bucket, including a table that is still being drained by a resize
+    for(unsigned int i = 0; i < pool_ptr->total_blocks; i++) 
+    {
+        _delete_hash_bucket(pool_ptr, &pool_ptr->hash_buckets_ptr[i]);
+    }
 
-    // Clean up each hash bucket
-    for(unsigned int i = 0; i < g_hash_bucket_pool.total_blocks; i++) 
+    for(unsigned int i = 0; i < pool_ptr->old_total_blocks; i++) 
     {
-        _delete_hash_bucket(i);
+        _delete_hash_bucket(pool_ptr, &pool_ptr->old_hash_buckets_ptr[i]);
     }
 
+    for (unsigned int i = 0; i < pool_ptr->lock_stripe_count; ++i) destroy_bucket_lock(&pool_ptr->lock_stripes_ptr[i].lock, pool_ptr->lock_type);
+    if (pool_ptr->is_concurrency_enabled) pthread_rwlock_destroy(&pool_ptr->resize_lock);
+
     // Free the memory pool
-    free(g_hash_bucket_pool.hash_buckets_ptr);
-    g_hash_bucket_pool.hash_buckets_ptr = NULL;
-    g_hash_bucket_pool.block_size = 0;
-    g_hash_bucket_pool.total_blocks = 0;
-    g_hash_bucket_pool.is_initialized = false;
-    g_hash_bucket_pool = (hash_bucket_memory_pool){0};
+    free(pool_ptr->old_hash_buckets_ptr);
+    free(pool_ptr->old_bucket_rwlocks_ptr);
+    _free_lock_storage_and_reset(pool_ptr);
     
     return 0;
 }
 
 
-hash_bucket*  get_hash_bucket(unsigned int index) 
+hash_bucket*  get_hash_bucket(hash_bucket_memory_pool* pool_ptr, unsigned int index) 
 {
-    if(!g_hash_bucket_pool.is_initialized || index >= g_hash_bucket_pool.total_blocks) return NULL; // Error handling: out of bounds or not initialized
+    if(pool_ptr == NULL || !pool_ptr->is_initialized || index >= pool_ptr->total_blocks) return NULL; // Error handling: out of bounds or not initialized
 
-    hash_bucket* target_bucket_ptr =  &g_hash_bucket_pool.hash_buckets_ptr[index];
+    hash_bucket* target_bucket_ptr =  &pool_ptr->hash_buckets_ptr[index];
 
     if(!target_bucket_ptr->is_initialized)
     {
-        if (_initialise_hash_bucket(target_bucket_ptr) != 0) {
-            _delete_hash_bucket(index); // or pass the pointer
+        if (_initialise_hash_bucket(pool_ptr, target_bucket_ptr, (pool_ptr->bucket_rwlocks_ptr != NULL) ? &pool_ptr->bucket_rwlocks_ptr[index] : NULL) != 0) {
+            _delete_hash_bucket(pool_ptr, target_bucket_ptr);
             return NULL;
         }
+        _record_bucket_presence(pool_ptr, 0, 1);
     }
 
     return target_bucket_ptr;
 }
 
-int upsert_node_to_bucket(unsigned int index, const char *key, uint32_t key_hash, key_store_value* new_value)
+unsigned int get_hash_bucket_count(hash_bucket_memory_pool* pool_ptr)
 {
-    if (key == NULL || new_value == NULL) return -20; // Error handling: invalid input
-
-    hash_bucket *hash_bucket_ptr = get_hash_bucket(index);
-    if (hash_bucket_ptr == NULL) return -40; // Error handling: bucket not found or initialized
+    return (pool_ptr != NULL && pool_ptr->is_initialized) ? pool_ptr->total_blocks : 0;
+}
 
-    data_node* data_node_ptr;
-    bucket_operation_args input_args = {hash_bucket_ptr, key, key_hash, NULL};
+int upsert_node_to_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* new_value)
+{
+    if (pool_ptr == NULL || key == NULL || new_value == NULL) return -20; // Error handling: invalid input
 
-    int result = 0;
-    result = g_hash_bucket_pool.is_concurrency_enabled ? _hash_bucket_lock_wrapper(FIND_NODE, input_args, &data_node_ptr) : _find_node(input_args, &data_node_ptr);
+    // Create the data node speculatively, outside any lock; it is discarded if the key already exists
+    data_node* new_data_node = NULL;
+    int result = create_data_node(&pool_ptr->data_node_counters, pool_ptr->node_context.memory_manager_ptr, key, key_len, key_hash, new_value, pool_ptr->node_sync_mode, pool_ptr->inline_value_threshold, &new_data_node);
+    if (result != 0) return result; // Error handling: invalid value or memory allocation failure
 
-    if(result == 0){
-        // Node exists, update it
-        result = g_hash_bucket_pool.is_concurrency_enabled ? data_node_mutex_lock_wrapper(DATA_NODE_UPDATE, data_node_ptr, new_value) : update_data_node(data_node_ptr, new_value);
+    hash_bucket *hash_bucket_ptr = NULL;
+    bool is_migration_complete = false;
+    result = _begin_bucket_operation(pool_ptr, key_hash, &hash_bucket_ptr, &is_migration_complete);
+    if (result != 0) {
+        delete_data_node(&pool_ptr->data_node_counters, new_data_node);
+        return result; // Error handling: bucket not found or initialized
     }
-    else if (result == -41)
-    {
-        // Node does not exist, add it
-        return _add_node_to_bucket(index, key, key_hash, new_value);
+
+    // Lookup and insert-or-update in a single write-locked pass
+    data_node* data_node_ptr = NULL;
+    bucket_operation_args input_args = {pool_ptr, hash_bucket_ptr, key, key_len, key_hash, new_data_node};
+
+    result = pool_ptr->is_concurrency_enabled ? _hash_bucket_lock_wrapper(UPSERT_NODE, input_args, &data_node_ptr) : _upsert_node(input_args, &data_node_ptr);
+
+    bool is_node_added = (result == 0 && data_node_ptr == NULL);
+    if (is_node_added) {
+        atomic_fetch_add(&pool_ptr->total_keys, 1);
+    } else if (result != 0 || data_node_ptr == new_data_node) {
+        delete_data_node(&pool_ptr->data_node_counters, new_data_node);
+    } else {
+        // Replaced node, lock-free readers may still hold it and pinned readers keep it alive
+        epoch_retire(pool_ptr->node_context.epoch_manager_ptr, data_node_ptr, _reclaim_data_node, &pool_ptr->data_node_counters);
     }
 
+    _end_bucket_operation(pool_ptr, is_migration_complete, is_node_added);
     return result;
 }
 
 
-int find_node_in_bucket(unsigned int index, const char *key, uint32_t key_hash, key_store_value* value_out)
+int find_node_in_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* value_out)
 {
-    if (key == NULL || value_out == NULL) return -20; // Error handling: invalid input
+    if (pool_ptr == NULL || key == NULL || value_out == NULL) return -20; // Error handling: invalid input
 
-    hash_bucket *hash_bucket_ptr = get_hash_bucket(index);
-    if (hash_bucket_ptr == NULL) return -40; // Error handling: bucket not found or initialized
+    data_node* data_node_ptr = NULL;
+    int result = _begin_node_read(pool_ptr, key, key_len, key_hash, &data_node_ptr);
+    if (result != 0) return result; // Error handling: bucket or node not found
 
-    bucket_operation_args input_args = {hash_bucket_ptr, key, key_hash, NULL};
+    result = data_node_lock_wrapper(&pool_ptr->data_node_counters, DATA_NODE_READ, data_node_ptr, value_out);
+    _end_node_read(pool_ptr, data_node_ptr);
+    return result;
+}
+
+int view_node_in_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_view_callback callback, void *context, uint32_t *version_out)
+{
+    if (pool_ptr == NULL || key == NULL || callback == NULL) return -20; // Error handling: invalid input
+
+    data_node* data_node_ptr = NULL;
+    int result = _begin_node_read(pool_ptr, key, key_len, key_hash, &data_node_ptr);
+    if (result != 0) return result; // Error handling: bucket or node not found
+
+    result = data_node_view_wrapper(&pool_ptr->data_node_counters, data_node_ptr, callback, context, version_out);
+    _end_node_read(pool_ptr, data_node_ptr);
+    return result;
+}
+
+int find_nodes_in_bucket_batch(hash_bucket_memory_pool* pool_ptr, const key_store_prepared_key *keys, size_t key_count, key_store_value *values_out, int *results_out)
+{
+    if (pool_ptr == NULL || keys == NULL || values_out == NULL || results_out == NULL || key_count > KEY_STORE_BATCH_GROUP_SIZE) return -20; // Error handling: invalid input
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+
+    epoch_manager *epoch_manager_ptr = pool_ptr->node_context.epoch_manager_ptr;
+    if (pool_ptr->is_lock_free_read_enabled) epoch_enter(epoch_manager_ptr);
+
+    hash_bucket *hash_buckets[KEY_STORE_BATCH_GROUP_SIZE];
+    data_node *data_nodes[KEY_STORE_BATCH_GROUP_SIZE];
+    size_t order[KEY_STORE_BATCH_GROUP_SIZE];
+    bool is_migration_complete = false;
+    for (size_t i = 0; i < key_count; ++i) results_out[i] = 0;
 
-    data_node* data_node_ptr;
     int result = 0;
-    result = g_hash_bucket_pool.is_concurrency_enabled ? _hash_bucket_lock_wrapper(FIND_NODE, input_args, &data_node_ptr) : _find_node(input_args, &data_node_ptr);
+    if (pool_ptr->is_lock_free_read_enabled) {
+        _find_nodes_in_tables(pool_ptr, keys, key_count, data_nodes, results_out);
+    } else {
+        result = _begin_batch_operation(pool_ptr, keys, key_count, hash_buckets, order, results_out, &is_migration_complete);
+        if (result == 0) {
+            _run_batch_by_bucket(pool_ptr, FIND_NODE, keys, key_count, hash_buckets, order, NULL, data_nodes, results_out);
+            _end_bucket_operation(pool_ptr, is_migration_complete, false);
+        }
+    }
+
+    if (result == 0) {
+        // The data nodes were pinned (or the epoch is held), start loading every value before the first one is copied
+        for (size_t i = 0; i < key_count; ++i) {
+            if (results_out[i] == 0) __builtin_prefetch(data_nodes[i]->data);
+        }
+
+        for (size_t i = 0; i < key_count; ++i) {
+            if (results_out[i] != 0) continue;
+            results_out[i] = data_node_lock_wrapper(&pool_ptr->data_node_counters, DATA_NODE_READ, data_nodes[i], &values_out[i]);
+            if (pool_ptr->is_concurrency_enabled && !pool_ptr->is_lock_free_read_enabled) unpin_data_node(&pool_ptr->data_node_counters, data_nodes[i]);
+        }
+    }
+
+    if (pool_ptr->is_lock_free_read_enabled) epoch_exit(epoch_manager_ptr);
+    return _first_batch_error(results_out, key_count);
+}
+
+int upsert_nodes_to_bucket_batch(hash_bucket_memory_pool* pool_ptr, const key_store_prepared_key *keys, size_t key_count, key_store_value *values, int *results_out)
+{
+    if (pool_ptr == NULL || keys == NULL || values == NULL || results_out == NULL || key_count > KEY_STORE_BATCH_GROUP_SIZE) return -20; // Error handling: invalid input
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+
+    // Create the data nodes speculatively, outside any lock, as upsert_node_to_bucket does
+    data_node *new_data_nodes[KEY_STORE_BATCH_GROUP_SIZE];
+    for (size_t i = 0; i < key_count; ++i) {
+        new_data_nodes[i] = NULL;
+        results_out[i] = create_data_node(&pool_ptr->data_node_counters, pool_ptr->node_context.memory_manager_ptr, keys[i].key, keys[i].key_len, keys[i].key_hash, &values[i], pool_ptr->node_sync_mode, pool_ptr->inline_value_threshold, &new_data_nodes[i]);
+    }
+
+    hash_bucket *hash_buckets[KEY_STORE_BATCH_GROUP_SIZE];
+    data_node *released_nodes[KEY_STORE_BATCH_GROUP_SIZE];
+    size_t order[KEY_STORE_BATCH_GROUP_SIZE];
+    bool is_migration_complete = false;
+    bool is_key_count_changed = false;
+    for (size_t i = 0; i < key_count; ++i) released_nodes[i] = new_data_nodes[i];
+
+    int result = _begin_batch_operation(pool_ptr, keys, key_count, hash_buckets, order, results_out, &is_migration_complete);
+    if (result == 0) _run_batch_by_bucket(pool_ptr, UPSERT_NODE, keys, key_count, hash_buckets, order, new_data_nodes, released_nodes, results_out);
+
+    for (size_t i = 0; i < key_count; ++i) {
+        if (new_data_nodes[i] == NULL) continue;
+
+        if (results_out[i] == 0 && released_nodes[i] == NULL) {
+            atomic_fetch_add(&pool_ptr->total_keys, 1);
+            is_key_count_changed = true;
+        } else if (results_out[i] != 0 || released_nodes[i] == new_data_nodes[i]) {
+            delete_data_node(&pool_ptr->data_node_counters, new_data_nodes[i]);
+        } else {
+            // Replaced node, lock-free readers may still hold it and pinned readers keep it alive
+            epoch_retire(pool_ptr->node_context.epoch_manager_ptr, released_nodes[i], _reclaim_data_node, &pool_ptr->data_node_counters);
+        }
+    }
 
-    if(result != 0) return result;
-    return g_hash_bucket_pool.is_concurrency_enabled ? data_node_mutex_lock_wrapper(DATA_NODE_READ, data_node_ptr, value_out) : get_data_from_node(data_node_ptr, value_out);
+    if (result == 0) _end_bucket_operation(pool_ptr, is_migration_complete, is_key_count_changed);
+    return _first_batch_error(results_out, key_count);
 }
 
-int delete_node_from_bucket(unsigned int index, const char *key, uint32_t key_hash)
+int update_node_in_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_update_callback callback, void *context)
 {
-    if (key == NULL) return -20; // Error handling: invalid input
+    if (pool_ptr == NULL || key == NULL || callback == NULL) return -20; // Error handling: invalid input
+
+    hash_bucket *hash_bucket_ptr = NULL;
+    bool is_migration_complete = false;
+    int result = _begin_bucket_operation(pool_ptr, key_hash, &hash_bucket_ptr, &is_migration_complete);
+    if (result != 0) return result; // Error handling: bucket not found or initialized
+
+    // The callback and the store of its value happen in a single write-locked pass
+    data_node* released_node_ptr = NULL;
+    bool is_node_added = false;
+    bucket_operation_args input_args = {pool_ptr, hash_bucket_ptr, key, key_len, key_hash, NULL};
+
+    result = pool_ptr->is_concurrency_enabled ? _hash_bucket_update_lock_wrapper(input_args, callback, context, &released_node_ptr, &is_node_added) : _update_node(input_args, callback, context, &released_node_ptr, &is_node_added);
+
+    if (is_node_added) {
+        atomic_fetch_add(&pool_ptr->total_keys, 1);
+    } else if (released_node_ptr != NULL) {
+        // Replaced node, lock-free readers may still hold it and pinned readers keep it alive
+        epoch_retire(pool_ptr->node_context.epoch_manager_ptr, released_node_ptr, _reclaim_data_node, &pool_ptr->data_node_counters);
+    }
+
+    _end_bucket_operation(pool_ptr, is_migration_complete, is_node_added);
+    return result;
+}
+
+int delete_node_from_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash)
+{
+    if (pool_ptr == NULL || key == NULL) return -20; // Error handling: invalid input
     
-    hash_bucket *hash_bucket_ptr = get_hash_bucket(index);
-    if (hash_bucket_ptr == NULL) return -40; // Error handling: bucket not found or initialized
+    hash_bucket *hash_bucket_ptr = NULL;
+    bool is_migration_complete = false;
+    int result = _begin_bucket_operation(pool_ptr, key_hash, &hash_bucket_ptr, &is_migration_complete);
+    if (result != 0) return result; // Error handling: bucket not found or initialized
 
-    bucket_operation_args input_args = {hash_bucket_ptr, key, key_hash, NULL};
+    bucket_operation_args input_args = {pool_ptr, hash_bucket_ptr, key, key_len, key_hash, NULL};
 
     data_node* data_node_ptr;
 
-    return g_hash_bucket_pool.is_concurrency_enabled ? _hash_bucket_lock_wrapper(DELETE_NODE, input_args, &data_node_ptr) : _delete_node(input_args, &data_node_ptr);
+    result = pool_ptr->is_concurrency_enabled ? _hash_bucket_lock_wrapper(DELETE_NODE, input_args, &data_node_ptr) : _delete_node(input_args, &data_node_ptr);
+    if (result == 0) {
+        atomic_fetch_sub(&pool_ptr->total_keys, 1);
+        // Drop the bucket's reference, pinned readers keep the node alive until they are done
+        if (pool_ptr->is_lock_free_read_enabled) epoch_retire(pool_ptr->node_context.epoch_manager_ptr, data_node_ptr, _reclaim_data_node, &pool_ptr->data_node_counters);
+        else unpin_data_node(&pool_ptr->data_node_counters, data_node_ptr);
+    }
+
+    _end_bucket_operation(pool_ptr, is_migration_complete, result == 0);
+    return result;
 }
 
-void get_hash_bucket_pool_stats(keystore_stats* pool_out)
+void get_hash_bucket_pool_stats(hash_bucket_memory_pool* pool_ptr, keystore_stats* pool_out)
 {
-    if (pool_out == NULL) return;
+    if (pool_ptr == NULL || pool_out == NULL) return;
+
+    if (_resize_lock(pool_ptr, false) != 0) return;
     
-    pool_out->key_entries = _calculate_key_entry_stats(&g_hash_bucket_pool);
-    pool_out->collisions = _calculate_collision_stats(&g_hash_bucket_pool);
-    pool_out->memory_pool = _calculate_memory_stats(&g_hash_bucket_pool, pool_out->key_entries.total_keys);
-    pool_out->operation_counters = _get_operation_counters();
-    pool_out->data_node_counters = get_data_node_operation_counters();
+    bucket_occupancy_summary occupancy;
+    _sum_bucket_occupancy(pool_ptr, &occupancy);
+    pool_out->key_entries = _calculate_key_entry_stats(&occupancy);
+    pool_out->collisions = _calculate_collision_stats(pool_ptr, &occupancy);
+    pool_out->memory_pool = _calculate_memory_stats(pool_ptr, &occupancy);
+    sum_bucket_operation_counters(&pool_ptr->operation_counters, &pool_out->operation_counters);
+    sum_data_node_operation_counters(&pool_ptr->data_node_counters, &pool_out->data_node_counters);
+
+    _resize_unlock(pool_ptr, false);
 }
 
 #pragma endregion
@@ -192,6 +518,30 @@ static bool _is_power_of_two(unsigned int n) {
     return n > 0 && (n & (n - 1)) == 0;
 }
 
+static bool _is_valid_lock_type(bucket_lock_type_t lock_type) {
+    return lock_type == BUCKET_LOCK_RWLOCK || lock_type == BUCKET_LOCK_SPIN || lock_type == BUCKET_LOCK_TICKET;
+}
+
+/**
+ * @fn _has_bucket_locks
+ * @brief Checks whether every bucket carries its own lock, which is the case with concurrency enabled and no lock stripes.
+ */
+static bool _has_bucket_locks(const hash_bucket_memory_pool* pool_ptr) {
+    return pool_ptr->is_concurrency_enabled && pool_ptr->lock_stripes_ptr == NULL;
+}
+
+/**
+ * @fn _free_lock_storage_and_reset
+ * @brief Frees the bucket table, its rwlock array and the lock stripes, and resets the pool to zero.
+ * @note The locks themselves must be destroyed already.
+ */
+static void _free_lock_storage_and_reset(hash_bucket_memory_pool* pool_ptr) {
+    free(pool_ptr->hash_buckets_ptr);
+    free(pool_ptr->bucket_rwlocks_ptr);
+    free(pool_ptr->lock_stripes_ptr);
+    *pool_ptr = (hash_bucket_memory_pool){0};
+}
+
 
 /**
  * @fn _initialise_hash_bucket
@@ -199,16 +549,18 @@ static bool _is_power_of_two(unsigned int n) {
  *
  * This function sets the type of the hash bucket to BUCKET_LIST,
  * initializes its container to NULL, sets the count to 0, marks it
- * as initialized, and initializes the read-write lock for concurrency control.
+ * as initialized, and initializes the bucket lock for concurrency control.
  *
+ * @param pool_ptr Pointer to the hash bucket memory pool owning the bucket.
  * @param hash_bucket_ptr Pointer to the hash_bucket structure to be initialized.
- * @return int Returns 0 on success, or -1 on failure.
+ * @param rwlock_ptr The bucket's slot in the rwlock array of its table with BUCKET_LOCK_RWLOCK, NULL otherwise.
+ * @return int Returns 0 on success, or -11 if the lock could not be initialized.
  */
-static int _initialise_hash_bucket(hash_bucket *hash_bucket_ptr) {
+static int _initialise_hash_bucket(hash_bucket_memory_pool* pool_ptr, hash_bucket *hash_bucket_ptr, pthread_rwlock_t *rwlock_ptr) {
 
-    if (g_hash_bucket_pool.is_concurrency_enabled)
+    if (_has_bucket_locks(pool_ptr))
     {
-        if (pthread_rwlock_init(&hash_bucket_ptr->lock, NULL) != 0) {
+        if (initialise_bucket_lock(&hash_bucket_ptr->lock, pool_ptr->lock_type, rwlock_ptr) != 0) {
             return -11; // Error handling: lock initialization failed
         }
     }
@@ -217,31 +569,37 @@ static int _initialise_hash_bucket(hash_bucket *hash_bucket_ptr) {
     hash_bucket_ptr->container.list = NULL;
     hash_bucket_ptr->count = 0;
     hash_bucket_ptr->is_initialized = true;
+    atomic_init(&hash_bucket_ptr->is_migrated, false);
+    atomic_init(&hash_bucket_ptr->version, 0);
     
     return 0;
 }
 
 /**
  * @fn _delete_hash_bucket
- * @brief Cleans up and resets a hash bucket at the specified index.
+ * @brief Cleans up and resets the given hash bucket.
  *
  * This function deletes all nodes in the hash bucket, frees associated memory,
  * and resets the bucket's properties to indicate it is uninitialized.
  *
- * @param index The index of the hash bucket to be deleted.
+ * @param pool_ptr Pointer to the hash bucket memory pool owning the bucket.
+ * @param hash_bucket_ptr Pointer to the hash bucket to be deleted.
  */
-static void _delete_hash_bucket(unsigned int index) {
+static void _delete_hash_bucket(hash_bucket_memory_pool* pool_ptr, hash_bucket *hash_bucket_ptr) {
 
-    hash_bucket *hash_bucket_ptr = get_hash_bucket(index);
-    if (hash_bucket_ptr == NULL) return; // Bucket not initialized, nothing to delete
+    if (hash_bucket_ptr == NULL || !hash_bucket_ptr->is_initialized) return; // Bucket not initialized, nothing to delete
 
     // Free resources based on bucket type
     switch (hash_bucket_ptr->type)
     {
         case BUCKET_LIST: 
-            delete_all_list_nodes(hash_bucket_ptr->container.list);
+            delete_all_list_nodes(&pool_ptr->node_context, hash_bucket_ptr->container.list);
             hash_bucket_ptr->container.list = NULL;
             break;
+        case BUCKET_TREE: 
+            delete_all_tree_nodes(&pool_ptr->node_context, hash_bucket_ptr->container.tree);
+            hash_bucket_ptr->container.tree = NULL;
+            break;
         default: return; // Error handling: unsupported bucket type
     }
     
@@ -249,53 +607,296 @@ static void _delete_hash_bucket(unsigned int index) {
     hash_bucket_ptr->type = NONE;
     hash_bucket_ptr->count = 0;
     hash_bucket_ptr->is_initialized = false;
-    if (g_hash_bucket_pool.is_concurrency_enabled) pthread_rwlock_destroy(&hash_bucket_ptr->lock);
+    if (_has_bucket_locks(pool_ptr)) destroy_bucket_lock(&hash_bucket_ptr->lock, pool_ptr->lock_type);
 }
 
 /**
- * @fn _add_node_to_bucket
- * @brief Adds a new node with the specified key and value to the hash bucket at the given index.
+ * @fn _begin_bucket_operation
+ * @brief Prepares a bucket operation on the given key hash.
  *
- * This function creates a new data node and a corresponding list node,
- * then inserts the list node into the hash bucket's linked list.
- * If any step fails, it cleans up allocated resources and returns an error code.
+ * This function takes the resize lock shared, advances an in-progress incremental resize
+ * (draining the key's old bucket first), and resolves the bucket of the current table
+ * that owns the key. On failure the resize lock is released before returning.
  *
- * @param index The index of the hash bucket to which the node will be added.
- * @param key The key string for the new node.
+ * @param pool_ptr Pointer to the hash bucket memory pool.
  * @param key_hash The hash value of the key.
- * @param new_value Pointer to the key_store_value containing the data to be stored in the new node.
+ * @param hash_bucket_out Pointer to receive the owning hash bucket.
+ * @param is_migration_complete_out Pointer to receive whether the old table can now be released.
  * @return int Returns 0 on success, or a negative error code on failure.
+ * @note Every successful call must be paired with _end_bucket_operation.
  */
-int _add_node_to_bucket(unsigned int index,  const char *key, uint32_t key_hash, key_store_value* new_value)
+static int _begin_bucket_operation(hash_bucket_memory_pool* pool_ptr, uint32_t key_hash, hash_bucket **hash_bucket_out, bool *is_migration_complete_out)
 {
-    if (key == NULL || new_value == NULL) return -20; // Error handling: invalid input
+    *is_migration_complete_out = false;
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
 
-    // Get the target hash bucket
-    hash_bucket *hash_bucket_ptr = get_hash_bucket(index);
-    if (hash_bucket_ptr == NULL) return -40; // Error handling: bucket not found or initialized
+    if (_resize_lock(pool_ptr, false) != 0) return -30; // Handle error: failed to acquire lock
 
-    // Create new data node
-    data_node* new_data_node = NULL;
-    int create_result = create_data_node(key, key_hash, new_value, g_hash_bucket_pool.is_concurrency_enabled, &new_data_node);
-    if (create_result != 0) return create_result; // Error handling: memory allocation failure
-
-    // Create new list node
-    list_node* new_list_node = create_new_list_node(key_hash, new_data_node);
-    if (new_list_node == NULL) {
-        delete_data_node(new_data_node);
-        return -10; // Error handling: memory allocation failure
-    }
+    int result = _incremental_migration_step(pool_ptr, key_hash, is_migration_complete_out);
 
-    bucket_operation_args input_args = {hash_bucket_ptr, key, key_hash, new_list_node};
+    *hash_bucket_out = (result == 0) ? _get_bucket_for_key(pool_ptr, key_hash) : NULL;
+    if (result == 0 && *hash_bucket_out == NULL) result = -40; // Error handling: bucket not found or initialized
 
-    int result = g_hash_bucket_pool.is_concurrency_enabled ? _hash_bucket_lock_wrapper(ADD_NODE, input_args , NULL) : _add_node(input_args);
+    if (result != 0) _resize_unlock(pool_ptr, false);
+    return result;
+}
 
-    if (result != 0) {
-        delete_data_node(new_data_node);
-        free_memory(new_list_node, LIST_POOL);
+/**
+ * @fn _end_bucket_operation
+ * @brief Completes a bucket operation started with _begin_bucket_operation.
+ *
+ * This function releases the resize lock, releases the old table if the migration just
+ * completed, and starts a new resize if the key count change crossed one of the resize
+ * thresholds. Checking the thresholds takes no lock.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param is_migration_complete Whether _begin_bucket_operation reported a completed migration.
+ * @param is_key_count_changed Whether the operation added or removed a key.
+ */
+static void _end_bucket_operation(hash_bucket_memory_pool* pool_ptr, bool is_migration_complete, bool is_key_count_changed)
+{
+    _resize_unlock(pool_ptr, false);
+
+    if (is_migration_complete) _finish_resize(pool_ptr);
+    if (is_key_count_changed) _resize_hash_buckets(pool_ptr);
+}
+
+/**
+ * @fn _begin_node_read
+ * @brief Finds a data node and protects it from reclamation until _end_node_read.
+ *
+ * With lock-free reads the lookup runs inside an epoch critical section that stays open until
+ * _end_node_read, so the node cannot be reclaimed while it is read, and takes neither the resize lock
+ * nor part in a resize (see _find_node_in_tables). Otherwise the node is pinned under the bucket lock
+ * when concurrency is enabled, so a concurrent delete cannot free it, and the bucket operation ends
+ * before returning; a resize only relinks nodes and never frees them.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param key The key string of the node to find.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key.
+ * @param data_node_out Pointer to receive the protected data node.
+ * @return int Returns 0 on success, or a negative error code on failure, in which case nothing is held.
+ * @note Every successful call must be paired with _end_node_read.
+ */
+static int _begin_node_read(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node **data_node_out)
+{
+    if (pool_ptr->is_lock_free_read_enabled) {
+        epoch_manager *epoch_manager_ptr = pool_ptr->node_context.epoch_manager_ptr;
+        epoch_enter(epoch_manager_ptr);
+        int result = _find_node_in_tables(pool_ptr, key, key_len, key_hash, data_node_out);
+        if (result != 0) epoch_exit(epoch_manager_ptr);
+        return result;
+    }
+
+    hash_bucket *hash_bucket_ptr = NULL;
+    bool is_migration_complete = false;
+    int result = _begin_bucket_operation(pool_ptr, key_hash, &hash_bucket_ptr, &is_migration_complete);
+    if (result == 0) {
+        bucket_operation_args input_args = {pool_ptr, hash_bucket_ptr, key, key_len, key_hash, NULL};
+        result = pool_ptr->is_concurrency_enabled ? _hash_bucket_lock_wrapper(FIND_NODE, input_args, data_node_out) : _find_node(input_args, data_node_out);
+        _end_bucket_operation(pool_ptr, is_migration_complete, false);
     }
 
     return result;
 }
 
+/**
+ * @fn _end_node_read
+ * @brief Releases the protection taken on a data node by _begin_node_read.
+ */
+static void _end_node_read(hash_bucket_memory_pool* pool_ptr, data_node *data_node_ptr)
+{
+    if (pool_ptr->is_lock_free_read_enabled) epoch_exit(pool_ptr->node_context.epoch_manager_ptr);
+    else if (pool_ptr->is_concurrency_enabled) unpin_data_node(&pool_ptr->data_node_counters, data_node_ptr);
+}
+
+/**
+ * @fn _find_node_in_tables
+ * @brief Finds a data node for a lock-free reader, without the resize lock.
+ *
+ * The reader neither waits for nor advances a resize: it looks the key up in its old bucket while
+ * that is not drained yet, and in the current table otherwise. If the bucket is drained while it
+ * is read, a miss is not trusted and the lookup is repeated on a fresh snapshot of the tables.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param key The key string of the node to find.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key.
+ * @param data_node_out Pointer to receive the found data node.
+ * @return int Returns 0 on success, -40 if the buckets are not initialized, -41 if the node was not found, or a lock error code.
+ * @note The caller must be inside an epoch critical section until it is done with *data_node_out.
+ */
+static int _find_node_in_tables(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node **data_node_out)
+{
+    if (!pool_ptr->is_initialized) return -40; // Error handling: buckets not initialized
+
+    for (;;) {
+        bucket_table_snapshot tables;
+        _load_bucket_tables(pool_ptr, &tables);
+
+        hash_bucket *hash_bucket_ptr = _get_read_bucket(&tables, key_hash);
+        bucket_operation_args input_args = {pool_ptr, hash_bucket_ptr, key, key_len, key_hash, NULL};
+        int result = _find_node_lock_free(input_args, data_node_out);
+
+        // The keys of a drained bucket moved to the current table, which the next snapshot leads to
+        if (result != -41 || !atomic_load_explicit(&hash_bucket_ptr->is_migrated, memory_order_acquire)) return result;
+    }
+}
+
+/**
+ * @fn _find_nodes_in_tables
+ * @brief Finds the data nodes of a batch for a lock-free reader, see _find_node_in_tables.
+ *
+ * The bucket headers of all keys are prefetched before the first key is looked up.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param keys The prepared keys of the batch.
+ * @param key_count Number of keys, at most KEY_STORE_BATCH_GROUP_SIZE.
+ * @param data_nodes_out Receives the found data node of each key.
+ * @param results_out Result of each key; keys with a non-zero result are skipped.
+ * @note The caller must be inside an epoch critical section until it is done with the data nodes.
+ */
+static void _find_nodes_in_tables(hash_bucket_memory_pool* pool_ptr, const key_store_prepared_key *keys, size_t key_count, data_node **data_nodes_out, int *results_out)
+{
+    bucket_table_snapshot tables;
+    _load_bucket_tables(pool_ptr, &tables);
+    for (size_t i = 0; i < key_count; ++i) __builtin_prefetch(_get_read_bucket(&tables, keys[i].key_hash));
+
+    for (size_t i = 0; i < key_count; ++i) {
+        if (results_out[i] == 0) results_out[i] = _find_node_in_tables(pool_ptr, keys[i].key, keys[i].key_len, keys[i].key_hash, &data_nodes_out[i]);
+    }
+}
+
+/**
+ * @fn _begin_batch_operation
+ * @brief Prepares a batched bucket operation: resolves the bucket of every key and groups the keys by bucket.
+ *
+ * The keys' dependent loads are overlapped in stages instead of being walked one key at a time: the
+ * bucket headers of all keys are prefetched first, then each bucket is resolved (draining its old
+ * bucket if a resize is in progress) and the head of its chain is prefetched. Finally the keys are
+ * ordered by bucket, stably so that later keys of the batch are applied after earlier ones.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param keys The prepared keys of the batch.
+ * @param key_count Number of keys, at most KEY_STORE_BATCH_GROUP_SIZE.
+ * @param hash_buckets_out Receives the owning bucket of each key.
+ * @param order_out Receives the key indices ordered by bucket.
+ * @param results_out Result of each key; keys with a non-zero result are skipped, failures to resolve a bucket are stored.
+ * @param is_migration_complete_out Pointer to receive whether the old table can now be released.
+ * @return int Returns 0 on success, or -30 if the resize lock could not be taken.
+ * @note Every successful call must be paired with _end_bucket_operation.
+ */
+static int _begin_batch_operation(hash_bucket_memory_pool* pool_ptr, const key_store_prepared_key *keys, size_t key_count, hash_bucket **hash_buckets_out, size_t *order_out, int *results_out, bool *is_migration_complete_out)
+{
+    *is_migration_complete_out = false;
+    if (_resize_lock(pool_ptr, false) != 0) {
+        for (size_t i = 0; i < key_count; ++i) {
+            if (results_out[i] == 0) results_out[i] = -30;
+        }
+        return -30; // Handle error: failed to acquire lock
+    }
+
+    unsigned int bucket_mask = pool_ptr->total_blocks - 1;
+    for (size_t i = 0; i < key_count; ++i) __builtin_prefetch(&pool_ptr->hash_buckets_ptr[keys[i].key_hash & bucket_mask]);
+
+    for (size_t i = 0; i < key_count; ++i) {
+        hash_buckets_out[i] = NULL;
+        if (results_out[i] != 0) continue;
+
+        bool is_migration_complete = false;
+        results_out[i] = _incremental_migration_step(pool_ptr, keys[i].key_hash, &is_migration_complete);
+        if (is_migration_complete) *is_migration_complete_out = true;
+        if (results_out[i] != 0) continue;
+
+        hash_buckets_out[i] = _get_bucket_for_key(pool_ptr, keys[i].key_hash);
+        if (hash_buckets_out[i] == NULL) results_out[i] = -40; // Error handling: bucket not found or initialized
+        else __builtin_prefetch(atomic_load_explicit(&hash_buckets_out[i]->container.list, memory_order_relaxed)); // A tree's root shares the slot
+    }
+
+    for (size_t i = 0; i < key_count; ++i) {
+        size_t j = i;
+        order_out[j] = i;
+        while (j > 0 && (uintptr_t)hash_buckets_out[order_out[j - 1]] > (uintptr_t)hash_buckets_out[i]) {
+            order_out[j] = order_out[j - 1];
+            j--;
+        }
+        order_out[j] = i;
+    }
+
+    return 0;
+}
+
+/**
+ * @fn _run_batch_by_bucket
+ * @brief Runs the operation of every pending key of a batch, taking each bucket's lock once.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param operation_type FIND_NODE or UPSERT_NODE.
+ * @param keys The prepared keys of the batch.
+ * @param key_count Number of keys.
+ * @param hash_buckets The owning bucket of each key, from _begin_batch_operation.
+ * @param order The key indices ordered by bucket, from _begin_batch_operation.
+ * @param new_data_nodes The speculatively created data node of each key for UPSERT_NODE, NULL for FIND_NODE.
+ * @param data_nodes_out Receives the found or released data node of each key, as for the single-key operations.
+ * @param results_out Result of each key; keys with a non-zero result are skipped.
+ */
+static void _run_batch_by_bucket(hash_bucket_memory_pool* pool_ptr, bucket_operation_type_t operation_type, const key_store_prepared_key *keys, size_t key_count, hash_bucket **hash_buckets, const size_t *order, data_node **new_data_nodes, data_node **data_nodes_out, int *results_out)
+{
+    size_t group_start = 0;
+    while (group_start < key_count) {
+        hash_bucket *hash_bucket_ptr = hash_buckets[order[group_start]];
+        size_t group_end = group_start + 1;
+        while (group_end < key_count && hash_buckets[order[group_end]] == hash_bucket_ptr) group_end++;
+
+        bucket_operation_args args[KEY_STORE_BATCH_GROUP_SIZE];
+        size_t indices[KEY_STORE_BATCH_GROUP_SIZE];
+        size_t count = 0;
+        for (size_t k = group_start; k < group_end; ++k) {
+            size_t i = order[k];
+            if (results_out[i] != 0) continue;
+
+            args[count] = (bucket_operation_args){pool_ptr, hash_bucket_ptr, keys[i].key, keys[i].key_len, keys[i].key_hash, (new_data_nodes != NULL) ? new_data_nodes[i] : NULL};
+            indices[count++] = i;
+        }
+        group_start = group_end;
+        if (count == 0) continue;
+
+        data_node *data_nodes[KEY_STORE_BATCH_GROUP_SIZE];
+        int results[KEY_STORE_BATCH_GROUP_SIZE];
+        if (pool_ptr->is_concurrency_enabled) {
+            _hash_bucket_batch_lock_wrapper(operation_type, args, count, data_nodes, results);
+        } else {
+            for (size_t j = 0; j < count; ++j) results[j] = (operation_type == FIND_NODE) ? _find_node(args[j], &data_nodes[j]) : _upsert_node(args[j], &data_nodes[j]);
+        }
+
+        for (size_t j = 0; j < count; ++j) {
+            results_out[indices[j]] = results[j];
+            if (results[j] == 0) data_nodes_out[indices[j]] = data_nodes[j];
+        }
+    }
+}
+
+/**
+ * @fn _first_batch_error
+ * @brief Returns the first non-zero result of a batch, or 0 if every key succeeded.
+ */
+static int _first_batch_error(const int *results, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (results[i] != 0) return results[i];
+    }
+    return 0;
+}
+
+/**
+ * @fn _reclaim_data_node
+ * @brief Epoch reclaim callback that releases the bucket's reference on a retired data node.
+ * @param context Pointer to the data node counters of the owning table.
+ */
+static void _reclaim_data_node(void *data_node_ptr, void *context)
+{
+    unpin_data_node(context, data_node_ptr);
+}
+
 #pragma endregion
\ No newline at end of file
@@ -7,66 +7,241 @@
 /**
  * @fn initialise_hash_buckets
  * @brief Initializes the hash bucket system with the specified bucket size.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
  * @param bucket_size The number of buckets to allocate.
  * @param is_concurrency_enabled Flag to enable or disable concurrency control.
- * @return 0 on success, non-zero on failure.
+ * @param memory_manager_ptr Pointer to the memory manager list and tree nodes are allocated from.
+ * @return 0 on success, -20 if pool_ptr is NULL, or another non-zero code on failure.
+ */
+int initialise_hash_buckets(hash_bucket_memory_pool* pool_ptr, unsigned int bucket_size, bool is_concurrency_enabled, memory_manager* memory_manager_ptr);
+
+/**
+ * @fn initialise_hash_buckets_with_lock_config
+ * @brief Initializes the hash bucket system with the given bucket locks (see bucket_lock.h).
+ *
+ * initialise_hash_buckets gives every bucket its own BUCKET_LOCK_RWLOCK. With lock_config.stripe_count set,
+ * the buckets share that many cache line sized locks instead, bucket i is guarded by stripe i % stripe_count.
+ * No lock is initialized per bucket then, which keeps the memory and the initialization time of large tables
+ * independent of their lock count.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param bucket_size The number of buckets to allocate.
+ * @param is_concurrency_enabled Flag to enable or disable concurrency control.
+ * @param lock_config Lock type and stripe count. A stripe count above bucket_size is reduced to bucket_size.
+ * @param memory_manager_ptr Pointer to the memory manager list and tree nodes are allocated from.
+ * @return 0 on success, -20 if pool_ptr is NULL, -21 if the lock type is unknown, the stripe count is not a power of two
+ *         or locks are configured without concurrency, or another non-zero code on failure.
+ */
+int initialise_hash_buckets_with_lock_config(hash_bucket_memory_pool* pool_ptr, unsigned int bucket_size, bool is_concurrency_enabled, bucket_lock_config lock_config, memory_manager* memory_manager_ptr);
+
+/**
+ * @fn configure_hash_bucket_resize
+ * @brief Configures the load factors that drive incremental resizing of the bucket table.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param grow_load_factor Average keys per bucket above which the table doubles (0 disables growth).
+ * @param shrink_load_factor Average keys per bucket below which the table halves (0 disables shrinking).
+ * @return 0 on success, -21 on invalid load factors, -40 if the buckets are not initialized.
+ * @note Resizing is disabled until this function is called. The table never shrinks below its initial size.
+ * @note Buckets are migrated incrementally by subsequent operations, so no single call rehashes the whole table.
+ */
+int configure_hash_bucket_resize(hash_bucket_memory_pool* pool_ptr, double grow_load_factor, double shrink_load_factor);
+
+/**
+ * @fn configure_hash_bucket_tree
+ * @brief Configures the bucket count at which a bucket's linked list is converted to a red-black tree.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param treeify_threshold Keys per bucket at which the bucket is treeified (0 disables treeification).
+ * @return 0 on success, -21 on an invalid threshold, -40 if the buckets are not initialized.
+ * @note A tree bucket is converted back to a list once it holds fewer than half of treeify_threshold keys.
+ * @note Tree nodes are allocated from the TREE_POOL of the memory manager.
  */
-int initialise_hash_buckets(unsigned int bucket_size, bool is_concurrency_enabled);
+int configure_hash_bucket_tree(hash_bucket_memory_pool* pool_ptr, unsigned int treeify_threshold);
+
+/**
+ * @fn configure_hash_bucket_lock_free_read
+ * @brief Enables or disables lookups that do not take the bucket lock.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param epoch_manager_ptr Initialized epoch manager that reclaims unlinked nodes, or NULL to disable lock-free reads.
+ * @return 0 on success, -21 if enabled without concurrency, -40 if the buckets are not initialized.
+ * @note While enabled, updates replace the data node of a key instead of writing into it, and deleted
+ *       or replaced data nodes are retired through the epoch manager. New data nodes then need no
+ *       mutex and are created with DATA_NODE_SYNC_SEQLOCK.
+ */
+int configure_hash_bucket_lock_free_read(hash_bucket_memory_pool* pool_ptr, epoch_manager* epoch_manager_ptr);
+
+/**
+ * @fn configure_hash_bucket_node_sync
+ * @brief Configures how reads of new data nodes are synchronized with in-place updates.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param sync_mode DATA_NODE_SYNC_NONE without concurrency, else DATA_NODE_SYNC_MUTEX or DATA_NODE_SYNC_SEQLOCK.
+ * @return 0 on success, -21 if the mode does not match the concurrency setting or a mutex is requested with lock-free reads, -40 if the buckets are not initialized.
+ * @note Concurrent buckets use DATA_NODE_SYNC_MUTEX until this function is called. With DATA_NODE_SYNC_SEQLOCK,
+ *       an update whose value cannot be written in place replaces the data node instead.
+ */
+int configure_hash_bucket_node_sync(hash_bucket_memory_pool* pool_ptr, data_node_sync_t sync_mode);
+
+/**
+ * @fn configure_hash_bucket_inline_values
+ * @brief Configures the largest value that new data nodes store inline, right after their key.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param inline_value_threshold Largest inline value in bytes (0 disables inline values).
+ * @return 0 on success, -21 if the threshold exceeds DATA_NODE_MAX_INLINE_VALUE_SIZE, -40 if the buckets are not initialized.
+ * @note Values are stored out of line until this function is called.
+ */
+int configure_hash_bucket_inline_values(hash_bucket_memory_pool* pool_ptr, unsigned int inline_value_threshold);
+
+/**
+ * @fn configure_hash_bucket_latency_histograms
+ * @brief Configures the histograms that bucket lock waits are recorded in.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param histograms_ptr Histograms of the owning key store instance, or NULL to stop timing lock waits.
+ * @return 0 on success, -20 if pool_ptr is NULL, -40 if the buckets are not initialized.
+ * @note Only the bucket locks of single-key and batched operations are timed, not those taken while resizing.
+ */
+int configure_hash_bucket_latency_histograms(hash_bucket_memory_pool* pool_ptr, sharded_latency_histograms* histograms_ptr);
+
+/**
+ * @fn configure_hash_bucket_lock_type
+ * @brief Configures the lock type of every bucket (see bucket_lock.h), BUCKET_LOCK_RWLOCK by default.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param lock_type The lock type of the current and of every future table.
+ * @return 0 on success, -20 if pool_ptr is NULL, -21 if the type is unknown, concurrency is disabled or a resize is in progress,
+ *         -40 if the buckets are not initialized, -10/-11 if the new locks could not be allocated or initialized.
+ * @note Must be called before the table is shared between threads, the current bucket or stripe locks are replaced.
+ */
+int configure_hash_bucket_lock_type(hash_bucket_memory_pool* pool_ptr, bucket_lock_type_t lock_type);
 
 /**
  * @fn cleanup_hash_buckets
  * @brief Cleans up and releases all resources used by the hash bucket system.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
  * @return 0 on success, non-zero on failure.
  */
-int cleanup_hash_buckets(void);
+int cleanup_hash_buckets(hash_bucket_memory_pool* pool_ptr);
 
 /**
  * @fn get_hash_bucket
- * @brief Retrieves a hash bucket at the specified index, optionally creating it if missing.
- * @param hash_bucket_ptr Pointer to the parent hash bucket container.
+ * @brief Retrieves a hash bucket at the specified index of the current table, creating it if missing.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
  * @param index Index of the bucket to retrieve.
- * @param create_if_missing If true, creates the bucket if it does not exist.
- * @return Pointer to the hash bucket at the specified index, or NULL if not found and not created.
+ * @return Pointer to the hash bucket at the specified index, or NULL if out of bounds or not initialized.
  */
-hash_bucket* get_hash_bucket(unsigned int index);
+hash_bucket* get_hash_bucket(hash_bucket_memory_pool* pool_ptr, unsigned int index);
+
+/**
+ * @fn get_hash_bucket_count
+ * @brief Returns the number of buckets in the current table.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @return The current bucket count, or 0 if the buckets are not initialized.
+ */
+unsigned int get_hash_bucket_count(hash_bucket_memory_pool* pool_ptr);
 
 /**
  * @fn upsert_node_to_bucket
  * @brief Sets or updates a data node in the hash bucket by key and key hash.
- * @param index Index of the hash bucket.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
  * @param key Key string of the node to set.
+ * @param key_len Length of the key in bytes.
  * @param key_hash Hash value of the key.
  * @param new_value New value to set in the node.
  * @return 0 on success, negative result if the node was not found or on error.
  * @note This function checks if the key contains a data node.If the node does not exist, it will be created.
+ * @note The lookup and the insert-or-update happen under a single bucket write lock, so concurrent
+ *       upserts of the same key never produce duplicate entries.
  */
-int upsert_node_to_bucket(unsigned int index, const char *key, uint32_t key_hash, key_store_value* new_value);
+int upsert_node_to_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* new_value);
 
 /**
  * @fn find_node_in_bucket
  * @brief Finds a data node in the hash bucket by key and key hash.
- * @param index Index of the hash bucket.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
  * @param key Key string to search for.
+ * @param key_len Length of the key in bytes.
  * @param key_hash Hash value of the key.
  * @return Pointer to the found data node, or NULL if not found.
  */
-int find_node_in_bucket(unsigned int index, const char *key, uint32_t key_hash, key_store_value* value_out);
+int find_node_in_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* value_out);
+
+/**
+ * @fn view_node_in_bucket
+ * @brief Runs a callback on the value of a data node in the hash bucket, without copying it.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param key Key string to search for.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash Hash value of the key.
+ * @param callback Function receiving the stored value bytes, see data_node_view_wrapper.
+ * @param context Caller context passed to the callback.
+ * @param version_out Receives the version of the value the callback saw, or NULL.
+ * @return The callback's result, -41 if the key was not found, or another negative code on error.
+ * @note The node stays pinned, or the epoch stays entered, until the callback returns.
+ */
+int view_node_in_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_view_callback callback, void *context, uint32_t *version_out);
+
+/**
+ * @fn find_nodes_in_bucket_batch
+ * @brief Finds a batch of keys and copies their values, overlapping the memory loads of the keys.
+ *
+ * The bucket headers of all keys are prefetched, then their chain heads, then the keys are looked up
+ * grouped by bucket so each bucket lock is taken once, and finally the values are prefetched and copied.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param keys The keys with their hashes.
+ * @param key_count Number of keys, at most KEY_STORE_BATCH_GROUP_SIZE.
+ * @param values_out Receives a copy of each found value; the caller frees their data.
+ * @param results_out Receives the result of each key, as find_node_in_bucket would return it.
+ * @return 0 if every key was found, the first non-zero result otherwise, or -20/-40 on invalid input or an uninitialized table.
+ */
+int find_nodes_in_bucket_batch(hash_bucket_memory_pool* pool_ptr, const key_store_prepared_key *keys, size_t key_count, key_store_value *values_out, int *results_out);
+
+/**
+ * @fn upsert_nodes_to_bucket_batch
+ * @brief Sets or updates a batch of keys, overlapping the memory loads of the keys (see find_nodes_in_bucket_batch).
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param keys The keys with their hashes.
+ * @param key_count Number of keys, at most KEY_STORE_BATCH_GROUP_SIZE.
+ * @param values The value of each key.
+ * @param results_out Receives the result of each key, as upsert_node_to_bucket would return it.
+ * @return 0 if every key was stored, the first non-zero result otherwise, or -20/-40 on invalid input or an uninitialized table.
+ * @note A key that appears more than once in the batch ends up with its last value.
+ */
+int upsert_nodes_to_bucket_batch(hash_bucket_memory_pool* pool_ptr, const key_store_prepared_key *keys, size_t key_count, key_store_value *values, int *results_out);
+
+/**
+ * @fn update_node_in_bucket
+ * @brief Replaces the value of a key with the value a callback computes from the current one.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
+ * @param key Key string of the node to update.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash Hash value of the key.
+ * @param callback Function receiving the current value and its version, see key_store_update_callback.
+ * @param context Caller context passed to the callback.
+ * @return 0 on success, the callback's non-zero result, or another negative code on error.
+ * @note The callback runs under the bucket write lock, so it must be short and must not call into the same table.
+ *       A missing key is created if the callback returns a value for it.
+ */
+int update_node_in_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_update_callback callback, void *context);
 
 /**
  * @fn delete_node_from_bucket
  * @brief Deletes a data node from the hash bucket by key and key hash.
- * @param index Index of the hash bucket.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
  * @param key Key string of the node to delete.
+ * @param key_len Length of the key in bytes.
  * @param key_hash Hash value of the key.
  * @return 0 on success, -1 if the node was not found or on error.
  */
-int delete_node_from_bucket(unsigned int index, const char *key, uint32_t key_hash);
+int delete_node_from_bucket(hash_bucket_memory_pool* pool_ptr, const char *key, size_t key_len, uint32_t key_hash);
 
 /**
  * @fn get_hash_bucket_pool_stats
  * @brief Retrieves statistics about the hash bucket memory pool.
+ * @param pool_ptr Pointer to the hash bucket memory pool (the table of one key store instance).
  * @param pool_out Pointer to a keystore_stats structure to receive the statistics.
+ * @note Key distribution, collision and bucket memory figures come from a histogram of buckets by key count
+ *       that every count change keeps up to date, so the call does not visit the buckets. Buckets holding
+ *       KEY_STORE_OCCUPANCY_EXACT_SLOTS or more keys are counted per power of two, with their keys and the
+ *       largest count reached, so max and median stay within the bucket's power of two.
  */
-void get_hash_bucket_pool_stats(keystore_stats* pool_out);
+void get_hash_bucket_pool_stats(hash_bucket_memory_pool* pool_ptr, keystore_stats* pool_out);
 
 #endif // HASH_BUCKETS_H
\ No newline at end of file
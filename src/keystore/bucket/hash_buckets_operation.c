@@ -3,20 +3,29 @@
 
 #include "core/type_definition.h"
 #include "core/data_node.h"
+#include "core/operation_counters.h"
+#include "bucket_lock.h"
 #include "hash_bucket_list.h"
+#include "hash_bucket_tree.h"
+#include "utils/memory_manager.h"
+#include "utils/epoch_manager.h"
 
 #pragma region Private Type Definitions
 typedef struct {
+    hash_bucket_memory_pool *pool_ptr; // Table owning the bucket: treeify threshold, read mode, node context and counters
     hash_bucket *hash_bucket_ptr;
     const char *key;
+    size_t key_len; // Bytes of the key, which may contain zero bytes
     uint32_t key_hash;
-    list_node* new_list_node;
+    data_node* new_data_node;
 } bucket_operation_args;
 
 typedef enum {
     ADD_NODE,
     DELETE_NODE,
-    FIND_NODE
+    FIND_NODE,
+    UPSERT_NODE,
+    UPDATE_NODE
 } bucket_operation_type_t;
 
 #pragma endregion
@@ -24,70 +33,80 @@ typedef enum {
 
 #pragma region Private Function declarations
 // Helper to find data node in bucket
-static data_node* _find_data_node(hash_bucket *hash_bucket_ptr, const char *key, uint32_t key_hash);
+static data_node* _find_data_node(hash_bucket *hash_bucket_ptr, const char *key, size_t key_len, uint32_t key_hash);
 
-// Stat helpers
-static int _operation_counter_increment(bucket_operation_type_t operation_type, int operation_result);
+// Helper to link a data node into the bucket's container
+static int _insert_data_node(bucket_operation_args args);
 
-#pragma endregion
+// Helper to swap the data node of an existing key for a new one
+static data_node* _replace_data_node(hash_bucket *hash_bucket_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node *new_data_node);
+
+// Helpers to switch a bucket between list and tree containers
+static int _convert_bucket_type(hash_bucket_memory_pool *pool_ptr, hash_bucket *hash_bucket_ptr, bucket_type_t new_type);
+static void _update_bucket_type(hash_bucket_memory_pool *pool_ptr, hash_bucket *hash_bucket_ptr);
+
+// Helper to keep the bucket occupancy histogram in step with the bucket counts (see hash_buckets_stats.c)
+static void _record_bucket_count_change(hash_bucket_memory_pool* pool_ptr, unsigned int old_count, unsigned int new_count);
+
+// Helper to resolve the lock guarding a bucket, its own or the one of its lock stripe
+static bucket_lock* _get_bucket_lock(hash_bucket_memory_pool* pool_ptr, hash_bucket *hash_bucket_ptr, uint32_t bucket_index);
 
+// Locked fallback of the lock-free lookup
+int _hash_bucket_lock_wrapper(bucket_operation_type_t operation_type, bucket_operation_args args, data_node** data_node_out);
+
+// Locked read-modify-write of a single key
+int _hash_bucket_update_lock_wrapper(bucket_operation_args args, key_store_update_callback callback, void *context, data_node** released_node_out, bool *is_node_added_out);
+
+// Locked batch of operations on a single bucket
+int _hash_bucket_batch_lock_wrapper(bucket_operation_type_t operation_type, const bucket_operation_args *args, size_t count, data_node** data_nodes_out, int *results_out);
+
+// Stat helpers
+static int _operation_counter_increment(hash_bucket_memory_pool *pool_ptr, bucket_operation_type_t operation_type, int operation_result);
 
-#pragma region Private Global Variables
-static bucket_operation_counter_stats g_operation_counters = {0};
 #pragma endregion
 
 
 #pragma region Statistics Function Definitions
 
-/**
- * @fn _get_operation_counters
- * @brief Retrieves a copy of the global operation counters.
- *
- * This function returns a copy of the global operation_counter_stats structure,
- * which contains counts of total and failed operations as well as error code occurrences.
- *
- * @return operation_counter_stats A copy of the global operation counters.
- */
-bucket_operation_counter_stats _get_operation_counters(void)
-{
-    bucket_operation_counter_stats counters_copy;
-    memcpy(&counters_copy, &g_operation_counters, sizeof(bucket_operation_counter_stats));
-    return counters_copy;
-}
-
 /**
  * @fn _operation_counter_increment
  * @brief Increments the operation counters based on the operation type and result.
  *
- * This function updates the global operation counters for add, delete, find, and edit operations.
+ * This function updates the table's operation counters for add, delete, find, and edit operations.
  * It also increments the failed operation counters and error code counters based on the result.
  *
+ * @param pool_ptr Pointer to the hash bucket memory pool owning the counters.
  * @param operation_type The type of operation performed.
  * @param operation_result The result of the operation (0 for success, negative for errors).
  * @return int The operation_result passed in.
  */
-static int _operation_counter_increment(bucket_operation_type_t operation_type, int operation_result)
+static int _operation_counter_increment(hash_bucket_memory_pool *pool_ptr, bucket_operation_type_t operation_type, int operation_result)
 {
+    if (!OPERATION_COUNTERS_ENABLED) return operation_result;
+    bucket_operation_counter_stats *counters_ptr = &pool_ptr->operation_counters.shards[get_operation_counter_shard_index()].counters;
+
     switch (operation_type)
     {
         case ADD_NODE:
-            g_operation_counters.total_add_ops++;
-            if (operation_result != 0) g_operation_counters.failed_add_ops++;
+        case UPSERT_NODE:
+        case UPDATE_NODE:
+            OPERATION_COUNTER_ADD(counters_ptr->total_add_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(counters_ptr->failed_add_ops, 1);
             break;
         case DELETE_NODE:
-            g_operation_counters.total_delete_ops++;
-            if (operation_result != 0) g_operation_counters.failed_delete_ops++;
+            OPERATION_COUNTER_ADD(counters_ptr->total_delete_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(counters_ptr->failed_delete_ops, 1);
             break;
         case FIND_NODE:
-            g_operation_counters.total_find_ops++;
-            if (operation_result != 0) g_operation_counters.failed_find_ops++;
+            OPERATION_COUNTER_ADD(counters_ptr->total_find_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(counters_ptr->failed_find_ops, 1);
             break;
         default:
             break;
     }
 
     if (operation_result < 0 && operation_result > -100) {
-        g_operation_counters.error_code_counters[-operation_result]++;
+        OPERATION_COUNTER_ADD(counters_ptr->error_code_counters[-operation_result], 1);
     }
 
     return operation_result;
@@ -102,41 +121,202 @@ static int _operation_counter_increment(bucket_operation_type_t operation_type,
  * @fn _add_node
  * @brief Adds a data node to the specified hash bucket.
  *
- * This function inserts a data node into the hash bucket's container and increments its count after successful addition
- * based on its type (currently only BUCKET_LIST is supported).
+ * This function wraps the data node in a list or tree node depending on the bucket type, inserts it into
+ * the hash bucket's container and increments its count after successful addition. A list bucket that
+ * reaches the treeify threshold is converted to a red-black tree.
  *
- * @param args A struct containing the hash bucket, key hash, and list node to be added.
- * @note The caller is responsible for creating the list_node with associated data_node. 
- * @note The caller is responsible for managing the memory of the list_node and data_node in case of failure.
- * @return int Returns 0 on success, or -1 on failure.
+ * @param args A struct containing the table, hash bucket, key hash and data node to be added.
+ * @note The caller is responsible for creating the data_node and for managing its memory in case of failure.
+ * @return int Returns 0 on success, or a negative error code on failure.
  */
 int _add_node(bucket_operation_args args)
+{
+    return _operation_counter_increment(args.pool_ptr, ADD_NODE, _insert_data_node(args));
+}
+
+/**
+ * @fn _upsert_node
+ * @brief Updates the value of an existing key or inserts a new data node, in a single pass over the bucket.
+ *
+ * The lookup and the insert happen under the same bucket write lock, so no other thread can insert
+ * the same key in between. The new data node is created by the caller before the lock is taken: it is
+ * linked into the bucket if the key is missing. Otherwise its value is copied into the existing node or,
+ * when a seqlock node cannot take the value in place, it replaces the existing node so that readers never
+ * see a partial write or freed value storage. Lock-free reads always use seqlock nodes, so they take the
+ * same path: a value that fits the node's storage is written in place under the sequence counter.
+ *
+ * @param args A struct containing the table, hash bucket, key hash, key and speculatively created data node.
+ * @param released_node_out Pointer to receive the data node the bucket no longer references: NULL if the key was added,
+ *        args.new_data_node if its value was copied, or the replaced data node.
+ * @return int Returns 0 on success, or a negative error code on failure.
+ * @note The caller owns *released_node_out. A replaced data node may still be in use by lock-free readers and must be
+ *       retired through the epoch manager rather than deleted.
+ */
+int _upsert_node(bucket_operation_args args, data_node** released_node_out)
+{
+    int result = 0;
+    data_node* released_node_ptr = args.new_data_node;
+    data_node* data_node_ptr = _find_data_node(args.hash_bucket_ptr, args.key, args.key_len, args.key_hash);
+
+    if (data_node_ptr != NULL && !can_update_data_node_in_place(data_node_ptr, args.new_data_node->data_size))
+    {
+        // Seqlock readers may still copy from the node's value storage, publish the new node instead
+        released_node_ptr = _replace_data_node(args.hash_bucket_ptr, args.key, args.key_len, args.key_hash, args.new_data_node);
+    }
+    else if (data_node_ptr != NULL)
+    {
+        // Node exists, copy the new value into it
+        key_store_value new_value = { .data = args.new_data_node->data, .data_size = args.new_data_node->data_size };
+        result = data_node_lock_wrapper(&args.pool_ptr->data_node_counters, DATA_NODE_UPDATE, data_node_ptr, &new_value);
+    }
+    else
+    {
+        // Node does not exist, link the new one
+        result = _insert_data_node(args);
+        if (result == 0) released_node_ptr = NULL;
+    }
+
+    *released_node_out = released_node_ptr;
+    return _operation_counter_increment(args.pool_ptr, UPSERT_NODE, result);
+}
+
+/**
+ * @fn _update_node
+ * @brief Runs a read-modify-write callback on the value of a key and stores the value it produces.
+ *
+ * The callback sees the current value under the bucket write lock, so no other writer can change it
+ * before the new value is stored. The new value is copied into the existing data node under the node's
+ * synchronization when that is allowed; when a seqlock node's storage would change, a new data node
+ * replaces it instead, as in _upsert_node. A missing key gets a new data node.
+ *
+ * @param args A struct containing the table, hash bucket, key hash and key to update.
+ * @param callback Function computing the new value from the current one, see key_store_update_callback.
+ * @param context Caller context passed to the callback.
+ * @param released_node_out Pointer to receive the replaced data node, or NULL if no node was replaced.
+ * @param is_node_added_out Pointer to a flag set if the key was missing and a new data node was linked.
+ * @return int Returns 0 on success, the callback's non-zero result, or a negative error code on failure.
+ * @note The caller must hold the bucket's write lock and retire *released_node_out through the epoch manager.
+ */
+int _update_node(bucket_operation_args args, key_store_update_callback callback, void *context, data_node** released_node_out, bool *is_node_added_out)
+{
+    hash_bucket_memory_pool *pool_ptr = args.pool_ptr;
+    data_node *data_node_ptr = _find_data_node(args.hash_bucket_ptr, args.key, args.key_len, args.key_hash);
+    *released_node_out = NULL;
+    *is_node_added_out = false;
+
+    key_store_value new_value = {0};
+    int result = (data_node_ptr != NULL) ? callback(data_node_ptr->data, data_node_ptr->data_size, data_node_ptr->version, &new_value, context) : callback(NULL, 0, 0, &new_value, context);
+    if (result != 0 || new_value.data == NULL) return _operation_counter_increment(pool_ptr, UPDATE_NODE, result); // Aborted, or the current value is kept
+    if (new_value.data_size == 0) return _operation_counter_increment(pool_ptr, UPDATE_NODE, -20); // Error handling: empty values cannot be stored
+
+    if (data_node_ptr != NULL && can_update_data_node_in_place(data_node_ptr, new_value.data_size))
+    {
+        // Node exists, copy the new value into it
+        result = data_node_lock_wrapper(&pool_ptr->data_node_counters, DATA_NODE_UPDATE, data_node_ptr, &new_value);
+        return _operation_counter_increment(pool_ptr, UPDATE_NODE, result);
+    }
+
+    result = create_data_node(&pool_ptr->data_node_counters, pool_ptr->node_context.memory_manager_ptr, args.key, args.key_len, args.key_hash, &new_value, pool_ptr->node_sync_mode, pool_ptr->inline_value_threshold, &args.new_data_node);
+    if (result != 0) return _operation_counter_increment(pool_ptr, UPDATE_NODE, result);
+
+    if (data_node_ptr != NULL) {
+        // Readers may still use the existing node, publish the new one instead
+        *released_node_out = _replace_data_node(args.hash_bucket_ptr, args.key, args.key_len, args.key_hash, args.new_data_node);
+    } else {
+        result = _insert_data_node(args);
+        if (result == 0) *is_node_added_out = true;
+        else delete_data_node(&pool_ptr->data_node_counters, args.new_data_node);
+    }
+
+    return _operation_counter_increment(pool_ptr, UPDATE_NODE, result);
+}
+
+/**
+ * @fn _replace_data_node
+ * @brief Swaps the data node of an existing key for a new data node with the same key.
+ *
+ * A list bucket links the new data node in place of the old one, and a tree bucket publishes
+ * it through the tree node, so a lock-free reader sees either the old or the new data node,
+ * never a partially written value. The new data node continues the version of the old one.
+ *
+ * @param hash_bucket_ptr Pointer to the hash bucket to search in.
+ * @param key The key string of the node to replace.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash Hash value of the key.
+ * @param new_data_node The data node to publish.
+ * @return Pointer to the replaced data node, or NULL if the key was not found.
+ * @note The caller must hold the bucket's write lock.
+ */
+static data_node* _replace_data_node(hash_bucket *hash_bucket_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node *new_data_node)
+{
+    data_node* replaced_node_ptr = NULL;
+    switch (hash_bucket_ptr->type)
+    {
+        case BUCKET_LIST:
+            replaced_node_ptr = replace_list_node(&hash_bucket_ptr->container.list, key, key_len, key_hash, new_data_node);
+            break;
+        case BUCKET_TREE: {
+            tree_node* found_node = find_tree_node(hash_bucket_ptr->container.tree, key, key_len, key_hash);
+            if (found_node == NULL) return NULL;
+
+            replaced_node_ptr = found_node->data;
+            found_node->data = new_data_node; // Tree buckets are only read under the bucket lock
+            break;
+        }
+        default:
+            return NULL; // Error handling: unsupported bucket type
+    }
+
+    // Versions are only read under the bucket write lock, which is still held
+    if (replaced_node_ptr != NULL) new_data_node->version = replaced_node_ptr->version + 1;
+    return replaced_node_ptr;
+}
+
+/**
+ * @fn _insert_data_node
+ * @brief Links a data node into the hash bucket's container without updating the operation counters.
+ *
+ * @param args A struct containing the table, hash bucket, key hash and data node to be added.
+ * @return int Returns 0 on success, or a negative error code on failure.
+ */
+static int _insert_data_node(bucket_operation_args args)
 {
     int result = 0;
     switch (args.hash_bucket_ptr->type)
     {
         case BUCKET_LIST:
-            result = insert_list_node(&args.hash_bucket_ptr->container.list, args.new_list_node);
+            result = insert_list_node(&args.hash_bucket_ptr->container.list, args.new_data_node);
             break;
+        case BUCKET_TREE: {
+            tree_node *tree_root = args.hash_bucket_ptr->container.tree;
+            tree_node *new_tree_node = create_new_tree_node(&args.pool_ptr->node_context, args.key_hash, args.new_data_node);
+            result = (new_tree_node != NULL) ? insert_tree_node(&tree_root, new_tree_node) : -10;
+            if (result == 0) args.hash_bucket_ptr->container.tree = tree_root;
+            if (result != 0 && new_tree_node != NULL) free_memory(args.pool_ptr->node_context.memory_manager_ptr, new_tree_node, TREE_POOL);
+            break;
+        }
         default:
             result = -43; // Error handling: unsupported bucket type
             break;
     }
 
     if(result == 0) {
+        _record_bucket_count_change(args.pool_ptr, args.hash_bucket_ptr->count, args.hash_bucket_ptr->count + 1);
         args.hash_bucket_ptr->count += 1;
+        _update_bucket_type(args.pool_ptr, args.hash_bucket_ptr);
     }
 
-    return _operation_counter_increment(ADD_NODE, result);
+    return result;
 }
 
 /**
  * @fn _delete_node
  * @brief Deletes a data node from the specified hash bucket.
  * This function removes a data node from the hash bucket's container
- * based on its type (currently only BUCKET_LIST is supported) and decrements its count after successful deletion.
+ * based on its type and decrements its count after successful deletion. A tree bucket that shrinks below
+ * half of the treeify threshold is converted back to a linked list.
  * 
- * @param args A struct containing the hash bucket, key hash, and key of the node to be deleted.
+ * @param args A struct containing the table, hash bucket, key hash and key of the node to be deleted.
  * @param deleted_node_out Pointer to a data_node pointer to receive the deleted node.
  * @note The caller is responsible for managing the memory of the deleted data_node.
  * @return int Returns 0 on success, or -1 on failure.
@@ -147,18 +327,26 @@ int _delete_node(bucket_operation_args args, data_node** deleted_node_out)
     switch (args.hash_bucket_ptr->type)
     {
         case BUCKET_LIST:
-            result = delete_list_node(&args.hash_bucket_ptr->container.list, args.key, args.key_hash, deleted_node_out);
+            result = delete_list_node(&args.hash_bucket_ptr->container.list, args.key, args.key_len, args.key_hash, deleted_node_out);
+            break;
+        case BUCKET_TREE: {
+            tree_node *tree_root = args.hash_bucket_ptr->container.tree;
+            result = delete_tree_node(&args.pool_ptr->node_context, &tree_root, args.key, args.key_len, args.key_hash, deleted_node_out);
+            args.hash_bucket_ptr->container.tree = tree_root;
             break;
+        }
         default:
             result = -43; // Error handling: unsupported bucket type
             break;
     }
 
     if(result == 0) {
+        _record_bucket_count_change(args.pool_ptr, args.hash_bucket_ptr->count, args.hash_bucket_ptr->count - 1);
         args.hash_bucket_ptr->count -= 1;
+        _update_bucket_type(args.pool_ptr, args.hash_bucket_ptr);
     }
 
-    return _operation_counter_increment(DELETE_NODE, result);
+    return _operation_counter_increment(args.pool_ptr, DELETE_NODE, result);
 }
 
 /**
@@ -166,14 +354,15 @@ int _delete_node(bucket_operation_args args, data_node** deleted_node_out)
  * @brief Finds a data node in the specified hash bucket.
  *
  * This function searches for a data node in the hash bucket's container
- * based on its type (currently only BUCKET_LIST is supported).
+ * based on its type: a linear scan for BUCKET_LIST, an O(log n) descent for BUCKET_TREE.
  *
  * @param hash_bucket_ptr Pointer to the hash bucket to search in.
  * @param key The key string of the node to find.
+ * @param key_len Length of the key in bytes.
  * @param key_hash Hash value of the key.
  * @return Pointer to the found data node, or NULL if not found.
  */
-data_node* _find_data_node(hash_bucket *hash_bucket_ptr, const char *key, uint32_t key_hash)
+data_node* _find_data_node(hash_bucket *hash_bucket_ptr, const char *key, size_t key_len, uint32_t key_hash)
 {
     data_node* data_node_ptr = NULL;
     
@@ -181,9 +370,13 @@ data_node* _find_data_node(hash_bucket *hash_bucket_ptr, const char *key, uint32
     switch (hash_bucket_ptr->type)
     {
         case BUCKET_LIST:
-            list_node* found_node = find_list_node(hash_bucket_ptr->container.list, key, key_hash);
+            data_node_ptr = find_list_node(hash_bucket_ptr->container.list, key, key_len, key_hash);
+            break;
+        case BUCKET_TREE: {
+            tree_node* found_node = find_tree_node(hash_bucket_ptr->container.tree, key, key_len, key_hash);
             data_node_ptr = (found_node != NULL) ? found_node->data : NULL;
             break;
+        }
         default: 
             return NULL; // Error handling: unsupported bucket type
     }
@@ -191,13 +384,83 @@ data_node* _find_data_node(hash_bucket *hash_bucket_ptr, const char *key, uint32
     return data_node_ptr;
 }
 
+/**
+ * @fn _convert_bucket_type
+ * @brief Converts the container of a hash bucket between a linked list and a red-black tree.
+ *
+ * The new container is fully built before the old one is released, so on failure the
+ * bucket is left unchanged and still valid. The bucket version is odd while the container
+ * changes, which sends lock-free readers to the locked path.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool owning the bucket.
+ * @param hash_bucket_ptr Pointer to the hash bucket to convert.
+ * @param new_type The container type to convert to (BUCKET_LIST or BUCKET_TREE).
+ * @return int Returns 0 on success (or if the bucket already has that type), -43 for unsupported types, or a negative error code from the conversion.
+ * @note The caller must hold the bucket's write lock when concurrency is enabled.
+ */
+static int _convert_bucket_type(hash_bucket_memory_pool *pool_ptr, hash_bucket *hash_bucket_ptr, bucket_type_t new_type)
+{
+    if (hash_bucket_ptr->type == new_type) return 0;
+
+    if (new_type != BUCKET_TREE && new_type != BUCKET_LIST) return -43; // Error handling: unsupported bucket type
+
+    int result = 0;
+    atomic_fetch_add(&hash_bucket_ptr->version, 1);
+
+    switch (new_type)
+    {
+        case BUCKET_TREE: {
+            tree_node *tree_root = NULL;
+            result = convert_list_to_tree(&pool_ptr->node_context, &hash_bucket_ptr->container.list, &tree_root);
+            if (result == 0) hash_bucket_ptr->container.tree = tree_root;
+            break;
+        }
+        case BUCKET_LIST: {
+            tree_node *tree_root = hash_bucket_ptr->container.tree;
+            data_node *list_head = NULL;
+            result = convert_tree_to_list(&pool_ptr->node_context, &tree_root, &list_head);
+            if (result == 0) hash_bucket_ptr->container.list = list_head;
+            break;
+        }
+        default:
+            break;
+    }
+
+    if (result == 0) hash_bucket_ptr->type = new_type;
+    atomic_fetch_add(&hash_bucket_ptr->version, 1);
+    return result;
+}
+
+/**
+ * @fn _update_bucket_type
+ * @brief Treeifies or untreeifies a hash bucket based on its current count.
+ *
+ * A list bucket is converted to a tree once it holds treeify_threshold keys, and a tree bucket
+ * is converted back once it holds fewer than half of that. The gap keeps a bucket that hovers
+ * around the threshold from converting back and forth on every insert and delete.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool owning the bucket, holds the treeify threshold (0 disables treeification).
+ * @param hash_bucket_ptr Pointer to the hash bucket to check.
+ * @note A failed conversion only leaves the bucket in its current, valid, form.
+ */
+static void _update_bucket_type(hash_bucket_memory_pool *pool_ptr, hash_bucket *hash_bucket_ptr)
+{
+    unsigned int treeify_threshold = pool_ptr->treeify_threshold;
+    if (treeify_threshold == 0) return;
+
+    if (hash_bucket_ptr->type == BUCKET_LIST && hash_bucket_ptr->count >= treeify_threshold) {
+        _convert_bucket_type(pool_ptr, hash_bucket_ptr, BUCKET_TREE);
+    } else if (hash_bucket_ptr->type == BUCKET_TREE && hash_bucket_ptr->count < treeify_threshold / 2) {
+        _convert_bucket_type(pool_ptr, hash_bucket_ptr, BUCKET_LIST);
+    }
+}
+
 /**
  * @fn _find_node
  * @brief Finds a data node in the specified hash bucket and retrieves its value.
  *
  * This function searches for a data node in the hash bucket's container
- * based on its type (currently only BUCKET_LIST is supported) and copies
- * its data to the output parameter if found.
+ * based on its type and returns it through the output parameter if found.
  *
  * @param args A struct containing the hash bucket, key hash, and key of the node to be found.
  * @param value_out Pointer to a key_store_value structure to receive the found value.
@@ -208,18 +471,73 @@ int _find_node(bucket_operation_args args, data_node** data_node_out)
     int result = 0;
 
     // Find the data node
-    data_node* data_node_ptr = _find_data_node(args.hash_bucket_ptr, args.key, args.key_hash);
+    data_node* data_node_ptr = _find_data_node(args.hash_bucket_ptr, args.key, args.key_len, args.key_hash);
     result = (data_node_ptr != NULL) ? 0 : -41;
 
     *data_node_out = data_node_ptr;
     
-    return _operation_counter_increment(FIND_NODE, result);
+    return _operation_counter_increment(args.pool_ptr, FIND_NODE, result);
 }
 
 #pragma endregion
 
 #pragma region Concurrency Control Definitions
 
+/**
+ * @fn _find_node_lock_free
+ * @brief Finds a data node in the specified hash bucket without taking the bucket lock.
+ *
+ * List buckets are traversed without the lock: writers publish data nodes fully linked and
+ * retire unlinked nodes through the epoch manager. Tree buckets, and buckets whose container is
+ * being converted (odd or changed version), fall back to the read-locked lookup. A conversion
+ * relinks the data nodes themselves, so a miss is only trusted if the version is still unchanged.
+ *
+ * @param args A struct containing the hash bucket, key hash, and key of the node to be found.
+ * @param data_node_out Pointer to receive the found data node.
+ * @return int Returns 0 on success, -41 if the node was not found, or a lock error code.
+ * @note The caller must be inside an epoch critical section until it is done with *data_node_out.
+ */
+int _find_node_lock_free(bucket_operation_args args, data_node** data_node_out)
+{
+    hash_bucket *hash_bucket_ptr = args.hash_bucket_ptr;
+    unsigned int version = atomic_load(&hash_bucket_ptr->version);
+
+    if ((version & 1) == 0 && hash_bucket_ptr->type == BUCKET_LIST)
+    {
+        data_node *list_head = hash_bucket_ptr->container.list;
+        if (atomic_load(&hash_bucket_ptr->version) == version)
+        {
+            data_node *found_node = find_list_node(list_head, args.key, args.key_len, args.key_hash);
+            if (found_node != NULL || atomic_load(&hash_bucket_ptr->version) == version)
+            {
+                *data_node_out = found_node;
+                return _operation_counter_increment(args.pool_ptr, FIND_NODE, (found_node != NULL) ? 0 : -41);
+            }
+        }
+    }
+
+    return _hash_bucket_lock_wrapper(FIND_NODE, args, data_node_out);
+}
+
+/**
+ * @fn _get_bucket_lock
+ * @brief Returns the lock guarding a bucket.
+ *
+ * With lock stripes, the stripe is picked by the low bits of the bucket index. Both tables of a resize
+ * are at least lock_stripe_count buckets large, so these bits are the same for a key in either table
+ * and the key hash can be passed in place of the index.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool owning the bucket.
+ * @param hash_bucket_ptr Pointer to the bucket.
+ * @param bucket_index The index of the bucket in its table, or the hash of a key it holds.
+ * @return bucket_lock* The bucket's own lock, or the lock of its stripe.
+ */
+static bucket_lock* _get_bucket_lock(hash_bucket_memory_pool* pool_ptr, hash_bucket *hash_bucket_ptr, uint32_t bucket_index)
+{
+    if (pool_ptr->lock_stripes_ptr == NULL) return &hash_bucket_ptr->lock;
+    return &pool_ptr->lock_stripes_ptr[bucket_index & (pool_ptr->lock_stripe_count - 1)].lock;
+}
+
 /**
  * @fn _hash_bucket_lock_wrapper
  * @brief Wraps bucket operations with read-write lock for concurrency control.
@@ -227,33 +545,34 @@ int _find_node(bucket_operation_args args, data_node** data_node_out)
  * This function acquires the appropriate lock (read or write) based on the
  * operation type, performs the operation, and then releases the lock.
  *
- * @param operation_type The type of operation to perform (ADD_NODE, DELETE_NODE, FIND_NODE, EDIT_NODE).
+ * @param operation_type The type of operation to perform (ADD_NODE, DELETE_NODE, FIND_NODE, UPSERT_NODE).
  * @param args A struct containing the hash bucket and operation parameters.
  * @param result_out Pointer to a key_store_value structure to receive the result for FIND_NODE operations.
  * @return int Returns the result of the operation, or -1 on lock acquisition failure.
+ * @note A data node found by FIND_NODE is pinned before the bucket lock is released, unless lock-free reads are
+ *       enabled (the epoch then keeps it alive). The caller must release it with unpin_data_node.
  */
 int _hash_bucket_lock_wrapper(bucket_operation_type_t operation_type, bucket_operation_args args, data_node** data_node_out) {
     
-    int lock_result = 0;
-    
-    if (operation_type == FIND_NODE) {
-        lock_result = pthread_rwlock_rdlock(&args.hash_bucket_ptr->lock);
-    } else {
-        lock_result = pthread_rwlock_wrlock(&args.hash_bucket_ptr->lock);
-    }
+    bucket_lock *lock_ptr = _get_bucket_lock(args.pool_ptr, args.hash_bucket_ptr, args.key_hash);
+    int lock_result = acquire_bucket_lock(lock_ptr, args.pool_ptr->lock_type, operation_type != FIND_NODE, args.pool_ptr->latency_histograms_ptr);
 
-    if (lock_result != 0) return _operation_counter_increment(operation_type, -30); // Handle error: failed to acquire lock
+    if (lock_result != 0) return _operation_counter_increment(args.pool_ptr, operation_type, -30); // Handle error: failed to acquire lock
 
     int operation_result = 0;
     switch (operation_type) {
         case ADD_NODE:
             operation_result = _add_node(args);
             break;
+        case UPSERT_NODE:
+            operation_result = _upsert_node(args, data_node_out);
+            break;
         case DELETE_NODE:
             operation_result = _delete_node(args, data_node_out);
             break;
         case FIND_NODE:
             operation_result = _find_node(args, data_node_out);
+            if (operation_result == 0 && !args.pool_ptr->is_lock_free_read_enabled) pin_data_node(*data_node_out);
             break;
         default: 
             // Error handling: unknown operation
@@ -261,8 +580,75 @@ int _hash_bucket_lock_wrapper(bucket_operation_type_t operation_type, bucket_ope
             break;
     }
 
-    if (pthread_rwlock_unlock(&args.hash_bucket_ptr->lock) != 0) return _operation_counter_increment(operation_type, -31); // Handle error: failed to release lock
-    return _operation_counter_increment(operation_type, operation_result);
+    if (release_bucket_lock(lock_ptr, args.pool_ptr->lock_type, operation_type != FIND_NODE) != 0) return _operation_counter_increment(args.pool_ptr, operation_type, -31); // Handle error: failed to release lock
+    return operation_result; // Already counted by the operation itself
+}
+
+/**
+ * @fn _hash_bucket_update_lock_wrapper
+ * @brief Wraps a read-modify-write of a single key (see _update_node) with the bucket write lock.
+ *
+ * @param args A struct containing the hash bucket and operation parameters.
+ * @param callback Function computing the new value from the current one.
+ * @param context Caller context passed to the callback.
+ * @param released_node_out Pointer to receive the replaced data node, or NULL.
+ * @param is_node_added_out Pointer to a flag set if a new key was linked.
+ * @return int Returns the result of _update_node, or -30/-31 on lock failures.
+ */
+int _hash_bucket_update_lock_wrapper(bucket_operation_args args, key_store_update_callback callback, void *context, data_node** released_node_out, bool *is_node_added_out)
+{
+    *released_node_out = NULL;
+    *is_node_added_out = false;
+    bucket_lock *lock_ptr = _get_bucket_lock(args.pool_ptr, args.hash_bucket_ptr, args.key_hash);
+    if (acquire_bucket_lock(lock_ptr, args.pool_ptr->lock_type, true, args.pool_ptr->latency_histograms_ptr) != 0) return _operation_counter_increment(args.pool_ptr, UPDATE_NODE, -30); // Handle error: failed to acquire lock
+
+    int operation_result = _update_node(args, callback, context, released_node_out, is_node_added_out);
+
+    if (release_bucket_lock(lock_ptr, args.pool_ptr->lock_type, true) != 0) return _operation_counter_increment(args.pool_ptr, UPDATE_NODE, -31); // Handle error: failed to release lock
+    return operation_result;
+}
+
+/**
+ * @fn _hash_bucket_batch_lock_wrapper
+ * @brief Runs several FIND_NODE or UPSERT_NODE operations on the same hash bucket under one lock acquisition.
+ *
+ * Batched operations group their keys by bucket, so a bucket that several keys of a batch land in is
+ * locked once instead of once per key. Each operation behaves as in _hash_bucket_lock_wrapper.
+ *
+ * @param operation_type FIND_NODE (read lock) or UPSERT_NODE (write lock).
+ * @param args count operation arguments, all referring to the same hash bucket.
+ * @param count Number of operations, at least 1.
+ * @param data_nodes_out Receives the found (pinned, see _hash_bucket_lock_wrapper) or released data node of each operation.
+ * @param results_out Receives the result of each operation.
+ * @return int Returns 0 if the lock was taken and released, or -30/-31 on lock failures.
+ */
+int _hash_bucket_batch_lock_wrapper(bucket_operation_type_t operation_type, const bucket_operation_args *args, size_t count, data_node** data_nodes_out, int *results_out)
+{
+    bucket_lock *lock_ptr = _get_bucket_lock(args[0].pool_ptr, args[0].hash_bucket_ptr, args[0].key_hash);
+    int lock_result = acquire_bucket_lock(lock_ptr, args[0].pool_ptr->lock_type, operation_type != FIND_NODE, args[0].pool_ptr->latency_histograms_ptr);
+    if (lock_result != 0) {
+        for (size_t i = 0; i < count; ++i) results_out[i] = _operation_counter_increment(args[i].pool_ptr, operation_type, -30);
+        return -30; // Handle error: failed to acquire lock
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        data_nodes_out[i] = NULL;
+        switch (operation_type) {
+            case FIND_NODE:
+                results_out[i] = _find_node(args[i], &data_nodes_out[i]);
+                if (results_out[i] == 0 && !args[i].pool_ptr->is_lock_free_read_enabled) pin_data_node(data_nodes_out[i]);
+                break;
+            case UPSERT_NODE:
+                results_out[i] = _upsert_node(args[i], &data_nodes_out[i]);
+                break;
+            default:
+                // Error handling: unsupported batch operation
+                results_out[i] = -43;
+                break;
+        }
+    }
+
+    return (release_bucket_lock(lock_ptr, args[0].pool_ptr->lock_type, operation_type != FIND_NODE) == 0) ? 0 : -31; // Handle error: failed to release lock
 }
 
 #pragma endregion
@@ -0,0 +1,501 @@
+#include "core/type_definition.h"
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <sched.h>
+#include "hash_bucket_list.h"
+#include "utils/epoch_manager.h"
+
+#pragma region Private Type Definitions
+// The tables a lock-free reader looks a key up in, loaded together (see _load_bucket_tables)
+typedef struct {
+    hash_bucket *hash_buckets_ptr;
+    unsigned int total_blocks;
+    hash_bucket *old_hash_buckets_ptr; // NULL when not resizing
+    unsigned int old_total_blocks;
+} bucket_table_snapshot;
+
+// A drained old table, released once no lock-free reader can still be inside it
+typedef struct {
+    hash_bucket *hash_buckets_ptr;
+    pthread_rwlock_t *rwlocks_ptr; // NULL unless every bucket has its own pthread rwlock
+    unsigned int total_blocks;
+    bucket_lock_type_t lock_type;
+    bool has_bucket_locks; // Whether every bucket carries its own lock that must be destroyed
+} retired_bucket_table;
+
+#pragma endregion
+
+#pragma region Private Function Declarations
+static int _initialise_hash_bucket(hash_bucket_memory_pool* pool_ptr, hash_bucket *hash_bucket_ptr, pthread_rwlock_t *rwlock_ptr);
+static bool _has_bucket_locks(const hash_bucket_memory_pool* pool_ptr);
+static int _resize_lock(hash_bucket_memory_pool* pool_ptr, bool is_exclusive);
+static void _resize_unlock(hash_bucket_memory_pool* pool_ptr, bool is_exclusive);
+static hash_bucket* _get_bucket_for_key(hash_bucket_memory_pool* pool_ptr, uint32_t key_hash);
+static void _load_bucket_tables(hash_bucket_memory_pool* pool_ptr, bucket_table_snapshot *tables_out);
+static hash_bucket* _get_read_bucket(const bucket_table_snapshot *tables, uint32_t key_hash);
+static int _incremental_migration_step(hash_bucket_memory_pool* pool_ptr, uint32_t key_hash, bool *is_migration_complete_out);
+static int _migrate_hash_bucket(hash_bucket_memory_pool* pool_ptr, unsigned int old_index);
+static void _update_resize_thresholds(hash_bucket_memory_pool* pool_ptr);
+static bool _is_resize_required(hash_bucket_memory_pool* pool_ptr);
+static bool _get_resized_bucket_count(hash_bucket_memory_pool* pool_ptr, unsigned int *new_size_out);
+static int _resize_hash_buckets(hash_bucket_memory_pool* pool_ptr);
+static void _finish_resize(hash_bucket_memory_pool* pool_ptr);
+static void _reclaim_bucket_table(void *retired_table_ptr, void *context);
+static void _record_bucket_count_change(hash_bucket_memory_pool* pool_ptr, unsigned int old_count, unsigned int new_count);
+static void _record_bucket_presence(hash_bucket_memory_pool* pool_ptr, unsigned int key_count, long bucket_delta);
+#pragma endregion
+
+#pragma region Private Function Definitions
+
+/**
+ * @fn _resize_lock
+ * @brief Acquires the table-level resize lock.
+ *
+ * Bucket operations hold the lock shared so the table pointers they resolved stay valid,
+ * while swapping or releasing a table requires it exclusively. This is a no-op when
+ * concurrency control is disabled.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param is_exclusive true to acquire the write lock, false for the read lock.
+ * @return 0 on success, -30 on lock acquisition failure.
+ * @note Readers back off while an exclusive acquisition is pending. pthread rwlocks may prefer
+ *       readers, and a steady stream of bucket operations would otherwise starve the resize.
+ */
+static int _resize_lock(hash_bucket_memory_pool* pool_ptr, bool is_exclusive)
+{
+    if (!pool_ptr->is_concurrency_enabled) return 0;
+
+    int lock_result;
+    if (is_exclusive) {
+        atomic_fetch_add(&pool_ptr->pending_resize_writers, 1);
+        lock_result = pthread_rwlock_wrlock(&pool_ptr->resize_lock);
+        if (lock_result != 0) atomic_fetch_sub(&pool_ptr->pending_resize_writers, 1);
+    } else {
+        while (atomic_load(&pool_ptr->pending_resize_writers) > 0) sched_yield();
+        lock_result = pthread_rwlock_rdlock(&pool_ptr->resize_lock);
+    }
+
+    return (lock_result == 0) ? 0 : -30;
+}
+
+/**
+ * @fn _resize_unlock
+ * @brief Releases the table-level resize lock acquired by _resize_lock.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param is_exclusive Must match the mode the lock was acquired with.
+ */
+static void _resize_unlock(hash_bucket_memory_pool* pool_ptr, bool is_exclusive)
+{
+    if (!pool_ptr->is_concurrency_enabled) return;
+
+    pthread_rwlock_unlock(&pool_ptr->resize_lock);
+    if (is_exclusive) atomic_fetch_sub(&pool_ptr->pending_resize_writers, 1);
+}
+
+/**
+ * @fn _get_bucket_for_key
+ * @brief Resolves the bucket in the current table that owns the given key hash.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param key_hash The hash value of the key.
+ * @return Pointer to the owning hash bucket, or NULL if the pool is not initialized.
+ * @note The caller must hold the resize lock and have migrated the key's old bucket (see _incremental_migration_step).
+ */
+static hash_bucket* _get_bucket_for_key(hash_bucket_memory_pool* pool_ptr, uint32_t key_hash)
+{
+    if (!pool_ptr->is_initialized || pool_ptr->total_blocks == 0) return NULL;
+
+    return get_hash_bucket(pool_ptr, key_hash & (pool_ptr->total_blocks - 1));
+}
+
+/**
+ * @fn _load_bucket_tables
+ * @brief Loads a consistent snapshot of the current and the old table without the resize lock.
+ *
+ * The table pointers and sizes only change under the exclusive resize lock, with table_version
+ * odd meanwhile. The snapshot is retried until it was taken while the version stayed the same and even.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param tables_out Pointer to receive the snapshot.
+ * @note The caller must be inside an epoch critical section, which keeps the tables of the snapshot allocated.
+ */
+static void _load_bucket_tables(hash_bucket_memory_pool* pool_ptr, bucket_table_snapshot *tables_out)
+{
+    for (;;) {
+        unsigned int version = atomic_load_explicit(&pool_ptr->table_version, memory_order_acquire);
+        if ((version & 1) != 0) {
+            sched_yield(); // A table swap is in progress
+            continue;
+        }
+
+        tables_out->hash_buckets_ptr = __atomic_load_n(&pool_ptr->hash_buckets_ptr, __ATOMIC_RELAXED);
+        tables_out->total_blocks = __atomic_load_n(&pool_ptr->total_blocks, __ATOMIC_RELAXED);
+        tables_out->old_hash_buckets_ptr = __atomic_load_n(&pool_ptr->old_hash_buckets_ptr, __ATOMIC_RELAXED);
+        tables_out->old_total_blocks = __atomic_load_n(&pool_ptr->old_total_blocks, __ATOMIC_RELAXED);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&pool_ptr->table_version, memory_order_relaxed) == version) return;
+    }
+}
+
+/**
+ * @fn _get_read_bucket
+ * @brief Resolves the bucket a lock-free reader looks a key up in.
+ *
+ * While the old bucket of the key has not been drained, it still holds the key. Once it is marked
+ * migrated, the targets in the current table hold every one of its keys.
+ *
+ * @param tables The snapshot of the tables from _load_bucket_tables.
+ * @param key_hash The hash value of the key.
+ * @return Pointer to the bucket, which may be drained by a resize while it is read.
+ */
+static hash_bucket* _get_read_bucket(const bucket_table_snapshot *tables, uint32_t key_hash)
+{
+    if (tables->old_hash_buckets_ptr != NULL) {
+        hash_bucket *old_bucket_ptr = &tables->old_hash_buckets_ptr[key_hash & (tables->old_total_blocks - 1)];
+        if (!atomic_load_explicit(&old_bucket_ptr->is_migrated, memory_order_acquire)) return old_bucket_ptr;
+    }
+
+    return &tables->hash_buckets_ptr[key_hash & (tables->total_blocks - 1)];
+}
+
+/**
+ * @fn _incremental_migration_step
+ * @brief Performs one step of an in-progress resize on behalf of a bucket operation.
+ *
+ * The old bucket that owns key_hash is drained first so the caller can operate on the
+ * new table alone, then one more old bucket is drained from the migration cursor so that
+ * the resize completes even if the remaining keys are never touched.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param key_hash The hash value of the key about to be operated on.
+ * @param is_migration_complete_out Set to true if every old bucket has been drained and the old table can be released.
+ * @return 0 on success, or a negative error code on failure.
+ * @note The caller must hold the resize lock shared.
+ */
+static int _incremental_migration_step(hash_bucket_memory_pool* pool_ptr, uint32_t key_hash, bool *is_migration_complete_out)
+{
+    *is_migration_complete_out = false;
+    if (pool_ptr->old_hash_buckets_ptr == NULL) return 0; // No resize in progress
+
+    int result = _migrate_hash_bucket(pool_ptr, key_hash & (pool_ptr->old_total_blocks - 1));
+    if (result != 0) return result;
+
+    if (atomic_load(&pool_ptr->migration_cursor) < pool_ptr->old_total_blocks)
+    {
+        unsigned int cursor = atomic_fetch_add(&pool_ptr->migration_cursor, 1);
+        if (cursor < pool_ptr->old_total_blocks) result = _migrate_hash_bucket(pool_ptr, cursor);
+    }
+
+    *is_migration_complete_out = (atomic_load(&pool_ptr->migrated_blocks) == pool_ptr->old_total_blocks);
+    return result;
+}
+
+/**
+ * @fn _migrate_hash_bucket
+ * @brief Drains an old-table bucket into the new table.
+ *
+ * When growing, the chain of the old bucket splits between the targets index and index + old size.
+ * When shrinking, the sibling buckets index and index + new size fold into the same target, so both
+ * are drained together. Only the old buckets are write-locked (in ascending index order): a target is
+ * unreachable until all of its old buckets are marked migrated, so it is initialized here, on first use,
+ * instead of when the resize starts. Data nodes are not copied, only relinked. Tree buckets are
+ * converted to lists first and the targets are re-treeified if they reach the treeify threshold.
+ * The versions of the old buckets are odd while their nodes are relinked, so lock-free readers
+ * do not trust a miss in them (see _find_node_lock_free).
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param old_index Index of the bucket in the old table.
+ * @return 0 on success, or a negative error code on failure.
+ */
+static int _migrate_hash_bucket(hash_bucket_memory_pool* pool_ptr, unsigned int old_index)
+{
+    bool is_growing = (pool_ptr->total_blocks > pool_ptr->old_total_blocks);
+    unsigned int source_count = is_growing ? 1 : 2;
+    unsigned int target_count = is_growing ? 2 : 1;
+    unsigned int first_index = is_growing ? old_index : (old_index & (pool_ptr->total_blocks - 1));
+
+    hash_bucket *source_buckets[2] = { &pool_ptr->old_hash_buckets_ptr[first_index], NULL };
+    if (!is_growing) source_buckets[1] = &pool_ptr->old_hash_buckets_ptr[first_index + pool_ptr->total_blocks];
+    if (atomic_load_explicit(&source_buckets[0]->is_migrated, memory_order_acquire)) return 0; // Already drained, siblings are drained together
+
+    // Siblings share a lock stripe, which is then taken only once
+    bucket_lock *locks[2] = { _get_bucket_lock(pool_ptr, source_buckets[0], first_index), NULL };
+    unsigned int lock_count = 1;
+    if (!is_growing) {
+        bucket_lock *sibling_lock_ptr = _get_bucket_lock(pool_ptr, source_buckets[1], first_index + pool_ptr->total_blocks);
+        if (sibling_lock_ptr != locks[0]) locks[lock_count++] = sibling_lock_ptr;
+    }
+
+    if (pool_ptr->is_concurrency_enabled)
+    {
+        for (unsigned int i = 0; i < lock_count; ++i) {
+            if (acquire_bucket_lock(locks[i], pool_ptr->lock_type, true, NULL) != 0) {
+                while (i-- > 0) release_bucket_lock(locks[i], pool_ptr->lock_type, true);
+                return -30; // Handle error: failed to acquire lock
+            }
+        }
+    }
+
+    int result = 0;
+    if (!atomic_load_explicit(&source_buckets[0]->is_migrated, memory_order_relaxed))
+    {
+        hash_bucket *target_buckets[2] = {NULL, NULL};
+        for (unsigned int i = 0; i < target_count && result == 0; ++i) {
+            target_buckets[i] = get_hash_bucket(pool_ptr, first_index + i * pool_ptr->old_total_blocks);
+            if (target_buckets[i] == NULL) result = -40; // Error handling: bucket not found or initialized
+        }
+        for (unsigned int i = 0; i < source_count && result == 0; ++i) {
+            if (source_buckets[i]->is_initialized) result = _convert_bucket_type(pool_ptr, source_buckets[i], BUCKET_LIST);
+        }
+
+        if (result == 0)
+        {
+            unsigned int target_counts[2] = { target_buckets[0]->count, is_growing ? target_buckets[1]->count : 0 };
+            for (unsigned int i = 0; i < source_count; ++i) atomic_fetch_add(&source_buckets[i]->version, 1);
+
+            for (unsigned int i = 0; i < source_count; ++i)
+            {
+                hash_bucket *source_bucket_ptr = source_buckets[i];
+                data_node *current_node_ptr = source_bucket_ptr->is_initialized ? source_bucket_ptr->container.list : NULL;
+                while (current_node_ptr != NULL)
+                {
+                    data_node *next_node_ptr = current_node_ptr->next;
+                    unsigned int target_slot = (is_growing && (current_node_ptr->key_hash & pool_ptr->old_total_blocks) != 0) ? 1 : 0;
+                    hash_bucket *target_bucket_ptr = target_buckets[target_slot];
+
+                    insert_list_node(&target_bucket_ptr->container.list, current_node_ptr);
+                    target_bucket_ptr->count += 1;
+                    current_node_ptr = next_node_ptr;
+                }
+
+                // A drained bucket leaves the statistics, which only visit buckets that are not migrated yet
+                if (source_bucket_ptr->is_initialized) _record_bucket_presence(pool_ptr, source_bucket_ptr->count, -1);
+                source_bucket_ptr->container.list = NULL;
+                source_bucket_ptr->count = 0;
+            }
+
+            for (unsigned int i = 0; i < target_count; ++i) {
+                _record_bucket_count_change(pool_ptr, target_counts[i], target_buckets[i]->count);
+                _update_bucket_type(pool_ptr, target_buckets[i]);
+            }
+
+            for (unsigned int i = 0; i < source_count; ++i) {
+                atomic_store_explicit(&source_buckets[i]->is_migrated, true, memory_order_release);
+                atomic_fetch_add(&source_buckets[i]->version, 1);
+            }
+            atomic_fetch_add(&pool_ptr->migrated_blocks, source_count);
+        }
+    }
+
+    if (pool_ptr->is_concurrency_enabled)
+    {
+        for (unsigned int i = lock_count; i-- > 0;) release_bucket_lock(locks[i], pool_ptr->lock_type, true);
+    }
+
+    return result;
+}
+
+/**
+ * @fn _update_resize_thresholds
+ * @brief Converts the load factors into key counts for the current table size.
+ *
+ * Bucket operations compare the key count against these thresholds after every insert and delete,
+ * which takes no lock and no floating point division.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @note Call after the load factors or total_blocks changed. The caller must not race with a table swap.
+ */
+static void _update_resize_thresholds(hash_bucket_memory_pool* pool_ptr)
+{
+    // keys / blocks > factor exactly when keys > floor(factor * blocks), and < factor when keys < ceil(factor * blocks)
+    unsigned int grow_key_threshold = UINT_MAX;
+    if (pool_ptr->grow_load_factor > 0 && pool_ptr->total_blocks <= UINT32_MAX / 4) {
+        double key_count = floor(pool_ptr->grow_load_factor * pool_ptr->total_blocks);
+        grow_key_threshold = (key_count < UINT_MAX) ? (unsigned int)key_count : UINT_MAX;
+    }
+
+    unsigned int shrink_key_threshold = 0;
+    if (pool_ptr->shrink_load_factor > 0 && pool_ptr->total_blocks > pool_ptr->min_total_blocks) {
+        double key_count = ceil(pool_ptr->shrink_load_factor * pool_ptr->total_blocks);
+        shrink_key_threshold = (key_count < UINT_MAX) ? (unsigned int)key_count : UINT_MAX;
+    }
+
+    atomic_store(&pool_ptr->grow_key_threshold, grow_key_threshold);
+    atomic_store(&pool_ptr->shrink_key_threshold, shrink_key_threshold);
+}
+
+/**
+ * @fn _is_resize_required
+ * @brief Checks the key count against the resize thresholds of the current table size.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @return true if the table should grow or shrink and no resize is in progress, false otherwise.
+ * @note Takes no lock, only atomic loads, so it can run after every insert and delete.
+ */
+static bool _is_resize_required(hash_bucket_memory_pool* pool_ptr)
+{
+    unsigned int key_count = atomic_load_explicit(&pool_ptr->total_keys, memory_order_relaxed);
+    if (key_count <= atomic_load_explicit(&pool_ptr->grow_key_threshold, memory_order_relaxed) &&
+        key_count >= atomic_load_explicit(&pool_ptr->shrink_key_threshold, memory_order_relaxed)) return false;
+
+    return !atomic_load_explicit(&pool_ptr->is_resizing, memory_order_relaxed);
+}
+
+/**
+ * @fn _get_resized_bucket_count
+ * @brief Returns the bucket count the table should be resized to.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param new_size_out Pointer to receive the new bucket count if a resize is required.
+ * @return true if the table should grow or shrink, false otherwise.
+ * @note Only the thread that set is_resizing may call this, as it reads total_blocks without the resize lock.
+ */
+static bool _get_resized_bucket_count(hash_bucket_memory_pool* pool_ptr, unsigned int *new_size_out)
+{
+    unsigned int key_count = atomic_load(&pool_ptr->total_keys);
+
+    if (key_count > atomic_load(&pool_ptr->grow_key_threshold)) {
+        *new_size_out = pool_ptr->total_blocks * 2;
+        return true;
+    }
+
+    if (key_count < atomic_load(&pool_ptr->shrink_key_threshold)) {
+        *new_size_out = pool_ptr->total_blocks / 2;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @fn _resize_hash_buckets
+ * @brief Starts an incremental resize if the key count crossed one of the resize thresholds.
+ *
+ * The new table is only allocated zeroed; its buckets are initialized as they receive the keys of
+ * the old table (see _migrate_hash_bucket), so starting a resize costs the same for any table size.
+ * The resize lock is only taken exclusively to swap the table pointers.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @return 0 on success or if no resize was needed, or a negative error code on failure.
+ * @note The caller must not hold the resize lock.
+ */
+static int _resize_hash_buckets(hash_bucket_memory_pool* pool_ptr)
+{
+    if (!pool_ptr->is_initialized || !_is_resize_required(pool_ptr)) return 0;
+
+    // Only one thread performs a resize at a time
+    bool expected = false;
+    if (!atomic_compare_exchange_strong(&pool_ptr->is_resizing, &expected, true)) return 0;
+
+    unsigned int new_size = 0;
+    if (!_get_resized_bucket_count(pool_ptr, &new_size)) {
+        atomic_store(&pool_ptr->is_resizing, false); // Another thread's resize just finished
+        return 0;
+    }
+
+    bool is_rwlock_table = _has_bucket_locks(pool_ptr) && pool_ptr->lock_type == BUCKET_LOCK_RWLOCK;
+    hash_bucket *new_buckets_ptr = calloc(new_size, sizeof(hash_bucket));
+    pthread_rwlock_t *new_rwlocks_ptr = is_rwlock_table ? calloc(new_size, sizeof(pthread_rwlock_t)) : NULL;
+    if (new_buckets_ptr == NULL || (is_rwlock_table && new_rwlocks_ptr == NULL)) {
+        free(new_buckets_ptr);
+        free(new_rwlocks_ptr);
+        atomic_store(&pool_ptr->is_resizing, false);
+        return -10; // Error handling: memory allocation failed
+    }
+
+    if (_resize_lock(pool_ptr, true) != 0) {
+        free(new_buckets_ptr);
+        free(new_rwlocks_ptr);
+        atomic_store(&pool_ptr->is_resizing, false);
+        return -30;
+    }
+
+    // Lock-free readers load the tables without the resize lock, the odd version makes them wait for a consistent pair
+    atomic_fetch_add(&pool_ptr->table_version, 1);
+    __atomic_store_n(&pool_ptr->old_hash_buckets_ptr, pool_ptr->hash_buckets_ptr, __ATOMIC_RELAXED);
+    __atomic_store_n(&pool_ptr->old_total_blocks, pool_ptr->total_blocks, __ATOMIC_RELAXED);
+    pool_ptr->old_bucket_rwlocks_ptr = pool_ptr->bucket_rwlocks_ptr;
+    atomic_store(&pool_ptr->migration_cursor, 0);
+    atomic_store(&pool_ptr->migrated_blocks, 0);
+    __atomic_store_n(&pool_ptr->hash_buckets_ptr, new_buckets_ptr, __ATOMIC_RELAXED);
+    __atomic_store_n(&pool_ptr->total_blocks, new_size, __ATOMIC_RELAXED);
+    pool_ptr->bucket_rwlocks_ptr = new_rwlocks_ptr;
+    atomic_fetch_add(&pool_ptr->table_version, 1);
+    _update_resize_thresholds(pool_ptr);
+
+    _resize_unlock(pool_ptr, true);
+    return 0;
+}
+
+/**
+ * @fn _finish_resize
+ * @brief Releases the old table once every one of its buckets has been migrated.
+ *
+ * The old table is only detached under the exclusive resize lock. Lock-free readers may still be
+ * inside it, so it is retired through the epoch manager, which destroys its locks and frees it once
+ * no reader can reach it anymore (immediately without lock-free reads), after the lock is released.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @note The caller must not hold the resize lock.
+ * @note Only call this after _incremental_migration_step reported completion, as it takes the resize lock exclusively.
+ */
+static void _finish_resize(hash_bucket_memory_pool* pool_ptr)
+{
+    if (!atomic_load(&pool_ptr->is_resizing)) return;
+
+    retired_bucket_table *retired_table_ptr = malloc(sizeof(retired_bucket_table));
+    if (retired_table_ptr == NULL) return; // Retried by the next operation that finds the migration complete
+
+    if (_resize_lock(pool_ptr, true) != 0) {
+        free(retired_table_ptr);
+        return;
+    }
+
+    bool is_detached = false;
+    if (pool_ptr->old_hash_buckets_ptr != NULL && atomic_load(&pool_ptr->migrated_blocks) == pool_ptr->old_total_blocks)
+    {
+        *retired_table_ptr = (retired_bucket_table){ pool_ptr->old_hash_buckets_ptr, pool_ptr->old_bucket_rwlocks_ptr, pool_ptr->old_total_blocks, pool_ptr->lock_type, _has_bucket_locks(pool_ptr) };
+
+        atomic_fetch_add(&pool_ptr->table_version, 1);
+        __atomic_store_n(&pool_ptr->old_hash_buckets_ptr, NULL, __ATOMIC_RELAXED);
+        __atomic_store_n(&pool_ptr->old_total_blocks, 0, __ATOMIC_RELAXED);
+        pool_ptr->old_bucket_rwlocks_ptr = NULL;
+        atomic_fetch_add(&pool_ptr->table_version, 1);
+
+        atomic_store(&pool_ptr->is_resizing, false);
+        is_detached = true;
+    }
+
+    _resize_unlock(pool_ptr, true);
+
+    if (is_detached) epoch_retire(pool_ptr->node_context.epoch_manager_ptr, retired_table_ptr, _reclaim_bucket_table, NULL);
+    else free(retired_table_ptr);
+}
+
+/**
+ * @fn _reclaim_bucket_table
+ * @brief Epoch reclaim callback that destroys the locks of a retired bucket table and frees it.
+ * @param retired_table_ptr Pointer to the retired_bucket_table, which is freed as well.
+ * @param context Unused.
+ */
+static void _reclaim_bucket_table(void *retired_table_ptr, void *context)
+{
+    (void)context;
+    retired_bucket_table *table_ptr = retired_table_ptr;
+
+    if (table_ptr->has_bucket_locks)
+    {
+        for (unsigned int i = 0; i < table_ptr->total_blocks; ++i) {
+            if (table_ptr->hash_buckets_ptr[i].is_initialized) destroy_bucket_lock(&table_ptr->hash_buckets_ptr[i].lock, table_ptr->lock_type);
+        }
+    }
+
+    free(table_ptr->hash_buckets_ptr);
+    free(table_ptr->rwlocks_ptr);
+    free(table_ptr);
+}
+
+#pragma endregion
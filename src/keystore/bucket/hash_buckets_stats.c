@@ -1,83 +1,211 @@
 #include "core/type_definition.h"
+#include "core/operation_counters.h"
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
 
+#pragma region Private Type Definitions
+typedef struct
+{
+    unsigned long bucket_counts[KEY_STORE_OCCUPANCY_HISTOGRAM_SIZE]; // Buckets by the number of keys they hold, fuller buckets by power of two
+    unsigned long long overflow_key_counts[KEY_STORE_OCCUPANCY_OVERFLOW_SLOTS]; // Keys in the buckets of each overflow slot
+    unsigned long total_buckets;
+    unsigned long long total_keys;
+    unsigned long long key_count_squares;
+    unsigned int max_overflow_key_count; // Largest key count a bucket of an overflow slot reached
+} bucket_occupancy_summary;
+
+#pragma endregion
+
 #pragma region Private Function Declarations
-static double _calculate_standard_deviation_keys_per_bucket(key_entry_stats* stats, hash_bucket_memory_pool* pool_ptr);
-static double _calculate_median_keys_per_bucket(key_entry_stats* stats, hash_bucket_memory_pool* pool_ptr);
-static int _uint_compare(const void *a, const void *b);
+static void _record_bucket_count_change(hash_bucket_memory_pool* pool_ptr, unsigned int old_count, unsigned int new_count);
+static void _record_bucket_presence(hash_bucket_memory_pool* pool_ptr, unsigned int key_count, long bucket_delta);
+static void _sum_bucket_occupancy(hash_bucket_memory_pool* pool_ptr, bucket_occupancy_summary* summary_out);
+static unsigned int _get_occupancy_slot(unsigned int key_count);
+static void _record_overflow_keys(bucket_occupancy_shard *shard_ptr, unsigned int key_count, long bucket_delta);
+static unsigned int _get_slot_key_count(const bucket_occupancy_summary* occupancy, unsigned int slot);
+static unsigned int _get_max_bucket_count(const bucket_occupancy_summary* occupancy);
+static unsigned int _get_nth_nonempty_bucket_count(const bucket_occupancy_summary* occupancy, unsigned long n);
+static unsigned int _get_stats_bucket_count(hash_bucket_memory_pool* pool_ptr);
 #pragma endregion
 
 #pragma region Private Function Definitions
 
+/**
+ * @fn _get_stats_bucket_count
+ * @brief Returns the number of bucket positions of the current and the old table.
+ *
+ * While an incremental resize is in progress, keys are spread across the current and
+ * the old table, so the memory of both is reported.
+ */
+static unsigned int _get_stats_bucket_count(hash_bucket_memory_pool* pool_ptr) {
+    return pool_ptr->total_blocks + pool_ptr->old_total_blocks;
+}
 
 /**
- * @fn _calculate_standard_deviation_keys_per_bucket
- * @brief Calculates the standard deviation of keys per non-empty bucket.
+ * @fn _get_occupancy_slot
+ * @brief Returns the occupancy histogram slot that counts buckets with key_count keys.
  *
- * This function computes the standard deviation of the number of keys
- * in each non-empty hash bucket based on the average keys per non-empty bucket.
+ * Key counts below KEY_STORE_OCCUPANCY_EXACT_SLOTS have their own slot, larger ones share
+ * an overflow slot with the key counts of the same highest set bit.
+ */
+static unsigned int _get_occupancy_slot(unsigned int key_count) {
+    if (key_count < KEY_STORE_OCCUPANCY_EXACT_SLOTS) return key_count;
+
+    unsigned int high_bit = 31 - (unsigned int)__builtin_clz(key_count); // 6 for the first overflow slot
+    return KEY_STORE_OCCUPANCY_EXACT_SLOTS + high_bit - 6;
+}
+
+/**
+ * @fn _record_overflow_keys
+ * @brief Adds the keys of buckets entering an overflow slot, or removes those of buckets leaving it.
  *
- * @param stats Pointer to key_entry_stats structure containing average keys per non-empty bucket.
- * @note Assumes that stats->avg_keys_per_nonempty_bucket is already populated.
- * @return double The standard deviation of keys per non-empty bucket.
+ * @param shard_ptr Pointer to the calling thread's occupancy shard.
+ * @param key_count Key count of each of the buckets, nothing is recorded below KEY_STORE_OCCUPANCY_EXACT_SLOTS.
+ * @param bucket_delta Number of buckets entering the slot, negative for buckets leaving it.
  */
-static double _calculate_standard_deviation_keys_per_bucket(key_entry_stats* stats, hash_bucket_memory_pool* pool_ptr) {
-    if (stats->nonempty_buckets == 0) return 0.0;
-
-    double sum_squared_diff = 0.0;
-    for (unsigned int i = 0; i < pool_ptr->total_blocks; ++i) {
-        hash_bucket *bucket_ptr = &pool_ptr->hash_buckets_ptr[i];
-        if (bucket_ptr->is_initialized && bucket_ptr->count > 0) {
-            double diff = bucket_ptr->count - stats->avg_keys_per_nonempty_bucket;
-            sum_squared_diff += diff * diff;
-        }
+static void _record_overflow_keys(bucket_occupancy_shard *shard_ptr, unsigned int key_count, long bucket_delta) {
+    if (key_count < KEY_STORE_OCCUPANCY_EXACT_SLOTS) return;
+
+    OPERATION_COUNTER_ADD(shard_ptr->overflow_key_counts[_get_occupancy_slot(key_count) - KEY_STORE_OCCUPANCY_EXACT_SLOTS], (long long)key_count * bucket_delta);
+    if (bucket_delta <= 0) return;
+
+    unsigned int max_key_count = __atomic_load_n(&shard_ptr->max_overflow_key_count, __ATOMIC_RELAXED);
+    while (key_count > max_key_count && !__atomic_compare_exchange_n(&shard_ptr->max_overflow_key_count, &max_key_count, key_count, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // max_key_count was reloaded by the failed exchange
     }
+}
 
-    return sqrt(sum_squared_diff / stats->nonempty_buckets);
+/**
+ * @fn _record_bucket_count_change
+ * @brief Moves a bucket between occupancy histogram slots after its key count changed.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool owning the bucket.
+ * @param old_count Key count of the bucket before the change.
+ * @param new_count Key count of the bucket after the change.
+ * @note The caller must hold the bucket's write lock (or run without concurrency), so the changes of one bucket are never reordered.
+ */
+static void _record_bucket_count_change(hash_bucket_memory_pool* pool_ptr, unsigned int old_count, unsigned int new_count) {
+    bucket_occupancy_shard *shard_ptr = &pool_ptr->occupancy.shards[get_operation_counter_shard_index()];
+    OPERATION_COUNTER_ADD(shard_ptr->bucket_counts[_get_occupancy_slot(old_count)], -1);
+    OPERATION_COUNTER_ADD(shard_ptr->bucket_counts[_get_occupancy_slot(new_count)], 1);
+    _record_overflow_keys(shard_ptr, old_count, -1);
+    _record_overflow_keys(shard_ptr, new_count, 1);
+    OPERATION_COUNTER_ADD(shard_ptr->key_count, (long long)new_count - old_count);
+    OPERATION_COUNTER_ADD(shard_ptr->key_count_squares, (long long)new_count * new_count - (long long)old_count * old_count);
 }
 
+/**
+ * @fn _record_bucket_presence
+ * @brief Adds initialized buckets to the occupancy histogram, or removes migrated and deleted ones.
+ *
+ * @param pool_ptr Pointer to the hash bucket memory pool owning the buckets.
+ * @param key_count Key count of each of the buckets.
+ * @param bucket_delta Number of buckets to add, negative to remove.
+ */
+static void _record_bucket_presence(hash_bucket_memory_pool* pool_ptr, unsigned int key_count, long bucket_delta) {
+    bucket_occupancy_shard *shard_ptr = &pool_ptr->occupancy.shards[get_operation_counter_shard_index()];
+    OPERATION_COUNTER_ADD(shard_ptr->bucket_counts[_get_occupancy_slot(key_count)], bucket_delta);
+    _record_overflow_keys(shard_ptr, key_count, bucket_delta);
+    OPERATION_COUNTER_ADD(shard_ptr->key_count, (long long)key_count * bucket_delta);
+    OPERATION_COUNTER_ADD(shard_ptr->key_count_squares, (long long)key_count * key_count * bucket_delta);
+}
 
 /**
- * @fn _calculate_median_keys_per_bucket
- * @brief Calculates the median number of keys per non-empty bucket.
+ * @fn _sum_bucket_occupancy
+ * @brief Adds up the shards of the occupancy histogram.
  *
- * This function collects the key counts from all non-empty buckets,
- * sorts them, and computes the median value.
+ * The summary is exact while no bucket count changes. Taken concurrently with writers, a bucket
+ * may briefly be seen in both or neither of its slots, negative sums are then read as zero.
  *
- * @param stats Pointer to key_entry_stats structure containing non-empty bucket count.
- * @note Assumes that stats->nonempty_buckets is already populated.
- * @return double The median number of keys per non-empty bucket.
+ * @param pool_ptr Pointer to the hash bucket memory pool.
+ * @param summary_out Pointer to the summary to fill in.
  */
-static double _calculate_median_keys_per_bucket(key_entry_stats* stats, hash_bucket_memory_pool* pool_ptr) {
+static void _sum_bucket_occupancy(hash_bucket_memory_pool* pool_ptr, bucket_occupancy_summary* summary_out) {
+    long bucket_counts[KEY_STORE_OCCUPANCY_HISTOGRAM_SIZE] = {0};
+    long long overflow_key_counts[KEY_STORE_OCCUPANCY_OVERFLOW_SLOTS] = {0};
+    long long total_keys = 0;
+    long long key_count_squares = 0;
+    unsigned int max_overflow_key_count = 0;
+
+    for (unsigned int s = 0; s < KEY_STORE_COUNTER_SHARD_COUNT; ++s) {
+        const bucket_occupancy_shard *shard_ptr = &pool_ptr->occupancy.shards[s];
+        for (unsigned int i = 0; i < KEY_STORE_OCCUPANCY_HISTOGRAM_SIZE; ++i) bucket_counts[i] += __atomic_load_n(&shard_ptr->bucket_counts[i], __ATOMIC_RELAXED);
+        for (unsigned int i = 0; i < KEY_STORE_OCCUPANCY_OVERFLOW_SLOTS; ++i) overflow_key_counts[i] += __atomic_load_n(&shard_ptr->overflow_key_counts[i], __ATOMIC_RELAXED);
+        total_keys += __atomic_load_n(&shard_ptr->key_count, __ATOMIC_RELAXED);
+        key_count_squares += __atomic_load_n(&shard_ptr->key_count_squares, __ATOMIC_RELAXED);
+
+        unsigned int shard_max = __atomic_load_n(&shard_ptr->max_overflow_key_count, __ATOMIC_RELAXED);
+        if (shard_max > max_overflow_key_count) max_overflow_key_count = shard_max;
+    }
 
-    if (stats->nonempty_buckets == 0) return 0.0;
+    memset(summary_out, 0, sizeof(*summary_out));
+    for (unsigned int i = 0; i < KEY_STORE_OCCUPANCY_HISTOGRAM_SIZE; ++i) {
+        summary_out->bucket_counts[i] = (bucket_counts[i] > 0) ? (unsigned long)bucket_counts[i] : 0;
+        summary_out->total_buckets += summary_out->bucket_counts[i];
+    }
+    for (unsigned int i = 0; i < KEY_STORE_OCCUPANCY_OVERFLOW_SLOTS; ++i) {
+        summary_out->overflow_key_counts[i] = (overflow_key_counts[i] > 0) ? (unsigned long long)overflow_key_counts[i] : 0;
+    }
+    summary_out->max_overflow_key_count = max_overflow_key_count;
+    summary_out->total_keys = (total_keys > 0) ? (unsigned long long)total_keys : 0;
+    summary_out->key_count_squares = (key_count_squares > 0) ? (unsigned long long)key_count_squares : 0;
+}
 
-    unsigned int *keys_per_bucket = malloc(stats->nonempty_buckets * sizeof(unsigned int));
-    if (keys_per_bucket == NULL) return 0.0; // Memory allocation failure
+/**
+ * @fn _get_slot_key_count
+ * @brief Returns the key count reported for the buckets of a histogram slot.
+ * @note Buckets of an overflow slot are reported with their average key count, which is exact if the slot holds one bucket.
+ */
+static unsigned int _get_slot_key_count(const bucket_occupancy_summary* occupancy, unsigned int slot) {
+    if (slot < KEY_STORE_OCCUPANCY_EXACT_SLOTS) return slot;
 
-    unsigned int idx = 0;
-    for (unsigned int i = 0; i < pool_ptr->total_blocks; ++i) {
-        hash_bucket *bucket_ptr = &pool_ptr->hash_buckets_ptr[i];
-        if (bucket_ptr->is_initialized && bucket_ptr->count > 0) {
-            keys_per_bucket[idx++] = bucket_ptr->count;
-        }
-    }
+    unsigned long long slot_min = 1ULL << (slot - KEY_STORE_OCCUPANCY_EXACT_SLOTS + 6);
+    unsigned long long slot_keys = occupancy->overflow_key_counts[slot - KEY_STORE_OCCUPANCY_EXACT_SLOTS];
+    unsigned long long average = (occupancy->bucket_counts[slot] > 0) ? (slot_keys + occupancy->bucket_counts[slot] / 2) / occupancy->bucket_counts[slot] : slot_min;
 
-    // Sort the array to find median
-    
-    qsort(keys_per_bucket, stats->nonempty_buckets, sizeof(unsigned int), _uint_compare);
+    // Concurrent changes may briefly leave the sums of a slot inconsistent
+    if (average < slot_min) return (unsigned int)slot_min;
+    if (average > 2 * slot_min - 1) return (unsigned int)(2 * slot_min - 1);
+    return (unsigned int)average;
+}
 
-    double median;
-    if (stats->nonempty_buckets % 2 == 0) {
-        median = (keys_per_bucket[stats->nonempty_buckets / 2 - 1] + keys_per_bucket[stats->nonempty_buckets / 2]) / 2.0;
-    } else {
-        median = keys_per_bucket[stats->nonempty_buckets / 2];
+/**
+ * @fn _get_max_bucket_count
+ * @brief Returns the key count of the fullest bucket, 0 if every bucket is empty.
+ *
+ * A lone bucket in the highest overflow slot is reported exactly. Otherwise the largest key count
+ * an overflow bucket reached is reported, bounded to the slot, so a bucket that shrank within
+ * its slot may still be reported with its earlier count.
+ */
+static unsigned int _get_max_bucket_count(const bucket_occupancy_summary* occupancy) {
+    for (unsigned int i = KEY_STORE_OCCUPANCY_HISTOGRAM_SIZE; i-- > 1;) {
+        if (occupancy->bucket_counts[i] == 0) continue;
+        if (i < KEY_STORE_OCCUPANCY_EXACT_SLOTS || occupancy->bucket_counts[i] == 1) return _get_slot_key_count(occupancy, i);
+
+        unsigned long long slot_max = (2ULL << (i - KEY_STORE_OCCUPANCY_EXACT_SLOTS + 6)) - 1;
+        unsigned int average = _get_slot_key_count(occupancy, i);
+        if (occupancy->max_overflow_key_count < average) return average;
+        return (occupancy->max_overflow_key_count > slot_max) ? (unsigned int)slot_max : occupancy->max_overflow_key_count;
     }
+    return 0;
+}
 
-    free(keys_per_bucket);
-    return median;
+/**
+ * @fn _get_nth_nonempty_bucket_count
+ * @brief Returns the key count of the n-th (0-based) non-empty bucket in ascending key count order.
+ * @note Buckets in an overflow slot are reported with its average key count (see _get_slot_key_count).
+ */
+static unsigned int _get_nth_nonempty_bucket_count(const bucket_occupancy_summary* occupancy, unsigned long n) {
+    unsigned long seen = 0;
+    unsigned int last_slot = 0;
+    for (unsigned int i = 1; i < KEY_STORE_OCCUPANCY_HISTOGRAM_SIZE; ++i) {
+        if (occupancy->bucket_counts[i] == 0) continue;
+        seen += occupancy->bucket_counts[i];
+        last_slot = i;
+        if (seen > n) break;
+    }
+    return _get_slot_key_count(occupancy, last_slot);
 }
 
 #pragma endregion
@@ -86,85 +214,73 @@ static double _calculate_median_keys_per_bucket(key_entry_stats* stats, hash_buc
 
 /**
  * @fn _calculate_key_entry_stats
- * @brief Calculates statistics about key entries in the hash bucket memory pool.
+ * @brief Calculates statistics about key entries from the bucket occupancy histogram.
  *
- * This function iterates through all hash buckets in the memory pool,
- * collecting statistics such as total keys, non-empty buckets, max/min keys
- * in a bucket, average keys per non-empty bucket, standard deviation, median,
- * and empty bucket percentage.
+ * Total keys, non-empty buckets, max/min keys in a bucket, average, standard deviation and
+ * median keys per non-empty bucket and the empty bucket percentage are derived from the
+ * histogram, in time proportional to its size rather than to the number of buckets.
  *
+ * @param occupancy Pointer to the summed occupancy histogram.
  * @return key_entry_stats A struct containing the calculated statistics.
+ * @note Buckets holding KEY_STORE_OCCUPANCY_EXACT_SLOTS or more keys share a slot per power of two, the
+ *       median reports them with the average of their slot and the maximum follows _get_max_bucket_count.
+ *       Totals, average and standard deviation stay exact.
  */
-key_entry_stats _calculate_key_entry_stats(hash_bucket_memory_pool* pool_ptr) {
+key_entry_stats _calculate_key_entry_stats(const bucket_occupancy_summary* occupancy) {
     key_entry_stats entry_stats = {0};
 
-    unsigned int total_keys = 0;
-    unsigned int nonempty_buckets = 0;
-    unsigned int max_keys_in_bucket = 0;
-    unsigned int min_keys_in_bucket = UINT32_MAX;
-
-    for (unsigned int i = 0; i < pool_ptr->total_blocks; ++i) {
-        hash_bucket *bucket_ptr = &pool_ptr->hash_buckets_ptr[i];
-        if (bucket_ptr->is_initialized) {
-            entry_stats.total_buckets++;
-            if (bucket_ptr->count > 0) {
-                nonempty_buckets++;
-                total_keys += bucket_ptr->count;
-                if (bucket_ptr->count > max_keys_in_bucket) {
-                    max_keys_in_bucket = bucket_ptr->count;
-                }
-                if (bucket_ptr->count < min_keys_in_bucket) {
-                    min_keys_in_bucket = bucket_ptr->count;
-                }
-            }
-        }
+    unsigned long nonempty_buckets = occupancy->total_buckets - occupancy->bucket_counts[0];
+    entry_stats.total_keys = (unsigned int)occupancy->total_keys;
+    entry_stats.total_buckets = (unsigned int)occupancy->total_buckets;
+    entry_stats.nonempty_buckets = (unsigned int)nonempty_buckets;
+    entry_stats.empty_buckets = (unsigned int)occupancy->bucket_counts[0];
+    if (nonempty_buckets == 0) return entry_stats;
+
+    entry_stats.max_keys_in_bucket = _get_max_bucket_count(occupancy);
+    entry_stats.min_keys_in_bucket = _get_nth_nonempty_bucket_count(occupancy, 0);
+
+    double avg_keys = (double)occupancy->total_keys / nonempty_buckets;
+    double variance = (double)occupancy->key_count_squares / nonempty_buckets - avg_keys * avg_keys;
+    entry_stats.avg_keys_per_nonempty_bucket = avg_keys;
+    entry_stats.stddev_keys_per_bucket = (variance > 0.0) ? sqrt(variance) : 0.0; // Rounding may leave a tiny negative variance
+    entry_stats.avg_collisions_per_nonempty_bucket = (occupancy->total_keys > nonempty_buckets) ? (double)(occupancy->total_keys - nonempty_buckets) / nonempty_buckets : 0.0;
+    entry_stats.empty_bucket_percent = ((double)entry_stats.empty_buckets / entry_stats.total_buckets) * 100.0;
+
+    if (nonempty_buckets % 2 == 0) {
+        entry_stats.median_keys_per_bucket = (_get_nth_nonempty_bucket_count(occupancy, nonempty_buckets / 2 - 1) + _get_nth_nonempty_bucket_count(occupancy, nonempty_buckets / 2)) / 2.0;
+    } else {
+        entry_stats.median_keys_per_bucket = _get_nth_nonempty_bucket_count(occupancy, nonempty_buckets / 2);
     }
 
-    entry_stats.total_keys = total_keys;
-    entry_stats.nonempty_buckets = nonempty_buckets;
-    entry_stats.empty_buckets = entry_stats.total_buckets - nonempty_buckets;
-    entry_stats.max_keys_in_bucket = max_keys_in_bucket;
-    entry_stats.min_keys_in_bucket = (min_keys_in_bucket == UINT32_MAX) ? 0 : min_keys_in_bucket;
-    entry_stats.avg_keys_per_nonempty_bucket = (nonempty_buckets > 0) ? ((double)total_keys / nonempty_buckets) : 0.0;
-    entry_stats.empty_bucket_percent = (entry_stats.total_buckets > 0) ? ((double)entry_stats.empty_buckets / entry_stats.total_buckets) * 100.0 : 0.0;
-    entry_stats.avg_collisions_per_nonempty_bucket = (nonempty_buckets > 0) ? ((double)(total_keys - nonempty_buckets) / nonempty_buckets) : 0.0;
-    entry_stats.median_keys_per_bucket = _calculate_median_keys_per_bucket(&entry_stats, pool_ptr);
-    entry_stats.stddev_keys_per_bucket = _calculate_standard_deviation_keys_per_bucket(&entry_stats, pool_ptr);
-
     return entry_stats;
 }
 
 
 /**
  * @fn _calculate_collision_stats
- * @brief Calculates statistics about key collisions in the hash bucket memory pool.
+ * @brief Calculates statistics about key collisions from the bucket occupancy histogram.
  *
- * This function iterates through all hash buckets in the memory pool,
- * collecting statistics such as number of collision buckets, highest
- * collision in a bucket, average collisions per non-empty bucket, and
- * collision percentage.
+ * The number of collision buckets (more than one key), the highest collision in a bucket,
+ * the average collisions per collision bucket and the collision percentage are derived from
+ * the histogram, in time proportional to its size.
  *
+ * @param pool_ptr Pointer to the hash bucket memory pool, whose current table size the percentage refers to.
+ * @param occupancy Pointer to the summed occupancy histogram.
  * @return key_collision_stats A struct containing the calculated statistics.
  */
-key_collision_stats _calculate_collision_stats(hash_bucket_memory_pool* pool_ptr) {
+key_collision_stats _calculate_collision_stats(hash_bucket_memory_pool* pool_ptr, const bucket_occupancy_summary* occupancy) {
     key_collision_stats collision_stats = {0};
-    unsigned int collision_buckets = 0;
-    unsigned int highest_collision_in_bucket = 0;
-    double sum_collisions = 0.0;
-
-    for (unsigned int i = 0; i < pool_ptr->total_blocks; ++i) {
-        hash_bucket *bucket_ptr = &pool_ptr->hash_buckets_ptr[i];
-        if (bucket_ptr->is_initialized && bucket_ptr->count > 1) {
-            unsigned int collisions = bucket_ptr->count - 1;
-            collision_buckets++;
-            sum_collisions += collisions;
-            if (collisions > highest_collision_in_bucket) {
-                highest_collision_in_bucket = collisions;
-            }
-        }
-    }
+    unsigned long collision_buckets = 0;
+    for (unsigned int i = 2; i < KEY_STORE_OCCUPANCY_HISTOGRAM_SIZE; ++i) collision_buckets += occupancy->bucket_counts[i];
+
+    unsigned int max_bucket_count = _get_max_bucket_count(occupancy);
+    unsigned int highest_collision_in_bucket = (max_bucket_count > 1) ? max_bucket_count - 1 : 0;
+
+    // Every key beyond the first of a bucket is a collision, and only collision buckets hold more than one
+    unsigned long nonempty_buckets = occupancy->total_buckets - occupancy->bucket_counts[0];
+    double sum_collisions = (occupancy->total_keys > nonempty_buckets) ? (double)(occupancy->total_keys - nonempty_buckets) : 0.0;
 
-    collision_stats.collision_buckets = collision_buckets;
+    collision_stats.collision_buckets = (unsigned int)collision_buckets;
     collision_stats.collision_percent = (pool_ptr->total_blocks > 0) ? ((double)collision_buckets / pool_ptr->total_blocks) * 100.0 : 0.0;
     collision_stats.highest_collision_in_bucket = highest_collision_in_bucket;
     collision_stats.avg_collisions_per_nonempty_bucket = (collision_buckets > 0) ? (sum_collisions / collision_buckets) : 0.0;
@@ -178,22 +294,25 @@ key_collision_stats _calculate_collision_stats(hash_bucket_memory_pool* pool_ptr
  *
  * This function computes total memory, used memory, free memory,
  * memory utilization percentage, and memory per key based on the
- * current state of the hash bucket memory pool.
+ * current state of the hash bucket memory pool and the list, tree
+ * and slab pools of its memory manager. Blocks cached in thread
+ * magazines count as free memory.
  *
- * @param total_keys The total number of keys stored in the hash buckets.
+ * @param occupancy Pointer to the summed occupancy histogram, which counts the initialized buckets and stored keys.
  * @return memory_pool_stats A struct containing the calculated memory statistics.
  */
-memory_pool_stats _calculate_memory_stats(hash_bucket_memory_pool* pool_ptr, unsigned int total_keys) {
+memory_pool_stats _calculate_memory_stats(hash_bucket_memory_pool* pool_ptr, const bucket_occupancy_summary* occupancy) {
     memory_pool_stats mem_stats = {0};
-    size_t total_memory_bytes = pool_ptr->total_blocks * pool_ptr->block_size;
-    size_t used_memory_bytes = 0;
-
-    for (unsigned int i = 0; i < pool_ptr->total_blocks; ++i) {
-        hash_bucket *bucket_ptr = &pool_ptr->hash_buckets_ptr[i];
-        if (bucket_ptr->is_initialized) {
-            used_memory_bytes += sizeof(hash_bucket);
-            // Additional memory used by nodes can be added here if tracked
-        }
+    size_t lock_stripe_bytes = (size_t)pool_ptr->lock_stripe_count * sizeof(bucket_lock_stripe);
+    size_t total_memory_bytes = (size_t)_get_stats_bucket_count(pool_ptr) * pool_ptr->block_size + lock_stripe_bytes;
+    size_t used_memory_bytes = (size_t)occupancy->total_buckets * pool_ptr->block_size + lock_stripe_bytes; // Initialized buckets that are not migrated yet
+    unsigned long long total_keys = occupancy->total_keys;
+
+    memory_pool_usage node_usage = {0};
+    if (get_memory_manager_usage(pool_ptr->node_context.memory_manager_ptr, &node_usage) == 0) {
+        total_memory_bytes += node_usage.total_bytes;
+        used_memory_bytes += node_usage.used_bytes;
+        memcpy(mem_stats.slab_classes, node_usage.slab_classes, sizeof(mem_stats.slab_classes));
     }
 
     size_t free_memory_bytes = total_memory_bytes - used_memory_bytes;
@@ -209,21 +328,4 @@ memory_pool_stats _calculate_memory_stats(hash_bucket_memory_pool* pool_ptr, uns
     return mem_stats;
 }
 
-/**
- * @fn _uint_compare
- * @brief Comparison function for qsort to sort unsigned integers.
- *
- * This function compares two unsigned integers and is used by qsort
- * to sort an array of unsigned integers in ascending order.
- *
- * @param a Pointer to the first unsigned integer.
- * @param b Pointer to the second unsigned integer.
- * @return int Negative if a < b, zero if a == b, positive if a > b.
- */
-int _uint_compare(const void *a, const void *b){
-    unsigned int int_a = *(unsigned int*)a;
-    unsigned int int_b = *(unsigned int*)b;
-    return (int_a > int_b) - (int_a < int_b);
-}
-
 #pragma endregion
\ No newline at end of file
@@ -0,0 +1,784 @@
+/**
+ * @file swiss_table.c
+ * @brief Implementation of the open-addressing table engine.
+ *
+ * @note Groups are probed on aligned group boundaries with triangular steps, which visits every
+ *       group of a power-of-two table exactly once.
+ * @note Control bytes use the sign bit for empty and deleted slots, so a single movemask finds
+ *       every free slot of a group.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "swiss_table.h"
+#include "core/data_node.h"
+#include "core/operation_counters.h"
+#include "core/latency_histogram.h"
+#include "utils/memory_manager.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#pragma region Private Type Definitions
+#define SWISS_TABLE_CTRL_EMPTY ((int8_t)-128) // 0x80, ends a probe sequence
+#define SWISS_TABLE_CTRL_DELETED ((int8_t)-2) // 0xFE, tombstone that probing skips over
+#define SWISS_TABLE_TAG_BITS 7 // Low hash bits stored in the control byte
+#define SWISS_TABLE_MAX_LOAD_NUMERATOR 7 // Grow once full and deleted slots reach 7/8 of the capacity
+#define SWISS_TABLE_MAX_LOAD_DENOMINATOR 8
+
+typedef enum {
+    SWISS_UPSERT,
+    SWISS_DELETE,
+    SWISS_FIND
+} swiss_table_operation_type_t;
+
+#pragma endregion
+
+
+#pragma region Private Function Declarations
+static inline uint32_t _group_match(const int8_t *group_ctrl, int8_t tag);
+static inline uint32_t _group_match_free(const int8_t *group_ctrl);
+static inline int8_t _hash_tag(uint32_t key_hash);
+static inline unsigned int _home_group(const swiss_table *table_ptr, uint32_t key_hash);
+static bool _find_slot(const swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, unsigned int *slot_index_out);
+static unsigned int _find_free_slot(const int8_t *ctrl, unsigned int capacity, uint32_t key_hash);
+static int _allocate_table_arrays(unsigned int capacity, int8_t **ctrl_out, swiss_table_slot **slots_out);
+static int _rehash(swiss_table *table_ptr, unsigned int new_capacity);
+static int _insert_data_node(swiss_table *table_ptr, data_node *new_data_node);
+static int _lock(swiss_table *table_ptr, bool is_exclusive);
+static int _begin_node_read(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node **data_node_out);
+static void _end_node_read(swiss_table *table_ptr, data_node *data_node_ptr);
+static int _upsert_data_node(swiss_table *table_ptr, data_node *new_data_node, key_store_value *new_value, data_node **released_node_out);
+static void _release_data_node(swiss_table *table_ptr, data_node *new_data_node, data_node *released_node_ptr);
+static void _prefetch_home_groups(const swiss_table *table_ptr, const key_store_prepared_key *keys, size_t key_count);
+static int _first_batch_error(const int *results, size_t count);
+static void _unlock(swiss_table *table_ptr);
+static int _operation_counter_increment(swiss_table *table_ptr, swiss_table_operation_type_t operation_type, int operation_result);
+#pragma endregion
+
+
+#pragma region Public Function Definitions
+
+int initialise_swiss_table(swiss_table *table_ptr, unsigned int capacity, bool is_concurrency_enabled, memory_manager *memory_manager_ptr)
+{
+    if (table_ptr == NULL) return -20; // Error handling: invalid input
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) return -21; // Error handling: capacity must be a power of two
+
+    if (table_ptr->is_initialized) return 0; // Already initialized
+
+    if (capacity < SWISS_TABLE_GROUP_SIZE) capacity = SWISS_TABLE_GROUP_SIZE;
+
+    int result = _allocate_table_arrays(capacity, &table_ptr->ctrl, &table_ptr->slots);
+    if (result != 0) return result; // Error handling: memory allocation failed
+
+    if (is_concurrency_enabled && pthread_rwlock_init(&table_ptr->lock, NULL) != 0) {
+        free(table_ptr->ctrl);
+        free(table_ptr->slots);
+        *table_ptr = (swiss_table){0};
+        return -11; // Error handling: lock initialization failed
+    }
+
+    table_ptr->capacity = capacity;
+    table_ptr->size = 0;
+    table_ptr->deleted_count = 0;
+    table_ptr->is_concurrency_enabled = is_concurrency_enabled;
+    table_ptr->node_sync_mode = is_concurrency_enabled ? DATA_NODE_SYNC_MUTEX : DATA_NODE_SYNC_NONE;
+    table_ptr->memory_manager_ptr = memory_manager_ptr;
+    table_ptr->is_initialized = true;
+    return 0;
+}
+
+int configure_swiss_table_inline_values(swiss_table *table_ptr, unsigned int inline_value_threshold)
+{
+    if (table_ptr == NULL) return -20; // Error handling: invalid input
+    if (inline_value_threshold > DATA_NODE_MAX_INLINE_VALUE_SIZE) return -21; // Error handling: threshold too large
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+
+    table_ptr->inline_value_threshold = inline_value_threshold;
+    return 0;
+}
+
+int configure_swiss_table_node_sync(swiss_table *table_ptr, data_node_sync_t sync_mode)
+{
+    if (table_ptr == NULL) return -20; // Error handling: invalid input
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+    if (sync_mode != DATA_NODE_SYNC_NONE && sync_mode != DATA_NODE_SYNC_MUTEX && sync_mode != DATA_NODE_SYNC_SEQLOCK) return -21; // Error handling: unknown mode
+    if ((sync_mode != DATA_NODE_SYNC_NONE) != table_ptr->is_concurrency_enabled) return -21; // Error handling: concurrent tables need synchronized nodes and vice versa
+
+    table_ptr->node_sync_mode = sync_mode;
+    return 0;
+}
+
+int configure_swiss_table_latency_histograms(swiss_table *table_ptr, sharded_latency_histograms *histograms_ptr)
+{
+    if (table_ptr == NULL) return -20; // Error handling: invalid input
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+
+    table_ptr->latency_histograms_ptr = histograms_ptr;
+    return 0;
+}
+
+int cleanup_swiss_table(swiss_table *table_ptr)
+{
+    if (table_ptr == NULL || !table_ptr->is_initialized) return 0; // Nothing to clean up
+
+    for (unsigned int i = 0; i < table_ptr->capacity; ++i) {
+        if (table_ptr->ctrl[i] >= 0) delete_data_node(&table_ptr->data_node_counters, table_ptr->slots[i].data);
+    }
+
+    free(table_ptr->ctrl);
+    free(table_ptr->slots);
+    if (table_ptr->is_concurrency_enabled) pthread_rwlock_destroy(&table_ptr->lock);
+    *table_ptr = (swiss_table){0};
+    return 0;
+}
+
+int upsert_node_to_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* new_value)
+{
+    if (table_ptr == NULL || key == NULL || new_value == NULL) return -20; // Error handling: invalid input
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+
+    // Create the data node speculatively, outside the lock; it is discarded if the key already exists
+    data_node *new_data_node = NULL;
+    int result = create_data_node(&table_ptr->data_node_counters, table_ptr->memory_manager_ptr, key, key_len, key_hash, new_value, table_ptr->node_sync_mode, table_ptr->inline_value_threshold, &new_data_node);
+    if (result != 0) return result; // Error handling: invalid value or memory allocation failure
+
+    if (_lock(table_ptr, true) != 0) {
+        delete_data_node(&table_ptr->data_node_counters, new_data_node);
+        return _operation_counter_increment(table_ptr, SWISS_UPSERT, -30); // Handle error: failed to acquire lock
+    }
+
+    data_node *released_node_ptr = NULL;
+    result = _upsert_data_node(table_ptr, new_data_node, new_value, &released_node_ptr);
+
+    _unlock(table_ptr);
+
+    _release_data_node(table_ptr, new_data_node, released_node_ptr);
+    return _operation_counter_increment(table_ptr, SWISS_UPSERT, result);
+}
+
+int find_node_in_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* value_out)
+{
+    if (table_ptr == NULL || key == NULL || value_out == NULL) return -20; // Error handling: invalid input
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+
+    data_node *data_node_ptr = NULL;
+    int result = _begin_node_read(table_ptr, key, key_len, key_hash, &data_node_ptr);
+    if (result != 0) return _operation_counter_increment(table_ptr, SWISS_FIND, result);
+
+    result = data_node_lock_wrapper(&table_ptr->data_node_counters, DATA_NODE_READ, data_node_ptr, value_out);
+    _end_node_read(table_ptr, data_node_ptr);
+
+    return _operation_counter_increment(table_ptr, SWISS_FIND, result);
+}
+
+int find_nodes_in_swiss_table_batch(swiss_table *table_ptr, const key_store_prepared_key *keys, size_t key_count, key_store_value *values_out, int *results_out)
+{
+    if (table_ptr == NULL || keys == NULL || values_out == NULL || results_out == NULL || key_count > KEY_STORE_BATCH_GROUP_SIZE) return -20; // Error handling: invalid input
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+
+    if (_lock(table_ptr, false) != 0) {
+        for (size_t i = 0; i < key_count; ++i) results_out[i] = _operation_counter_increment(table_ptr, SWISS_FIND, -30);
+        return -30; // Handle error: failed to acquire lock
+    }
+
+    // One table lock for the whole batch; the home groups of all keys are loaded before the first probe
+    _prefetch_home_groups(table_ptr, keys, key_count);
+
+    data_node *data_nodes[KEY_STORE_BATCH_GROUP_SIZE];
+    for (size_t i = 0; i < key_count; ++i) {
+        unsigned int slot_index = 0;
+        data_nodes[i] = NULL;
+        if (keys[i].key == NULL || !_find_slot(table_ptr, keys[i].key, keys[i].key_len, keys[i].key_hash, &slot_index)) continue;
+
+        data_nodes[i] = table_ptr->slots[slot_index].data;
+        if (table_ptr->is_concurrency_enabled) pin_data_node(data_nodes[i]);
+        __builtin_prefetch(data_nodes[i]->data);
+    }
+
+    _unlock(table_ptr);
+
+    for (size_t i = 0; i < key_count; ++i) {
+        if (data_nodes[i] == NULL) {
+            results_out[i] = _operation_counter_increment(table_ptr, SWISS_FIND, (keys[i].key == NULL) ? -20 : -41);
+            continue;
+        }
+
+        results_out[i] = _operation_counter_increment(table_ptr, SWISS_FIND, data_node_lock_wrapper(&table_ptr->data_node_counters, DATA_NODE_READ, data_nodes[i], &values_out[i]));
+        _end_node_read(table_ptr, data_nodes[i]);
+    }
+
+    return _first_batch_error(results_out, key_count);
+}
+
+int upsert_nodes_to_swiss_table_batch(swiss_table *table_ptr, const key_store_prepared_key *keys, size_t key_count, key_store_value *values, int *results_out)
+{
+    if (table_ptr == NULL || keys == NULL || values == NULL || results_out == NULL || key_count > KEY_STORE_BATCH_GROUP_SIZE) return -20; // Error handling: invalid input
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+
+    // Create the data nodes speculatively, outside the lock, as upsert_node_to_swiss_table does
+    data_node *new_data_nodes[KEY_STORE_BATCH_GROUP_SIZE];
+    data_node *released_nodes[KEY_STORE_BATCH_GROUP_SIZE];
+    for (size_t i = 0; i < key_count; ++i) {
+        new_data_nodes[i] = NULL;
+        released_nodes[i] = NULL;
+        results_out[i] = create_data_node(&table_ptr->data_node_counters, table_ptr->memory_manager_ptr, keys[i].key, keys[i].key_len, keys[i].key_hash, &values[i], table_ptr->node_sync_mode, table_ptr->inline_value_threshold, &new_data_nodes[i]);
+    }
+
+    int lock_result = _lock(table_ptr, true);
+    if (lock_result == 0) {
+        _prefetch_home_groups(table_ptr, keys, key_count);
+        for (size_t i = 0; i < key_count; ++i) {
+            if (results_out[i] == 0) results_out[i] = _upsert_data_node(table_ptr, new_data_nodes[i], &values[i], &released_nodes[i]);
+        }
+        _unlock(table_ptr);
+    }
+
+    for (size_t i = 0; i < key_count; ++i) {
+        if (new_data_nodes[i] == NULL) continue; // Creation failed, already counted by the data node
+
+        if (lock_result != 0) results_out[i] = -30; // Handle error: failed to acquire lock
+        _release_data_node(table_ptr, new_data_nodes[i], (lock_result != 0) ? new_data_nodes[i] : released_nodes[i]);
+        results_out[i] = _operation_counter_increment(table_ptr, SWISS_UPSERT, results_out[i]);
+    }
+
+    return _first_batch_error(results_out, key_count);
+}
+
+int view_node_in_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_view_callback callback, void *context, uint32_t *version_out)
+{
+    if (table_ptr == NULL || key == NULL || callback == NULL) return -20; // Error handling: invalid input
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+
+    data_node *data_node_ptr = NULL;
+    int result = _begin_node_read(table_ptr, key, key_len, key_hash, &data_node_ptr);
+    _operation_counter_increment(table_ptr, SWISS_FIND, result); // The lookup is counted, not the callback's result
+    if (result != 0) return result;
+
+    result = data_node_view_wrapper(&table_ptr->data_node_counters, data_node_ptr, callback, context, version_out);
+    _end_node_read(table_ptr, data_node_ptr);
+    return result;
+}
+
+int update_node_in_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_update_callback callback, void *context)
+{
+    if (table_ptr == NULL || key == NULL || callback == NULL) return -20; // Error handling: invalid input
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+
+    if (_lock(table_ptr, true) != 0) return _operation_counter_increment(table_ptr, SWISS_UPSERT, -30); // Handle error: failed to acquire lock
+
+    // The callback sees the current value while no other writer can change it
+    unsigned int slot_index = 0;
+    data_node *data_node_ptr = _find_slot(table_ptr, key, key_len, key_hash, &slot_index) ? table_ptr->slots[slot_index].data : NULL;
+    key_store_value new_value = {0};
+    int result = (data_node_ptr != NULL) ? callback(data_node_ptr->data, data_node_ptr->data_size, data_node_ptr->version, &new_value, context) : callback(NULL, 0, 0, &new_value, context);
+    if (result == 0 && new_value.data != NULL && new_value.data_size == 0) result = -20; // Error handling: empty values cannot be stored
+
+    data_node *new_data_node = NULL;
+    data_node *released_node_ptr = NULL;
+    bool is_value_stored = (result == 0 && new_value.data != NULL); // Otherwise aborted, or the current value is kept
+    if (is_value_stored && data_node_ptr != NULL && can_update_data_node_in_place(data_node_ptr, new_value.data_size)) {
+        result = data_node_lock_wrapper(&table_ptr->data_node_counters, DATA_NODE_UPDATE, data_node_ptr, &new_value);
+    } else if (is_value_stored) {
+        // A missing key, or a seqlock node whose storage would change, gets a new data node
+        result = create_data_node(&table_ptr->data_node_counters, table_ptr->memory_manager_ptr, key, key_len, key_hash, &new_value, table_ptr->node_sync_mode, table_ptr->inline_value_threshold, &new_data_node);
+        if (result == 0) result = _upsert_data_node(table_ptr, new_data_node, &new_value, &released_node_ptr);
+    }
+
+    _unlock(table_ptr);
+
+    if (new_data_node != NULL) _release_data_node(table_ptr, new_data_node, released_node_ptr);
+    return _operation_counter_increment(table_ptr, SWISS_UPSERT, result);
+}
+
+int delete_node_from_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash)
+{
+    if (table_ptr == NULL || key == NULL) return -20; // Error handling: invalid input
+    if (!table_ptr->is_initialized) return -40; // Error handling: table not initialized
+
+    if (_lock(table_ptr, true) != 0) return _operation_counter_increment(table_ptr, SWISS_DELETE, -30); // Handle error: failed to acquire lock
+
+    unsigned int slot_index = 0;
+    data_node *data_node_ptr = NULL;
+    if (_find_slot(table_ptr, key, key_len, key_hash, &slot_index))
+    {
+        data_node_ptr = table_ptr->slots[slot_index].data;
+        table_ptr->slots[slot_index].data = NULL;
+
+        // A slot can only become empty again if its group still has an empty slot: no probe sequence continues past such a group
+        const int8_t *group_ctrl = &table_ptr->ctrl[slot_index & ~(SWISS_TABLE_GROUP_SIZE - 1)];
+        if (_group_match(group_ctrl, SWISS_TABLE_CTRL_EMPTY) != 0) {
+            table_ptr->ctrl[slot_index] = SWISS_TABLE_CTRL_EMPTY;
+        } else {
+            table_ptr->ctrl[slot_index] = SWISS_TABLE_CTRL_DELETED;
+            table_ptr->deleted_count++;
+        }
+        table_ptr->size--;
+    }
+
+    _unlock(table_ptr);
+
+    if (data_node_ptr == NULL) return _operation_counter_increment(table_ptr, SWISS_DELETE, -41);
+
+    unpin_data_node(&table_ptr->data_node_counters, data_node_ptr); // Drop the table's reference, pinned readers keep the node alive until they are done
+    return _operation_counter_increment(table_ptr, SWISS_DELETE, 0);
+}
+
+void get_swiss_table_stats(swiss_table *table_ptr, keystore_stats* stats_out)
+{
+    if (table_ptr == NULL || stats_out == NULL || !table_ptr->is_initialized) return;
+
+    if (_lock(table_ptr, false) != 0) return;
+
+    unsigned int group_count = table_ptr->capacity / SWISS_TABLE_GROUP_SIZE;
+    unsigned int keys_per_group_histogram[SWISS_TABLE_GROUP_SIZE + 1] = {0};
+    key_entry_stats entry_stats = {0};
+    key_collision_stats collision_stats = {0};
+    unsigned int min_keys_in_group = UINT32_MAX;
+    double sum_probe_length = 0.0;
+
+    for (unsigned int group_index = 0; group_index < group_count; ++group_index)
+    {
+        unsigned int keys_in_group = 0;
+        for (unsigned int i = 0; i < SWISS_TABLE_GROUP_SIZE; ++i)
+        {
+            unsigned int slot_index = group_index * SWISS_TABLE_GROUP_SIZE + i;
+            if (table_ptr->ctrl[slot_index] < 0) continue;
+            keys_in_group++;
+
+            // Replay the probe sequence to find how many groups were skipped to reach this slot
+            unsigned int probe_group = _home_group(table_ptr, table_ptr->slots[slot_index].key_hash);
+            unsigned int probe_length = 0;
+            while (probe_group != group_index) {
+                probe_length++;
+                probe_group = (probe_group + probe_length) & (group_count - 1);
+            }
+
+            if (probe_length > 0) {
+                collision_stats.collision_buckets++;
+                sum_probe_length += probe_length;
+                if (probe_length > collision_stats.highest_collision_in_bucket) collision_stats.highest_collision_in_bucket = probe_length;
+            }
+        }
+
+        keys_per_group_histogram[keys_in_group]++;
+        if (keys_in_group > 0) {
+            entry_stats.nonempty_buckets++;
+            entry_stats.total_keys += keys_in_group;
+            if (keys_in_group > entry_stats.max_keys_in_bucket) entry_stats.max_keys_in_bucket = keys_in_group;
+            if (keys_in_group < min_keys_in_group) min_keys_in_group = keys_in_group;
+        }
+    }
+
+    entry_stats.total_buckets = group_count;
+    entry_stats.empty_buckets = group_count - entry_stats.nonempty_buckets;
+    entry_stats.min_keys_in_bucket = (min_keys_in_group == UINT32_MAX) ? 0 : min_keys_in_group;
+    entry_stats.avg_keys_per_nonempty_bucket = (entry_stats.nonempty_buckets > 0) ? ((double)entry_stats.total_keys / entry_stats.nonempty_buckets) : 0.0;
+    entry_stats.empty_bucket_percent = ((double)entry_stats.empty_buckets / group_count) * 100.0;
+
+    // Median and standard deviation of keys per group, from the histogram
+    double mean_keys = (double)entry_stats.total_keys / group_count;
+    double sum_squared_diff = 0.0;
+    unsigned int seen_groups = 0;
+    bool is_median_set = false;
+    for (unsigned int keys = 0; keys <= SWISS_TABLE_GROUP_SIZE; ++keys) {
+        sum_squared_diff += keys_per_group_histogram[keys] * (keys - mean_keys) * (keys - mean_keys);
+        seen_groups += keys_per_group_histogram[keys];
+        if (!is_median_set && seen_groups * 2 >= group_count) {
+            entry_stats.median_keys_per_bucket = keys;
+            is_median_set = true;
+        }
+    }
+    entry_stats.stddev_keys_per_bucket = sqrt(sum_squared_diff / group_count);
+
+    collision_stats.collision_percent = (entry_stats.total_keys > 0) ? ((double)collision_stats.collision_buckets / entry_stats.total_keys) * 100.0 : 0.0;
+    collision_stats.avg_collisions_per_nonempty_bucket = (collision_stats.collision_buckets > 0) ? (sum_probe_length / collision_stats.collision_buckets) : 0.0;
+    entry_stats.avg_collisions_per_nonempty_bucket = collision_stats.avg_collisions_per_nonempty_bucket;
+
+    memory_pool_stats memory_stats = {0};
+    size_t slot_bytes = sizeof(int8_t) + sizeof(swiss_table_slot);
+    memory_stats.total_memory_bytes = (size_t)table_ptr->capacity * slot_bytes;
+    memory_stats.used_memory_bytes = (size_t)table_ptr->size * slot_bytes;
+    memory_stats.free_memory_bytes = memory_stats.total_memory_bytes - memory_stats.used_memory_bytes;
+    memory_stats.memory_utilization_percent = ((double)memory_stats.used_memory_bytes / memory_stats.total_memory_bytes) * 100.0;
+    memory_stats.memory_per_key_bytes = (table_ptr->size > 0) ? (memory_stats.total_memory_bytes / table_ptr->size) : 0;
+    memory_stats.fragmentation_percent = ((double)table_ptr->deleted_count / table_ptr->capacity) * 100.0;
+
+    memory_pool_usage node_usage = {0};
+    if (get_memory_manager_usage(table_ptr->memory_manager_ptr, &node_usage) == 0) {
+        memory_stats.total_memory_bytes += node_usage.total_bytes;
+        memory_stats.used_memory_bytes += node_usage.used_bytes;
+        memory_stats.free_memory_bytes = memory_stats.total_memory_bytes - memory_stats.used_memory_bytes;
+        memory_stats.memory_utilization_percent = ((double)memory_stats.used_memory_bytes / memory_stats.total_memory_bytes) * 100.0;
+        memcpy(memory_stats.slab_classes, node_usage.slab_classes, sizeof(memory_stats.slab_classes));
+    }
+
+    stats_out->key_entries = entry_stats;
+    stats_out->collisions = collision_stats;
+    stats_out->memory_pool = memory_stats;
+    sum_bucket_operation_counters(&table_ptr->operation_counters, &stats_out->operation_counters);
+    sum_data_node_operation_counters(&table_ptr->data_node_counters, &stats_out->data_node_counters);
+
+    _unlock(table_ptr);
+}
+
+#pragma endregion
+
+
+#pragma region Private Function Definitions
+
+/**
+ * @fn _group_match
+ * @brief Returns a bit mask of the group's slots whose control byte equals tag.
+ */
+static inline uint32_t _group_match(const int8_t *group_ctrl, int8_t tag)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_load_si128((const __m128i *)group_ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#else
+    uint32_t match = 0;
+    for (unsigned int i = 0; i < SWISS_TABLE_GROUP_SIZE; ++i) {
+        if (group_ctrl[i] == tag) match |= 1u << i;
+    }
+    return match;
+#endif
+}
+
+/**
+ * @fn _group_match_free
+ * @brief Returns a bit mask of the group's empty or deleted slots (control bytes with the sign bit set).
+ */
+static inline uint32_t _group_match_free(const int8_t *group_ctrl)
+{
+#if defined(__SSE2__)
+    return (uint32_t)_mm_movemask_epi8(_mm_load_si128((const __m128i *)group_ctrl));
+#else
+    uint32_t match = 0;
+    for (unsigned int i = 0; i < SWISS_TABLE_GROUP_SIZE; ++i) {
+        if (group_ctrl[i] < 0) match |= 1u << i;
+    }
+    return match;
+#endif
+}
+
+static inline int8_t _hash_tag(uint32_t key_hash)
+{
+    return (int8_t)(key_hash & ((1u << SWISS_TABLE_TAG_BITS) - 1));
+}
+
+static inline unsigned int _home_group(const swiss_table *table_ptr, uint32_t key_hash)
+{
+    return (key_hash >> SWISS_TABLE_TAG_BITS) & (table_ptr->capacity / SWISS_TABLE_GROUP_SIZE - 1);
+}
+
+/**
+ * @fn _find_slot
+ * @brief Probes the table for a key.
+ *
+ * @param table_ptr Pointer to the table.
+ * @param key The key string.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key.
+ * @param slot_index_out Pointer to receive the slot index of the key.
+ * @return true if the key was found, false otherwise.
+ */
+static bool _find_slot(const swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, unsigned int *slot_index_out)
+{
+    unsigned int group_mask = table_ptr->capacity / SWISS_TABLE_GROUP_SIZE - 1;
+    unsigned int group_index = _home_group(table_ptr, key_hash);
+    int8_t tag = _hash_tag(key_hash);
+
+    for (unsigned int probe = 1; probe <= group_mask + 1; ++probe)
+    {
+        const int8_t *group_ctrl = &table_ptr->ctrl[group_index * SWISS_TABLE_GROUP_SIZE];
+
+        for (uint32_t match = _group_match(group_ctrl, tag); match != 0; match &= match - 1)
+        {
+            unsigned int slot_index = group_index * SWISS_TABLE_GROUP_SIZE + (unsigned int)__builtin_ctz(match);
+            const swiss_table_slot *slot_ptr = &table_ptr->slots[slot_index];
+            if (slot_ptr->key_hash == key_hash && slot_ptr->data->key_size == key_len && memcmp(slot_ptr->data->key, key, key_len) == 0) {
+                *slot_index_out = slot_index;
+                return true;
+            }
+        }
+
+        if (_group_match(group_ctrl, SWISS_TABLE_CTRL_EMPTY) != 0) return false; // The key would have been placed here
+
+        group_index = (group_index + probe) & group_mask;
+    }
+
+    return false;
+}
+
+/**
+ * @fn _find_free_slot
+ * @brief Returns the first empty or deleted slot on the probe sequence of a key hash.
+ *
+ * Takes the control bytes and capacity rather than the table, so that _rehash can fill new arrays
+ * before they are published in the table.
+ *
+ * @note The load factor bound guarantees that a free slot exists.
+ */
+static unsigned int _find_free_slot(const int8_t *ctrl, unsigned int capacity, uint32_t key_hash)
+{
+    unsigned int group_mask = capacity / SWISS_TABLE_GROUP_SIZE - 1;
+    unsigned int group_index = (key_hash >> SWISS_TABLE_TAG_BITS) & group_mask;
+
+    for (unsigned int probe = 1; ; ++probe)
+    {
+        uint32_t match = _group_match_free(&ctrl[group_index * SWISS_TABLE_GROUP_SIZE]);
+        if (match != 0) return group_index * SWISS_TABLE_GROUP_SIZE + (unsigned int)__builtin_ctz(match);
+
+        group_index = (group_index + probe) & group_mask;
+    }
+}
+
+/**
+ * @fn _allocate_table_arrays
+ * @brief Allocates the control bytes, all set to empty, and the slots of a table.
+ * @return 0 on success, -10 on allocation failure.
+ */
+static int _allocate_table_arrays(unsigned int capacity, int8_t **ctrl_out, swiss_table_slot **slots_out)
+{
+    int8_t *ctrl = aligned_alloc(SWISS_TABLE_GROUP_SIZE, capacity);
+    swiss_table_slot *slots = calloc(capacity, sizeof(swiss_table_slot));
+    if (ctrl == NULL || slots == NULL) {
+        free(ctrl);
+        free(slots);
+        return -10; // Error handling: memory allocation failed
+    }
+
+    memset(ctrl, SWISS_TABLE_CTRL_EMPTY, capacity);
+    *ctrl_out = ctrl;
+    *slots_out = slots;
+    return 0;
+}
+
+/**
+ * @fn _rehash
+ * @brief Moves every key into freshly allocated arrays of the given capacity, dropping all tombstones.
+ * @return 0 on success, -10 on allocation failure (the table is left unchanged).
+ * @note The caller must hold the table lock exclusively.
+ */
+static int _rehash(swiss_table *table_ptr, unsigned int new_capacity)
+{
+    int8_t *new_ctrl = NULL;
+    swiss_table_slot *new_slots = NULL;
+    int result = _allocate_table_arrays(new_capacity, &new_ctrl, &new_slots);
+    if (result != 0) return result;
+
+    for (unsigned int i = 0; i < table_ptr->capacity; ++i)
+    {
+        if (table_ptr->ctrl[i] < 0) continue;
+
+        unsigned int slot_index = _find_free_slot(new_ctrl, new_capacity, table_ptr->slots[i].key_hash);
+        new_ctrl[slot_index] = table_ptr->ctrl[i];
+        new_slots[slot_index] = table_ptr->slots[i];
+    }
+
+    free(table_ptr->ctrl);
+    free(table_ptr->slots);
+    table_ptr->ctrl = new_ctrl;
+    table_ptr->slots = new_slots;
+    table_ptr->capacity = new_capacity;
+    table_ptr->deleted_count = 0;
+    return 0;
+}
+
+/**
+ * @fn _upsert_data_node
+ * @brief Links a new data node for its key, or updates the key's existing data node.
+ *
+ * @param table_ptr Pointer to the swiss table.
+ * @param new_data_node The speculatively created data node holding the key and the new value.
+ * @param new_value The new value, copied into the existing data node if it can be updated in place.
+ * @param released_node_out Receives the data node the table no longer references: NULL if the key was
+ *        added, new_data_node if its value was copied, or the replaced data node.
+ * @return int Returns 0 on success, or a negative error code on failure (new_data_node is then released).
+ * @note The caller must hold the table lock exclusively and pass *released_node_out to _release_data_node after unlocking.
+ */
+static int _upsert_data_node(swiss_table *table_ptr, data_node *new_data_node, key_store_value *new_value, data_node **released_node_out)
+{
+    int result = 0;
+    unsigned int slot_index = 0;
+    data_node *released_node_ptr = new_data_node;
+    if (!_find_slot(table_ptr, new_data_node->key, new_data_node->key_size, new_data_node->key_hash, &slot_index))
+    {
+        result = _insert_data_node(table_ptr, new_data_node);
+        if (result == 0) released_node_ptr = NULL;
+    }
+    else if (can_update_data_node_in_place(table_ptr->slots[slot_index].data, new_value->data_size))
+    {
+        // Key exists, copy the new value into its data node
+        result = data_node_lock_wrapper(&table_ptr->data_node_counters, DATA_NODE_UPDATE, table_ptr->slots[slot_index].data, new_value);
+    }
+    else
+    {
+        // Seqlock readers may still copy from the node's value storage, publish the new node instead
+        released_node_ptr = table_ptr->slots[slot_index].data;
+        new_data_node->version = released_node_ptr->version + 1;
+        table_ptr->slots[slot_index].data = new_data_node;
+    }
+
+    *released_node_out = released_node_ptr;
+    return result;
+}
+
+/**
+ * @fn _release_data_node
+ * @brief Drops the data node an upsert released, after the table lock is released.
+ *
+ * An unused new data node is deleted. A replaced node loses the table's reference, pinned readers
+ * keep it alive until they are done.
+ */
+static void _release_data_node(swiss_table *table_ptr, data_node *new_data_node, data_node *released_node_ptr)
+{
+    if (released_node_ptr == new_data_node) delete_data_node(&table_ptr->data_node_counters, new_data_node);
+    else if (released_node_ptr != NULL) unpin_data_node(&table_ptr->data_node_counters, released_node_ptr);
+}
+
+/**
+ * @fn _prefetch_home_groups
+ * @brief Starts loading the control bytes and slots of each key's home group.
+ * @note The caller must hold the table lock, so the arrays cannot be swapped by a rehash.
+ */
+static void _prefetch_home_groups(const swiss_table *table_ptr, const key_store_prepared_key *keys, size_t key_count)
+{
+    for (size_t i = 0; i < key_count; ++i) {
+        unsigned int group_start = _home_group(table_ptr, keys[i].key_hash) * SWISS_TABLE_GROUP_SIZE;
+        __builtin_prefetch(&table_ptr->ctrl[group_start]);
+        __builtin_prefetch(&table_ptr->slots[group_start]);
+    }
+}
+
+/**
+ * @fn _first_batch_error
+ * @brief Returns the first non-zero result of a batch, or 0 if every key succeeded.
+ */
+static int _first_batch_error(const int *results, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (results[i] != 0) return results[i];
+    }
+    return 0;
+}
+
+/**
+ * @fn _begin_node_read
+ * @brief Finds a data node under the table read lock and pins it until _end_node_read.
+ *
+ * The pin keeps the node alive after the table lock is released, so a concurrent delete or
+ * replace cannot free it while it is read. Without concurrency nothing needs to be pinned.
+ *
+ * @param table_ptr Pointer to the swiss table.
+ * @param key The key of the node to find.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key.
+ * @param data_node_out Pointer to receive the pinned data node.
+ * @return int Returns 0 on success, -30 if the lock could not be taken or -41 if the key was not found.
+ */
+static int _begin_node_read(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, data_node **data_node_out)
+{
+    if (_lock(table_ptr, false) != 0) return -30; // Handle error: failed to acquire lock
+
+    unsigned int slot_index = 0;
+    data_node *data_node_ptr = NULL;
+    if (_find_slot(table_ptr, key, key_len, key_hash, &slot_index)) {
+        data_node_ptr = table_ptr->slots[slot_index].data;
+        if (table_ptr->is_concurrency_enabled) pin_data_node(data_node_ptr);
+    }
+
+    _unlock(table_ptr);
+
+    *data_node_out = data_node_ptr;
+    return (data_node_ptr != NULL) ? 0 : -41;
+}
+
+/**
+ * @fn _end_node_read
+ * @brief Releases the pin taken on a data node by _begin_node_read.
+ */
+static void _end_node_read(swiss_table *table_ptr, data_node *data_node_ptr)
+{
+    if (table_ptr->is_concurrency_enabled) unpin_data_node(&table_ptr->data_node_counters, data_node_ptr);
+}
+
+/**
+ * @fn _insert_data_node
+ * @brief Stores a data node whose key is not in the table yet, growing the table first if needed.
+ *
+ * Tombstones count towards the load factor because they lengthen probe sequences. When most of
+ * the load is tombstones, the table is rehashed at its current capacity instead of doubled.
+ *
+ * @return 0 on success, -10 if the table could not grow.
+ * @note The caller must hold the table lock exclusively.
+ */
+static int _insert_data_node(swiss_table *table_ptr, data_node *new_data_node)
+{
+    size_t max_load = (size_t)table_ptr->capacity * SWISS_TABLE_MAX_LOAD_NUMERATOR / SWISS_TABLE_MAX_LOAD_DENOMINATOR;
+    if ((size_t)table_ptr->size + table_ptr->deleted_count + 1 > max_load)
+    {
+        bool is_mostly_deleted = table_ptr->deleted_count > table_ptr->size;
+        int result = _rehash(table_ptr, is_mostly_deleted ? table_ptr->capacity : table_ptr->capacity * 2);
+        if (result != 0) return result; // Error handling: the table could not grow
+    }
+
+    unsigned int slot_index = _find_free_slot(table_ptr->ctrl, table_ptr->capacity, new_data_node->key_hash);
+    if (table_ptr->ctrl[slot_index] == SWISS_TABLE_CTRL_DELETED) table_ptr->deleted_count--;
+
+    table_ptr->ctrl[slot_index] = _hash_tag(new_data_node->key_hash);
+    table_ptr->slots[slot_index] = (swiss_table_slot){ new_data_node->key_hash, new_data_node };
+    table_ptr->size++;
+    return 0;
+}
+
+static int _lock(swiss_table *table_ptr, bool is_exclusive)
+{
+    if (!table_ptr->is_concurrency_enabled) return 0;
+    return lock_rwlock_recording_wait(&table_ptr->lock, is_exclusive, table_ptr->latency_histograms_ptr);
+}
+
+static void _unlock(swiss_table *table_ptr)
+{
+    if (table_ptr->is_concurrency_enabled) pthread_rwlock_unlock(&table_ptr->lock);
+}
+
+/**
+ * @fn _operation_counter_increment
+ * @brief Increments the operation counters based on the operation type and result.
+ * @return int The operation_result passed in.
+ */
+static int _operation_counter_increment(swiss_table *table_ptr, swiss_table_operation_type_t operation_type, int operation_result)
+{
+    if (!OPERATION_COUNTERS_ENABLED) return operation_result;
+    bucket_operation_counter_stats *counters_ptr = &table_ptr->operation_counters.shards[get_operation_counter_shard_index()].counters;
+
+    switch (operation_type)
+    {
+        case SWISS_UPSERT:
+            OPERATION_COUNTER_ADD(counters_ptr->total_add_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(counters_ptr->failed_add_ops, 1);
+            break;
+        case SWISS_DELETE:
+            OPERATION_COUNTER_ADD(counters_ptr->total_delete_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(counters_ptr->failed_delete_ops, 1);
+            break;
+        case SWISS_FIND:
+            OPERATION_COUNTER_ADD(counters_ptr->total_find_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(counters_ptr->failed_find_ops, 1);
+            break;
+        default:
+            break;
+    }
+
+    if (operation_result < 0 && operation_result > -100) {
+        OPERATION_COUNTER_ADD(counters_ptr->error_code_counters[-operation_result], 1);
+    }
+
+    return operation_result;
+}
+
+#pragma endregion
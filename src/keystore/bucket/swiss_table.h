@@ -0,0 +1,208 @@
+#ifndef SWISS_TABLE_H
+#define SWISS_TABLE_H
+
+#include "core/type_definition.h"
+#include <stdbool.h>
+
+/**
+ * @file swiss_table.h
+ * @brief Open-addressing table engine with SIMD-probed control bytes (Swiss-table layout).
+ *
+ * The table is split into groups of SWISS_TABLE_GROUP_SIZE slots. Each slot has a control byte
+ * holding a 7-bit tag of the key hash (or an empty/deleted marker), and stores the full key hash
+ * and data node pointer inline. A lookup compares the tag against all control bytes of a group
+ * with one SSE2 compare and only touches the slots whose tag matches, so a miss usually costs a
+ * single cache line and a hit one more, instead of walking bucket, list and data node pointers.
+ *
+ * The table doubles once it is 7/8 full (counting deleted slots) and never shrinks.
+ *
+ * @note Thread safety uses a single table-level read-write lock: lookups run in parallel, while
+ *       inserts and deletes are exclusive. Values are read through pinned data nodes, so the
+ *       lock is not held while they are copied.
+ */
+
+#define SWISS_TABLE_GROUP_SIZE 16 // Slots probed per SIMD compare
+
+typedef struct
+{
+    uint32_t key_hash; // Full hash, compared before the key string
+    data_node *data; // Owning reference to the stored data node
+} swiss_table_slot;
+
+/**
+ * @struct swiss_table
+ * @brief The table of one key store instance using the swiss engine.
+ */
+typedef struct swiss_table
+{
+    int8_t *ctrl; // One control byte per slot, aligned to SWISS_TABLE_GROUP_SIZE
+    swiss_table_slot *slots;
+    unsigned int capacity; // Number of slots, a power of two and a multiple of SWISS_TABLE_GROUP_SIZE
+    unsigned int size; // Number of full slots
+    unsigned int deleted_count; // Number of tombstones
+    pthread_rwlock_t lock; // Shared for lookups, exclusive for inserts, deletes and growth
+    sharded_bucket_operation_counters operation_counters; // Table operation counters
+    sharded_data_node_operation_counters data_node_counters; // Data node operation counters of this table
+    sharded_latency_histograms *latency_histograms_ptr; // Table lock waits are recorded here (NULL skips timing)
+    memory_manager *memory_manager_ptr; // Slab the data nodes are allocated from (NULL uses the heap)
+    unsigned int inline_value_threshold; // Values of at most this many bytes are stored inside new data nodes (0 disables)
+    data_node_sync_t node_sync_mode; // Synchronization of new data nodes, DATA_NODE_SYNC_SEQLOCK nodes are replaced when their storage must change
+    bool is_initialized;
+    bool is_concurrency_enabled;
+} swiss_table;
+
+/**
+ * @fn initialise_swiss_table
+ * @brief Initializes the table with the specified capacity.
+ * @param table_ptr Pointer to the zero-initialized or cleaned up table.
+ * @param capacity Initial number of slots, must be a power of two (raised to SWISS_TABLE_GROUP_SIZE if smaller).
+ * @param is_concurrency_enabled Flag to enable or disable concurrency control.
+ * @param memory_manager_ptr Pointer to the memory manager whose slab holds the data nodes, NULL uses the heap.
+ * @return 0 on success, -20 if table_ptr is NULL, -21 if capacity is not a power of two, -10 on allocation failure, -11 on lock init failure.
+ */
+int initialise_swiss_table(swiss_table *table_ptr, unsigned int capacity, bool is_concurrency_enabled, memory_manager *memory_manager_ptr);
+
+/**
+ * @fn configure_swiss_table_inline_values
+ * @brief Configures the largest value that new data nodes store inline, right after their key.
+ * @param table_ptr Pointer to the table.
+ * @param inline_value_threshold Largest inline value in bytes (0 disables inline values).
+ * @return 0 on success, -20 if table_ptr is NULL, -21 if the threshold exceeds DATA_NODE_MAX_INLINE_VALUE_SIZE, -40 if the table is not initialized.
+ */
+int configure_swiss_table_inline_values(swiss_table *table_ptr, unsigned int inline_value_threshold);
+
+/**
+ * @fn configure_swiss_table_node_sync
+ * @brief Configures how reads of new data nodes are synchronized with in-place updates.
+ * @param table_ptr Pointer to the swiss table.
+ * @param sync_mode DATA_NODE_SYNC_NONE without concurrency, else DATA_NODE_SYNC_MUTEX or DATA_NODE_SYNC_SEQLOCK.
+ * @return 0 on success, -21 if the mode does not match the concurrency setting, -40 if the table is not initialized.
+ * @note Concurrent tables use DATA_NODE_SYNC_MUTEX until this function is called. With DATA_NODE_SYNC_SEQLOCK,
+ *       an update whose value cannot be written in place replaces the data node instead.
+ */
+int configure_swiss_table_node_sync(swiss_table *table_ptr, data_node_sync_t sync_mode);
+
+/**
+ * @fn configure_swiss_table_latency_histograms
+ * @brief Configures the histograms that table lock waits are recorded in.
+ * @param table_ptr Pointer to the swiss table.
+ * @param histograms_ptr Histograms of the owning key store instance, or NULL to stop timing lock waits.
+ * @return 0 on success, -20 if table_ptr is NULL, -40 if the table is not initialized.
+ */
+int configure_swiss_table_latency_histograms(swiss_table *table_ptr, sharded_latency_histograms *histograms_ptr);
+
+/**
+ * @fn cleanup_swiss_table
+ * @brief Deletes every stored data node and releases the table.
+ * @param table_ptr Pointer to the table.
+ * @return 0 on success.
+ */
+int cleanup_swiss_table(swiss_table *table_ptr);
+
+/**
+ * @fn upsert_node_to_swiss_table
+ * @brief Inserts a key with its value, or updates the value of an existing key.
+ * @param table_ptr Pointer to the table.
+ * @param key The key string.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key.
+ * @param new_value Pointer to the value to store.
+ * @return 0 on success, -20 on invalid input, -40 if the table is not initialized, or a negative error code on failure.
+ */
+int upsert_node_to_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* new_value);
+
+/**
+ * @fn find_node_in_swiss_table
+ * @brief Finds a key and copies its value.
+ * @param table_ptr Pointer to the table.
+ * @param key The key string.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key.
+ * @param value_out Pointer to receive a copy of the value; the caller frees value_out->data.
+ * @return 0 on success, -41 if the key was not found, or a negative error code on failure.
+ */
+int find_node_in_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* value_out);
+
+/**
+ * @fn view_node_in_swiss_table
+ * @brief Runs a callback on the value of a data node in the table, without copying it.
+ * @param table_ptr Pointer to the swiss table.
+ * @param key Key to search for.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash Hash value of the key.
+ * @param callback Function receiving the stored value bytes, see data_node_view_wrapper.
+ * @param context Caller context passed to the callback.
+ * @param version_out Receives the version of the value the callback saw, or NULL.
+ * @return The callback's result, -41 if the key was not found, or another negative code on error.
+ * @note The node stays pinned until the callback returns.
+ */
+int view_node_in_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_view_callback callback, void *context, uint32_t *version_out);
+
+/**
+ * @fn find_nodes_in_swiss_table_batch
+ * @brief Finds a batch of keys and copies their values under a single acquisition of the table lock.
+ *
+ * The home groups of all keys are prefetched before the first probe, and each found value is
+ * prefetched before the first one is copied.
+ *
+ * @param table_ptr Pointer to the swiss table.
+ * @param keys The keys with their hashes.
+ * @param key_count Number of keys, at most KEY_STORE_BATCH_GROUP_SIZE.
+ * @param values_out Receives a copy of each found value; the caller frees their data.
+ * @param results_out Receives the result of each key, as find_node_in_swiss_table would return it.
+ * @return 0 if every key was found, the first non-zero result otherwise, or -20/-40 on invalid input or an uninitialized table.
+ */
+int find_nodes_in_swiss_table_batch(swiss_table *table_ptr, const key_store_prepared_key *keys, size_t key_count, key_store_value *values_out, int *results_out);
+
+/**
+ * @fn upsert_nodes_to_swiss_table_batch
+ * @brief Sets or updates a batch of keys under a single acquisition of the table lock.
+ * @param table_ptr Pointer to the swiss table.
+ * @param keys The keys with their hashes.
+ * @param key_count Number of keys, at most KEY_STORE_BATCH_GROUP_SIZE.
+ * @param values The value of each key.
+ * @param results_out Receives the result of each key, as upsert_node_to_swiss_table would return it.
+ * @return 0 if every key was stored, the first non-zero result otherwise, or -20/-40 on invalid input or an uninitialized table.
+ * @note A key that appears more than once in the batch ends up with its last value.
+ */
+int upsert_nodes_to_swiss_table_batch(swiss_table *table_ptr, const key_store_prepared_key *keys, size_t key_count, key_store_value *values, int *results_out);
+
+/**
+ * @fn update_node_in_swiss_table
+ * @brief Replaces the value of a key with the value a callback computes from the current one (see update_node_in_bucket).
+ * @param table_ptr Pointer to the swiss table.
+ * @param key The key to update.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key.
+ * @param callback Function receiving the current value and its version, see key_store_update_callback.
+ * @param context Caller context passed to the callback.
+ * @return 0 on success, the callback's non-zero result, -40 if the table is not initialized, or another negative code on error.
+ * @note The callback runs under the exclusive table lock.
+ */
+int update_node_in_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_update_callback callback, void *context);
+
+/**
+ * @fn delete_node_from_swiss_table
+ * @brief Deletes a key and releases its data node.
+ * @param table_ptr Pointer to the table.
+ * @param key The key string.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash The hash value of the key.
+ * @return 0 on success, -41 if the key was not found, or a negative error code on failure.
+ */
+int delete_node_from_swiss_table(swiss_table *table_ptr, const char *key, size_t key_len, uint32_t key_hash);
+
+/**
+ * @fn get_swiss_table_stats
+ * @brief Fills the keystore statistics for the table.
+ *
+ * A group of SWISS_TABLE_GROUP_SIZE slots is reported as a bucket. A key stored outside its
+ * home group counts as a collision, and highest_collision_in_bucket is the longest probe
+ * sequence in groups. The memory figures include the slab of the table's memory manager.
+ *
+ * @param table_ptr Pointer to the table.
+ * @param stats_out Pointer to the keystore_stats structure to fill.
+ */
+void get_swiss_table_stats(swiss_table *table_ptr, keystore_stats* stats_out);
+
+#endif // SWISS_TABLE_H
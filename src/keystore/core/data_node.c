@@ -1,124 +1,171 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <sched.h>
 #include "data_node.h"
 #include "core/type_definition.h"
+#include "core/operation_counters.h"
 #include "utils/memory_manager.h"
 
 #pragma region Private Function Declarations
-int _allocate_and_init_data_node(size_t key_len, bool is_concurrency_enabled, data_node** data_node_ptr);
+int _allocate_and_init_data_node(memory_manager *memory_manager_ptr, size_t key_len, size_t inline_value_capacity, data_node_sync_t sync_mode, data_node** data_node_ptr);
+static inline unsigned char* _get_inline_value(const data_node *node_ptr);
+static inline size_t _get_mutex_offset(size_t key_len, size_t inline_value_capacity);
+static inline size_t _get_data_node_block_size(size_t key_len, size_t inline_value_capacity, data_node_sync_t sync_mode);
+static inline pthread_mutex_t* _get_node_mutex(data_node *node_ptr);
+static int _run_data_node_operation(sharded_data_node_operation_counters *counters_ptr, data_node_operation_type_t operation_type, data_node *node_ptr, key_store_value *value);
+static int _read_data_node_optimistic(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr, key_store_value *value_out);
+static int _update_data_node_sequenced(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr, key_store_value *new_value);
+static int _view_data_node_optimistic(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr, key_store_view_callback callback, void *context, uint32_t *version_out);
+static data_node_operation_counters* _get_counter_shard(sharded_data_node_operation_counters *counters_ptr);
 int _add_data_to_node(data_node *node_ptr, key_store_value* value);
 int _add_key_to_node(data_node *node_ptr, const char *key, size_t key_len, uint32_t key_hash);
 int _update_data_node(data_node *node_ptr, key_store_value* new_value);
-int _operate_data_node_counters(data_node_operation_type_t operation_type, int operation_result);
+int _operate_data_node_counters(sharded_data_node_operation_counters *counters_ptr, data_node_operation_type_t operation_type, int operation_result);
 
 #pragma endregion
 
-#pragma region global Variables
-data_node_operation_counters g_data_node_operation_counters = {0};
-#pragma endregion
-
 #pragma region Public Function Definitions
 
-int create_data_node(const char *key, uint32_t key_hash, key_store_value* value, bool is_concurrency_enabled, data_node** data_node_ptr) 
+int create_data_node(sharded_data_node_operation_counters *counters_ptr, memory_manager *memory_manager_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* value, data_node_sync_t sync_mode, unsigned int inline_value_threshold, data_node** data_node_ptr) 
 {
     // Argument validation
-    if (key == NULL || key[0] == '\0' || value == NULL || value->data == NULL || value->data_size == 0) return _operate_data_node_counters(DATA_NODE_CREATE, -20); // Handle invalid input
+    if (key == NULL || key_len == 0 || key_len >= UINT32_MAX || value == NULL || value->data == NULL || value->data_size == 0) return _operate_data_node_counters(counters_ptr, DATA_NODE_CREATE, -20); // Handle invalid input
 
     // Allocation and initialisation
-    size_t key_len = strlen(key) + 1;
+    // The whole threshold is reserved, so later values up to the threshold stay inline whatever the size of the first one
+    size_t inline_value_capacity = (inline_value_threshold < DATA_NODE_MAX_INLINE_VALUE_SIZE) ? inline_value_threshold : DATA_NODE_MAX_INLINE_VALUE_SIZE;
     data_node* node = NULL;
-    int alloc_result = _allocate_and_init_data_node(key_len, is_concurrency_enabled, &node);
-    if (alloc_result != 0) return _operate_data_node_counters(DATA_NODE_CREATE, alloc_result);
+    int alloc_result = _allocate_and_init_data_node(memory_manager_ptr, key_len, inline_value_capacity, sync_mode, &node);
+    if (alloc_result != 0) return _operate_data_node_counters(counters_ptr, DATA_NODE_CREATE, alloc_result);
 
     // Add key to node
     if(_add_key_to_node(node, key, key_len, key_hash) != 0) {
-       delete_data_node(node);
-       return _operate_data_node_counters(DATA_NODE_CREATE, -48);
+       delete_data_node(counters_ptr, node);
+       return _operate_data_node_counters(counters_ptr, DATA_NODE_CREATE, -48);
     }
 
     // Add data to node
     if (_add_data_to_node(node, value) != 0) {
-       delete_data_node(node);
-       return _operate_data_node_counters(DATA_NODE_CREATE, -48);
+       delete_data_node(counters_ptr, node);
+       return _operate_data_node_counters(counters_ptr, DATA_NODE_CREATE, -48);
     }
     
     *data_node_ptr  = node;
-    return _operate_data_node_counters(DATA_NODE_CREATE, 0);
+    return _operate_data_node_counters(counters_ptr, DATA_NODE_CREATE, 0);
 }
 
 
-int update_data_node(data_node *node_ptr, key_store_value* new_value) {
+int update_data_node(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr, key_store_value* new_value) {
 
-    if (node_ptr == NULL || new_value == NULL || new_value->data == NULL) return _operate_data_node_counters(DATA_NODE_UPDATE, -20); // Handle null pointer
+    if (node_ptr == NULL || new_value == NULL || new_value->data == NULL) return _operate_data_node_counters(counters_ptr, DATA_NODE_UPDATE, -20); // Handle null pointer
     int result = _update_data_node(node_ptr, new_value);
-    return _operate_data_node_counters(DATA_NODE_UPDATE, result);
+    return _operate_data_node_counters(counters_ptr, DATA_NODE_UPDATE, result);
 }
 
-int delete_data_node(data_node *node_ptr) {
+int delete_data_node(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr) {
 
     int result = 0;
-    if (node_ptr == NULL) return _operate_data_node_counters(DATA_NODE_DELETE, -20); // Handle null pointer, nothing to delete
+    if (node_ptr == NULL) return _operate_data_node_counters(counters_ptr, DATA_NODE_DELETE, -20); // Handle null pointer, nothing to delete
 
-    free_memory(node_ptr->data, NO_POOL);
+    if (node_ptr->data != _get_inline_value(node_ptr)) free_memory_to_slab(node_ptr->memory_manager_ptr, node_ptr->data, node_ptr->data_size);
     
-    if(node_ptr->is_concurrency_enabled){
-        result = pthread_mutex_destroy(&node_ptr->lock);
+    if(node_ptr->sync_mode == DATA_NODE_SYNC_MUTEX){
+        result = pthread_mutex_destroy(_get_node_mutex(node_ptr));
     }
 
-    free_memory(node_ptr, NO_POOL);
+    free_memory_to_slab(node_ptr->memory_manager_ptr, node_ptr, _get_data_node_block_size(node_ptr->key_size, node_ptr->inline_value_capacity, node_ptr->sync_mode));
 
-    return _operate_data_node_counters(DATA_NODE_DELETE, result);
+    return _operate_data_node_counters(counters_ptr, DATA_NODE_DELETE, result);
 }
 
-int get_data_from_node(data_node *node_ptr, key_store_value *value_out) {
-    if (node_ptr == NULL || value_out == NULL) return _operate_data_node_counters(DATA_NODE_READ, -20); // Handle null pointer
+int pin_data_node(data_node *node_ptr) {
+    if (node_ptr == NULL) return -20; // Handle null pointer
+
+    atomic_fetch_add_explicit(&node_ptr->ref_count, 1, memory_order_relaxed);
+    return 0;
+}
+
+int unpin_data_node(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr) {
+    if (node_ptr == NULL) return -20; // Handle null pointer
+
+    // The last reference frees the node, every earlier release must be visible to it
+    if (atomic_fetch_sub_explicit(&node_ptr->ref_count, 1, memory_order_acq_rel) == 1) return delete_data_node(counters_ptr, node_ptr);
+    return 0;
+}
+
+int get_data_from_node(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr, key_store_value *value_out) {
+    if (node_ptr == NULL || value_out == NULL) return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, -20); // Handle null pointer
     
     if (node_ptr->data_size == 0 || node_ptr->data == NULL) {
         value_out->data = NULL;
         value_out->data_size = 0;
-        return _operate_data_node_counters(DATA_NODE_READ, 0);
+        return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, 0);
     }
 
     value_out->data = (unsigned char *)allocate_memory(node_ptr->data_size);
-    if (value_out->data == NULL) return _operate_data_node_counters(DATA_NODE_READ, -10); // Handle memory allocation failure
+    if (value_out->data == NULL) return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, -10); // Handle memory allocation failure
 
     memcpy(value_out->data, node_ptr->data, node_ptr->data_size);
     value_out->data_size = node_ptr->data_size;
 
-    return _operate_data_node_counters(DATA_NODE_READ, 0);
+    return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, 0);
 }
 
-int data_node_mutex_lock_wrapper(data_node_operation_type_t operation_type, data_node* data_node_ptr, key_store_value* value) {
-    if(data_node_ptr == NULL) return _operate_data_node_counters(operation_type, -20); // Handle null pointer
-    int result = 0;
-    int lock_result = 0;
+bool can_update_data_node_in_place(const data_node *node_ptr, size_t new_data_size) {
+    if (node_ptr == NULL || node_ptr->sync_mode != DATA_NODE_SYNC_SEQLOCK) return true;
 
-    lock_result = pthread_mutex_lock(&data_node_ptr->lock);
-    if (lock_result != 0) return _operate_data_node_counters(operation_type, -30); // Handle error: failed to acquire lock
+    // Inline values may change size within the capacity, out-of-line buffers are only overwritten
+    bool is_inline = (node_ptr->data != NULL && node_ptr->data == _get_inline_value(node_ptr));
+    return is_inline ? (new_data_size > 0 && new_data_size <= node_ptr->inline_value_capacity) : (new_data_size == node_ptr->data_size);
+}
 
-    switch(operation_type) {
-        case DATA_NODE_UPDATE:
-            result = update_data_node(data_node_ptr, value);
+int data_node_lock_wrapper(sharded_data_node_operation_counters *counters_ptr, data_node_operation_type_t operation_type, data_node* data_node_ptr, key_store_value* value) {
+    if(data_node_ptr == NULL) return _operate_data_node_counters(counters_ptr, operation_type, -20); // Handle null pointer
+    if(operation_type != DATA_NODE_READ && operation_type != DATA_NODE_UPDATE) return -47; // Invalid operation type
+
+    int result = 0;
+    switch(data_node_ptr->sync_mode) {
+        case DATA_NODE_SYNC_MUTEX: {
+            if (pthread_mutex_lock(_get_node_mutex(data_node_ptr)) != 0) return _operate_data_node_counters(counters_ptr, operation_type, -30); // Handle error: failed to acquire lock
+            result = _run_data_node_operation(counters_ptr, operation_type, data_node_ptr, value);
+            if (pthread_mutex_unlock(_get_node_mutex(data_node_ptr)) != 0) return _operate_data_node_counters(counters_ptr, operation_type, -31); // Handle error: failed to release lock
             break;
-        case DATA_NODE_READ:
-            result = get_data_from_node(data_node_ptr, value);
+        }
+        case DATA_NODE_SYNC_SEQLOCK:
+            result = (operation_type == DATA_NODE_READ) ? _read_data_node_optimistic(counters_ptr, data_node_ptr, value) : _update_data_node_sequenced(counters_ptr, data_node_ptr, value);
             break;
         default:
-            result = -47; // Invalid operation type
+            result = _run_data_node_operation(counters_ptr, operation_type, data_node_ptr, value);
             break;
     }
 
-    int unlock_result = pthread_mutex_unlock(&data_node_ptr->lock);
-    if (unlock_result != 0) return _operate_data_node_counters(operation_type, -31); // Handle error: failed to release lock
-
     return result;
 }
 
-data_node_operation_counters get_data_node_operation_counters(void) {
-    data_node_operation_counters counters_copy;
-    memcpy(&counters_copy, &g_data_node_operation_counters, sizeof(data_node_operation_counters));
-    return counters_copy;
+int data_node_view_wrapper(sharded_data_node_operation_counters *counters_ptr, data_node* data_node_ptr, key_store_view_callback callback, void *context, uint32_t *version_out) {
+    if(data_node_ptr == NULL || callback == NULL) return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, -20); // Handle null pointer
+
+    int result = 0;
+    switch(data_node_ptr->sync_mode) {
+        case DATA_NODE_SYNC_MUTEX: {
+            if (pthread_mutex_lock(_get_node_mutex(data_node_ptr)) != 0) return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, -30); // Handle error: failed to acquire lock
+            result = callback(data_node_ptr->data, data_node_ptr->data_size, context);
+            if (version_out != NULL) *version_out = data_node_ptr->version;
+            if (pthread_mutex_unlock(_get_node_mutex(data_node_ptr)) != 0) return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, -31); // Handle error: failed to release lock
+            break;
+        }
+        case DATA_NODE_SYNC_SEQLOCK:
+            result = _view_data_node_optimistic(counters_ptr, data_node_ptr, callback, context, version_out);
+            break;
+        default:
+            result = callback(data_node_ptr->data, data_node_ptr->data_size, context);
+            if (version_out != NULL) *version_out = data_node_ptr->version;
+            break;
+    }
+
+    _operate_data_node_counters(counters_ptr, DATA_NODE_READ, 0); // The value was read, whatever the callback made of it
+    return result;
 }
 
 #pragma endregion
@@ -127,40 +174,44 @@ data_node_operation_counters get_data_node_operation_counters(void) {
 
 /**
  * @fn _operate_data_node_counters
- * @brief Updates the global data node operation counters based on the operation type and result.
+ * @brief Updates the data node operation counters of a key store instance based on the operation type and result.
  *
- * This function increments the appropriate counters in the global
- * data_node_operation_counters structure based on the operation type
- * (update, read, delete, create) and whether the operation was successful or failed.
+ * This function increments the appropriate counters in the calling thread's shard of
+ * the given counters based on the operation type (update, read, delete, create) and
+ * whether the operation was successful or failed.
  *
+ * @param counters_ptr Pointer to the counters to update, NULL skips counting.
  * @param operation_type The type of operation performed.
  * @param operation_result The result of the operation (0 for success, non-zero for failure).
  * @return int Returns the original operation_result for convenience.
  */
-int _operate_data_node_counters(data_node_operation_type_t operation_type, int operation_result) {
+int _operate_data_node_counters(sharded_data_node_operation_counters *counters_ptr, data_node_operation_type_t operation_type, int operation_result) {
+    data_node_operation_counters *shard_ptr = _get_counter_shard(counters_ptr);
+    if (shard_ptr == NULL) return operation_result;
+
     switch (operation_type) {
         case DATA_NODE_UPDATE:
-            g_data_node_operation_counters.total_update_ops++;
-            if (operation_result != 0) g_data_node_operation_counters.failed_update_ops++;
+            OPERATION_COUNTER_ADD(shard_ptr->total_update_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(shard_ptr->failed_update_ops, 1);
             break;
         case DATA_NODE_READ:
-            g_data_node_operation_counters.total_read_ops++;
-            if (operation_result != 0) g_data_node_operation_counters.failed_read_ops++;
+            OPERATION_COUNTER_ADD(shard_ptr->total_read_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(shard_ptr->failed_read_ops, 1);
             break;
         case DATA_NODE_DELETE:
-            g_data_node_operation_counters.total_delete_ops++;
-            if (operation_result != 0) g_data_node_operation_counters.failed_delete_ops++;
+            OPERATION_COUNTER_ADD(shard_ptr->total_delete_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(shard_ptr->failed_delete_ops, 1);
             break;
         case DATA_NODE_CREATE:
-            g_data_node_operation_counters.total_create_ops++;
-            if (operation_result != 0) g_data_node_operation_counters.failed_create_ops++;
+            OPERATION_COUNTER_ADD(shard_ptr->total_create_ops, 1);
+            if (operation_result != 0) OPERATION_COUNTER_ADD(shard_ptr->failed_create_ops, 1);
             break;
         default:
             break;
     }
 
     if (operation_result < 0 && operation_result > -100) {
-        g_data_node_operation_counters.error_code_counters[-operation_result]++;
+        OPERATION_COUNTER_ADD(shard_ptr->error_code_counters[-operation_result], 1);
     }
 
     return operation_result;
@@ -170,26 +221,38 @@ int _operate_data_node_counters(data_node_operation_type_t operation_type, int o
  * @fn _allocate_and_init_data_node
  * @brief Allocates memory for a data node and initializes its fields.
  *
- * This function allocates memory for a data_node structure including space for the key.
- * It also initializes the concurrency control mutex if enabled.
+ * This function allocates memory for a data_node structure including space for the key
+ * and an inline value from the slab of the memory manager. It also initializes the
+ * concurrency control mutex if enabled.
  *
- * @param key_len Length of the key including null terminator.
- * @param is_concurrency_enabled Flag indicating if concurrency control is enabled.
+ * @param memory_manager_ptr Pointer to the memory manager to allocate from, NULL uses the heap.
+ * @param key_len Length of the key in bytes, without the terminator stored after it.
+ * @param inline_value_capacity Bytes reserved after the key for an inline value.
+ * @param sync_mode Synchronization of the node, DATA_NODE_SYNC_MUTEX appends and initializes a mutex.
  * @return data_node* Pointer to the allocated and initialized data_node, or NULL on failure.
  */
-int _allocate_and_init_data_node(size_t key_len, bool is_concurrency_enabled, data_node** data_node_ptr) {
+int _allocate_and_init_data_node(memory_manager *memory_manager_ptr, size_t key_len, size_t inline_value_capacity, data_node_sync_t sync_mode, data_node** data_node_ptr) {
     
-    data_node *node = (data_node *)allocate_memory(sizeof(data_node) + key_len);
+    size_t block_size = _get_data_node_block_size(key_len, inline_value_capacity, sync_mode);
+    data_node *node = (data_node *)allocate_memory_from_slab(memory_manager_ptr, block_size);
     if (node == NULL) return -10; // Handle memory allocation failure
 
+    node->key_size = (uint32_t)key_len;
+    node->inline_value_capacity = (uint16_t)inline_value_capacity;
+    node->key[0] = '\0';
+    atomic_init(&node->next, NULL);
     node->data = NULL;
     node->data_size = 0;
-    node->is_concurrency_enabled = is_concurrency_enabled;
+    node->memory_manager_ptr = memory_manager_ptr;
+    node->sync_mode = (uint8_t)sync_mode;
+    atomic_init(&node->ref_count, 1);
+    atomic_init(&node->sequence, 0);
+    node->version = 1;
 
-    if(is_concurrency_enabled)
+    if(sync_mode == DATA_NODE_SYNC_MUTEX)
     {
-        if(pthread_mutex_init(&node->lock, NULL) != 0) {
-            delete_data_node(node);
+        if(pthread_mutex_init(_get_node_mutex(node), NULL) != 0) {
+            free_memory_to_slab(memory_manager_ptr, node, block_size); // The failed create is counted by the caller
             return -11; // Handle mutex initialization failure
         }
     }
@@ -201,7 +264,8 @@ int _allocate_and_init_data_node(size_t key_len, bool is_concurrency_enabled, da
 /**
  * @fn _add_data_to_node
  * @brief Adds data to the specified data node.
- * Copies the provided data into the node's data buffer and sets the data size.
+ * Copies the provided data into the node's inline space if it fits, else into a buffer
+ * from the slab, and sets the data size.
  * @param node_ptr Pointer to the data_node structure to which the data will be added.
  * @param value The data and its size to be copied.
  * @return int 0 on success, -1 on memory allocation failure.
@@ -215,7 +279,7 @@ int _add_data_to_node(data_node *node_ptr, key_store_value* value)
         return 0;
     }
 
-    node_ptr->data = (unsigned char *)allocate_memory(value->data_size);
+    node_ptr->data = (value->data_size <= node_ptr->inline_value_capacity) ? _get_inline_value(node_ptr) : (unsigned char *)allocate_memory_from_slab(node_ptr->memory_manager_ptr, value->data_size);
 
     if (node_ptr->data == NULL) {
         return -10; // Handle memory allocation failure
@@ -234,16 +298,16 @@ int _add_data_to_node(data_node *node_ptr, key_store_value* value)
  * Copies the provided key into the node's key buffer and sets the key hash.
  * @param node_ptr Pointer to the data_node structure to which the key will be added.
  * @param key The key string to be copied.
- * @param key_len Length of the key string including null terminator.
+ * @param key_len Length of the key in bytes, without the terminator added after it.
  * @param key_hash Hash value of the key to be stored in the node.
  * @return 0 on success.
  */
 int _add_key_to_node(data_node *node_ptr, const char *key, size_t key_len, uint32_t key_hash) 
 {
-    if (node_ptr == NULL || key == NULL || key[0] == '\0' || key_len == 0) return -20; // Handle null pointer or invalid key
+    if (node_ptr == NULL || key == NULL || key_len == 0) return -20; // Handle null pointer or invalid key
 
     memcpy(node_ptr->key, key, key_len);
-    node_ptr->key[key_len - 1] = '\0';  // Ensure null termination
+    node_ptr->key[key_len] = '\0';  // Keeps string keys printable, comparisons use key_size
 
     node_ptr->key_hash = key_hash;
 
@@ -253,28 +317,40 @@ int _add_key_to_node(data_node *node_ptr, const char *key, size_t key_len, uint3
 /**
  * @fn update_node_data
  * @brief Updates the data in the specified data node.
- * Reallocates memory if the new data size differs from the current size,
- * and copies the new data into the node's data buffer.
+ * Stores the new data inline if it fits the node's inline space, releasing an out-of-line
+ * buffer. Otherwise resizes the out-of-line buffer if the new data size differs from the
+ * current size, or allocates one if the value was inline, and copies the new data into it.
  * @param node_ptr Pointer to the data_node structure to be updated.
  * @param new_value The new data and its size to be copied.
  * @return int 0 on success, -1 on memory allocation failure.
  * @note If new_value.data_size is 0, the node's data will be set to NULL and data_size to 0.
  * @note If the new data size is the same as the current size, no reallocation is performed.
+ * @note A successfully copied value increments the node's version.
 */
 int _update_data_node(data_node *node_ptr, key_store_value* new_value) {
 
     if(new_value == NULL || new_value->data == NULL) return -20; // Handle null pointer
 
+    unsigned char *inline_value = _get_inline_value(node_ptr);
+    bool is_inline = (node_ptr->data == inline_value);
+
     if(new_value->data_size == 0)
     {
-        free_memory(node_ptr->data, NO_POOL);
+        if (!is_inline) free_memory_to_slab(node_ptr->memory_manager_ptr, node_ptr->data, node_ptr->data_size);
         node_ptr->data = NULL;
         node_ptr->data_size = 0;
+        node_ptr->version++;
         return 0;
     }
 
-    if(node_ptr->data_size != new_value->data_size) {
-        unsigned char *new_data = (unsigned char *)reallocate_memory(node_ptr->data, new_value->data_size);
+    if(new_value->data_size <= node_ptr->inline_value_capacity) {
+        if (!is_inline) free_memory_to_slab(node_ptr->memory_manager_ptr, node_ptr->data, node_ptr->data_size);
+        node_ptr->data = inline_value;
+        node_ptr->data_size = new_value->data_size;
+    }
+    else if(is_inline || node_ptr->data_size != new_value->data_size) {
+        // An inline value moves out of line into a new buffer, an out-of-line one is resized
+        unsigned char *new_data = is_inline ? (unsigned char *)allocate_memory_from_slab(node_ptr->memory_manager_ptr, new_value->data_size) : (unsigned char *)reallocate_memory_from_slab(node_ptr->memory_manager_ptr, node_ptr->data, node_ptr->data_size, new_value->data_size);
         if (new_data == NULL)  return -10; // Handle memory allocation failure
 
         node_ptr->data = new_data;
@@ -282,6 +358,182 @@ int _update_data_node(data_node *node_ptr, key_store_value* new_value) {
     }
 
     memcpy(node_ptr->data, new_value->data, new_value->data_size);
+    node_ptr->version++;
     return 0;
 }
-#pragma endregion
\ No newline at end of file
+
+/**
+ * @fn _get_inline_value
+ * @brief Returns the inline value space of a data node, right after its key.
+ * @param node_ptr Pointer to the data node.
+ * @return Pointer to the inline value space, or NULL if the node has none.
+ */
+static inline unsigned char* _get_inline_value(const data_node *node_ptr)
+{
+    return (node_ptr->inline_value_capacity > 0) ? (unsigned char *)node_ptr->key + node_ptr->key_size + 1 : NULL;
+}
+
+/**
+ * @fn _get_mutex_offset
+ * @brief Returns the offset of a DATA_NODE_SYNC_MUTEX node's mutex, the first aligned byte after its inline value.
+ */
+static inline size_t _get_mutex_offset(size_t key_len, size_t inline_value_capacity)
+{
+    size_t alignment = _Alignof(pthread_mutex_t);
+    return (sizeof(data_node) + key_len + 1 + inline_value_capacity + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @fn _get_data_node_block_size
+ * @brief Returns the bytes of the slab block holding a data node: header, key, inline value and, for DATA_NODE_SYNC_MUTEX, the mutex.
+ */
+static inline size_t _get_data_node_block_size(size_t key_len, size_t inline_value_capacity, data_node_sync_t sync_mode)
+{
+    return (sync_mode == DATA_NODE_SYNC_MUTEX) ? _get_mutex_offset(key_len, inline_value_capacity) + sizeof(pthread_mutex_t) : sizeof(data_node) + key_len + 1 + inline_value_capacity;
+}
+
+/**
+ * @fn _get_node_mutex
+ * @brief Returns the mutex of a DATA_NODE_SYNC_MUTEX data node.
+ */
+static inline pthread_mutex_t* _get_node_mutex(data_node *node_ptr)
+{
+    return (pthread_mutex_t *)((char *)node_ptr + _get_mutex_offset(node_ptr->key_size, node_ptr->inline_value_capacity));
+}
+
+/**
+ * @fn _run_data_node_operation
+ * @brief Runs a read or an update on a data node without any synchronization.
+ */
+static int _run_data_node_operation(sharded_data_node_operation_counters *counters_ptr, data_node_operation_type_t operation_type, data_node *node_ptr, key_store_value *value)
+{
+    return (operation_type == DATA_NODE_READ) ? get_data_from_node(counters_ptr, node_ptr, value) : update_data_node(counters_ptr, node_ptr, value);
+}
+
+/**
+ * @fn _read_data_node_optimistic
+ * @brief Copies the value of a DATA_NODE_SYNC_SEQLOCK node, retrying while a writer updates it.
+ *
+ * The copy is only kept if the sequence was even before and unchanged after it. In-place updates
+ * never free or move the value storage (see can_update_data_node_in_place), so a copy that races
+ * with a writer reads stale bytes but stays in bounds, and is then discarded.
+ *
+ * @param counters_ptr Pointer to the data node counters, NULL skips counting.
+ * @param node_ptr Pointer to the pinned data node.
+ * @param value_out Pointer to receive a heap copy of the value, owned by the caller.
+ * @return int Returns 0 on success, -20 on invalid input, or -10 on allocation failure.
+ */
+static int _read_data_node_optimistic(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr, key_store_value *value_out)
+{
+    if (value_out == NULL) return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, -20); // Handle null pointer
+
+    unsigned char *buffer = NULL;
+    size_t buffer_size = 0;
+
+    for (;;)
+    {
+        unsigned int sequence = atomic_load_explicit(&node_ptr->sequence, memory_order_acquire);
+        if ((sequence & 1) == 0)
+        {
+            size_t data_size = node_ptr->data_size;
+            if (data_size > buffer_size) {
+                free(buffer);
+                buffer = (unsigned char *)allocate_memory(data_size);
+                if (buffer == NULL) return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, -10); // Handle memory allocation failure
+                buffer_size = data_size;
+            }
+            if (data_size > 0) memcpy(buffer, node_ptr->data, data_size);
+
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&node_ptr->sequence, memory_order_relaxed) == sequence)
+            {
+                if (data_size == 0) {
+                    free(buffer);
+                    buffer = NULL;
+                }
+                value_out->data = buffer;
+                value_out->data_size = data_size;
+                return _operate_data_node_counters(counters_ptr, DATA_NODE_READ, 0);
+            }
+        }
+
+        data_node_operation_counters *shard_ptr = _get_counter_shard(counters_ptr);
+        if (shard_ptr != NULL) OPERATION_COUNTER_ADD(shard_ptr->read_retry_ops, 1);
+        sched_yield(); // The writer holds the bucket lock for a single copy
+    }
+}
+
+/**
+ * @fn _update_data_node_sequenced
+ * @brief Updates the value of a DATA_NODE_SYNC_SEQLOCK node in place, keeping the sequence odd meanwhile.
+ *
+ * @param counters_ptr Pointer to the data node counters, NULL skips counting.
+ * @param node_ptr Pointer to the data node to update.
+ * @param new_value Pointer to the new value.
+ * @return int Returns the result of update_data_node, or -43 if the value storage would have to change.
+ * @note The caller serializes writers with the bucket or table write lock.
+ */
+static int _update_data_node_sequenced(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr, key_store_value *new_value)
+{
+    if (new_value == NULL) return _operate_data_node_counters(counters_ptr, DATA_NODE_UPDATE, -20); // Handle null pointer
+    if (!can_update_data_node_in_place(node_ptr, new_value->data_size)) return _operate_data_node_counters(counters_ptr, DATA_NODE_UPDATE, -43); // Readers may still copy from the old storage
+
+    unsigned int sequence = atomic_load_explicit(&node_ptr->sequence, memory_order_relaxed);
+    atomic_store_explicit(&node_ptr->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    int result = update_data_node(counters_ptr, node_ptr, new_value);
+
+    atomic_store_explicit(&node_ptr->sequence, sequence + 2, memory_order_release);
+    return result;
+}
+
+/**
+ * @fn _view_data_node_optimistic
+ * @brief Runs a view callback on the value of a DATA_NODE_SYNC_SEQLOCK node, retrying while a writer updates it.
+ *
+ * The callback sees the node's own value storage. If a writer updated the value while the callback
+ * ran, the bytes it saw may be torn, so its result is discarded and the callback runs again. The
+ * storage stays in bounds meanwhile, as for _read_data_node_optimistic.
+ *
+ * @param counters_ptr Pointer to the data node counters, NULL skips counting.
+ * @param node_ptr Pointer to the pinned data node.
+ * @param callback Function receiving the value bytes and their size.
+ * @param context Caller context passed to the callback.
+ * @param version_out Receives the version read in the same run as the value, or NULL.
+ * @return int Returns the result of the last callback run, which saw a consistent value.
+ */
+static int _view_data_node_optimistic(sharded_data_node_operation_counters *counters_ptr, data_node *node_ptr, key_store_view_callback callback, void *context, uint32_t *version_out)
+{
+    for (;;)
+    {
+        unsigned int sequence = atomic_load_explicit(&node_ptr->sequence, memory_order_acquire);
+        if ((sequence & 1) == 0)
+        {
+            int result = callback(node_ptr->data, node_ptr->data_size, context);
+            uint32_t version = node_ptr->version;
+
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&node_ptr->sequence, memory_order_relaxed) == sequence) {
+                if (version_out != NULL) *version_out = version;
+                return result;
+            }
+        }
+
+        data_node_operation_counters *shard_ptr = _get_counter_shard(counters_ptr);
+        if (shard_ptr != NULL) OPERATION_COUNTER_ADD(shard_ptr->read_retry_ops, 1);
+        sched_yield(); // The writer holds the bucket lock for a single copy
+    }
+}
+
+/**
+ * @fn _get_counter_shard
+ * @brief Returns the calling thread's shard of the data node counters.
+ * @return data_node_operation_counters* The shard, or NULL if counters_ptr is NULL or counting is compiled out.
+ */
+static data_node_operation_counters* _get_counter_shard(sharded_data_node_operation_counters *counters_ptr)
+{
+    if (!OPERATION_COUNTERS_ENABLED || counters_ptr == NULL) return NULL;
+    return &counters_ptr->shards[get_operation_counter_shard_index()].counters;
+}
+#pragma endregion
@@ -26,13 +26,23 @@ typedef enum {
  * @fn create_data_node
  * @brief Creates a new data node with the specified key, key hash, and value.
  *
- * @param key The key associated with the data node.
+ * The node and its value buffer are allocated from the slab of the memory manager, which the
+ * node keeps to release them. The node reserves inline_value_threshold bytes right after the key,
+ * and a value of at most that size is stored there, so reading it needs no second pointer
+ * dereference. Updates move the value between the inline space and a separate buffer as its
+ * size crosses the threshold.
+ *
+ * @param counters_ptr Pointer to the data node counters of the key store instance, NULL skips counting.
+ * @param memory_manager_ptr Pointer to the memory manager of the key store instance, NULL uses the heap.
+ * @param key The key associated with the data node, copied as key_len bytes followed by a terminator.
+ * @param key_len Length of the key in bytes, which may include zero bytes.
  * @param key_hash The hash value of the key.
  * @param value Pointer to the key_store_value to be stored.
- * @param is_concurrency_enabled Whether to initialize the node for concurrency.
+ * @param sync_mode How reads of the node are synchronized with in-place updates (DATA_NODE_SYNC_NONE for single threaded tables).
+ * @param inline_value_threshold Largest value size stored inline (0 disables, capped at DATA_NODE_MAX_INLINE_VALUE_SIZE).
  * @return Pointer to the newly created data_node, or NULL on failure.
  */
-int create_data_node(const char *key, uint32_t key_hash, key_store_value* value, bool is_concurrency_enabled, data_node** data_node_ptr);
+int create_data_node(sharded_data_node_operation_counters *counters_ptr, memory_manager *memory_manager_ptr, const char *key, size_t key_len, uint32_t key_hash, key_store_value* value, data_node_sync_t sync_mode, unsigned int inline_value_threshold, data_node** data_node_ptr);
 
 /**
  * @fn update_data_node
@@ -40,13 +50,16 @@ int create_data_node(const char *key, uint32_t key_hash, key_store_value* value,
  *
  * This function replaces the existing data in the node with new data provided
  * in the key_store_value structure. It handles memory allocation and resizing
- * as necessary.
+ * as necessary, moving the value inline when it fits the node's inline space
+ * and out of line when it does not. Every successful update increments the
+ * node's version.
  *
+ * @param counters_ptr Pointer to the data node counters of the key store instance, NULL skips counting.
  * @param node Pointer to the data_node to be updated.
  * @param new_value Pointer to the key_store_value containing the new data.
  * @return 0 on success, non-zero on failure.
  */
-int update_data_node(data_node *node, key_store_value* new_value);
+int update_data_node(sharded_data_node_operation_counters *counters_ptr, data_node *node, key_store_value* new_value);
 
 /**
  * @fn get_data_from_node
@@ -56,11 +69,12 @@ int update_data_node(data_node *node, key_store_value* new_value);
  * key_store_value structure. The caller is responsible for managing the memory
  * of the data pointer in value_out.
  *
+ * @param counters_ptr Pointer to the data node counters of the key store instance, NULL skips counting.
  * @param node Pointer to the data_node from which to retrieve data.
  * @param value_out Pointer to a key_store_value structure to receive the data.
  * @return 0 on success, non-zero on failure.
  */
-int get_data_from_node(data_node *node, key_store_value* value_out);
+int get_data_from_node(sharded_data_node_operation_counters *counters_ptr, data_node *node, key_store_value* value_out);
 
 /**
  * @fn delete_data_node
@@ -69,34 +83,85 @@ int get_data_from_node(data_node *node, key_store_value* value_out);
  * This function releases all memory allocated for the data node, including
  * its data buffer and any concurrency control structures if enabled.
  *
+ * @param counters_ptr Pointer to the data node counters of the key store instance, NULL skips counting.
  * @param node Pointer to the data_node to be deleted.
  * @return 0 on success, non-zero on failure.
  */
-int delete_data_node(data_node *node);
+int delete_data_node(sharded_data_node_operation_counters *counters_ptr, data_node *node);
+
+/**
+ * @fn pin_data_node
+ * @brief Takes an additional reference on a data node.
+ *
+ * A reader pins a data node while it still holds the bucket lock, so the node stays valid
+ * after the lock is released even if a concurrent delete unlinks it.
+ *
+ * @param node Pointer to the data_node to pin. The caller must already hold a reference or the bucket lock.
+ * @return 0 on success, -20 on a NULL node.
+ */
+int pin_data_node(data_node *node);
+
+/**
+ * @fn unpin_data_node
+ * @brief Releases a reference on a data node and deletes the node with the last one.
+ *
+ * A new data node starts with a single reference, owned by the bucket it is linked into.
+ * Deleting a key releases that reference; every pin_data_node must be paired with a call here.
+ *
+ * @param counters_ptr Pointer to the data node counters of the key store instance, NULL skips counting.
+ * @param node Pointer to the data_node to release.
+ * @return 0 on success, -20 on a NULL node, or the result of delete_data_node for the last reference.
+ */
+int unpin_data_node(sharded_data_node_operation_counters *counters_ptr, data_node *node);
+
+/**
+ * @fn can_update_data_node_in_place
+ * @brief Checks whether a value of the given size may be copied into the node by update_data_node.
+ *
+ * A DATA_NODE_SYNC_SEQLOCK reader copies the value without a lock, so the node's value storage
+ * must not be freed or moved under it: only a value that stays inline, or an out-of-line value
+ * of the same size, is updated in place. Otherwise the caller replaces the node with a new one.
+ *
+ * @param node_ptr Pointer to the data node to update.
+ * @param new_data_size Size of the new value in bytes.
+ * @return true if the value may be updated in place, false if the node must be replaced.
+ */
+bool can_update_data_node_in_place(const data_node *node_ptr, size_t new_data_size);
 
 /**
- * @fn data_node_mutex_lock_wrapper
- * @brief Wraps data node operations with mutex lock for concurrency control.
+ * @fn data_node_lock_wrapper
+ * @brief Wraps data node operations with the node's synchronization.
  *
- * This function acquires the mutex lock of the data node, performs the
- * operation (DATA_NODE_READ or DATA_NODE_UPDATE), and then releases the lock.
+ * DATA_NODE_SYNC_MUTEX nodes hold their mutex for the operation. DATA_NODE_SYNC_SEQLOCK writers
+ * make the sequence counter odd while they update the value, and readers copy the value
+ * optimistically and retry until they saw an unchanged, even sequence. DATA_NODE_SYNC_NONE
+ * nodes run the operation directly. The time a read takes is added to the read latency counter.
  *
+ * @param counters_ptr Pointer to the data node counters of the key store instance, NULL skips counting.
  * @param operation_type The type of operation to perform (DATA_NODE_READ or DATA_NODE_UPDATE).
  * @param data_node_ptr Pointer to the data node on which to perform the operation.
  * @param value Pointer to a key_store_value structure for input/output as needed.
- * @return int Returns the result of the operation, or -1 on lock acquisition failure.
+ * @return int Returns the result of the operation, or -30/-31 on lock failures.
+ * @note A seqlock update must be serialized with other writers by the caller (bucket or table write lock).
  */
-int data_node_mutex_lock_wrapper(data_node_operation_type_t operation_type, data_node* data_node_ptr, key_store_value* value);
+int data_node_lock_wrapper(sharded_data_node_operation_counters *counters_ptr, data_node_operation_type_t operation_type, data_node* data_node_ptr, key_store_value* value);
 
 /**
- * @fn get_data_node_operation_counters
- * @brief Retrieves the global data node operation counters.
+ * @fn data_node_view_wrapper
+ * @brief Runs a callback on the value stored in a data node, under the node's synchronization.
  *
- * This function returns a copy of the global data_node_operation_counters structure,
- * which contains counts of total and failed operations as well as error code occurrences.
+ * The callback receives a pointer to the node's own value bytes, so nothing is allocated or copied.
+ * DATA_NODE_SYNC_MUTEX nodes hold their mutex while the callback runs. On DATA_NODE_SYNC_SEQLOCK
+ * nodes the callback runs without a lock and is run again if a writer updated the value meanwhile;
+ * only the result of the run that saw a consistent value is returned. The view counts as a read.
  *
- * @return data_node_operation_counters A copy of the global data node operation counters.
+ * @param counters_ptr Pointer to the data node counters of the key store instance, NULL skips counting.
+ * @param data_node_ptr Pointer to the pinned data node.
+ * @param callback Function receiving the value bytes and their size, which must not keep the pointer.
+ * @param context Caller context passed to the callback.
+ * @param version_out Receives the version of the value the callback saw, or NULL.
+ * @return int Returns the callback's result, -20 on a NULL node or callback, or -30/-31 on lock failures.
  */
-data_node_operation_counters get_data_node_operation_counters(void);
+int data_node_view_wrapper(sharded_data_node_operation_counters *counters_ptr, data_node* data_node_ptr, key_store_view_callback callback, void *context, uint32_t *version_out);
 
 #endif // DATA_NODE_H
\ No newline at end of file
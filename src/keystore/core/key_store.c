@@ -2,105 +2,809 @@
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
+#include <math.h>
 #include "key_store.h"
 #include "data_node.h"
+#include "operation_counters.h"
+#include "latency_histogram.h"
 #include "bucket/hash_buckets.h"
 #include "bucket/hash_bucket_list.h"
+#include "bucket/swiss_table.h"
 #include "hash/hash_functions.h"
 #include "utils/memory_manager.h"
+#include "utils/epoch_manager.h"
+#include <pthread.h>
+#include <stdint.h>
+
+#define KEY_STORE_CACHE_LINE_SIZE 64 // Shards start on their own cache line so neighbours never share one
+
+#pragma region Private Type Definitions
+typedef struct key_store_shard
+{
+    _Alignas(KEY_STORE_CACHE_LINE_SIZE) memory_manager memory; // List and tree node pools of the chained engine
+    hash_bucket_memory_pool buckets; // Table of the chained engine
+    swiss_table swiss; // Table of the swiss engine
+} key_store_shard;
+
+struct key_store
+{
+    key_store_engine_t engine; // Table engine selected at initialization
+    uint32_t hash_seed;
+    key_store_shard *shards; // shard_count independent sub-stores
+    unsigned int shard_count;
+    unsigned int shard_shift; // The shard of a key is its hash shifted right by this many bits
+    epoch_manager epoch; // Reclaims nodes for lock-free readers of every shard, only enabled with is_lock_free_read_enabled
+    bool is_thread_affinity_enabled;
+    pthread_key_t home_shard_key; // Home shard index + 1 of the calling thread, only created with is_thread_affinity_enabled
+    atomic_uint next_home_shard; // Round-robin assignment of home shards
+    sharded_latency_histograms *latency_histograms; // Set, get, delete and lock wait latencies of every shard (NULL if counters are compiled out)
+    bool is_initialized;
+};
+
+typedef struct
+{
+    unsigned char *buffer; // Caller buffer receiving the value, may be NULL if buffer_capacity is 0
+    size_t buffer_capacity;
+    size_t *value_size_out; // Receives the value size, whether or not the value fit
+} key_store_copy_context;
+
+typedef struct
+{
+    int64_t delta; // Amount added to the counter
+    int64_t value; // Counter after the update
+    unsigned char buffer[sizeof(int64_t)]; // New value handed to the table, which copies it
+} key_store_counter_context;
+
+typedef struct
+{
+    const key_store_value *part; // Bytes added to the value
+    bool is_prepend;
+    unsigned char *buffer; // Combined value, freed by the caller once the table copied it
+} key_store_concat_context;
+
+typedef struct
+{
+    const key_store_value *expected; // Bytes the value must equal, NULL to compare versions instead
+    uint32_t expected_version;
+    key_store_value *new_value; // Value stored if the comparison holds
+    uint32_t new_version; // Version of the stored value
+} key_store_compare_context;
+
+typedef struct
+{
+    bool is_copied; // Whether the caller wants a copy of the value
+    key_store_value copy; // Copy made by the last run of the view callback, which may run again on a concurrent update
+} key_store_versioned_read_context;
+
+#pragma endregion
+
 
 #pragma region Private Global Variables
-static uint32_t g_hash_seed = 0;
-static unsigned int g_bucket_size = 0;
+static key_store g_default_key_store = {0}; // Instance behind the global API
+
+#pragma endregion
+
+
+#pragma region Private Function Declarations
+static uint32_t _generate_hash_seed(void);
+static int _get_key_hash(const key_store *store_ptr, const void *key, size_t key_len, uint32_t *key_hash_out);
+static bool _is_prepared_key_valid(const key_store_prepared_key *prepared_key);
+static int _initialise_key_store(key_store *store_ptr, const key_store_config config);
+static int _initialise_shard(key_store *store_ptr, key_store_shard *shard_ptr, const key_store_config config);
+static int _initialise_chained_engine(key_store *store_ptr, key_store_shard *shard_ptr, const key_store_config config);
+static void _cleanup_shards(key_store *store_ptr, unsigned int shard_count);
+static int _cleanup_key_store(key_store *store_ptr);
+static key_store_shard* _get_shard(key_store *store_ptr, uint32_t key_hash);
+static void _merge_shard_stats(keystore_stats *total_ptr, const keystore_stats *shard_stats_ptr);
+static int _copy_value_into(const unsigned char *data, size_t data_size, void *context);
+static int _read_value_size(const unsigned char *data, size_t data_size, void *context);
+static int _run_batch(key_store *store_ptr, bool is_set, const key_store_prepared_key *keys, size_t key_count, key_store_value *values, int *results_out);
+static int _apply_increment(const unsigned char *data, size_t data_size, uint32_t version, key_store_value *new_value_out, void *context);
+static int _apply_concat(const unsigned char *data, size_t data_size, uint32_t version, key_store_value *new_value_out, void *context);
+static int _apply_compare(const unsigned char *data, size_t data_size, uint32_t version, key_store_value *new_value_out, void *context);
+static int _view_prepared_key(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_view_callback callback, void *context, uint32_t *version_out);
+static int _read_versioned(const unsigned char *data, size_t data_size, void *context);
+static bool _is_value_valid(const key_store_value *value);
+
+#pragma endregion
+
+#pragma region Public Function Definitions
+int initialise_key_store(unsigned int bucket_size, double pre_memory_allocation_factor, bool is_concurrency_enabled) 
+{ 
+    key_store_config config = {
+        .bucket_size = bucket_size,
+        .pre_memory_allocation_factor = pre_memory_allocation_factor,
+        .is_concurrency_enabled = is_concurrency_enabled,
+        .grow_load_factor = KEY_STORE_DEFAULT_GROW_LOAD_FACTOR,
+        .shrink_load_factor = KEY_STORE_DEFAULT_SHRINK_LOAD_FACTOR,
+        .treeify_threshold = KEY_STORE_DEFAULT_TREEIFY_THRESHOLD,
+        .inline_value_threshold = KEY_STORE_DEFAULT_INLINE_VALUE_THRESHOLD
+    };
+
+    return initialise_key_store_with_config(config);
+}
+
+
+int initialise_key_store_with_config(const key_store_config config) 
+{ 
+    return _initialise_key_store(&g_default_key_store, config);
+}
+
+
+int cleanup_key_store(void) 
+{
+    return _cleanup_key_store(&g_default_key_store);
+}
+
+
+int set_key(const char *key, key_store_value* value) 
+{
+    return store_set_key(&g_default_key_store, key, value);
+}
+
+
+int get_key(const char *key, key_store_value *value_out) 
+{
+    return store_get_key(&g_default_key_store, key, value_out);
+}
+
+
+int delete_key(const char *key) 
+{    
+    return store_delete_key(&g_default_key_store, key);
+}
+
+
+int set_key_n(const void *key, size_t key_len, key_store_value* value)
+{
+    return store_set_key_n(&g_default_key_store, key, key_len, value);
+}
+
+
+int get_key_n(const void *key, size_t key_len, key_store_value *value_out)
+{
+    return store_get_key_n(&g_default_key_store, key, key_len, value_out);
+}
+
+
+int delete_key_n(const void *key, size_t key_len)
+{
+    return store_delete_key_n(&g_default_key_store, key, key_len);
+}
+
+
+int prepare_key(const void *key, size_t key_len, key_store_prepared_key *prepared_key_out)
+{
+    return store_prepare_key(&g_default_key_store, key, key_len, prepared_key_out);
+}
+
+
+int prepare_key_with_hash(const void *key, size_t key_len, uint32_t key_hash, key_store_prepared_key *prepared_key_out)
+{
+    return store_prepare_key_with_hash(&g_default_key_store, key, key_len, key_hash, prepared_key_out);
+}
+
+
+int set_prepared_key(const key_store_prepared_key *prepared_key, key_store_value* value)
+{
+    return store_set_prepared_key(&g_default_key_store, prepared_key, value);
+}
+
+
+int get_prepared_key(const key_store_prepared_key *prepared_key, key_store_value *value_out)
+{
+    return store_get_prepared_key(&g_default_key_store, prepared_key, value_out);
+}
+
+
+int delete_prepared_key(const key_store_prepared_key *prepared_key)
+{
+    return store_delete_prepared_key(&g_default_key_store, prepared_key);
+}
+
+
+int get_key_view(const char *key, key_store_view_callback callback, void *context)
+{
+    return store_get_key_view(&g_default_key_store, key, callback, context);
+}
+
+
+int get_key_view_n(const void *key, size_t key_len, key_store_view_callback callback, void *context)
+{
+    return store_get_key_view_n(&g_default_key_store, key, key_len, callback, context);
+}
+
+
+int get_prepared_key_view(const key_store_prepared_key *prepared_key, key_store_view_callback callback, void *context)
+{
+    return store_get_prepared_key_view(&g_default_key_store, prepared_key, callback, context);
+}
+
+
+int get_key_into(const char *key, void *buffer, size_t buffer_capacity, size_t *value_size_out)
+{
+    return store_get_key_into(&g_default_key_store, key, buffer, buffer_capacity, value_size_out);
+}
+
+
+int get_key_into_n(const void *key, size_t key_len, void *buffer, size_t buffer_capacity, size_t *value_size_out)
+{
+    return store_get_key_into_n(&g_default_key_store, key, key_len, buffer, buffer_capacity, value_size_out);
+}
+
+
+int get_prepared_key_into(const key_store_prepared_key *prepared_key, void *buffer, size_t buffer_capacity, size_t *value_size_out)
+{
+    return store_get_prepared_key_into(&g_default_key_store, prepared_key, buffer, buffer_capacity, value_size_out);
+}
+
+
+int exists_key(const char *key)
+{
+    return store_exists_key(&g_default_key_store, key);
+}
+
+
+int exists_key_n(const void *key, size_t key_len)
+{
+    return store_exists_key_n(&g_default_key_store, key, key_len);
+}
+
+
+int get_value_size(const char *key, size_t *value_size_out)
+{
+    return store_get_value_size(&g_default_key_store, key, value_size_out);
+}
+
+
+int get_value_size_n(const void *key, size_t key_len, size_t *value_size_out)
+{
+    return store_get_value_size_n(&g_default_key_store, key, key_len, value_size_out);
+}
+
+
+int get_keys(const char *const *keys, size_t key_count, key_store_value *values_out, int *results_out)
+{
+    return store_get_keys(&g_default_key_store, keys, key_count, values_out, results_out);
+}
+
+
+int set_keys(const char *const *keys, size_t key_count, key_store_value *values, int *results_out)
+{
+    return store_set_keys(&g_default_key_store, keys, key_count, values, results_out);
+}
+
+
+int get_prepared_keys(const key_store_prepared_key *prepared_keys, size_t key_count, key_store_value *values_out, int *results_out)
+{
+    return store_get_prepared_keys(&g_default_key_store, prepared_keys, key_count, values_out, results_out);
+}
+
+
+int set_prepared_keys(const key_store_prepared_key *prepared_keys, size_t key_count, key_store_value *values, int *results_out)
+{
+    return store_set_prepared_keys(&g_default_key_store, prepared_keys, key_count, values, results_out);
+}
+
+int update_key_with(const char *key, key_store_update_callback callback, void *context)
+{
+    return store_update_key_with(&g_default_key_store, key, callback, context);
+}
+
+
+int update_key_with_n(const void *key, size_t key_len, key_store_update_callback callback, void *context)
+{
+    return store_update_key_with_n(&g_default_key_store, key, key_len, callback, context);
+}
+
+
+int update_prepared_key_with(const key_store_prepared_key *prepared_key, key_store_update_callback callback, void *context)
+{
+    return store_update_prepared_key_with(&g_default_key_store, prepared_key, callback, context);
+}
+
+
+int incr_key(const char *key, int64_t delta, int64_t *value_out)
+{
+    return store_incr_key(&g_default_key_store, key, delta, value_out);
+}
+
+
+int decr_key(const char *key, int64_t delta, int64_t *value_out)
+{
+    return store_decr_key(&g_default_key_store, key, delta, value_out);
+}
+
+
+int append_key(const char *key, const key_store_value *suffix)
+{
+    return store_append_key(&g_default_key_store, key, suffix);
+}
+
+
+int prepend_key(const char *key, const key_store_value *prefix)
+{
+    return store_prepend_key(&g_default_key_store, key, prefix);
+}
+
+
+int compare_and_swap_key(const char *key, const key_store_value *expected, key_store_value *new_value)
+{
+    return store_compare_and_swap_key(&g_default_key_store, key, expected, new_value);
+}
+
+
+int get_key_versioned(const char *key, key_store_value *value_out, uint32_t *version_out)
+{
+    return store_get_key_versioned(&g_default_key_store, key, value_out, version_out);
+}
+
+
+int compare_version_and_set_key(const char *key, uint32_t expected_version, key_store_value *value, uint32_t *new_version_out)
+{
+    return store_compare_version_and_set_key(&g_default_key_store, key, expected_version, value, new_version_out);
+}
+
+keystore_stats get_keystore_stats(void) 
+{
+    return store_get_keystore_stats(&g_default_key_store);
+}
+
+
+int set_thread_home_shard(unsigned int shard_index)
+{
+    return store_set_thread_home_shard(&g_default_key_store, shard_index);
+}
+
+
+int create_key_store(const key_store_config config, key_store **key_store_out)
+{
+    if (key_store_out == NULL) return -20; // Error handling: invalid output pointer
+
+    key_store *store_ptr = calloc(1, sizeof(key_store));
+    if (store_ptr == NULL) return -10; // Error handling: memory allocation failed
+
+    int init_result = _initialise_key_store(store_ptr, config);
+    if (init_result != 0) {
+        free(store_ptr);
+        return init_result; // Error handling: invalid configuration or failed to initialize
+    }
+
+    *key_store_out = store_ptr;
+    return 0;
+}
+
+
+int destroy_key_store(key_store *store_ptr)
+{
+    if (store_ptr == NULL) return -20; // Error handling: invalid input
+    if (store_ptr == &g_default_key_store) return -20; // Error handling: the default instance is released with cleanup_key_store
+
+    _cleanup_key_store(store_ptr);
+    free(store_ptr);
+    return 0;
+}
+
+
+int store_set_key(key_store *store_ptr, const char *key, key_store_value* value) 
+{
+    if (key == NULL) return -20; // Error handling: invalid input
+
+    return store_set_key_n(store_ptr, key, strlen(key), value);
+}
+
+
+int store_get_key(key_store *store_ptr, const char *key, key_store_value *value_out) 
+{
+    if (key == NULL) return -20; // Error handling: invalid input
+
+    return store_get_key_n(store_ptr, key, strlen(key), value_out);
+}
+
+
+int store_delete_key(key_store *store_ptr, const char *key) 
+{    
+    if (key == NULL) return -20; // Error handling: invalid input
+
+    return store_delete_key_n(store_ptr, key, strlen(key));
+}
+
+
+int store_set_key_n(key_store *store_ptr, const void *key, size_t key_len, key_store_value* value)
+{
+    key_store_prepared_key prepared_key;
+    int prepare_result = store_prepare_key(store_ptr, key, key_len, &prepared_key);
+    if (prepare_result != 0) return prepare_result; // Error handling: invalid key or failed to get hash
+
+    return store_set_prepared_key(store_ptr, &prepared_key, value);
+}
+
+
+int store_get_key_n(key_store *store_ptr, const void *key, size_t key_len, key_store_value *value_out)
+{
+    key_store_prepared_key prepared_key;
+    int prepare_result = store_prepare_key(store_ptr, key, key_len, &prepared_key);
+    if (prepare_result != 0) return prepare_result; // Error handling: invalid key or failed to get hash
+
+    return store_get_prepared_key(store_ptr, &prepared_key, value_out);
+}
+
+
+int store_delete_key_n(key_store *store_ptr, const void *key, size_t key_len)
+{
+    key_store_prepared_key prepared_key;
+    int prepare_result = store_prepare_key(store_ptr, key, key_len, &prepared_key);
+    if (prepare_result != 0) return prepare_result; // Error handling: invalid key or failed to get hash
+
+    return store_delete_prepared_key(store_ptr, &prepared_key);
+}
+
+
+int store_prepare_key(key_store *store_ptr, const void *key, size_t key_len, key_store_prepared_key *prepared_key_out)
+{
+    if (store_ptr == NULL || key == NULL || key_len == 0 || key_len > KEY_STORE_MAX_KEY_SIZE || prepared_key_out == NULL) return -20; // Error handling: invalid input
+
+    uint32_t key_hash;
+    int get_hash_result = _get_key_hash(store_ptr, key, key_len, &key_hash);
+    if (get_hash_result != 0) return get_hash_result; // Error handling: failed to get hash
+
+    *prepared_key_out = (key_store_prepared_key){ key, key_len, key_hash };
+    return 0;
+}
+
+
+int store_prepare_key_with_hash(key_store *store_ptr, const void *key, size_t key_len, uint32_t key_hash, key_store_prepared_key *prepared_key_out)
+{
+    if (store_ptr == NULL || key == NULL || key_len == 0 || key_len > KEY_STORE_MAX_KEY_SIZE || prepared_key_out == NULL) return -20; // Error handling: invalid input
+
+#ifndef NDEBUG
+    // A hash that differs from the store's own would file the key under the wrong bucket and shard
+    uint32_t expected_hash;
+    if (_get_key_hash(store_ptr, key, key_len, &expected_hash) != 0 || expected_hash != key_hash) return -20; // Error handling: wrong key hash
+#endif
+
+    *prepared_key_out = (key_store_prepared_key){ key, key_len, key_hash };
+    return 0;
+}
+
+
+int store_set_prepared_key(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_value* value)
+{
+    if (store_ptr == NULL || value == NULL || value->data == NULL || value->data_size == 0 || !_is_prepared_key_valid(prepared_key)) return -20; // Error handling: invalid input
+
+    key_store_shard *shard_ptr = _get_shard(store_ptr, prepared_key->key_hash);
+    if (shard_ptr == NULL) return -40; // Error handling: key store not initialized
+
+    unsigned long long start_ns = start_latency_timer();
+    int result = (store_ptr->engine == KEY_STORE_ENGINE_SWISS) ? upsert_node_to_swiss_table(&shard_ptr->swiss, prepared_key->key, prepared_key->key_len, prepared_key->key_hash, value) : upsert_node_to_bucket(&shard_ptr->buckets, prepared_key->key, prepared_key->key_len, prepared_key->key_hash, value);
+    record_latency_since(store_ptr->latency_histograms, KEY_STORE_LATENCY_SET, start_ns);
+    return result;
+}
+
+
+int store_get_prepared_key(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_value *value_out)
+{
+    if (store_ptr == NULL || !_is_prepared_key_valid(prepared_key)) return -20; // Error handling: invalid input
+
+    key_store_shard *shard_ptr = _get_shard(store_ptr, prepared_key->key_hash);
+    if (shard_ptr == NULL) return -40; // Error handling: key store not initialized
+
+    unsigned long long start_ns = start_latency_timer();
+    int result = (store_ptr->engine == KEY_STORE_ENGINE_SWISS) ? find_node_in_swiss_table(&shard_ptr->swiss, prepared_key->key, prepared_key->key_len, prepared_key->key_hash, value_out) : find_node_in_bucket(&shard_ptr->buckets, prepared_key->key, prepared_key->key_len, prepared_key->key_hash, value_out);
+    record_latency_since(store_ptr->latency_histograms, KEY_STORE_LATENCY_GET, start_ns);
+    return result;
+}
+
+
+int store_delete_prepared_key(key_store *store_ptr, const key_store_prepared_key *prepared_key)
+{
+    if (store_ptr == NULL || !_is_prepared_key_valid(prepared_key)) return -20; // Error handling: invalid input
+
+    key_store_shard *shard_ptr = _get_shard(store_ptr, prepared_key->key_hash);
+    if (shard_ptr == NULL) return -40; // Error handling: key store not initialized
+
+    unsigned long long start_ns = start_latency_timer();
+    int result = (store_ptr->engine == KEY_STORE_ENGINE_SWISS) ? delete_node_from_swiss_table(&shard_ptr->swiss, prepared_key->key, prepared_key->key_len, prepared_key->key_hash) : delete_node_from_bucket(&shard_ptr->buckets, prepared_key->key, prepared_key->key_len, prepared_key->key_hash);
+    record_latency_since(store_ptr->latency_histograms, KEY_STORE_LATENCY_DELETE, start_ns);
+    return result;
+}
+
+
+int store_get_key_view(key_store *store_ptr, const char *key, key_store_view_callback callback, void *context)
+{
+    if (key == NULL) return -20; // Error handling: invalid input
+
+    return store_get_key_view_n(store_ptr, key, strlen(key), callback, context);
+}
+
+
+int store_get_key_view_n(key_store *store_ptr, const void *key, size_t key_len, key_store_view_callback callback, void *context)
+{
+    key_store_prepared_key prepared_key;
+    int prepare_result = store_prepare_key(store_ptr, key, key_len, &prepared_key);
+    if (prepare_result != 0) return prepare_result; // Error handling: invalid key or failed to get hash
+
+    return store_get_prepared_key_view(store_ptr, &prepared_key, callback, context);
+}
+
+
+int store_get_prepared_key_view(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_view_callback callback, void *context)
+{
+    if (store_ptr == NULL || callback == NULL || !_is_prepared_key_valid(prepared_key)) return -20; // Error handling: invalid input
+
+    return _view_prepared_key(store_ptr, prepared_key, callback, context, NULL);
+}
+
+
+int store_get_key_into(key_store *store_ptr, const char *key, void *buffer, size_t buffer_capacity, size_t *value_size_out)
+{
+    if (key == NULL) return -20; // Error handling: invalid input
+
+    return store_get_key_into_n(store_ptr, key, strlen(key), buffer, buffer_capacity, value_size_out);
+}
+
+
+int store_get_key_into_n(key_store *store_ptr, const void *key, size_t key_len, void *buffer, size_t buffer_capacity, size_t *value_size_out)
+{
+    key_store_prepared_key prepared_key;
+    int prepare_result = store_prepare_key(store_ptr, key, key_len, &prepared_key);
+    if (prepare_result != 0) return prepare_result; // Error handling: invalid key or failed to get hash
+
+    return store_get_prepared_key_into(store_ptr, &prepared_key, buffer, buffer_capacity, value_size_out);
+}
+
+
+int store_get_prepared_key_into(key_store *store_ptr, const key_store_prepared_key *prepared_key, void *buffer, size_t buffer_capacity, size_t *value_size_out)
+{
+    if (value_size_out == NULL || (buffer == NULL && buffer_capacity != 0)) return -20; // Error handling: invalid input
+
+    key_store_copy_context copy_context = { buffer, buffer_capacity, value_size_out };
+    return store_get_prepared_key_view(store_ptr, prepared_key, _copy_value_into, &copy_context);
+}
+
 
-#pragma endregion
+int store_exists_key(key_store *store_ptr, const char *key)
+{
+    size_t value_size;
+    return store_get_value_size(store_ptr, key, &value_size);
+}
 
 
-#pragma region Private Function Declarations
-static uint32_t _generate_hash_seed(void);
-static int _get_bucket_index(uint32_t key_hash);
-static int _get_hash_and_index(const char *key, uint32_t *key_hash_out, unsigned int *index_out);
+int store_exists_key_n(key_store *store_ptr, const void *key, size_t key_len)
+{
+    size_t value_size;
+    return store_get_value_size_n(store_ptr, key, key_len, &value_size);
+}
 
-#pragma endregion
 
-#pragma region Public Function Definitions
-int initialise_key_store(unsigned int bucket_size, double pre_memory_allocation_factor, bool is_concurrency_enabled) 
-{ 
-    if(bucket_size == 0 || pre_memory_allocation_factor < 0 || pre_memory_allocation_factor > 1) return -21; // Error handling: Invalid parameters
+int store_get_value_size(key_store *store_ptr, const char *key, size_t *value_size_out)
+{
+    if (value_size_out == NULL) return -20; // Error handling: invalid input
+
+    return store_get_key_view(store_ptr, key, _read_value_size, value_size_out);
+}
+
+
+int store_get_value_size_n(key_store *store_ptr, const void *key, size_t key_len, size_t *value_size_out)
+{
+    if (value_size_out == NULL) return -20; // Error handling: invalid input
+
+    return store_get_key_view_n(store_ptr, key, key_len, _read_value_size, value_size_out);
+}
 
-    int hb_init_result = initialise_hash_buckets(bucket_size, is_concurrency_enabled);
-    if(hb_init_result != 0)  return hb_init_result; // Error handling: Failed to initialize hash buckets
 
-    memory_manager_config config = {bucket_size, pre_memory_allocation_factor, true, false, is_concurrency_enabled};
+int store_get_keys(key_store *store_ptr, const char *const *keys, size_t key_count, key_store_value *values_out, int *results_out)
+{
+    if (store_ptr == NULL || keys == NULL || values_out == NULL || results_out == NULL) return -20; // Error handling: invalid input
+
+    int first_error = 0;
+    for (size_t group_start = 0; group_start < key_count; group_start += KEY_STORE_BATCH_GROUP_SIZE) {
+        size_t group_size = (key_count - group_start < KEY_STORE_BATCH_GROUP_SIZE) ? key_count - group_start : KEY_STORE_BATCH_GROUP_SIZE;
+        key_store_prepared_key prepared_keys[KEY_STORE_BATCH_GROUP_SIZE];
 
-    int memory_init_result = initialize_memory_manager(config);
-    if(memory_init_result != 0) {
-        cleanup_hash_buckets();
-        return memory_init_result; // Error handling: Failed to initialize memory manager
+        // Every key of the group is hashed before the first bucket is touched
+        for (size_t i = 0; i < group_size; ++i) {
+            const char *key = keys[group_start + i];
+            results_out[group_start + i] = (key != NULL) ? store_prepare_key(store_ptr, key, strlen(key), &prepared_keys[i]) : -20;
+        }
+
+        int result = _run_batch(store_ptr, false, prepared_keys, group_size, &values_out[group_start], &results_out[group_start]);
+        if (first_error == 0) first_error = result;
     }
+    return first_error;
+}
 
-    g_hash_seed = _generate_hash_seed();
-    g_bucket_size = bucket_size;
-    return 0;
+
+int store_set_keys(key_store *store_ptr, const char *const *keys, size_t key_count, key_store_value *values, int *results_out)
+{
+    if (store_ptr == NULL || keys == NULL || values == NULL || results_out == NULL) return -20; // Error handling: invalid input
+
+    int first_error = 0;
+    for (size_t group_start = 0; group_start < key_count; group_start += KEY_STORE_BATCH_GROUP_SIZE) {
+        size_t group_size = (key_count - group_start < KEY_STORE_BATCH_GROUP_SIZE) ? key_count - group_start : KEY_STORE_BATCH_GROUP_SIZE;
+        key_store_prepared_key prepared_keys[KEY_STORE_BATCH_GROUP_SIZE];
+
+        for (size_t i = 0; i < group_size; ++i) {
+            const char *key = keys[group_start + i];
+            const key_store_value *value = &values[group_start + i];
+            bool is_valid = (key != NULL && value->data != NULL && value->data_size != 0);
+            results_out[group_start + i] = is_valid ? store_prepare_key(store_ptr, key, strlen(key), &prepared_keys[i]) : -20;
+        }
+
+        int result = _run_batch(store_ptr, true, prepared_keys, group_size, &values[group_start], &results_out[group_start]);
+        if (first_error == 0) first_error = result;
+    }
+    return first_error;
 }
 
 
-int cleanup_key_store(void) 
+int store_get_prepared_keys(key_store *store_ptr, const key_store_prepared_key *prepared_keys, size_t key_count, key_store_value *values_out, int *results_out)
 {
-    cleanup_hash_buckets();
-    cleanup_memory_manager();
-    g_hash_seed = 0;
-    return 0;
+    if (store_ptr == NULL || prepared_keys == NULL || values_out == NULL || results_out == NULL) return -20; // Error handling: invalid input
+
+    int first_error = 0;
+    for (size_t group_start = 0; group_start < key_count; group_start += KEY_STORE_BATCH_GROUP_SIZE) {
+        size_t group_size = (key_count - group_start < KEY_STORE_BATCH_GROUP_SIZE) ? key_count - group_start : KEY_STORE_BATCH_GROUP_SIZE;
+        for (size_t i = 0; i < group_size; ++i) {
+            results_out[group_start + i] = _is_prepared_key_valid(&prepared_keys[group_start + i]) ? 0 : -20;
+        }
+
+        int result = _run_batch(store_ptr, false, &prepared_keys[group_start], group_size, &values_out[group_start], &results_out[group_start]);
+        if (first_error == 0) first_error = result;
+    }
+    return first_error;
 }
 
 
-int set_key(const char *key, key_store_value* value) 
+int store_set_prepared_keys(key_store *store_ptr, const key_store_prepared_key *prepared_keys, size_t key_count, key_store_value *values, int *results_out)
 {
-    if (value == NULL || value->data == NULL || value->data_size == 0 || key == NULL || key[0] == '\0') return -20; // Error handling: invalid input
+    if (store_ptr == NULL || prepared_keys == NULL || values == NULL || results_out == NULL) return -20; // Error handling: invalid input
 
-    uint32_t key_hash;
-    unsigned int index;
+    int first_error = 0;
+    for (size_t group_start = 0; group_start < key_count; group_start += KEY_STORE_BATCH_GROUP_SIZE) {
+        size_t group_size = (key_count - group_start < KEY_STORE_BATCH_GROUP_SIZE) ? key_count - group_start : KEY_STORE_BATCH_GROUP_SIZE;
+        for (size_t i = 0; i < group_size; ++i) {
+            const key_store_value *value = &values[group_start + i];
+            bool is_valid = (value->data != NULL && value->data_size != 0 && _is_prepared_key_valid(&prepared_keys[group_start + i]));
+            results_out[group_start + i] = is_valid ? 0 : -20;
+        }
+
+        int result = _run_batch(store_ptr, true, &prepared_keys[group_start], group_size, &values[group_start], &results_out[group_start]);
+        if (first_error == 0) first_error = result;
+    }
+    return first_error;
+}
 
-    int get_hash_result = _get_hash_and_index(key, &key_hash, &index);
-    if (get_hash_result != 0) return get_hash_result; // Error handling: failed to get hash and index
+int store_update_key_with(key_store *store_ptr, const char *key, key_store_update_callback callback, void *context)
+{
+    if (key == NULL) return -20; // Error handling: invalid input
 
-    return upsert_node_to_bucket(index, key, key_hash, value);
+    return store_update_key_with_n(store_ptr, key, strlen(key), callback, context);
 }
 
 
-int get_key(const char *key, key_store_value *value_out) 
+int store_update_key_with_n(key_store *store_ptr, const void *key, size_t key_len, key_store_update_callback callback, void *context)
 {
-    if (key == NULL || key[0] == '\0') return -20; // Error handling: invalid input
+    key_store_prepared_key prepared_key;
+    int prepare_result = store_prepare_key(store_ptr, key, key_len, &prepared_key);
+    if (prepare_result != 0) return prepare_result; // Error handling: invalid key or failed to get hash
 
-    uint32_t key_hash;
-    unsigned int index;
-   
-    int get_hash_result = _get_hash_and_index(key, &key_hash, &index);
-    if (get_hash_result != 0) return get_hash_result; // Error handling: failed to get hash and index
+    return store_update_prepared_key_with(store_ptr, &prepared_key, callback, context);
+}
+
+
+int store_update_prepared_key_with(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_update_callback callback, void *context)
+{
+    if (store_ptr == NULL || callback == NULL || !_is_prepared_key_valid(prepared_key)) return -20; // Error handling: invalid input
 
-    return find_node_in_bucket(index, key, key_hash, value_out);
+    key_store_shard *shard_ptr = _get_shard(store_ptr, prepared_key->key_hash);
+    if (shard_ptr == NULL) return -40; // Error handling: key store not initialized
+
+    return (store_ptr->engine == KEY_STORE_ENGINE_SWISS) ? update_node_in_swiss_table(&shard_ptr->swiss, prepared_key->key, prepared_key->key_len, prepared_key->key_hash, callback, context) : update_node_in_bucket(&shard_ptr->buckets, prepared_key->key, prepared_key->key_len, prepared_key->key_hash, callback, context);
 }
 
 
-int delete_key(const char *key) 
-{    
-    if (key == NULL || key[0] == '\0') return -20; // Error handling: invalid input
+int store_incr_key(key_store *store_ptr, const char *key, int64_t delta, int64_t *value_out)
+{
+    key_store_counter_context counter_context = { .delta = delta };
+    int result = store_update_key_with(store_ptr, key, _apply_increment, &counter_context);
+    if (result == 0 && value_out != NULL) *value_out = counter_context.value;
+    return result;
+}
 
-    uint32_t key_hash;
-    unsigned int index;
-    int get_hash_result = _get_hash_and_index(key, &key_hash, &index);
-    if (get_hash_result != 0) return get_hash_result; // Error handling: failed to get hash and index
 
-    return delete_node_from_bucket(index, key, key_hash);
+int store_decr_key(key_store *store_ptr, const char *key, int64_t delta, int64_t *value_out)
+{
+    return store_incr_key(store_ptr, key, (int64_t)(0 - (uint64_t)delta), value_out); // Negated without overflowing on INT64_MIN
 }
 
-keystore_stats get_keystore_stats(void) 
+
+int store_append_key(key_store *store_ptr, const char *key, const key_store_value *suffix)
+{
+    if (!_is_value_valid(suffix)) return -20; // Error handling: invalid input
+
+    key_store_concat_context concat_context = { suffix, false, NULL };
+    int result = store_update_key_with(store_ptr, key, _apply_concat, &concat_context);
+    free(concat_context.buffer);
+    return result;
+}
+
+
+int store_prepend_key(key_store *store_ptr, const char *key, const key_store_value *prefix)
+{
+    if (!_is_value_valid(prefix)) return -20; // Error handling: invalid input
+
+    key_store_concat_context concat_context = { prefix, true, NULL };
+    int result = store_update_key_with(store_ptr, key, _apply_concat, &concat_context);
+    free(concat_context.buffer);
+    return result;
+}
+
+
+int store_compare_and_swap_key(key_store *store_ptr, const char *key, const key_store_value *expected, key_store_value *new_value)
+{
+    if (!_is_value_valid(expected) || !_is_value_valid(new_value)) return -20; // Error handling: invalid input
+
+    key_store_compare_context compare_context = { .expected = expected, .new_value = new_value };
+    return store_update_key_with(store_ptr, key, _apply_compare, &compare_context);
+}
+
+
+int store_get_key_versioned(key_store *store_ptr, const char *key, key_store_value *value_out, uint32_t *version_out)
+{
+    if (key == NULL || version_out == NULL) return -20; // Error handling: invalid input
+
+    key_store_prepared_key prepared_key;
+    int result = store_prepare_key(store_ptr, key, strlen(key), &prepared_key);
+    if (result != 0) return result; // Error handling: invalid key or failed to get hash
+
+    key_store_versioned_read_context read_context = { .is_copied = (value_out != NULL) };
+    result = _view_prepared_key(store_ptr, &prepared_key, _read_versioned, &read_context, version_out);
+    if (result == 0 && value_out != NULL) *value_out = read_context.copy;
+    else free(read_context.copy.data);
+    return result;
+}
+
+
+int store_compare_version_and_set_key(key_store *store_ptr, const char *key, uint32_t expected_version, key_store_value *value, uint32_t *new_version_out)
+{
+    if (!_is_value_valid(value)) return -20; // Error handling: invalid input
+
+    key_store_compare_context compare_context = { .expected = NULL, .expected_version = expected_version, .new_value = value };
+    int result = store_update_key_with(store_ptr, key, _apply_compare, &compare_context);
+    if (result == 0 && new_version_out != NULL) *new_version_out = compare_context.new_version;
+    return result;
+}
+
+keystore_stats store_get_keystore_stats(key_store *store_ptr) 
 {
     keystore_stats stats = {0};
-    get_hash_bucket_pool_stats(&stats);
+    if (store_ptr == NULL || !store_ptr->is_initialized) return stats;
+
+    for (unsigned int i = 0; i < store_ptr->shard_count; ++i) {
+        keystore_stats shard_stats = {0};
+        if (store_ptr->engine == KEY_STORE_ENGINE_SWISS) get_swiss_table_stats(&store_ptr->shards[i].swiss, &shard_stats);
+        else get_hash_bucket_pool_stats(&store_ptr->shards[i].buckets, &shard_stats);
+
+        if (i == 0) stats = shard_stats;
+        else _merge_shard_stats(&stats, &shard_stats);
+    }
+    summarize_latency_histograms(store_ptr->latency_histograms, &stats.latency);
+    stats.data_node_counters.avg_read_latency_ns = stats.latency.get.mean_ns; // Gets are timed once, data node reads are not timed separately
     return stats;
 }
 
+
+int store_set_thread_home_shard(key_store *store_ptr, unsigned int shard_index)
+{
+    if (store_ptr == NULL) return -20; // Error handling: invalid input
+    if (!store_ptr->is_initialized) return -40; // Error handling: key store not initialized
+    if (!store_ptr->is_thread_affinity_enabled) return -43; // Error handling: keys are routed by hash
+    if (shard_index >= store_ptr->shard_count) return -20; // Error handling: shard out of range
+
+    return pthread_setspecific(store_ptr->home_shard_key, (void *)(uintptr_t)(shard_index + 1)) == 0 ? 0 : -10;
+}
+
 #pragma endregion
 
 #pragma region Private Function Definitions
@@ -123,52 +827,541 @@ uint32_t _generate_hash_seed(void)
 
 
 /**
- * @fn get_bucket_index
- * @brief Computes the bucket index for a given key hash.
+ * @fn _get_key_hash
+ * @brief Computes the hash of a key with the keystore's seed.
+ *
+ * The bucket index is not derived here: the hash bucket module resolves it against
+ * its current table, which may change size while an incremental resize is in progress.
+ *
+ * @param store_ptr Pointer to the key store instance, whose seed is used.
+ * @param key The key bytes to hash.
+ * @param key_len Length of the key in bytes.
+ * @param key_hash_out Pointer to receive the computed hash.
+ * @return 0 on success, -20 on invalid output pointer, -70 if hashing failed.
+ */
+int _get_key_hash(const key_store *store_ptr, const void *key, size_t key_len, uint32_t *key_hash_out) 
+{
+    if (key_hash_out == NULL) return -20; // Handle error: invalid output pointer
+
+    uint32_t key_hash = hash_function_murmur_32(key, key_len, store_ptr->hash_seed);
+
+    if(key_hash == UINT32_MAX) return -70; // Handle error: hash function failed
+
+    *key_hash_out = key_hash;
+    return 0;
+}
+
+/**
+ * @fn _is_prepared_key_valid
+ * @brief Checks that a prepared key references a key of a valid length.
+ * @param prepared_key Pointer to the prepared key.
+ * @return true if the prepared key can be used, false otherwise.
+ */
+static bool _is_prepared_key_valid(const key_store_prepared_key *prepared_key)
+{
+    return prepared_key != NULL && prepared_key->key != NULL && prepared_key->key_len != 0 && prepared_key->key_len <= KEY_STORE_MAX_KEY_SIZE;
+}
+
+/**
+ * @fn _initialise_key_store
+ * @brief Validates the configuration and initializes the latency histograms, the epoch manager and the shards of an instance.
+ *
+ * @param store_ptr Pointer to the zero-initialized key store instance.
+ * @param config The key_store_config structure containing initialization parameters.
+ * @return 0 on success (or if the instance is already initialized), or a negative error code on failure.
+ */
+static int _initialise_key_store(key_store *store_ptr, const key_store_config config)
+{
+    if(config.bucket_size == 0 || config.pre_memory_allocation_factor < 0 || config.pre_memory_allocation_factor > 1) return -21; // Error handling: Invalid parameters
+    if(config.is_lock_free_read_enabled && !config.is_concurrency_enabled) return -21; // Error handling: Lock-free reads require concurrency
+    if(config.engine != KEY_STORE_ENGINE_CHAINED && config.engine != KEY_STORE_ENGINE_SWISS) return -21; // Error handling: Unknown engine
+    if(config.engine == KEY_STORE_ENGINE_SWISS && config.is_lock_free_read_enabled) return -21; // Error handling: Lock-free reads are only supported by the chained engine
+    if(config.inline_value_threshold > DATA_NODE_MAX_INLINE_VALUE_SIZE) return -21; // Error handling: Inline values are limited in size
+    if(config.node_sync != KEY_STORE_NODE_SYNC_MUTEX && config.node_sync != KEY_STORE_NODE_SYNC_SEQLOCK) return -21; // Error handling: Unknown node synchronization
+    if(config.node_sync == KEY_STORE_NODE_SYNC_SEQLOCK && !config.is_concurrency_enabled) return -21; // Error handling: Seqlock nodes only guard concurrent readers
+    if(config.bucket_lock != KEY_STORE_BUCKET_LOCK_RWLOCK && config.bucket_lock != KEY_STORE_BUCKET_LOCK_SPIN && config.bucket_lock != KEY_STORE_BUCKET_LOCK_TICKET) return -21; // Error handling: Unknown bucket lock
+    if(config.bucket_lock != KEY_STORE_BUCKET_LOCK_RWLOCK && (!config.is_concurrency_enabled || config.engine == KEY_STORE_ENGINE_SWISS)) return -21; // Error handling: Bucket locks only exist in the concurrent chained engine
+    if(config.bucket_lock_stripes != 0 && (!config.is_concurrency_enabled || config.engine == KEY_STORE_ENGINE_SWISS)) return -21; // Error handling: Bucket locks only exist in the concurrent chained engine
+    if(config.bucket_lock_stripes > KEY_STORE_MAX_BUCKET_LOCK_STRIPES || (config.bucket_lock_stripes & (config.bucket_lock_stripes - 1)) != 0) return -21; // Error handling: Stripe count must be a power of two
+    if(config.shard_count > KEY_STORE_MAX_SHARD_COUNT || (config.shard_count & (config.shard_count - 1)) != 0) return -21; // Error handling: Shard count must be a power of two
+
+    if(store_ptr->is_initialized) return 0; // Already initialized
+
+    unsigned int shard_count = (config.shard_count > 1) ? config.shard_count : 1;
+    unsigned int shard_bits = 0;
+    while ((1u << shard_bits) < shard_count) shard_bits++;
+
+    store_ptr->shards = aligned_alloc(KEY_STORE_CACHE_LINE_SIZE, shard_count * sizeof(key_store_shard));
+    if(store_ptr->shards == NULL) return -10; // Error handling: Failed to allocate the shards
+    memset(store_ptr->shards, 0, shard_count * sizeof(key_store_shard));
+
+    if(OPERATION_COUNTERS_ENABLED) {
+        store_ptr->latency_histograms = aligned_alloc(KEY_STORE_CACHE_LINE_SIZE, sizeof(sharded_latency_histograms));
+        if(store_ptr->latency_histograms == NULL) {
+            free(store_ptr->shards);
+            store_ptr->shards = NULL;
+            return -10; // Error handling: Failed to allocate the latency histograms
+        }
+        memset(store_ptr->latency_histograms, 0, sizeof(sharded_latency_histograms));
+    }
+
+    int epoch_init_result = config.is_lock_free_read_enabled ? initialize_epoch_manager(&store_ptr->epoch) : 0;
+    if(epoch_init_result == 0 && config.is_thread_affinity_enabled && pthread_key_create(&store_ptr->home_shard_key, NULL) != 0) {
+        cleanup_epoch_manager(&store_ptr->epoch);
+        epoch_init_result = -11; // Error handling: Failed to create the home shard key
+    }
+    if(epoch_init_result != 0) {
+        free(store_ptr->latency_histograms);
+        free(store_ptr->shards);
+        *store_ptr = (key_store){0};
+        return epoch_init_result; // Error handling: Failed to initialize epoch manager
+    }
+
+    // The initial buckets are split between the shards, so sharding does not change the pre-allocated memory
+    key_store_config shard_config = config;
+    shard_config.bucket_size = (config.bucket_size > shard_count) ? config.bucket_size / shard_count : 1;
+
+    for (unsigned int i = 0; i < shard_count; ++i) {
+        int shard_init_result = _initialise_shard(store_ptr, &store_ptr->shards[i], shard_config);
+        if(shard_init_result != 0) {
+            _cleanup_shards(store_ptr, i);
+            if(config.is_thread_affinity_enabled) pthread_key_delete(store_ptr->home_shard_key);
+            free(store_ptr->latency_histograms);
+            free(store_ptr->shards);
+            *store_ptr = (key_store){0};
+            return shard_init_result; // Error handling: Failed to initialize a shard
+        }
+    }
+
+    store_ptr->engine = config.engine;
+    store_ptr->hash_seed = (config.hash_seed != 0) ? config.hash_seed : _generate_hash_seed();
+    store_ptr->shard_count = shard_count;
+    store_ptr->shard_shift = 32 - shard_bits;
+    store_ptr->is_thread_affinity_enabled = config.is_thread_affinity_enabled;
+    atomic_store(&store_ptr->next_home_shard, 0);
+    store_ptr->is_initialized = true;
+    return 0;
+}
+
+/**
+ * @fn _initialise_shard
+ * @brief Initializes the memory manager and the table engine of one shard.
+ *
+ * @param store_ptr Pointer to the key store instance whose epoch manager is already initialized.
+ * @param shard_ptr Pointer to the zeroed shard.
+ * @param config The configuration of the shard, with the bucket size of one shard.
+ * @return 0 on success, or a negative error code on failure (the shard is cleaned up again).
+ */
+static int _initialise_shard(key_store *store_ptr, key_store_shard *shard_ptr, const key_store_config config)
+{
+    // List buckets chain data nodes directly, only treeified buckets need a node pool. The swiss engine needs neither
+    bool is_chained = (config.engine == KEY_STORE_ENGINE_CHAINED);
+    memory_manager_config memory_config = {config.bucket_size, config.pre_memory_allocation_factor, is_chained && config.treeify_threshold > 0, config.is_concurrency_enabled, true};
+
+    int memory_init_result = initialize_memory_manager(&shard_ptr->memory, memory_config);
+    if(memory_init_result != 0) return memory_init_result; // Error handling: Failed to initialize memory manager
+
+    int engine_init_result = is_chained ? _initialise_chained_engine(store_ptr, shard_ptr, config) : initialise_swiss_table(&shard_ptr->swiss, config.bucket_size, config.is_concurrency_enabled, &shard_ptr->memory);
+    if(engine_init_result == 0 && !is_chained) engine_init_result = configure_swiss_table_inline_values(&shard_ptr->swiss, config.inline_value_threshold);
+    if(engine_init_result == 0 && !is_chained && config.node_sync == KEY_STORE_NODE_SYNC_SEQLOCK) engine_init_result = configure_swiss_table_node_sync(&shard_ptr->swiss, DATA_NODE_SYNC_SEQLOCK);
+    if(engine_init_result == 0 && !is_chained) engine_init_result = configure_swiss_table_latency_histograms(&shard_ptr->swiss, store_ptr->latency_histograms);
+    if(engine_init_result != 0) {
+        cleanup_swiss_table(&shard_ptr->swiss);
+        cleanup_memory_manager(&shard_ptr->memory);
+        return engine_init_result; // Error handling: Failed to initialize the table engine
+    }
+
+    return 0;
+}
+
+/**
+ * @fn _initialise_chained_engine
+ * @brief Initializes the hash buckets of a shard and applies the resize, treeify and read path configuration.
+ *
+ * @param store_ptr Pointer to the key store instance whose epoch manager is already initialized.
+ * @param shard_ptr Pointer to the shard whose memory manager is already initialized.
+ * @param config The key_store_config structure containing initialization parameters.
+ * @return 0 on success, or a negative error code on failure (the buckets are cleaned up again).
+ */
+static int _initialise_chained_engine(key_store *store_ptr, key_store_shard *shard_ptr, const key_store_config config)
+{
+    hash_bucket_memory_pool *pool_ptr = &shard_ptr->buckets;
+
+    bucket_lock_type_t lock_type = (config.bucket_lock == KEY_STORE_BUCKET_LOCK_SPIN) ? BUCKET_LOCK_SPIN : (config.bucket_lock == KEY_STORE_BUCKET_LOCK_TICKET) ? BUCKET_LOCK_TICKET : BUCKET_LOCK_RWLOCK;
+    bucket_lock_config lock_config = { lock_type, config.bucket_lock_stripes };
+
+    int hb_init_result = initialise_hash_buckets_with_lock_config(pool_ptr, config.bucket_size, config.is_concurrency_enabled, lock_config, &shard_ptr->memory);
+    if(hb_init_result != 0)  return hb_init_result; // Error handling: Failed to initialize hash buckets
+
+    int config_result = configure_hash_bucket_resize(pool_ptr, config.grow_load_factor, config.shrink_load_factor);
+    if(config_result == 0) config_result = configure_hash_bucket_tree(pool_ptr, config.treeify_threshold);
+    if(config_result == 0) config_result = configure_hash_bucket_lock_free_read(pool_ptr, config.is_lock_free_read_enabled ? &store_ptr->epoch : NULL);
+    if(config_result == 0) config_result = configure_hash_bucket_inline_values(pool_ptr, config.inline_value_threshold);
+    if(config_result == 0 && config.node_sync == KEY_STORE_NODE_SYNC_SEQLOCK) config_result = configure_hash_bucket_node_sync(pool_ptr, DATA_NODE_SYNC_SEQLOCK);
+    if(config_result == 0) config_result = configure_hash_bucket_latency_histograms(pool_ptr, store_ptr->latency_histograms);
+    if(config_result != 0) {
+        cleanup_hash_buckets(pool_ptr);
+        return config_result; // Error handling: Invalid resize, treeify, read path, inline value or node sync configuration
+    }
+
+    return 0;
+}
+
+/**
+ * @fn _cleanup_shards
+ * @brief Releases the tables, then the retired nodes, then the memory managers of the first shards of an instance.
+ *
+ * @param store_ptr Pointer to the key store instance.
+ * @param shard_count Number of initialized shards to release.
+ */
+static void _cleanup_shards(key_store *store_ptr, unsigned int shard_count)
+{
+    for (unsigned int i = 0; i < shard_count; ++i) {
+        cleanup_hash_buckets(&store_ptr->shards[i].buckets);
+        cleanup_swiss_table(&store_ptr->shards[i].swiss);
+    }
+
+    cleanup_epoch_manager(&store_ptr->epoch); // Reclaims retired nodes, so it must run before their memory pools are released
+
+    for (unsigned int i = 0; i < shard_count; ++i) {
+        cleanup_memory_manager(&store_ptr->shards[i].memory);
+    }
+}
+
+/**
+ * @fn _cleanup_key_store
+ * @brief Releases the shards and the epoch manager of an instance and resets it.
+ *
+ * @param store_ptr Pointer to the key store instance.
+ * @return 0 on success.
+ */
+static int _cleanup_key_store(key_store *store_ptr)
+{
+    if (!store_ptr->is_initialized) return 0; // Nothing to clean up
+
+    _cleanup_shards(store_ptr, store_ptr->shard_count);
+    if (store_ptr->is_thread_affinity_enabled) pthread_key_delete(store_ptr->home_shard_key);
+    free(store_ptr->latency_histograms);
+    free(store_ptr->shards);
+    *store_ptr = (key_store){0};
+    return 0;
+}
+
+/**
+ * @fn _get_shard
+ * @brief Returns the shard an operation of the calling thread on a key runs on.
  *
- * This function uses bitwise AND to map the key_hash to a valid bucket index
- * within the range [0, g_bucket_size - 1]. If the computed index is out of bounds,
- * it returns -1 to indicate an invalid index.
+ * Keys are routed by the high bits of their hash, which are independent of the low bits
+ * that select the bucket or group inside the shard. With thread affinity, the calling
+ * thread's home shard is used instead, and assigned round-robin on its first operation.
  *
+ * @param store_ptr Pointer to the key store instance.
  * @param key_hash The hash value of the key.
- * @return The bucket index corresponding to the key_hash, or -1 if invalid.
+ * @return key_store_shard* The shard, or NULL if the instance is not initialized.
  */
-int _get_bucket_index(uint32_t key_hash) 
+static key_store_shard* _get_shard(key_store *store_ptr, uint32_t key_hash)
 {
-    unsigned int index = key_hash & (g_bucket_size - 1);
+    if (!store_ptr->is_initialized) return NULL;
+
+    if (!store_ptr->is_thread_affinity_enabled) {
+        return &store_ptr->shards[(unsigned int)((uint64_t)key_hash >> store_ptr->shard_shift)];
+    }
 
-    if(index >= g_bucket_size) {
-        index = -1;
+    uintptr_t home_shard = (uintptr_t)pthread_getspecific(store_ptr->home_shard_key);
+    if (home_shard == 0) {
+        home_shard = atomic_fetch_add(&store_ptr->next_home_shard, 1) % store_ptr->shard_count + 1;
+        pthread_setspecific(store_ptr->home_shard_key, (void *)home_shard);
     }
-    
-    return index;
+    return &store_ptr->shards[home_shard - 1];
 }
 
 /**
- * @fn _get_hash_and_index
- * @brief Generates a random seed for the hash function.
+ * @fn _merge_shard_stats
+ * @brief Adds the statistics of one more shard to the statistics of the shards merged so far.
  *
- * This function generates a random seed based on the current time.
- * The seed is used to initialize the hash function to ensure different
- * hash distributions across different runs of the program.
+ * Counts and counters are summed and ratios are recomputed from the sums. The standard
+ * deviation is pooled exactly from the per-shard means and deviations, while the median
+ * is approximated by the key-weighted mean of the shard medians.
  *
- * @return A 32-bit unsigned integer representing the generated hash seed.
+ * @param total_ptr Pointer to the statistics merged so far, updated in place.
+ * @param shard_stats_ptr Pointer to the statistics of the next shard.
  */
-int _get_hash_and_index(const char *key, uint32_t *key_hash_out, unsigned int *index_out) 
+static void _merge_shard_stats(keystore_stats *total_ptr, const keystore_stats *shard_stats_ptr)
 {
-    if ( key_hash_out == NULL || index_out == NULL) return -20; // Handle error: invalid output pointers
+    key_entry_stats *entries = &total_ptr->key_entries;
+    const key_entry_stats *shard_entries = &shard_stats_ptr->key_entries;
 
-    uint32_t key_hash = hash_function_murmur_32(key, g_hash_seed);
+    unsigned int nonempty_buckets = entries->nonempty_buckets + shard_entries->nonempty_buckets;
+    unsigned int total_keys = entries->total_keys + shard_entries->total_keys;
+    double mean = (nonempty_buckets > 0) ? (double)total_keys / nonempty_buckets : 0.0;
+    double total_deviation = entries->avg_keys_per_nonempty_bucket - mean;
+    double shard_deviation = shard_entries->avg_keys_per_nonempty_bucket - mean;
+    double pooled_variance = (nonempty_buckets > 0) ? (entries->nonempty_buckets * (entries->stddev_keys_per_bucket * entries->stddev_keys_per_bucket + total_deviation * total_deviation)
+                            + shard_entries->nonempty_buckets * (shard_entries->stddev_keys_per_bucket * shard_entries->stddev_keys_per_bucket + shard_deviation * shard_deviation)) / nonempty_buckets : 0.0;
 
-    if(key_hash == UINT32_MAX) return -70; // Handle error: hash function failed
+    entries->median_keys_per_bucket = (nonempty_buckets > 0) ? (entries->median_keys_per_bucket * entries->nonempty_buckets + shard_entries->median_keys_per_bucket * shard_entries->nonempty_buckets) / nonempty_buckets : 0.0;
+    entries->stddev_keys_per_bucket = sqrt(pooled_variance);
+    if (shard_entries->nonempty_buckets > 0 && (entries->nonempty_buckets == 0 || shard_entries->min_keys_in_bucket < entries->min_keys_in_bucket)) entries->min_keys_in_bucket = shard_entries->min_keys_in_bucket;
+    if (shard_entries->max_keys_in_bucket > entries->max_keys_in_bucket) entries->max_keys_in_bucket = shard_entries->max_keys_in_bucket;
+    entries->total_keys = total_keys;
+    entries->total_buckets += shard_entries->total_buckets;
+    entries->nonempty_buckets = nonempty_buckets;
+    entries->empty_buckets += shard_entries->empty_buckets;
+    entries->avg_keys_per_nonempty_bucket = mean;
+    entries->avg_collisions_per_nonempty_bucket = (nonempty_buckets > 0) ? (double)(total_keys - nonempty_buckets) / nonempty_buckets : 0.0;
+    entries->empty_bucket_percent = (entries->total_buckets > 0) ? (double)entries->empty_buckets / entries->total_buckets * 100.0 : 0.0;
+
+    key_collision_stats *collisions = &total_ptr->collisions;
+    const key_collision_stats *shard_collisions = &shard_stats_ptr->collisions;
+    unsigned int collision_buckets = collisions->collision_buckets + shard_collisions->collision_buckets;
+    collisions->avg_collisions_per_nonempty_bucket = (collision_buckets > 0) ? (collisions->avg_collisions_per_nonempty_bucket * collisions->collision_buckets + shard_collisions->avg_collisions_per_nonempty_bucket * shard_collisions->collision_buckets) / collision_buckets : 0.0;
+    collisions->collision_buckets = collision_buckets;
+    collisions->collision_percent = (entries->total_buckets > 0) ? (double)collision_buckets / entries->total_buckets * 100.0 : 0.0;
+    if (shard_collisions->highest_collision_in_bucket > collisions->highest_collision_in_bucket) collisions->highest_collision_in_bucket = shard_collisions->highest_collision_in_bucket;
 
-    int index = _get_bucket_index(key_hash);
+    memory_pool_stats *memory = &total_ptr->memory_pool;
+    const memory_pool_stats *shard_memory = &shard_stats_ptr->memory_pool;
+    memory->fragmentation_percent = (memory->total_memory_bytes + shard_memory->total_memory_bytes > 0) ? (memory->fragmentation_percent * memory->total_memory_bytes + shard_memory->fragmentation_percent * shard_memory->total_memory_bytes) / (memory->total_memory_bytes + shard_memory->total_memory_bytes) : 0.0;
+    memory->total_memory_bytes += shard_memory->total_memory_bytes;
+    memory->used_memory_bytes += shard_memory->used_memory_bytes;
+    memory->free_memory_bytes += shard_memory->free_memory_bytes;
+    memory->memory_utilization_percent = (memory->total_memory_bytes > 0) ? (double)memory->used_memory_bytes / memory->total_memory_bytes * 100.0 : 0.0;
+    memory->memory_per_key_bytes = (total_keys > 0) ? memory->used_memory_bytes / total_keys : 0;
+    for (unsigned int i = 0; i < MEMORY_SLAB_CLASS_COUNT; ++i) {
+        memory->slab_classes[i].block_size = shard_memory->slab_classes[i].block_size;
+        memory->slab_classes[i].total_blocks += shard_memory->slab_classes[i].total_blocks;
+        memory->slab_classes[i].used_blocks += shard_memory->slab_classes[i].used_blocks;
+        memory->slab_classes[i].cached_blocks += shard_memory->slab_classes[i].cached_blocks;
+    }
 
-    if(index < 0) return -71; // Handle error: invalid index
+    bucket_operation_counter_stats *operations = &total_ptr->operation_counters;
+    const bucket_operation_counter_stats *shard_operations = &shard_stats_ptr->operation_counters;
+    operations->total_add_ops += shard_operations->total_add_ops;
+    operations->total_find_ops += shard_operations->total_find_ops;
+    operations->total_delete_ops += shard_operations->total_delete_ops;
+    operations->failed_add_ops += shard_operations->failed_add_ops;
+    operations->failed_find_ops += shard_operations->failed_find_ops;
+    operations->failed_delete_ops += shard_operations->failed_delete_ops;
+    for (int i = 0; i < 100; ++i) operations->error_code_counters[i] += shard_operations->error_code_counters[i];
 
-    *key_hash_out = key_hash;
-    *index_out = (unsigned int)index;
+    data_node_operation_counters *nodes = &total_ptr->data_node_counters;
+    const data_node_operation_counters *shard_nodes = &shard_stats_ptr->data_node_counters;
+    nodes->total_update_ops += shard_nodes->total_update_ops;
+    nodes->total_read_ops += shard_nodes->total_read_ops;
+    nodes->total_delete_ops += shard_nodes->total_delete_ops;
+    nodes->total_create_ops += shard_nodes->total_create_ops;
+    nodes->failed_update_ops += shard_nodes->failed_update_ops;
+    nodes->failed_read_ops += shard_nodes->failed_read_ops;
+    nodes->failed_delete_ops += shard_nodes->failed_delete_ops;
+    nodes->failed_create_ops += shard_nodes->failed_create_ops;
+    nodes->read_retry_ops += shard_nodes->read_retry_ops;
+    for (int i = 0; i < 100; ++i) nodes->error_code_counters[i] += shard_nodes->error_code_counters[i];
+}
+
+
+/**
+ * @fn _run_batch
+ * @brief Runs one group of a batched get or set, handing the keys of each shard to its engine in one call.
+ *
+ * @param store_ptr Pointer to the key store instance.
+ * @param is_set true to set the values, false to read them into values.
+ * @param keys The prepared keys of the group.
+ * @param key_count Number of keys, at most KEY_STORE_BATCH_GROUP_SIZE.
+ * @param values The values to set, or the values read.
+ * @param results_out Result of each key; keys that already have a non-zero result are skipped.
+ * @return int Returns 0 if every key succeeded, otherwise the first non-zero result.
+ */
+static int _run_batch(key_store *store_ptr, bool is_set, const key_store_prepared_key *keys, size_t key_count, key_store_value *values, int *results_out)
+{
+    bool is_dispatched[KEY_STORE_BATCH_GROUP_SIZE];
+    for (size_t i = 0; i < key_count; ++i) is_dispatched[i] = (results_out[i] != 0);
+
+    for (size_t first = 0; first < key_count; ++first) {
+        if (is_dispatched[first]) continue;
+
+        key_store_shard *shard_ptr = _get_shard(store_ptr, keys[first].key_hash);
+        if (shard_ptr == NULL) {
+            results_out[first] = -40; // Error handling: key store not initialized
+            continue;
+        }
+
+        // Gather the remaining keys of the same shard, keeping their order
+        key_store_prepared_key shard_keys[KEY_STORE_BATCH_GROUP_SIZE];
+        key_store_value shard_values[KEY_STORE_BATCH_GROUP_SIZE];
+        int shard_results[KEY_STORE_BATCH_GROUP_SIZE];
+        size_t indices[KEY_STORE_BATCH_GROUP_SIZE];
+        size_t count = 0;
+        for (size_t i = first; i < key_count; ++i) {
+            if (is_dispatched[i] || _get_shard(store_ptr, keys[i].key_hash) != shard_ptr) continue;
+
+            shard_keys[count] = keys[i];
+            shard_values[count] = is_set ? values[i] : (key_store_value){0};
+            shard_results[count] = -40; // Overwritten by the engine unless the table is not initialized
+            indices[count++] = i;
+            is_dispatched[i] = true;
+        }
+
+        if (store_ptr->engine == KEY_STORE_ENGINE_SWISS) {
+            if (is_set) upsert_nodes_to_swiss_table_batch(&shard_ptr->swiss, shard_keys, count, shard_values, shard_results);
+            else find_nodes_in_swiss_table_batch(&shard_ptr->swiss, shard_keys, count, shard_values, shard_results);
+        } else {
+            if (is_set) upsert_nodes_to_bucket_batch(&shard_ptr->buckets, shard_keys, count, shard_values, shard_results);
+            else find_nodes_in_bucket_batch(&shard_ptr->buckets, shard_keys, count, shard_values, shard_results);
+        }
+
+        for (size_t j = 0; j < count; ++j) {
+            results_out[indices[j]] = shard_results[j];
+            if (!is_set) values[indices[j]] = shard_values[j];
+        }
+    }
+
+    for (size_t i = 0; i < key_count; ++i) {
+        if (results_out[i] != 0) return results_out[i];
+    }
+    return 0;
+}
+
+/**
+ * @fn _view_prepared_key
+ * @brief Runs a view callback on the value of a prepared key in the shard's table, timed as a get.
+ *
+ * @param store_ptr Handle of the instance.
+ * @param prepared_key Pointer to a valid key prepared for the instance.
+ * @param callback Function receiving the value bytes, see data_node_view_wrapper.
+ * @param context Caller context passed to the callback.
+ * @param version_out Receives the version of the value the callback saw, or NULL.
+ * @return The callback's result, -41 if the key is not found, -40 if the instance is not initialized, or a negative error code on failure.
+ */
+static int _view_prepared_key(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_view_callback callback, void *context, uint32_t *version_out)
+{
+    key_store_shard *shard_ptr = _get_shard(store_ptr, prepared_key->key_hash);
+    if (shard_ptr == NULL) return -40; // Error handling: key store not initialized
+
+    unsigned long long start_ns = start_latency_timer();
+    int result = (store_ptr->engine == KEY_STORE_ENGINE_SWISS) ? view_node_in_swiss_table(&shard_ptr->swiss, prepared_key->key, prepared_key->key_len, prepared_key->key_hash, callback, context, version_out) : view_node_in_bucket(&shard_ptr->buckets, prepared_key->key, prepared_key->key_len, prepared_key->key_hash, callback, context, version_out);
+    record_latency_since(store_ptr->latency_histograms, KEY_STORE_LATENCY_GET, start_ns);
+    return result;
+}
+
+/**
+ * @fn _copy_value_into
+ * @brief View callback copying the value into a key_store_copy_context buffer if it fits.
+ * @return 0 if the value was copied, -22 if the buffer is too small; the value size is reported either way.
+ */
+static int _copy_value_into(const unsigned char *data, size_t data_size, void *context)
+{
+    key_store_copy_context *copy_context = context;
+    *copy_context->value_size_out = data_size;
+    if (data_size > copy_context->buffer_capacity) return -22; // Error handling: buffer too small
+
+    memcpy(copy_context->buffer, data, data_size);
+    return 0;
+}
+
+/**
+ * @fn _read_value_size
+ * @brief View callback storing the value size in the size_t pointed to by context.
+ */
+static int _read_value_size(const unsigned char *data, size_t data_size, void *context)
+{
+    (void)data;
+    *(size_t *)context = data_size;
+    return 0;
+}
+
+/**
+ * @fn _apply_increment
+ * @brief Update callback adding key_store_counter_context.delta to a counter value, a missing key starts from 0.
+ * @return 0 on success, -23 if the stored value is not an int64_t.
+ */
+static int _apply_increment(const unsigned char *data, size_t data_size, uint32_t version, key_store_value *new_value_out, void *context)
+{
+    (void)version;
+    key_store_counter_context *counter_context = context;
+
+    int64_t counter = 0;
+    if (data != NULL) {
+        if (data_size != sizeof(counter)) return -23; // Error handling: the value is not a counter
+        memcpy(&counter, data, sizeof(counter));
+    }
+
+    counter_context->value = (int64_t)((uint64_t)counter + (uint64_t)counter_context->delta); // Wraps around instead of overflowing
+    memcpy(counter_context->buffer, &counter_context->value, sizeof(counter_context->value));
+    *new_value_out = (key_store_value){ counter_context->buffer, sizeof(counter_context->buffer) };
+    return 0;
+}
+
+/**
+ * @fn _apply_concat
+ * @brief Update callback appending or prepending key_store_concat_context.part to an existing value.
+ * @return 0 on success, -41 if the key is missing, -10 on allocation failure.
+ */
+static int _apply_concat(const unsigned char *data, size_t data_size, uint32_t version, key_store_value *new_value_out, void *context)
+{
+    (void)version;
+    key_store_concat_context *concat_context = context;
+    if (data == NULL) return -41; // Error handling: nothing to append to
+
+    size_t part_size = concat_context->part->data_size;
+    unsigned char *buffer = allocate_memory(data_size + part_size);
+    if (buffer == NULL) return -10; // Error handling: memory allocation failed
+
+    memcpy(buffer + (concat_context->is_prepend ? part_size : 0), data, data_size);
+    memcpy(buffer + (concat_context->is_prepend ? 0 : data_size), concat_context->part->data, part_size);
+    concat_context->buffer = buffer;
+    *new_value_out = (key_store_value){ buffer, data_size + part_size };
+    return 0;
+}
+
+/**
+ * @fn _apply_compare
+ * @brief Update callback storing key_store_compare_context.new_value if the value equals the expected bytes or has the expected version.
+ * @return 0 if the value is stored, -49 on a mismatch, -41 if the key is missing (unless version 0 was expected).
+ */
+static int _apply_compare(const unsigned char *data, size_t data_size, uint32_t version, key_store_value *new_value_out, void *context)
+{
+    key_store_compare_context *compare_context = context;
+
+    if (compare_context->expected != NULL) {
+        if (data == NULL) return -41; // Error handling: key not found
+        if (data_size != compare_context->expected->data_size || memcmp(data, compare_context->expected->data, data_size) != 0) return -49; // Error handling: compare mismatch
+    } else if (version != compare_context->expected_version) {
+        return (data == NULL) ? -41 : -49; // Error handling: key not found or updated meanwhile
+    }
+
+    compare_context->new_version = version + 1; // A new key gets version 1, an update increments it
+    *new_value_out = *compare_context->new_value;
+    return 0;
+}
+
+/**
+ * @fn _read_versioned
+ * @brief View callback copying the value into a key_store_versioned_read_context, if a copy is wanted.
+ * @return 0 on success, -10 on allocation failure.
+ */
+static int _read_versioned(const unsigned char *data, size_t data_size, void *context)
+{
+    key_store_versioned_read_context *read_context = context;
+    if (!read_context->is_copied) return 0;
+
+    free(read_context->copy.data); // Made by a run that raced with an update
+    read_context->copy = (key_store_value){0};
+
+    unsigned char *copy = allocate_memory(data_size);
+    if (copy == NULL) return -10; // Error handling: memory allocation failed
+
+    memcpy(copy, data, data_size);
+    read_context->copy = (key_store_value){ copy, data_size };
     return 0;
 }
 
+/**
+ * @fn _is_value_valid
+ * @brief Checks that a value holds at least one byte.
+ */
+static bool _is_value_valid(const key_store_value *value)
+{
+    return value != NULL && value->data != NULL && value->data_size > 0;
+}
+
 #pragma endregion
@@ -3,6 +3,24 @@
 
 #include "type_definition.h"
 
+#define KEY_STORE_DEFAULT_GROW_LOAD_FACTOR 1.0 // Average keys per bucket above which the table doubles
+#define KEY_STORE_DEFAULT_SHRINK_LOAD_FACTOR 0.0 // Shrinking is disabled by default
+#define KEY_STORE_DEFAULT_TREEIFY_THRESHOLD 8 // Keys per bucket at which its list becomes a red-black tree
+#define KEY_STORE_DEFAULT_INLINE_VALUE_THRESHOLD 64 // Values of at most this many bytes are stored inside their data node
+#define KEY_STORE_MAX_SHARD_COUNT 256 // Upper bound of key_store_config.shard_count
+#define KEY_STORE_MAX_BUCKET_LOCK_STRIPES 65536 // Upper bound of key_store_config.bucket_lock_stripes
+#define KEY_STORE_MAX_KEY_SIZE (UINT32_MAX - 1) // Longest key in bytes, bounded by the key size stored in each data node
+
+/**
+ * @typedef key_store
+ * @brief Opaque handle to an independent key store instance.
+ *
+ * Every instance owns its table, memory pools, epoch manager, hash seed and statistics, so
+ * instances never share locks or counters. The global functions below (initialise_key_store,
+ * set_key, get_key, ...) operate on a built-in default instance.
+ */
+typedef struct key_store key_store;
+
 /**
  * @fn initialise_key_store
  * @brief Initializes the key store with the specified bucket size.
@@ -16,10 +34,57 @@
  * @return 0 on success, or a negative error code on failure.
  * 
  * @note The bucket_size must be a power of two. If it is not, the function returns -1 to indicate an error.
+ * @note The bucket table grows automatically with KEY_STORE_DEFAULT_GROW_LOAD_FACTOR; use
+ *       initialise_key_store_with_config to tune or disable resizing.
+ * @note Values of up to KEY_STORE_DEFAULT_INLINE_VALUE_THRESHOLD bytes are stored inside their data node.
  * 
  */
 int initialise_key_store(unsigned int bucket_size,  double pre_memory_allocation_factor, bool is_concurrency_enabled);
 
+/**
+ * @fn initialise_key_store_with_config
+ * @brief Initializes the key store with the specified configuration.
+ *
+ * This function behaves like initialise_key_store, and additionally lets the caller
+ * configure the load factors at which the bucket table grows or shrinks. Resizing is
+ * incremental: buckets are migrated a few at a time by subsequent operations, so no
+ * single call pays for rehashing the whole table.
+ *
+ * Buckets whose chain reaches config.treeify_threshold keys are converted to red-black
+ * trees, bounding lookups in heavily colliding buckets to O(log n).
+ *
+ * With config.is_lock_free_read_enabled, get_key traverses list buckets without taking the
+ * bucket or data node locks. Data nodes use seqlock synchronization: set_key overwrites a
+ * value in place when it fits the node's storage and otherwise publishes a new data node, and
+ * replaced or deleted nodes are freed once no reader can hold them.
+ *
+ * config.engine selects the table implementation behind set_key/get_key/delete_key. The
+ * default KEY_STORE_ENGINE_CHAINED uses the bucket array described above. KEY_STORE_ENGINE_SWISS
+ * uses an open-addressing table whose slots hold the key hash and data node inline, probed
+ * 16 slots at a time; it sizes itself (7/8 maximum load) and ignores the load factors and
+ * treeify_threshold.
+ *
+ * config.shard_count splits the store into that many shards, each with its own table, memory
+ * pools, locks and counters; a key belongs to the shard selected by the high bits of its hash,
+ * and config.bucket_size is divided evenly between the shards. With config.is_thread_affinity_enabled
+ * a thread instead works on its home shard only (see store_set_thread_home_shard): keys are then
+ * partitioned by thread rather than by hash, and a thread only sees the keys of its home shard.
+ *
+ * @param config The key_store_config structure containing initialization parameters.
+ * @return 0 on success, or a negative error code on failure.
+ *
+ * @note grow_load_factor and shrink_load_factor must be >= 0 (0 disables the respective direction), and
+ *       shrink_load_factor must be less than half of grow_load_factor when growth is enabled, else -21 is returned.
+ * @note is_lock_free_read_enabled requires is_concurrency_enabled, else -21 is returned.
+ * @note is_lock_free_read_enabled is only supported by KEY_STORE_ENGINE_CHAINED, else -21 is returned.
+ * @note shard_count must be 0 or a power of two up to KEY_STORE_MAX_SHARD_COUNT, else -21 is returned.
+ * @note bucket_lock_stripes must be 0 or a power of two up to KEY_STORE_MAX_BUCKET_LOCK_STRIPES, and a non-default
+ *       bucket_lock or non-zero bucket_lock_stripes require is_concurrency_enabled and KEY_STORE_ENGINE_CHAINED, else -21 is returned.
+ * @note A non-zero hash_seed fixes the seed of the key hash, so callers can compute key hashes for
+ *       store_prepare_key_with_hash; 0 picks a seed at initialization.
+ */
+int initialise_key_store_with_config(const key_store_config config);
+
 /**
  * @fn cleanup_key_store
  * @brief Cleans up and releases all resources used by the key store.
@@ -71,15 +136,907 @@ int get_key(const char *key, key_store_value* value_out);
  */
 int delete_key(const char *key);
 
+/**
+ * @fn set_key_n
+ * @brief Sets or updates the value of a binary key of the given length (see set_key).
+ *
+ * The _n variants take the key as key_len bytes, which may contain zero bytes, so binary
+ * keys such as UUIDs can be stored. Keys are hashed, stored and compared by length and
+ * bytes; set_key("abc") and set_key_n("abc", 3) address the same key. Callers that know
+ * the key length also save the strlen of the string variants.
+ *
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param value Pointer to a key_store_value structure containing the data and its size.
+ * @return 0 on success, -20 on a NULL or empty key, or a negative error code on failure.
+ */
+int set_key_n(const void *key, size_t key_len, key_store_value* value);
+
+/**
+ * @fn get_key_n
+ * @brief Retrieves the value of a binary key of the given length (see get_key and set_key_n).
+ *
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param value_out Pointer to a key_store_value structure to receive a copy of the value.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ * @note The caller is responsible for managing the memory of the data pointer in value_out.
+ */
+int get_key_n(const void *key, size_t key_len, key_store_value* value_out);
+
+/**
+ * @fn delete_key_n
+ * @brief Deletes a binary key of the given length (see delete_key and set_key_n).
+ *
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ */
+int delete_key_n(const void *key, size_t key_len);
+
+/**
+ * @fn prepare_key
+ * @brief Hashes a key once for repeated operations on the default instance (see store_prepare_key).
+ *
+ * @param key Pointer to the key bytes, which must stay valid while the prepared key is used.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param prepared_key_out Pointer to receive the key and its hash.
+ * @return 0 on success, -20 on invalid input, -70 if hashing failed.
+ */
+int prepare_key(const void *key, size_t key_len, key_store_prepared_key *prepared_key_out);
+
+/**
+ * @fn prepare_key_with_hash
+ * @brief Prepares a key with a hash the caller computed already (see store_prepare_key_with_hash).
+ *
+ * @param key Pointer to the key bytes, which must stay valid while the prepared key is used.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param key_hash The key's hash under the default instance's hash seed.
+ * @param prepared_key_out Pointer to receive the key and its hash.
+ * @return 0 on success, -20 on invalid input or, in debug builds, a wrong key hash.
+ */
+int prepare_key_with_hash(const void *key, size_t key_len, uint32_t key_hash, key_store_prepared_key *prepared_key_out);
+
+/**
+ * @fn set_prepared_key
+ * @brief Sets or updates the value of a prepared key in the default instance (see set_key_n).
+ *
+ * @param prepared_key Pointer to a key prepared for the default instance.
+ * @param value Pointer to a key_store_value structure containing the data and its size.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int set_prepared_key(const key_store_prepared_key *prepared_key, key_store_value* value);
+
+/**
+ * @fn get_prepared_key
+ * @brief Retrieves the value of a prepared key from the default instance (see get_key_n).
+ *
+ * @param prepared_key Pointer to a key prepared for the default instance.
+ * @param value_out Pointer to a key_store_value structure to receive a copy of the value.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ * @note The caller is responsible for managing the memory of the data pointer in value_out.
+ */
+int get_prepared_key(const key_store_prepared_key *prepared_key, key_store_value* value_out);
+
+/**
+ * @fn delete_prepared_key
+ * @brief Deletes a prepared key from the default instance (see delete_key_n).
+ *
+ * @param prepared_key Pointer to a key prepared for the default instance.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ */
+int delete_prepared_key(const key_store_prepared_key *prepared_key);
+
+/**
+ * @fn get_key_view
+ * @brief Runs a callback on the value of a key in the default instance, without copying it.
+ *
+ * The callback receives a pointer to the stored value bytes while the store keeps the value alive
+ * and consistent, so the read allocates and copies nothing. The pointer is only valid until the
+ * callback returns and must not be kept or written through. Depending on node_sync the callback
+ * runs under the data node mutex (keep it short and do not call into the same key, which would
+ * deadlock) or, with DATA_NODE_SYNC_SEQLOCK, without a lock: it may then run more than once if a
+ * writer updates the value meanwhile, and only the result of the last run is returned.
+ *
+ * @param key The key to look up (null-terminated string).
+ * @param callback Function receiving the value bytes, their size and context.
+ * @param context Caller context passed to the callback.
+ * @return The callback's result, -41 if the key is not found, -20 on a NULL key or callback, or a
+ *         negative error code on failure. Callbacks should return 0 or positive values to stay
+ *         distinguishable from the store's error codes.
+ */
+int get_key_view(const char *key, key_store_view_callback callback, void *context);
+
+/**
+ * @fn get_key_view_n
+ * @brief Runs a callback on the value of a binary key in the default instance (see get_key_view and set_key_n).
+ *
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param callback Function receiving the value bytes, their size and context.
+ * @param context Caller context passed to the callback.
+ * @return The callback's result, -41 if the key is not found, or a negative error code on failure.
+ */
+int get_key_view_n(const void *key, size_t key_len, key_store_view_callback callback, void *context);
+
+/**
+ * @fn get_prepared_key_view
+ * @brief Runs a callback on the value of a prepared key in the default instance (see get_key_view).
+ *
+ * @param prepared_key Pointer to a key prepared for the default instance.
+ * @param callback Function receiving the value bytes, their size and context.
+ * @param context Caller context passed to the callback.
+ * @return The callback's result, -41 if the key is not found, or a negative error code on failure.
+ */
+int get_prepared_key_view(const key_store_prepared_key *prepared_key, key_store_view_callback callback, void *context);
+
+/**
+ * @fn get_key_into
+ * @brief Copies the value of a key in the default instance into a caller-owned buffer.
+ *
+ * Unlike get_key nothing is allocated, so callers can reuse a scratch buffer across reads.
+ * If the value does not fit, nothing is copied and value_size_out receives the size the
+ * buffer needs; a NULL buffer with buffer_capacity 0 only queries the size.
+ *
+ * @param key The key to look up (null-terminated string).
+ * @param buffer Caller buffer receiving the value, may be NULL if buffer_capacity is 0.
+ * @param buffer_capacity Size of buffer in bytes.
+ * @param value_size_out Receives the size of the value, whether or not it was copied.
+ * @return 0 on success, -22 if the buffer is too small, -41 if the key is not found, -20 on invalid
+ *         input, or a negative error code on failure.
+ */
+int get_key_into(const char *key, void *buffer, size_t buffer_capacity, size_t *value_size_out);
+
+/**
+ * @fn get_key_into_n
+ * @brief Copies the value of a binary key in the default instance into a caller buffer (see get_key_into and set_key_n).
+ *
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param buffer Caller buffer receiving the value, may be NULL if buffer_capacity is 0.
+ * @param buffer_capacity Size of buffer in bytes.
+ * @param value_size_out Receives the size of the value, whether or not it was copied.
+ * @return 0 on success, -22 if the buffer is too small, -41 if the key is not found, or a negative error code on failure.
+ */
+int get_key_into_n(const void *key, size_t key_len, void *buffer, size_t buffer_capacity, size_t *value_size_out);
+
+/**
+ * @fn get_prepared_key_into
+ * @brief Copies the value of a prepared key in the default instance into a caller buffer (see get_key_into).
+ *
+ * @param prepared_key Pointer to a key prepared for the default instance.
+ * @param buffer Caller buffer receiving the value, may be NULL if buffer_capacity is 0.
+ * @param buffer_capacity Size of buffer in bytes.
+ * @param value_size_out Receives the size of the value, whether or not it was copied.
+ * @return 0 on success, -22 if the buffer is too small, -41 if the key is not found, or a negative error code on failure.
+ */
+int get_prepared_key_into(const key_store_prepared_key *prepared_key, void *buffer, size_t buffer_capacity, size_t *value_size_out);
+
+/**
+ * @fn exists_key
+ * @brief Checks whether a key is present in the default instance, without copying its value.
+ *
+ * @param key The key to look up (null-terminated string).
+ * @return 0 if the key exists, -41 if it does not, or a negative error code on failure.
+ */
+int exists_key(const char *key);
+
+/**
+ * @fn exists_key_n
+ * @brief Checks whether a binary key is present in the default instance (see exists_key and set_key_n).
+ *
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @return 0 if the key exists, -41 if it does not, or a negative error code on failure.
+ */
+int exists_key_n(const void *key, size_t key_len);
+
+/**
+ * @fn get_value_size
+ * @brief Retrieves the size of the value of a key in the default instance, without copying the value.
+ *
+ * @param key The key to look up (null-terminated string).
+ * @param value_size_out Receives the size of the value in bytes.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ */
+int get_value_size(const char *key, size_t *value_size_out);
+
+/**
+ * @fn get_value_size_n
+ * @brief Retrieves the value size of a binary key in the default instance (see get_value_size and set_key_n).
+ *
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param value_size_out Receives the size of the value in bytes.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ */
+int get_value_size_n(const void *key, size_t key_len, size_t *value_size_out);
+
+/**
+ * @fn get_keys
+ * @brief Retrieves the values of a batch of keys from the default instance.
+ *
+ * The keys are processed in groups of KEY_STORE_BATCH_GROUP_SIZE. Within a group every key is hashed
+ * first, then the memory loads of all keys are overlapped: the bucket headers are prefetched, then
+ * the chain heads, then the keys are looked up grouped by bucket, so a bucket that several keys land
+ * in is locked once, and finally the values are prefetched and copied. On a table much larger than
+ * the caches this hides most of the misses that a loop over get_key pays one after the other.
+ *
+ * @param keys The keys to look up (null-terminated strings).
+ * @param key_count Number of keys.
+ * @param values_out Receives a copy of each found value, as get_key would; the caller frees their data.
+ * @param results_out Receives the result of each key, as get_key would return it.
+ * @return 0 if every key was found, otherwise the first non-zero result in key order, or -20 on a NULL array.
+ */
+int get_keys(const char *const *keys, size_t key_count, key_store_value *values_out, int *results_out);
+
+/**
+ * @fn set_keys
+ * @brief Sets or updates the values of a batch of keys in the default instance (see get_keys).
+ *
+ * @param keys The keys to set (null-terminated strings).
+ * @param key_count Number of keys.
+ * @param values The value of each key.
+ * @param results_out Receives the result of each key, as set_key would return it.
+ * @return 0 if every key was stored, otherwise the first non-zero result in key order, or -20 on a NULL array.
+ * @note A key that appears more than once in the batch ends up with its last value.
+ */
+int set_keys(const char *const *keys, size_t key_count, key_store_value *values, int *results_out);
+
+/**
+ * @fn get_prepared_keys
+ * @brief Retrieves the values of a batch of prepared keys from the default instance (see get_keys).
+ *
+ * @param prepared_keys Keys prepared for the default instance.
+ * @param key_count Number of keys.
+ * @param values_out Receives a copy of each found value; the caller frees their data.
+ * @param results_out Receives the result of each key.
+ * @return 0 if every key was found, otherwise the first non-zero result in key order, or -20 on a NULL array.
+ */
+int get_prepared_keys(const key_store_prepared_key *prepared_keys, size_t key_count, key_store_value *values_out, int *results_out);
+
+/**
+ * @fn set_prepared_keys
+ * @brief Sets or updates the values of a batch of prepared keys in the default instance (see set_keys).
+ *
+ * @param prepared_keys Keys prepared for the default instance.
+ * @param key_count Number of keys.
+ * @param values The value of each key.
+ * @param results_out Receives the result of each key.
+ * @return 0 if every key was stored, otherwise the first non-zero result in key order, or -20 on a NULL array.
+ */
+int set_prepared_keys(const key_store_prepared_key *prepared_keys, size_t key_count, key_store_value *values, int *results_out);
+
+/**
+ * @fn update_key_with
+ * @brief Replaces the value of a key in the default instance with the value a callback computes from the current one.
+ *
+ * The callback runs while the key's bucket (or the swiss table) is write-locked, so no other writer can
+ * change the value between the callback reading it and its result being stored: one lookup, no copy of
+ * the current value and no race window, unlike get_key followed by set_key. The new value is copied into
+ * the existing data node under the node's synchronization when its storage allows it, otherwise a new
+ * data node replaces the old one as set_key would. A missing key reaches the callback as NULL, 0 and
+ * version 0 and is created if the callback returns a value. Keep the callback short and do not call
+ * into the same instance from it, which would deadlock.
+ *
+ * @param key The key to update (null-terminated string).
+ * @param callback Function computing the new value, see key_store_update_callback.
+ * @param context Caller context passed to the callback.
+ * @return 0 on success, the callback's non-zero result, -20 on a NULL key or callback or an empty new
+ *         value, or a negative error code on failure.
+ */
+int update_key_with(const char *key, key_store_update_callback callback, void *context);
+
+/**
+ * @fn update_key_with_n
+ * @brief Updates the value of a binary key in the default instance through a callback (see update_key_with and set_key_n).
+ *
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param callback Function computing the new value, see key_store_update_callback.
+ * @param context Caller context passed to the callback.
+ * @return 0 on success, the callback's non-zero result, or a negative error code on failure.
+ */
+int update_key_with_n(const void *key, size_t key_len, key_store_update_callback callback, void *context);
+
+/**
+ * @fn update_prepared_key_with
+ * @brief Updates the value of a prepared key in the default instance through a callback (see update_key_with).
+ *
+ * @param prepared_key Pointer to a key prepared for the default instance.
+ * @param callback Function computing the new value, see key_store_update_callback.
+ * @param context Caller context passed to the callback.
+ * @return 0 on success, the callback's non-zero result, or a negative error code on failure.
+ */
+int update_prepared_key_with(const key_store_prepared_key *prepared_key, key_store_update_callback callback, void *context);
+
+/**
+ * @fn incr_key
+ * @brief Atomically adds delta to the counter stored under a key in the default instance.
+ *
+ * A counter is a value of exactly sizeof(int64_t) bytes holding an int64_t in native byte order. A missing
+ * key is created as a counter starting from 0. The sum wraps around on overflow.
+ *
+ * @param key The key of the counter (null-terminated string).
+ * @param delta Amount to add, may be negative.
+ * @param value_out Receives the counter after the increment, may be NULL.
+ * @return 0 on success, -23 if the stored value is not a counter, or a negative error code on failure.
+ */
+int incr_key(const char *key, int64_t delta, int64_t *value_out);
+
+/**
+ * @fn decr_key
+ * @brief Atomically subtracts delta from the counter stored under a key in the default instance (see incr_key).
+ *
+ * @param key The key of the counter (null-terminated string).
+ * @param delta Amount to subtract, may be negative.
+ * @param value_out Receives the counter after the decrement, may be NULL.
+ * @return 0 on success, -23 if the stored value is not a counter, or a negative error code on failure.
+ */
+int decr_key(const char *key, int64_t delta, int64_t *value_out);
+
+/**
+ * @fn append_key
+ * @brief Atomically appends bytes to the value of an existing key in the default instance.
+ *
+ * @param key The key to update (null-terminated string).
+ * @param suffix The bytes to append, at least one.
+ * @return 0 on success, -41 if the key is not found, -20 on invalid input, or a negative error code on failure.
+ */
+int append_key(const char *key, const key_store_value *suffix);
+
+/**
+ * @fn prepend_key
+ * @brief Atomically prepends bytes to the value of an existing key in the default instance.
+ *
+ * @param key The key to update (null-terminated string).
+ * @param prefix The bytes to prepend, at least one.
+ * @return 0 on success, -41 if the key is not found, -20 on invalid input, or a negative error code on failure.
+ */
+int prepend_key(const char *key, const key_store_value *prefix);
+
+/**
+ * @fn compare_and_swap_key
+ * @brief Stores a new value under a key in the default instance only if the current value equals the expected bytes.
+ *
+ * @param key The key to update (null-terminated string).
+ * @param expected The value the key must currently hold, compared byte for byte.
+ * @param new_value The value to store.
+ * @return 0 if the value was swapped, -49 if the current value differs, -41 if the key is not found,
+ *         or a negative error code on failure.
+ */
+int compare_and_swap_key(const char *key, const key_store_value *expected, key_store_value *new_value);
+
+/**
+ * @fn get_key_versioned
+ * @brief Retrieves the value of a key in the default instance together with its version.
+ *
+ * Every key has a version that starts at 1 when the key is created and grows by one with every update,
+ * so a caller can read a value and its version, compute a new value and store it with
+ * compare_version_and_set_key only if nobody updated the key in between. Deleting a key drops its
+ * version. The value and version are read together as a get, under the key's read protection, so they always match.
+ *
+ * @param key The key to look up (null-terminated string).
+ * @param value_out Receives a copy of the value the caller frees, or NULL to only read the version.
+ * @param version_out Receives the version of the value.
+ * @return 0 on success, -41 if the key is not found, -20 on invalid input, or a negative error code on failure.
+ */
+int get_key_versioned(const char *key, key_store_value *value_out, uint32_t *version_out);
+
+/**
+ * @fn compare_version_and_set_key
+ * @brief Stores a new value under a key in the default instance only if the key still has the expected version.
+ *
+ * @param key The key to update (null-terminated string).
+ * @param expected_version The version read with get_key_versioned, or 0 to only create a missing key.
+ * @param value The value to store.
+ * @param new_version_out Receives the version of the stored value, may be NULL.
+ * @return 0 if the value was stored, -49 if the key has another version (or exists while 0 was expected),
+ *         -41 if the key is not found, or a negative error code on failure.
+ */
+int compare_version_and_set_key(const char *key, uint32_t expected_version, key_store_value *value, uint32_t *new_version_out);
+
 /**
  * @fn get_keystore_stats
  * @brief Retrieves statistics about the key store.
  *
  * This function gathers various statistics about the key store, including
- * key distribution, memory usage, and operation counts.
+ * key distribution, memory usage, operation counts and latency percentiles.
  *
  * @return A keystore_stats structure containing the collected statistics.
+ * @note The latency histograms time single-key set, get, view and delete calls (batched and
+ *       read-modify-write calls are not timed) and the waits for contended table or bucket locks.
+ *       Percentiles are bucket upper bounds, accurate to 1/16 of the value.
  */
 keystore_stats get_keystore_stats(void);
 
+/**
+ * @fn set_thread_home_shard
+ * @brief Binds the calling thread to a home shard of the default instance (see store_set_thread_home_shard).
+ *
+ * @param shard_index Index of the shard, below the configured shard_count.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int set_thread_home_shard(unsigned int shard_index);
+
+/**
+ * @fn create_key_store
+ * @brief Creates a new key store instance with the specified configuration.
+ *
+ * The configuration is validated and applied exactly as by initialise_key_store_with_config.
+ *
+ * @param config The key_store_config structure containing initialization parameters.
+ * @param key_store_out Pointer to receive the handle of the new instance.
+ * @return 0 on success, -20 if key_store_out is NULL, -10 on allocation failure, or the error code of initialise_key_store_with_config.
+ * @note Release the instance with destroy_key_store.
+ */
+int create_key_store(const key_store_config config, key_store **key_store_out);
+
+/**
+ * @fn destroy_key_store
+ * @brief Releases all resources of an instance created with create_key_store.
+ *
+ * @param store_ptr Handle of the instance to destroy.
+ * @return 0 on success, -20 if store_ptr is NULL.
+ * @note No other thread may use the instance while, or after, it is destroyed.
+ */
+int destroy_key_store(key_store *store_ptr);
+
+/**
+ * @fn store_set_key
+ * @brief Sets or updates the value associated with the specified key in an instance (see set_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to set or update (null-terminated string).
+ * @param value Pointer to a key_store_value structure containing the data and its size.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int store_set_key(key_store *store_ptr, const char *key, key_store_value* value);
+
+/**
+ * @fn store_get_key
+ * @brief Retrieves the value associated with the specified key from an instance (see get_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to look up (null-terminated string).
+ * @param value_out Pointer to a key_store_value structure to receive a copy of the value.
+ * @return 0 on success, or a negative error code if the key is not found or an error occurs.
+ * @note The caller is responsible for managing the memory of the data pointer in value_out.
+ */
+int store_get_key(key_store *store_ptr, const char *key, key_store_value* value_out);
+
+/**
+ * @fn store_delete_key
+ * @brief Deletes a key from an instance (see delete_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to be deleted.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int store_delete_key(key_store *store_ptr, const char *key);
+
+/**
+ * @fn store_set_key_n
+ * @brief Sets or updates the value of a binary key in an instance (see set_key_n).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param value Pointer to a key_store_value structure containing the data and its size.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int store_set_key_n(key_store *store_ptr, const void *key, size_t key_len, key_store_value* value);
+
+/**
+ * @fn store_get_key_n
+ * @brief Retrieves the value of a binary key from an instance (see get_key_n).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param value_out Pointer to a key_store_value structure to receive a copy of the value.
+ * @return 0 on success, or a negative error code if the key is not found or an error occurs.
+ * @note The caller is responsible for managing the memory of the data pointer in value_out.
+ */
+int store_get_key_n(key_store *store_ptr, const void *key, size_t key_len, key_store_value* value_out);
+
+/**
+ * @fn store_delete_key_n
+ * @brief Deletes a binary key from an instance (see delete_key_n).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int store_delete_key_n(key_store *store_ptr, const void *key, size_t key_len);
+
+/**
+ * @fn store_prepare_key
+ * @brief Hashes a key once, so repeated operations on it skip hashing.
+ *
+ * The prepared key holds the key pointer, its length and its hash under the instance's hash seed.
+ * store_set_prepared_key, store_get_prepared_key and store_delete_prepared_key then go straight to
+ * the key's shard and bucket. A prepared key is only valid for the instance it was prepared for.
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes, which are referenced and must stay valid while the prepared key is used.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param prepared_key_out Pointer to receive the key and its hash.
+ * @return 0 on success, -20 on invalid input, -70 if hashing failed.
+ */
+int store_prepare_key(key_store *store_ptr, const void *key, size_t key_len, key_store_prepared_key *prepared_key_out);
+
+/**
+ * @fn store_prepare_key_with_hash
+ * @brief Prepares a key with a hash the caller computed already, skipping hashing entirely.
+ *
+ * The hash must be the one the instance computes itself: hash_function_murmur_32(key, key_len, seed)
+ * with the seed set in key_store_config.hash_seed. Callers that route keys by this hash can then
+ * reuse it instead of hashing every key twice.
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes, which are referenced and must stay valid while the prepared key is used.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param key_hash The key's hash under the instance's hash seed.
+ * @param prepared_key_out Pointer to receive the key and its hash.
+ * @return 0 on success, -20 on invalid input or, in debug builds, a wrong key hash.
+ * @note The hash is only verified in debug builds (NDEBUG not defined); in release builds a wrong hash
+ *       makes the key unreachable through the other functions.
+ */
+int store_prepare_key_with_hash(key_store *store_ptr, const void *key, size_t key_len, uint32_t key_hash, key_store_prepared_key *prepared_key_out);
+
+/**
+ * @fn store_set_prepared_key
+ * @brief Sets or updates the value of a prepared key in an instance (see store_set_key_n).
+ *
+ * @param store_ptr Handle of the instance the key was prepared for.
+ * @param prepared_key Pointer to the prepared key.
+ * @param value Pointer to a key_store_value structure containing the data and its size.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int store_set_prepared_key(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_value* value);
+
+/**
+ * @fn store_get_prepared_key
+ * @brief Retrieves the value of a prepared key from an instance (see store_get_key_n).
+ *
+ * @param store_ptr Handle of the instance the key was prepared for.
+ * @param prepared_key Pointer to the prepared key.
+ * @param value_out Pointer to a key_store_value structure to receive a copy of the value.
+ * @return 0 on success, or a negative error code if the key is not found or an error occurs.
+ * @note The caller is responsible for managing the memory of the data pointer in value_out.
+ */
+int store_get_prepared_key(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_value* value_out);
+
+/**
+ * @fn store_delete_prepared_key
+ * @brief Deletes a prepared key from an instance (see store_delete_key_n).
+ *
+ * @param store_ptr Handle of the instance the key was prepared for.
+ * @param prepared_key Pointer to the prepared key.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int store_delete_prepared_key(key_store *store_ptr, const key_store_prepared_key *prepared_key);
+
+/**
+ * @fn store_get_key_view
+ * @brief Runs a callback on the value of a key in an instance, without copying it (see get_key_view).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to look up (null-terminated string).
+ * @param callback Function receiving the value bytes, their size and context.
+ * @param context Caller context passed to the callback.
+ * @return The callback's result, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_get_key_view(key_store *store_ptr, const char *key, key_store_view_callback callback, void *context);
+
+/**
+ * @fn store_get_key_view_n
+ * @brief Runs a callback on the value of a binary key in an instance (see get_key_view_n).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param callback Function receiving the value bytes, their size and context.
+ * @param context Caller context passed to the callback.
+ * @return The callback's result, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_get_key_view_n(key_store *store_ptr, const void *key, size_t key_len, key_store_view_callback callback, void *context);
+
+/**
+ * @fn store_get_prepared_key_view
+ * @brief Runs a callback on the value of a prepared key in an instance (see get_key_view).
+ *
+ * @param store_ptr Handle of the instance the key was prepared for.
+ * @param prepared_key Pointer to the prepared key.
+ * @param callback Function receiving the value bytes, their size and context.
+ * @param context Caller context passed to the callback.
+ * @return The callback's result, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_get_prepared_key_view(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_view_callback callback, void *context);
+
+/**
+ * @fn store_get_key_into
+ * @brief Copies the value of a key in an instance into a caller-owned buffer (see get_key_into).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to look up (null-terminated string).
+ * @param buffer Caller buffer receiving the value, may be NULL if buffer_capacity is 0.
+ * @param buffer_capacity Size of buffer in bytes.
+ * @param value_size_out Receives the size of the value, whether or not it was copied.
+ * @return 0 on success, -22 if the buffer is too small, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_get_key_into(key_store *store_ptr, const char *key, void *buffer, size_t buffer_capacity, size_t *value_size_out);
+
+/**
+ * @fn store_get_key_into_n
+ * @brief Copies the value of a binary key in an instance into a caller buffer (see get_key_into_n).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param buffer Caller buffer receiving the value, may be NULL if buffer_capacity is 0.
+ * @param buffer_capacity Size of buffer in bytes.
+ * @param value_size_out Receives the size of the value, whether or not it was copied.
+ * @return 0 on success, -22 if the buffer is too small, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_get_key_into_n(key_store *store_ptr, const void *key, size_t key_len, void *buffer, size_t buffer_capacity, size_t *value_size_out);
+
+/**
+ * @fn store_get_prepared_key_into
+ * @brief Copies the value of a prepared key in an instance into a caller buffer (see get_key_into).
+ *
+ * @param store_ptr Handle of the instance the key was prepared for.
+ * @param prepared_key Pointer to the prepared key.
+ * @param buffer Caller buffer receiving the value, may be NULL if buffer_capacity is 0.
+ * @param buffer_capacity Size of buffer in bytes.
+ * @param value_size_out Receives the size of the value, whether or not it was copied.
+ * @return 0 on success, -22 if the buffer is too small, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_get_prepared_key_into(key_store *store_ptr, const key_store_prepared_key *prepared_key, void *buffer, size_t buffer_capacity, size_t *value_size_out);
+
+/**
+ * @fn store_exists_key
+ * @brief Checks whether a key is present in an instance (see exists_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to look up (null-terminated string).
+ * @return 0 if the key exists, -41 if it does not, or a negative error code on failure.
+ */
+int store_exists_key(key_store *store_ptr, const char *key);
+
+/**
+ * @fn store_exists_key_n
+ * @brief Checks whether a binary key is present in an instance (see exists_key_n).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @return 0 if the key exists, -41 if it does not, or a negative error code on failure.
+ */
+int store_exists_key_n(key_store *store_ptr, const void *key, size_t key_len);
+
+/**
+ * @fn store_get_value_size
+ * @brief Retrieves the size of the value of a key in an instance (see get_value_size).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to look up (null-terminated string).
+ * @param value_size_out Receives the size of the value in bytes.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_get_value_size(key_store *store_ptr, const char *key, size_t *value_size_out);
+
+/**
+ * @fn store_get_value_size_n
+ * @brief Retrieves the value size of a binary key in an instance (see get_value_size_n).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param value_size_out Receives the size of the value in bytes.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_get_value_size_n(key_store *store_ptr, const void *key, size_t key_len, size_t *value_size_out);
+
+/**
+ * @fn store_get_keys
+ * @brief Retrieves the values of a batch of keys from an instance (see get_keys).
+ *
+ * Keys of a group that belong to different shards are handed to each shard's table in one call.
+ *
+ * @param store_ptr Handle of the instance.
+ * @param keys The keys to look up (null-terminated strings).
+ * @param key_count Number of keys.
+ * @param values_out Receives a copy of each found value; the caller frees their data.
+ * @param results_out Receives the result of each key.
+ * @return 0 if every key was found, otherwise the first non-zero result in key order, or -20 on invalid input.
+ */
+int store_get_keys(key_store *store_ptr, const char *const *keys, size_t key_count, key_store_value *values_out, int *results_out);
+
+/**
+ * @fn store_set_keys
+ * @brief Sets or updates the values of a batch of keys in an instance (see set_keys).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param keys The keys to set (null-terminated strings).
+ * @param key_count Number of keys.
+ * @param values The value of each key.
+ * @param results_out Receives the result of each key.
+ * @return 0 if every key was stored, otherwise the first non-zero result in key order, or -20 on invalid input.
+ */
+int store_set_keys(key_store *store_ptr, const char *const *keys, size_t key_count, key_store_value *values, int *results_out);
+
+/**
+ * @fn store_get_prepared_keys
+ * @brief Retrieves the values of a batch of prepared keys from an instance (see get_keys).
+ *
+ * @param store_ptr Handle of the instance the keys were prepared for.
+ * @param prepared_keys The prepared keys.
+ * @param key_count Number of keys.
+ * @param values_out Receives a copy of each found value; the caller frees their data.
+ * @param results_out Receives the result of each key.
+ * @return 0 if every key was found, otherwise the first non-zero result in key order, or -20 on invalid input.
+ */
+int store_get_prepared_keys(key_store *store_ptr, const key_store_prepared_key *prepared_keys, size_t key_count, key_store_value *values_out, int *results_out);
+
+/**
+ * @fn store_set_prepared_keys
+ * @brief Sets or updates the values of a batch of prepared keys in an instance (see set_keys).
+ *
+ * @param store_ptr Handle of the instance the keys were prepared for.
+ * @param prepared_keys The prepared keys.
+ * @param key_count Number of keys.
+ * @param values The value of each key.
+ * @param results_out Receives the result of each key.
+ * @return 0 if every key was stored, otherwise the first non-zero result in key order, or -20 on invalid input.
+ */
+int store_set_prepared_keys(key_store *store_ptr, const key_store_prepared_key *prepared_keys, size_t key_count, key_store_value *values, int *results_out);
+
+/**
+ * @fn store_update_key_with
+ * @brief Replaces the value of a key in an instance with the value a callback computes from the current one (see update_key_with).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to update (null-terminated string).
+ * @param callback Function computing the new value, see key_store_update_callback.
+ * @param context Caller context passed to the callback.
+ * @return 0 on success, the callback's non-zero result, or a negative error code on failure.
+ */
+int store_update_key_with(key_store *store_ptr, const char *key, key_store_update_callback callback, void *context);
+
+/**
+ * @fn store_update_key_with_n
+ * @brief Updates the value of a binary key in an instance through a callback (see update_key_with_n).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key Pointer to the key bytes.
+ * @param key_len Length of the key in bytes, 1 to KEY_STORE_MAX_KEY_SIZE.
+ * @param callback Function computing the new value, see key_store_update_callback.
+ * @param context Caller context passed to the callback.
+ * @return 0 on success, the callback's non-zero result, or a negative error code on failure.
+ */
+int store_update_key_with_n(key_store *store_ptr, const void *key, size_t key_len, key_store_update_callback callback, void *context);
+
+/**
+ * @fn store_update_prepared_key_with
+ * @brief Updates the value of a prepared key in an instance through a callback (see update_key_with).
+ *
+ * @param store_ptr Handle of the instance the key was prepared for.
+ * @param prepared_key Pointer to the prepared key.
+ * @param callback Function computing the new value, see key_store_update_callback.
+ * @param context Caller context passed to the callback.
+ * @return 0 on success, the callback's non-zero result, or a negative error code on failure.
+ */
+int store_update_prepared_key_with(key_store *store_ptr, const key_store_prepared_key *prepared_key, key_store_update_callback callback, void *context);
+
+/**
+ * @fn store_incr_key
+ * @brief Atomically adds delta to the counter stored under a key in an instance (see incr_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key of the counter (null-terminated string).
+ * @param delta Amount to add, may be negative.
+ * @param value_out Receives the counter after the increment, may be NULL.
+ * @return 0 on success, -23 if the stored value is not a counter, or a negative error code on failure.
+ */
+int store_incr_key(key_store *store_ptr, const char *key, int64_t delta, int64_t *value_out);
+
+/**
+ * @fn store_decr_key
+ * @brief Atomically subtracts delta from the counter stored under a key in an instance (see incr_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key of the counter (null-terminated string).
+ * @param delta Amount to subtract, may be negative.
+ * @param value_out Receives the counter after the decrement, may be NULL.
+ * @return 0 on success, -23 if the stored value is not a counter, or a negative error code on failure.
+ */
+int store_decr_key(key_store *store_ptr, const char *key, int64_t delta, int64_t *value_out);
+
+/**
+ * @fn store_append_key
+ * @brief Atomically appends bytes to the value of an existing key in an instance (see append_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to update (null-terminated string).
+ * @param suffix The bytes to append, at least one.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_append_key(key_store *store_ptr, const char *key, const key_store_value *suffix);
+
+/**
+ * @fn store_prepend_key
+ * @brief Atomically prepends bytes to the value of an existing key in an instance (see prepend_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to update (null-terminated string).
+ * @param prefix The bytes to prepend, at least one.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_prepend_key(key_store *store_ptr, const char *key, const key_store_value *prefix);
+
+/**
+ * @fn store_compare_and_swap_key
+ * @brief Stores a new value under a key in an instance only if the current value equals the expected bytes (see compare_and_swap_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to update (null-terminated string).
+ * @param expected The value the key must currently hold.
+ * @param new_value The value to store.
+ * @return 0 if the value was swapped, -49 if the current value differs, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_compare_and_swap_key(key_store *store_ptr, const char *key, const key_store_value *expected, key_store_value *new_value);
+
+/**
+ * @fn store_get_key_versioned
+ * @brief Retrieves the value of a key in an instance together with its version (see get_key_versioned).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to look up (null-terminated string).
+ * @param value_out Receives a copy of the value the caller frees, or NULL to only read the version.
+ * @param version_out Receives the version of the value.
+ * @return 0 on success, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_get_key_versioned(key_store *store_ptr, const char *key, key_store_value *value_out, uint32_t *version_out);
+
+/**
+ * @fn store_compare_version_and_set_key
+ * @brief Stores a new value under a key in an instance only if the key still has the expected version (see compare_version_and_set_key).
+ *
+ * @param store_ptr Handle of the instance.
+ * @param key The key to update (null-terminated string).
+ * @param expected_version The version read with store_get_key_versioned, or 0 to only create a missing key.
+ * @param value The value to store.
+ * @param new_version_out Receives the version of the stored value, may be NULL.
+ * @return 0 if the value was stored, -49 if the key has another version, -41 if the key is not found, or a negative error code on failure.
+ */
+int store_compare_version_and_set_key(key_store *store_ptr, const char *key, uint32_t expected_version, key_store_value *value, uint32_t *new_version_out);
+
+/**
+ * @fn store_get_keystore_stats
+ * @brief Retrieves statistics about an instance (see get_keystore_stats).
+ *
+ * @param store_ptr Handle of the instance.
+ * @return A keystore_stats structure containing the collected statistics, zeroed if store_ptr is NULL.
+ */
+keystore_stats store_get_keystore_stats(key_store *store_ptr);
+
+/**
+ * @fn store_set_thread_home_shard
+ * @brief Binds the calling thread to a home shard of an instance created with is_thread_affinity_enabled.
+ *
+ * Every subsequent operation of the thread on the instance runs on its home shard. A thread that
+ * never calls this function is assigned a home shard round-robin on its first operation. Threads
+ * that are bound to different shards share no locks, pools or counters.
+ *
+ * @param store_ptr Handle of the instance.
+ * @param shard_index Index of the shard, below the configured shard_count.
+ * @return 0 on success, -20 if store_ptr is NULL or shard_index is out of range, -40 if the instance
+ *         is not initialized, -43 if thread affinity is not enabled.
+ * @note Concurrency control may only be disabled if at most one thread is bound to each shard.
+ */
+int store_set_thread_home_shard(key_store *store_ptr, unsigned int shard_index);
+
 #endif // KEY_STORE_H
\ No newline at end of file
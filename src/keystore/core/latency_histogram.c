@@ -0,0 +1,147 @@
+#include <string.h>
+#include <time.h>
+#include "latency_histogram.h"
+#include "operation_counters.h"
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_COUNT (1u << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+
+#pragma region Private Function Declarations
+static void _summarize_histogram(const sharded_latency_histograms *histograms_ptr, key_store_latency_type_t latency_type, latency_distribution_stats *stats_out);
+static unsigned long long _get_percentile(const unsigned long *counts, unsigned long sample_count, unsigned long long max_ns, unsigned int per_mille);
+
+#pragma endregion
+
+#pragma region Public Function Definitions
+
+unsigned long long start_latency_timer(void)
+{
+    if (!OPERATION_COUNTERS_ENABLED) return 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+}
+
+void record_latency_since(sharded_latency_histograms *histograms_ptr, key_store_latency_type_t latency_type, unsigned long long start_ns)
+{
+    if (!OPERATION_COUNTERS_ENABLED || histograms_ptr == NULL) return;
+
+    unsigned long long now_ns = start_latency_timer();
+    record_latency(histograms_ptr, latency_type, (now_ns > start_ns) ? now_ns - start_ns : 0);
+}
+
+void record_latency(sharded_latency_histograms *histograms_ptr, key_store_latency_type_t latency_type, unsigned long long latency_ns)
+{
+    if (!OPERATION_COUNTERS_ENABLED || histograms_ptr == NULL || latency_type >= KEY_STORE_LATENCY_TYPE_COUNT) return;
+
+    latency_histogram_shard *shard_ptr = &histograms_ptr->shards[get_operation_counter_shard_index()];
+    OPERATION_COUNTER_ADD(shard_ptr->counts[latency_type][get_latency_bucket_index(latency_ns)], 1);
+    OPERATION_COUNTER_ADD(shard_ptr->total_ns[latency_type], latency_ns);
+
+    // Threads sharing the shard may race for a new maximum, the larger value wins
+    unsigned long long max_ns = __atomic_load_n(&shard_ptr->max_ns[latency_type], __ATOMIC_RELAXED);
+    while (latency_ns > max_ns && !__atomic_compare_exchange_n(&shard_ptr->max_ns[latency_type], &max_ns, latency_ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+int lock_rwlock_recording_wait(pthread_rwlock_t *lock_ptr, bool is_exclusive, sharded_latency_histograms *histograms_ptr)
+{
+    if (!OPERATION_COUNTERS_ENABLED || histograms_ptr == NULL) return is_exclusive ? pthread_rwlock_wrlock(lock_ptr) : pthread_rwlock_rdlock(lock_ptr);
+
+    if ((is_exclusive ? pthread_rwlock_trywrlock(lock_ptr) : pthread_rwlock_tryrdlock(lock_ptr)) == 0) {
+        record_latency(histograms_ptr, KEY_STORE_LATENCY_LOCK_WAIT, 0);
+        return 0;
+    }
+
+    unsigned long long start_ns = start_latency_timer();
+    int lock_result = is_exclusive ? pthread_rwlock_wrlock(lock_ptr) : pthread_rwlock_rdlock(lock_ptr);
+    if (lock_result == 0) record_latency_since(histograms_ptr, KEY_STORE_LATENCY_LOCK_WAIT, start_ns);
+    return lock_result;
+}
+
+unsigned int get_latency_bucket_index(unsigned long long latency_ns)
+{
+    if (latency_ns < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) return (unsigned int)latency_ns; // Small latencies are counted exactly
+
+    unsigned int exponent = 63 - (unsigned int)__builtin_clzll(latency_ns);
+    if (exponent > LATENCY_HISTOGRAM_MAX_EXPONENT) return LATENCY_HISTOGRAM_BUCKET_COUNT - 1;
+
+    unsigned int sub_bucket = (unsigned int)(latency_ns >> (exponent - LATENCY_HISTOGRAM_SUB_BUCKET_BITS)) & (LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1);
+    return ((exponent - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) << LATENCY_HISTOGRAM_SUB_BUCKET_BITS) + sub_bucket;
+}
+
+unsigned long long get_latency_bucket_upper_bound(unsigned int bucket_index)
+{
+    if (bucket_index < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) return bucket_index;
+    if (bucket_index >= LATENCY_HISTOGRAM_BUCKET_COUNT - 1) bucket_index = LATENCY_HISTOGRAM_BUCKET_COUNT - 1;
+
+    unsigned int shift = (bucket_index >> LATENCY_HISTOGRAM_SUB_BUCKET_BITS) - 1; // Exponent of the bucket minus LATENCY_HISTOGRAM_SUB_BUCKET_BITS
+    unsigned long long lower_bound = (unsigned long long)(LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + (bucket_index & (LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1))) << shift;
+    return lower_bound + (1ULL << shift) - 1;
+}
+
+void summarize_latency_histograms(const sharded_latency_histograms *histograms_ptr, operation_latency_stats *stats_out)
+{
+    memset(stats_out, 0, sizeof(*stats_out));
+    if (!OPERATION_COUNTERS_ENABLED || histograms_ptr == NULL) return;
+
+    _summarize_histogram(histograms_ptr, KEY_STORE_LATENCY_SET, &stats_out->set);
+    _summarize_histogram(histograms_ptr, KEY_STORE_LATENCY_GET, &stats_out->get);
+    _summarize_histogram(histograms_ptr, KEY_STORE_LATENCY_DELETE, &stats_out->remove);
+    _summarize_histogram(histograms_ptr, KEY_STORE_LATENCY_LOCK_WAIT, &stats_out->lock_wait);
+}
+
+#pragma endregion
+
+#pragma region Private Function Definitions
+
+/**
+ * @fn _summarize_histogram
+ * @brief Merges the shards of one histogram and computes its mean, percentiles and maximum.
+ */
+static void _summarize_histogram(const sharded_latency_histograms *histograms_ptr, key_store_latency_type_t latency_type, latency_distribution_stats *stats_out)
+{
+    unsigned long counts[LATENCY_HISTOGRAM_BUCKET_COUNT] = {0};
+    unsigned long long total_ns = 0;
+
+    for (unsigned int s = 0; s < KEY_STORE_COUNTER_SHARD_COUNT; ++s) {
+        const latency_histogram_shard *shard_ptr = &histograms_ptr->shards[s];
+        for (unsigned int b = 0; b < LATENCY_HISTOGRAM_BUCKET_COUNT; ++b) {
+            unsigned long count = __atomic_load_n(&shard_ptr->counts[latency_type][b], __ATOMIC_RELAXED);
+            counts[b] += count;
+            stats_out->sample_count += count;
+        }
+        total_ns += __atomic_load_n(&shard_ptr->total_ns[latency_type], __ATOMIC_RELAXED);
+        unsigned long long max_ns = __atomic_load_n(&shard_ptr->max_ns[latency_type], __ATOMIC_RELAXED);
+        if (max_ns > stats_out->max_ns) stats_out->max_ns = max_ns;
+    }
+    if (stats_out->sample_count == 0) return;
+
+    stats_out->mean_ns = (double)total_ns / stats_out->sample_count;
+    stats_out->p50_ns = _get_percentile(counts, stats_out->sample_count, stats_out->max_ns, 500);
+    stats_out->p90_ns = _get_percentile(counts, stats_out->sample_count, stats_out->max_ns, 900);
+    stats_out->p99_ns = _get_percentile(counts, stats_out->sample_count, stats_out->max_ns, 990);
+    stats_out->p999_ns = _get_percentile(counts, stats_out->sample_count, stats_out->max_ns, 999);
+}
+
+/**
+ * @fn _get_percentile
+ * @brief Returns the upper bound of the bucket holding the given percentile (in tenths of a percent), capped at the maximum.
+ * @note Samples recorded while the shards are merged may leave the counts short of max_ns, the maximum is returned then.
+ */
+static unsigned long long _get_percentile(const unsigned long *counts, unsigned long sample_count, unsigned long long max_ns, unsigned int per_mille)
+{
+    unsigned long rank = (unsigned long)(((unsigned long long)sample_count * per_mille + 999) / 1000); // Smallest rank covering per_mille of the samples
+    if (rank == 0) rank = 1;
+
+    unsigned long seen = 0;
+    for (unsigned int b = 0; b < LATENCY_HISTOGRAM_BUCKET_COUNT; ++b) {
+        seen += counts[b];
+        if (seen >= rank) {
+            unsigned long long upper_bound = get_latency_bucket_upper_bound(b);
+            return (upper_bound < max_ns) ? upper_bound : max_ns;
+        }
+    }
+    return max_ns;
+}
+
+#pragma endregion
@@ -0,0 +1,78 @@
+/**
+ * @file latency_histogram.h
+ * @brief Log-linear latency histograms of a key store instance.
+ *
+ * Latencies are counted in buckets that split every power of two of nanoseconds into
+ * 2^LATENCY_HISTOGRAM_SUB_BUCKET_BITS linear sub-buckets, so a recorded latency is
+ * off by at most 1/16 of its size while one histogram covers 1 ns to about a minute.
+ * Like the operation counters, every thread records into its own cache line aligned shard
+ * and the shards are only merged when percentiles are requested.
+ *
+ * @note Building with KEY_STORE_DISABLE_OPERATION_COUNTERS defined compiles the recording
+ *       out together with the operation counters, the clock is then never read.
+ */
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include "type_definition.h"
+
+/**
+ * @fn start_latency_timer
+ * @brief Reads the monotonic clock for a latency recorded with record_latency_since.
+ * @return unsigned long long The clock in nanoseconds, or 0 if recording is compiled out.
+ */
+unsigned long long start_latency_timer(void);
+
+/**
+ * @fn record_latency_since
+ * @brief Records the time since start_ns in the calling thread's shard of a histogram.
+ * @param histograms_ptr Pointer to the histograms of the instance, NULL skips recording.
+ * @param latency_type The histogram to record into.
+ * @param start_ns Value returned by start_latency_timer.
+ */
+void record_latency_since(sharded_latency_histograms *histograms_ptr, key_store_latency_type_t latency_type, unsigned long long start_ns);
+
+/**
+ * @fn record_latency
+ * @brief Records one latency in the calling thread's shard of a histogram.
+ * @param histograms_ptr Pointer to the histograms of the instance, NULL skips recording.
+ * @param latency_type The histogram to record into.
+ * @param latency_ns The latency in nanoseconds.
+ */
+void record_latency(sharded_latency_histograms *histograms_ptr, key_store_latency_type_t latency_type, unsigned long long latency_ns);
+
+/**
+ * @fn lock_rwlock_recording_wait
+ * @brief Acquires a read-write lock and records how long the calling thread waited for it.
+ * @param lock_ptr Pointer to the lock.
+ * @param is_exclusive Whether to take the lock for writing.
+ * @param histograms_ptr Pointer to the histograms of the instance, NULL takes the lock without timing.
+ * @return int The result of the pthread lock call, 0 on success.
+ * @note The lock is tried first: an uncontended acquisition is recorded as a 0 ns wait without reading the clock.
+ */
+int lock_rwlock_recording_wait(pthread_rwlock_t *lock_ptr, bool is_exclusive, sharded_latency_histograms *histograms_ptr);
+
+/**
+ * @fn get_latency_bucket_index
+ * @brief Returns the histogram bucket a latency is counted in.
+ * @return unsigned int Bucket index below LATENCY_HISTOGRAM_BUCKET_COUNT.
+ */
+unsigned int get_latency_bucket_index(unsigned long long latency_ns);
+
+/**
+ * @fn get_latency_bucket_upper_bound
+ * @brief Returns the largest latency counted in a histogram bucket.
+ */
+unsigned long long get_latency_bucket_upper_bound(unsigned int bucket_index);
+
+/**
+ * @fn summarize_latency_histograms
+ * @brief Merges the shards of every histogram and computes their percentiles.
+ * @param histograms_ptr Pointer to the histograms of the instance, NULL yields zeroed statistics.
+ * @param stats_out Pointer to the statistics to fill in.
+ */
+void summarize_latency_histograms(const sharded_latency_histograms *histograms_ptr, operation_latency_stats *stats_out);
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,71 @@
+#include <string.h>
+#include "operation_counters.h"
+
+#pragma region Private Global Variables
+static atomic_uint g_next_counter_shard = 0; // Round-robin assignment of counter shards to threads
+static _Thread_local unsigned int t_counter_shard = 0; // Counter shard index + 1 of the calling thread, 0 until assigned
+
+#pragma endregion
+
+#pragma region Private Function Declarations
+static unsigned long _load_counter(const unsigned long *counter_ptr);
+
+#pragma endregion
+
+#pragma region Public Function Definitions
+
+unsigned int get_operation_counter_shard_index(void)
+{
+    if (t_counter_shard == 0) t_counter_shard = atomic_fetch_add_explicit(&g_next_counter_shard, 1, memory_order_relaxed) % KEY_STORE_COUNTER_SHARD_COUNT + 1;
+    return t_counter_shard - 1;
+}
+
+void sum_bucket_operation_counters(const sharded_bucket_operation_counters *counters_ptr, bucket_operation_counter_stats *sum_out)
+{
+    memset(sum_out, 0, sizeof(*sum_out));
+
+    for (unsigned int s = 0; s < KEY_STORE_COUNTER_SHARD_COUNT; ++s) {
+        const bucket_operation_counter_stats *shard_ptr = &counters_ptr->shards[s].counters;
+        sum_out->total_add_ops += _load_counter(&shard_ptr->total_add_ops);
+        sum_out->total_find_ops += _load_counter(&shard_ptr->total_find_ops);
+        sum_out->total_delete_ops += _load_counter(&shard_ptr->total_delete_ops);
+        sum_out->failed_add_ops += _load_counter(&shard_ptr->failed_add_ops);
+        sum_out->failed_find_ops += _load_counter(&shard_ptr->failed_find_ops);
+        sum_out->failed_delete_ops += _load_counter(&shard_ptr->failed_delete_ops);
+        for (int i = 0; i < 100; ++i) sum_out->error_code_counters[i] += _load_counter(&shard_ptr->error_code_counters[i]);
+    }
+}
+
+void sum_data_node_operation_counters(const sharded_data_node_operation_counters *counters_ptr, data_node_operation_counters *sum_out)
+{
+    memset(sum_out, 0, sizeof(*sum_out));
+
+    for (unsigned int s = 0; s < KEY_STORE_COUNTER_SHARD_COUNT; ++s) {
+        const data_node_operation_counters *shard_ptr = &counters_ptr->shards[s].counters;
+        sum_out->total_update_ops += _load_counter(&shard_ptr->total_update_ops);
+        sum_out->total_read_ops += _load_counter(&shard_ptr->total_read_ops);
+        sum_out->total_delete_ops += _load_counter(&shard_ptr->total_delete_ops);
+        sum_out->total_create_ops += _load_counter(&shard_ptr->total_create_ops);
+        sum_out->failed_update_ops += _load_counter(&shard_ptr->failed_update_ops);
+        sum_out->failed_read_ops += _load_counter(&shard_ptr->failed_read_ops);
+        sum_out->failed_delete_ops += _load_counter(&shard_ptr->failed_delete_ops);
+        sum_out->failed_create_ops += _load_counter(&shard_ptr->failed_create_ops);
+        sum_out->read_retry_ops += _load_counter(&shard_ptr->read_retry_ops);
+        for (int i = 0; i < 100; ++i) sum_out->error_code_counters[i] += _load_counter(&shard_ptr->error_code_counters[i]);
+    }
+}
+
+#pragma endregion
+
+#pragma region Private Function Definitions
+
+/**
+ * @fn _load_counter
+ * @brief Reads a counter that other threads may be incrementing with OPERATION_COUNTER_ADD.
+ */
+static unsigned long _load_counter(const unsigned long *counter_ptr)
+{
+    return __atomic_load_n(counter_ptr, __ATOMIC_RELAXED);
+}
+
+#pragma endregion
@@ -0,0 +1,51 @@
+/**
+ * @file operation_counters.h
+ * @brief Sharded operation counters of the tables and data nodes.
+ *
+ * Every thread is mapped round-robin to one of the KEY_STORE_COUNTER_SHARD_COUNT cache line
+ * aligned shards of a counter set, so threads counting operations on the same table write to
+ * different cache lines. Increments are relaxed atomic adds, which keep the counts exact when
+ * more threads than shards share one. The shards are only summed up when statistics are requested.
+ *
+ * @note Building with KEY_STORE_DISABLE_OPERATION_COUNTERS defined compiles the counting out:
+ *       every counting path checks OPERATION_COUNTERS_ENABLED first, operation latencies are not timed
+ *       and all counters stay zero.
+ */
+#ifndef OPERATION_COUNTERS_H
+#define OPERATION_COUNTERS_H
+
+#include "type_definition.h"
+
+#ifdef KEY_STORE_DISABLE_OPERATION_COUNTERS
+#define OPERATION_COUNTERS_ENABLED 0 // Counting code is still compiled, but guarded by a constant false condition
+#else
+#define OPERATION_COUNTERS_ENABLED 1
+#endif
+
+// Adds to one counter of a shard, other threads mapped to the same shard may add concurrently
+#define OPERATION_COUNTER_ADD(counter, amount) ((void)__atomic_fetch_add(&(counter), (amount), __ATOMIC_RELAXED))
+
+/**
+ * @fn get_operation_counter_shard_index
+ * @brief Returns the counter shard of the calling thread, assigning the next one on its first call.
+ * @return unsigned int Shard index below KEY_STORE_COUNTER_SHARD_COUNT, the same for every counter set.
+ */
+unsigned int get_operation_counter_shard_index(void);
+
+/**
+ * @fn sum_bucket_operation_counters
+ * @brief Adds up the shards of a table's operation counters.
+ * @param counters_ptr Pointer to the sharded counters.
+ * @param sum_out Pointer to the counters receiving the sums.
+ */
+void sum_bucket_operation_counters(const sharded_bucket_operation_counters *counters_ptr, bucket_operation_counter_stats *sum_out);
+
+/**
+ * @fn sum_data_node_operation_counters
+ * @brief Adds up the shards of a table's data node counters and derives the average read latency.
+ * @param counters_ptr Pointer to the sharded counters.
+ * @param sum_out Pointer to the counters receiving the sums.
+ */
+void sum_data_node_operation_counters(const sharded_data_node_operation_counters *counters_ptr, data_node_operation_counters *sum_out);
+
+#endif // OPERATION_COUNTERS_H
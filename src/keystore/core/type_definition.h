@@ -5,6 +5,9 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include "utils/memory_manager.h"
+#include "utils/epoch_manager.h"
 
 
 #pragma region Data Structures Type Definitions
@@ -25,22 +28,33 @@ typedef enum{
     BLACK
 } rb_tree_color_t;
 
+#define DATA_NODE_MAX_INLINE_VALUE_SIZE 1024 // Largest value that may be stored inside a data node
+#define KEY_STORE_BATCH_GROUP_SIZE 16 // Keys of a batched operation whose bucket and node loads are overlapped
+
+typedef enum {
+    DATA_NODE_SYNC_NONE, // No synchronization, the table is single threaded
+    DATA_NODE_SYNC_MUTEX, // Readers and writers take a pthread mutex stored after the node's inline value
+    DATA_NODE_SYNC_SEQLOCK // Readers retry on the node's sequence counter, writers are serialized by the bucket or table write lock
+} data_node_sync_t;
+
 typedef struct  data_node
 {
     uint32_t key_hash; // Hash of the key (immutable)
+    uint32_t key_size; // Bytes of the key, compared with memcmp; the stored key is followed by a terminator so string keys stay printable
+    struct data_node *_Atomic next; // Next node of a list bucket's chain, atomic so lock-free readers can traverse while a writer relinks it
     unsigned char *data;
     size_t data_size;
-    bool is_concurrency_enabled;
-    pthread_mutex_t lock; // Mutex for concurrency control
-    char key[];
+    memory_manager *memory_manager_ptr; // Slab the node and its value buffer are allocated from (NULL uses the heap)
+    uint8_t sync_mode; // data_node_sync_t guarding reads against in-place updates
+    uint16_t inline_value_capacity; // Bytes reserved after the key for an inline value, 0 if values are always stored out of line
+    atomic_uint ref_count; // One reference held by the bucket plus one per pinned reader, freed at zero
+    atomic_uint sequence; // Odd while a DATA_NODE_SYNC_SEQLOCK writer updates the value in place
+    uint32_t version; // 1 for a new key, incremented by every update of its value (carried over when the node is replaced); wraps around
+    char key[]; // key_size bytes and a terminator, followed by inline_value_capacity bytes for an inline value and, for DATA_NODE_SYNC_MUTEX, the aligned mutex
 } data_node;
 
-typedef struct list_node
-{
-    uint32_t key_hash; // Hash of the key (immutable)
-    data_node *data;
-    struct list_node *next;
-} list_node;
+// List buckets chain their data nodes directly through data_node.next, a hop reads the hash and link of one node
+typedef data_node *_Atomic atomic_list_node_ptr;
 
 typedef struct  tree_node
 {
@@ -53,21 +67,108 @@ typedef struct  tree_node
 
 } tree_node;
 
+typedef enum {
+    BUCKET_LOCK_RWLOCK, // pthread rwlock kept in an array beside the bucket table
+    BUCKET_LOCK_SPIN, // 4-byte reader-writer spinlock, a waiting writer holds off new readers
+    BUCKET_LOCK_TICKET // 8-byte reader-writer ticket lock, waiters are served in arrival order
+} bucket_lock_type_t;
+
+// The lock word of a bucket, interpreted according to the bucket_lock_type_t of its table
+typedef union
+{
+    pthread_rwlock_t *rwlock_ptr; // BUCKET_LOCK_RWLOCK: the bucket's rwlock in the table's lock array
+    atomic_uint spin; // BUCKET_LOCK_SPIN: reader count plus writer and writer-waiting bits
+    _Atomic(uint64_t) ticket; // BUCKET_LOCK_TICKET: 16-bit write, read and next ticket counters
+} bucket_lock;
+
+typedef struct
+{
+    bucket_lock_type_t lock_type;
+    unsigned int stripe_count; // Locks shared by the buckets by index (power of two, 0 gives every bucket its own lock)
+} bucket_lock_config;
+
+#define BUCKET_LOCK_STRIPE_ALIGNMENT 64 // Every stripe fills its own cache line
+
+// A lock guarding every bucket whose index has the stripe's index in its low bits
+typedef struct
+{
+    _Alignas(BUCKET_LOCK_STRIPE_ALIGNMENT) bucket_lock lock;
+    pthread_rwlock_t rwlock; // BUCKET_LOCK_RWLOCK: the lock lock.rwlock_ptr points to
+} bucket_lock_stripe;
+
 typedef struct  hash_bucket
 {
-    bucket_type_t type;
+    _Atomic(bucket_type_t) type;
+    atomic_uint version; // Odd while the container type is being changed, lock-free readers retry on a change
     union {
-        list_node *list;
-        tree_node *tree;
+        atomic_list_node_ptr list;
+        tree_node *_Atomic tree;
     } container;
 
     unsigned int count;
     bool is_initialized;
-    pthread_rwlock_t lock;
+    atomic_bool is_migrated; // Set once an incremental resize has drained this bucket into the new table
+    bucket_lock lock; // Only initialized with concurrency enabled and unused with lock stripes
 } hash_bucket;
 
 #pragma endregion
 
+#pragma region Keystore Configuration Type Definition
+
+typedef enum {
+    KEY_STORE_ENGINE_CHAINED, // Bucket array with list or red-black tree chains (default)
+    KEY_STORE_ENGINE_SWISS // Open addressing with SIMD-probed control bytes
+} key_store_engine_t;
+
+typedef enum {
+    KEY_STORE_NODE_SYNC_MUTEX, // Every data node carries a pthread mutex taken by readers and writers (default)
+    KEY_STORE_NODE_SYNC_SEQLOCK // Every data node carries a sequence counter, readers retry instead of locking
+} key_store_node_sync_t;
+
+typedef enum {
+    KEY_STORE_BUCKET_LOCK_RWLOCK, // pthread rwlock per bucket, waiters sleep in the kernel (default)
+    KEY_STORE_BUCKET_LOCK_SPIN, // 4-byte reader-writer spinlock, cheapest for short critical sections
+    KEY_STORE_BUCKET_LOCK_TICKET // 8-byte reader-writer ticket lock, first come first served under contention
+} key_store_bucket_lock_t;
+
+typedef struct
+{
+    unsigned int bucket_size; // Initial number of hash buckets (must be a power of two)
+    double pre_memory_allocation_factor; // Fraction of memory to pre-allocate for nodes (0 < factor <= 1)
+    bool is_concurrency_enabled; // Enable thread safety
+    double grow_load_factor; // Average keys per bucket above which the table doubles (0 disables growth)
+    double shrink_load_factor; // Average keys per bucket below which the table halves (0 disables shrinking)
+    unsigned int treeify_threshold; // Keys per bucket at which its list is converted to a red-black tree (0 disables)
+    bool is_lock_free_read_enabled; // Readers skip the bucket and data node locks, memory is reclaimed by epochs (requires concurrency)
+    key_store_engine_t engine; // Table engine storing the keys
+    unsigned int inline_value_threshold; // Values of at most this many bytes are stored inside the data node instead of a separate buffer (0 disables, at most DATA_NODE_MAX_INLINE_VALUE_SIZE)
+    unsigned int shard_count; // Independent sub-stores the keys are split across by their high hash bits (0 or 1 disables sharding, must be a power of two)
+    bool is_thread_affinity_enabled; // Route every operation of a thread to the thread's home shard instead of the key's shard (shared-nothing)
+    key_store_node_sync_t node_sync; // How reads of a data node are synchronized with in-place updates (seqlock requires concurrency, lock-free reads always use seqlock nodes)
+    uint32_t hash_seed; // Seed of the key hash, so callers can compute key hashes themselves (0 picks a seed at initialization)
+    key_store_bucket_lock_t bucket_lock; // Lock guarding each bucket of the chained engine (non-default locks require concurrency)
+    unsigned int bucket_lock_stripes; // Locks shared by the buckets of each shard (power of two, 0 gives every bucket its own lock; requires concurrency and the chained engine)
+} key_store_config;
+
+// Receives a borrowed pointer to a stored value, valid only until the callback returns
+typedef int (*key_store_view_callback)(const unsigned char *data, size_t data_size, void *context);
+
+// Receives the stored value of a key (NULL, 0 and version 0 if the key is missing) while no other writer can change it.
+// Setting new_value_out stores that value (copied, so it may point to the caller's memory); leaving its data NULL keeps the
+// current one. A non-zero result aborts the update and is returned to the caller.
+typedef int (*key_store_update_callback)(const unsigned char *data, size_t data_size, uint32_t version, key_store_value *new_value_out, void *context);
+
+// A key together with its hash, so repeated operations on the key skip hashing. Fill it with
+// store_prepare_key and treat the fields as read-only; the key bytes are referenced, not copied.
+typedef struct
+{
+    const void *key;
+    size_t key_len;
+    uint32_t key_hash;
+} key_store_prepared_key;
+
+#pragma endregion
+
 #pragma region Keystore Statistics Type Definition
 
 typedef struct
@@ -107,6 +208,7 @@ typedef struct
     double memory_utilization_percent;
     size_t memory_per_key_bytes;
     double fragmentation_percent;
+    memory_slab_class_usage slab_classes[MEMORY_SLAB_CLASS_COUNT]; // Occupancy of the slab size classes data nodes and values are allocated from
 } memory_pool_stats;
 
 typedef struct
@@ -130,9 +232,104 @@ typedef struct
     unsigned long failed_read_ops;
     unsigned long failed_delete_ops;
     unsigned long failed_create_ops;
+    unsigned long read_retry_ops; // Seqlock reads repeated because a writer updated the value meanwhile
+    double avg_read_latency_ns; // Mean latency of single-key gets, filled in by store_get_keystore_stats from the GET latency histogram
     unsigned long error_code_counters[100]; // Array to hold counts for different error codes
 } data_node_operation_counters;
 
+#ifdef KEY_STORE_DISABLE_OPERATION_COUNTERS
+#define KEY_STORE_COUNTER_SHARD_COUNT 1 // Counting is compiled out, a single zeroed shard keeps the layout
+#else
+#define KEY_STORE_COUNTER_SHARD_COUNT 16 // Counter shards per table, threads are spread over them round-robin
+#endif
+#define KEY_STORE_COUNTER_SHARD_ALIGNMENT 64 // Every shard starts on its own cache line
+
+// Operation counters of the threads mapped to this shard
+typedef struct
+{
+    _Alignas(KEY_STORE_COUNTER_SHARD_ALIGNMENT) bucket_operation_counter_stats counters;
+} bucket_operation_counter_shard;
+
+typedef struct
+{
+    bucket_operation_counter_shard shards[KEY_STORE_COUNTER_SHARD_COUNT]; // Summed up only when statistics are requested
+} sharded_bucket_operation_counters;
+
+// Data node counters of the threads mapped to this shard, avg_read_latency_ns is left at 0
+typedef struct
+{
+    _Alignas(KEY_STORE_COUNTER_SHARD_ALIGNMENT) data_node_operation_counters counters;
+} data_node_operation_counter_shard;
+
+typedef struct
+{
+    data_node_operation_counter_shard shards[KEY_STORE_COUNTER_SHARD_COUNT]; // Summed up only when statistics are requested
+} sharded_data_node_operation_counters;
+
+#define KEY_STORE_OCCUPANCY_EXACT_SLOTS 64 // Buckets holding fewer keys are counted by their exact key count
+#define KEY_STORE_OCCUPANCY_OVERFLOW_SLOTS 26 // Fuller buckets are counted per power of two, [2^6, 2^7) up to [2^31, 2^32) keys
+#define KEY_STORE_OCCUPANCY_HISTOGRAM_SIZE (KEY_STORE_OCCUPANCY_EXACT_SLOTS + KEY_STORE_OCCUPANCY_OVERFLOW_SLOTS)
+
+// Bucket occupancy changes made by the threads mapped to this shard. A shard may go negative where
+// another shard counted the previous state of a bucket, only the sums over all shards are meaningful
+typedef struct
+{
+    _Alignas(KEY_STORE_COUNTER_SHARD_ALIGNMENT) long bucket_counts[KEY_STORE_OCCUPANCY_HISTOGRAM_SIZE]; // Buckets by the number of keys they hold
+    long long overflow_key_counts[KEY_STORE_OCCUPANCY_OVERFLOW_SLOTS]; // Keys in the buckets of each overflow slot
+    long long key_count; // Keys in the counted buckets
+    long long key_count_squares; // Sum of the squared key counts of the counted buckets
+    unsigned int max_overflow_key_count; // Largest key count any bucket of an overflow slot reached through this shard
+} bucket_occupancy_shard;
+
+typedef struct
+{
+    bucket_occupancy_shard shards[KEY_STORE_COUNTER_SHARD_COUNT]; // Summed up only when statistics are requested
+} sharded_bucket_occupancy;
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 4 // 16 linear sub-buckets per power of two, a latency is bucketed within 1/16 of its size
+#define LATENCY_HISTOGRAM_MAX_EXPONENT 35 // Latencies of 2^36 ns (about 69 s) and more share the last bucket
+#define LATENCY_HISTOGRAM_BUCKET_COUNT ((LATENCY_HISTOGRAM_MAX_EXPONENT - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 2) << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+
+typedef enum {
+    KEY_STORE_LATENCY_SET, // Single-key sets
+    KEY_STORE_LATENCY_GET, // Single-key gets, views, caller-buffer reads, existence and size queries
+    KEY_STORE_LATENCY_DELETE, // Single-key deletes
+    KEY_STORE_LATENCY_LOCK_WAIT, // Acquisitions of a bucket or table lock, 0 if the lock was free
+    KEY_STORE_LATENCY_TYPE_COUNT
+} key_store_latency_type_t;
+
+// Latency histograms of the threads mapped to this shard
+typedef struct
+{
+    _Alignas(KEY_STORE_COUNTER_SHARD_ALIGNMENT) unsigned long counts[KEY_STORE_LATENCY_TYPE_COUNT][LATENCY_HISTOGRAM_BUCKET_COUNT];
+    unsigned long long total_ns[KEY_STORE_LATENCY_TYPE_COUNT];
+    unsigned long long max_ns[KEY_STORE_LATENCY_TYPE_COUNT];
+} latency_histogram_shard;
+
+typedef struct
+{
+    latency_histogram_shard shards[KEY_STORE_COUNTER_SHARD_COUNT]; // Merged only when statistics are requested
+} sharded_latency_histograms;
+
+typedef struct
+{
+    unsigned long sample_count;
+    double mean_ns;
+    unsigned long long p50_ns; // Percentiles are the upper bound of their histogram bucket, capped at max_ns
+    unsigned long long p90_ns;
+    unsigned long long p99_ns;
+    unsigned long long p999_ns;
+    unsigned long long max_ns; // Exact
+} latency_distribution_stats;
+
+typedef struct
+{
+    latency_distribution_stats set;
+    latency_distribution_stats get;
+    latency_distribution_stats remove; // Deletes
+    latency_distribution_stats lock_wait;
+} operation_latency_stats;
+
 typedef struct {
     metadata_stats metadata;
     key_entry_stats key_entries;
@@ -140,16 +337,58 @@ typedef struct {
     memory_pool_stats memory_pool;
     bucket_operation_counter_stats operation_counters;
     data_node_operation_counters data_node_counters;
+    operation_latency_stats latency; // Filled in by get_keystore_stats, zero in the statistics of a single table
 } keystore_stats;
 
 #pragma endregion
 
 #pragma region Memory Pool Type Definitions
+
+// Resources of one key store instance that tree and data nodes are allocated from and released to
+typedef struct bucket_node_context
+{
+    memory_manager *memory_manager_ptr; // Pools for tree nodes and data nodes (NULL uses the heap)
+    epoch_manager *epoch_manager_ptr; // Defers the release of unlinked nodes while lock-free readers run (NULL releases immediately)
+    sharded_data_node_operation_counters *data_node_counters_ptr; // Counters updated when data nodes are released (NULL skips counting)
+} bucket_node_context;
+
 typedef struct hash_bucket_memory_pool
 {
     hash_bucket* hash_buckets_ptr; // Pointer to the array of hash buckets
-    unsigned int block_size; // Size of each block
+    unsigned int block_size; // Bytes of each block, including its own pthread rwlock with BUCKET_LOCK_RWLOCK
     unsigned int total_blocks; // Total number of blocks in the pool
+
+    // Incremental resize state: while old_hash_buckets_ptr is set, keys may still live in the old table
+    hash_bucket* old_hash_buckets_ptr; // Table being drained into hash_buckets_ptr (NULL when not resizing)
+    unsigned int old_total_blocks; // Number of blocks in the old table
+    atomic_uint migration_cursor; // Next old bucket to be drained by the incremental migration step
+    atomic_uint migrated_blocks; // Number of old buckets already drained
+    atomic_bool is_resizing; // Set from the start of a resize until the old table is released
+    atomic_uint table_version; // Odd while a resize swaps or detaches the tables, lock-free readers then retry their snapshot of them
+    atomic_uint total_keys; // Number of keys across both tables, drives the load factor
+    unsigned int min_total_blocks; // Initial bucket count, the table never shrinks below it
+    double grow_load_factor; // Load factor that triggers growth (0 disables growth)
+    double shrink_load_factor; // Load factor that triggers shrinking (0 disables shrinking)
+    atomic_uint grow_key_threshold; // Key count above which the table grows, grow_load_factor times the current size (UINT_MAX disables growth)
+    atomic_uint shrink_key_threshold; // Key count below which the table shrinks, shrink_load_factor times the current size (0 disables shrinking)
+    unsigned int treeify_threshold; // Keys per bucket at which its list is converted to a red-black tree (0 disables)
+    bool is_lock_free_read_enabled; // Readers traverse list buckets without locks, data nodes are seqlock nodes replaced only when their value storage changes
+    unsigned int inline_value_threshold; // Bytes reserved inside every new data node for values of at most this size (0 disables)
+    data_node_sync_t node_sync_mode; // Synchronization of new data nodes, DATA_NODE_SYNC_SEQLOCK nodes are replaced when their storage must change
+    bucket_lock_type_t lock_type; // Lock of every bucket, only used with concurrency enabled
+    pthread_rwlock_t* bucket_rwlocks_ptr; // BUCKET_LOCK_RWLOCK: the lock of each bucket of hash_buckets_ptr, by index (NULL otherwise)
+    pthread_rwlock_t* old_bucket_rwlocks_ptr; // BUCKET_LOCK_RWLOCK: the locks of old_hash_buckets_ptr
+    bucket_lock_stripe* lock_stripes_ptr; // Locks shared by the buckets of both tables instead of their own (NULL without striping)
+    unsigned int lock_stripe_count; // Power of two, at most min_total_blocks, so a key keeps its stripe across resizes
+    pthread_rwlock_t resize_lock; // Held shared by bucket operations, exclusive while swapping tables
+    atomic_uint pending_resize_writers; // Exclusive acquisitions waiting on resize_lock, new readers back off while non-zero
+
+    bucket_node_context node_context; // Memory, epoch manager and data node counters of the owning key store instance
+    sharded_bucket_operation_counters operation_counters; // Bucket operation counters of this table
+    sharded_data_node_operation_counters data_node_counters; // Data node operation counters of this table
+    sharded_bucket_occupancy occupancy; // Initialized, not yet migrated buckets of both tables by key count, updated with every bucket count
+    sharded_latency_histograms *latency_histograms_ptr; // Bucket lock waits are recorded here (NULL skips timing)
+
     bool is_initialized; // Flag to indicate if the pool is initialized
     bool is_concurrency_enabled; // Flag to indicate if concurrency control is enabled
 } hash_bucket_memory_pool;
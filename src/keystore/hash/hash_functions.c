@@ -150,16 +150,17 @@ uint32_t finalization(uint32_t hash) {
 /**
  * @brief Computes a 32-bit MurmurHash for the given key.
  *
- * This function applies the MurmurHash algorithm to the input string `key`
+ * This function applies the MurmurHash algorithm to the `key_len` bytes of `key`
  * using the specified `seed`. It processes the input in 4-byte blocks,
  * handles any remaining tailing bytes, and performs finalization steps
  * to produce the hash value.
  *
- * @param key   The input string to hash.
+ * @param key   The input bytes to hash.
+ * @param key_len Length of the key in bytes.
  * @param seed  The seed value for the hash function.
  * @return      The resulting 32-bit hash value or UINT32_MAX on error.
  */
-uint32_t hash_function_murmur_32(const char *key,  uint32_t seed) {
+uint32_t hash_function_murmur_32(const void *key, size_t key_len, uint32_t seed) {
   
     //Validation
     if (key == NULL) {
@@ -168,12 +169,11 @@ uint32_t hash_function_murmur_32(const char *key,  uint32_t seed) {
 
     // Initialize
     const uint8_t *data = (const uint8_t *)key;
-    size_t len = strlen(key);
-    const int block_count = len / block_size; // Number of 4-byte blocks
+    const int block_count = key_len / block_size; // Number of 4-byte blocks
     uint32_t hash = seed;
 
     hash = process_blocks(block_count, hash, data);
-    hash = process_tailing_bytes(block_count, hash, data, len);
+    hash = process_tailing_bytes(block_count, hash, data, key_len);
     hash = finalization(hash);
     return hash;
 }
@@ -9,13 +9,14 @@
  * @brief Computes the MurmurHash3 (32-bit) of the given key with the specified seed.
  *
  * This function implements the MurmurHash3 algorithm to generate a 32-bit hash value
- * from the input key string and seed. It is designed for non-cryptographic hashing,
+ * from the input key bytes and seed. It is designed for non-cryptographic hashing,
  * providing good distribution and performance for hash table lookups.
  *
- * @param key  The input string to be hashed. If NULL, the function returns 0.
+ * @param key  The input bytes to be hashed, which may contain zero bytes. If NULL, the function returns UINT32_MAX.
+ * @param key_len Length of the key in bytes.
  * @param seed A 32-bit seed value to initialize the hash. Different seeds produce different hashes.
  * @return A 32-bit hash value computed from the input key and seed or UINT32_MAX on error.
  */
-uint32_t hash_function_murmur_32(const char *key,  uint32_t seed);
+uint32_t hash_function_murmur_32(const void *key, size_t key_len, uint32_t seed);
 
 #endif // HASH_FUNCTIONS_H
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "epoch_manager.h"
+
+#pragma region Private Function Declarations
+static epoch_thread_record* _get_thread_record(epoch_manager *manager_ptr);
+static void _release_thread_record(void *record_ptr);
+static bool _try_advance_epoch(epoch_manager *manager_ptr);
+static size_t _reclaim_limbo_list(epoch_limbo_list *limbo_list);
+static size_t _reclaim_expired_limbo_lists(epoch_manager *manager_ptr, epoch_thread_record *record_ptr);
+
+#pragma endregion
+
+#pragma region Public Function Definitions
+
+int initialize_epoch_manager(epoch_manager *manager_ptr)
+{
+    if (manager_ptr == NULL) return -20; // Invalid argument
+    if (atomic_load(&manager_ptr->is_enabled)) return 0; // Already initialized
+
+    if (pthread_key_create(&manager_ptr->thread_record_key, _release_thread_record) != 0) return -11; // Resource initialization failed
+
+    atomic_store(&manager_ptr->thread_records, NULL);
+    atomic_store(&manager_ptr->global_epoch, 0);
+    atomic_store(&manager_ptr->is_enabled, true);
+    return 0;
+}
+
+int cleanup_epoch_manager(epoch_manager *manager_ptr)
+{
+    if (!is_epoch_manager_enabled(manager_ptr)) return 0; // Nothing to clean up
+
+    atomic_store(&manager_ptr->is_enabled, false);
+    pthread_key_delete(manager_ptr->thread_record_key); // Later keys start out NULL in every thread, so no stale record is found
+
+    epoch_thread_record *record_ptr = atomic_exchange(&manager_ptr->thread_records, NULL);
+    while (record_ptr != NULL)
+    {
+        epoch_thread_record *next_record_ptr = record_ptr->next;
+
+        for (int i = 0; i < EPOCH_LIMBO_LIST_COUNT; ++i) {
+            _reclaim_limbo_list(&record_ptr->limbo_lists[i]);
+            free(record_ptr->limbo_lists[i].entries);
+        }
+
+        free(record_ptr);
+        record_ptr = next_record_ptr;
+    }
+
+    return 0;
+}
+
+bool is_epoch_manager_enabled(epoch_manager *manager_ptr)
+{
+    return manager_ptr != NULL && atomic_load_explicit(&manager_ptr->is_enabled, memory_order_acquire);
+}
+
+void epoch_enter(epoch_manager *manager_ptr)
+{
+    epoch_thread_record *record_ptr = _get_thread_record(manager_ptr);
+    if (record_ptr == NULL) return;
+
+    if (record_ptr->nesting_depth++ == 0)
+    {
+        atomic_store(&record_ptr->active_epoch, atomic_load(&manager_ptr->global_epoch));
+        atomic_thread_fence(memory_order_seq_cst); // The published epoch must be visible before any shared pointer is loaded
+    }
+}
+
+void epoch_exit(epoch_manager *manager_ptr)
+{
+    epoch_thread_record *record_ptr = _get_thread_record(manager_ptr);
+    if (record_ptr == NULL || record_ptr->nesting_depth == 0) return;
+
+    if (--record_ptr->nesting_depth == 0)
+    {
+        atomic_store_explicit(&record_ptr->active_epoch, EPOCH_QUIESCENT, memory_order_release);
+    }
+}
+
+int epoch_retire(epoch_manager *manager_ptr, void *ptr, epoch_reclaim_fn reclaim_fn, void *context)
+{
+    if (ptr == NULL || reclaim_fn == NULL) return -20; // Invalid arguments
+
+    epoch_thread_record *record_ptr = _get_thread_record(manager_ptr);
+    if (record_ptr == NULL) {
+        reclaim_fn(ptr, context); // Reclamation is not deferred
+        return 0;
+    }
+
+    unsigned long current_epoch = atomic_load(&manager_ptr->global_epoch);
+    epoch_limbo_list *limbo_list = &record_ptr->limbo_lists[current_epoch % EPOCH_LIMBO_LIST_COUNT];
+
+    // A list that still holds an older epoch in this slot is at least EPOCH_LIMBO_LIST_COUNT epochs old and safe to reclaim
+    if (limbo_list->count > 0 && limbo_list->epoch != current_epoch) _reclaim_limbo_list(limbo_list);
+    limbo_list->epoch = current_epoch;
+
+    if (limbo_list->count == limbo_list->capacity)
+    {
+        size_t new_capacity = (limbo_list->capacity == 0) ? EPOCH_RECLAIM_INTERVAL : limbo_list->capacity * 2;
+        epoch_retired_entry *new_entries = realloc(limbo_list->entries, new_capacity * sizeof(epoch_retired_entry));
+        if (new_entries == NULL) return -10; // Memory allocation failure, freeing now could break a reader
+
+        limbo_list->entries = new_entries;
+        limbo_list->capacity = new_capacity;
+    }
+
+    limbo_list->entries[limbo_list->count++] = (epoch_retired_entry){ ptr, reclaim_fn, context };
+
+    if (++record_ptr->retire_count % EPOCH_RECLAIM_INTERVAL == 0) epoch_try_reclaim(manager_ptr);
+    return 0;
+}
+
+size_t epoch_try_reclaim(epoch_manager *manager_ptr)
+{
+    epoch_thread_record *record_ptr = _get_thread_record(manager_ptr);
+    if (record_ptr == NULL) return 0;
+
+    _try_advance_epoch(manager_ptr);
+    return _reclaim_expired_limbo_lists(manager_ptr, record_ptr);
+}
+
+#pragma endregion
+
+#pragma region Private Function Definitions
+
+/**
+ * @fn _get_thread_record
+ * @brief Returns the calling thread's record of the manager, claiming or creating one on first use.
+ * @return Pointer to the thread record, or NULL if the manager is disabled or allocation failed.
+ */
+static epoch_thread_record* _get_thread_record(epoch_manager *manager_ptr)
+{
+    if (!is_epoch_manager_enabled(manager_ptr)) return NULL;
+
+    epoch_thread_record *record_ptr = pthread_getspecific(manager_ptr->thread_record_key);
+    if (record_ptr != NULL) return record_ptr;
+
+    // Reuse a record released by a thread that has exited
+    for (epoch_thread_record *candidate_ptr = atomic_load(&manager_ptr->thread_records); candidate_ptr != NULL; candidate_ptr = candidate_ptr->next)
+    {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&candidate_ptr->is_owned, &expected, true)) {
+            record_ptr = candidate_ptr;
+            break;
+        }
+    }
+
+    if (record_ptr == NULL)
+    {
+        record_ptr = calloc(1, sizeof(epoch_thread_record));
+        if (record_ptr == NULL) return NULL; // Memory allocation failure
+
+        atomic_init(&record_ptr->active_epoch, EPOCH_QUIESCENT);
+        atomic_init(&record_ptr->is_owned, true);
+
+        epoch_thread_record *head_ptr = atomic_load(&manager_ptr->thread_records);
+        do {
+            record_ptr->next = head_ptr;
+        } while (!atomic_compare_exchange_weak(&manager_ptr->thread_records, &head_ptr, record_ptr));
+    }
+
+    record_ptr->nesting_depth = 0;
+    pthread_setspecific(manager_ptr->thread_record_key, record_ptr);
+    return record_ptr;
+}
+
+/**
+ * @fn _release_thread_record
+ * @brief Thread exit destructor: hands the record, and its pending limbo lists, to the next new thread.
+ */
+static void _release_thread_record(void *record_ptr)
+{
+    epoch_thread_record *thread_record_ptr = record_ptr;
+
+    atomic_store(&thread_record_ptr->active_epoch, EPOCH_QUIESCENT);
+    atomic_store(&thread_record_ptr->is_owned, false);
+}
+
+/**
+ * @fn _try_advance_epoch
+ * @brief Advances the global epoch if every thread inside a critical section has observed the current one.
+ * @return true if the epoch was advanced (by this or another thread), false otherwise.
+ */
+static bool _try_advance_epoch(epoch_manager *manager_ptr)
+{
+    unsigned long current_epoch = atomic_load(&manager_ptr->global_epoch);
+
+    for (epoch_thread_record *record_ptr = atomic_load(&manager_ptr->thread_records); record_ptr != NULL; record_ptr = record_ptr->next)
+    {
+        unsigned long active_epoch = atomic_load(&record_ptr->active_epoch);
+        if (active_epoch != EPOCH_QUIESCENT && active_epoch != current_epoch) return false; // A reader is still in an older epoch
+    }
+
+    atomic_compare_exchange_strong(&manager_ptr->global_epoch, &current_epoch, current_epoch + 1);
+    return true;
+}
+
+/**
+ * @fn _reclaim_limbo_list
+ * @brief Releases every pointer of the limbo list and empties it.
+ * @return The number of pointers released.
+ */
+static size_t _reclaim_limbo_list(epoch_limbo_list *limbo_list)
+{
+    size_t reclaimed_count = limbo_list->count;
+
+    for (size_t i = 0; i < limbo_list->count; ++i) {
+        limbo_list->entries[i].reclaim_fn(limbo_list->entries[i].ptr, limbo_list->entries[i].context);
+    }
+
+    limbo_list->count = 0;
+    return reclaimed_count;
+}
+
+/**
+ * @fn _reclaim_expired_limbo_lists
+ * @brief Releases the limbo lists of the record whose epoch is at least two behind the global epoch.
+ * @return The number of pointers released.
+ */
+static size_t _reclaim_expired_limbo_lists(epoch_manager *manager_ptr, epoch_thread_record *record_ptr)
+{
+    unsigned long current_epoch = atomic_load(&manager_ptr->global_epoch);
+    size_t reclaimed_count = 0;
+
+    for (int i = 0; i < EPOCH_LIMBO_LIST_COUNT; ++i)
+    {
+        epoch_limbo_list *limbo_list = &record_ptr->limbo_lists[i];
+        if (limbo_list->count > 0 && limbo_list->epoch + 2 <= current_epoch) reclaimed_count += _reclaim_limbo_list(limbo_list);
+    }
+
+    return reclaimed_count;
+}
+
+#pragma endregion
@@ -0,0 +1,160 @@
+/**
+ * @file epoch_manager.h
+ * @brief Epoch-based memory reclamation for lock-free readers.
+ *
+ * Each key store instance owns one epoch_manager, so the reclamation of one instance never
+ * waits for readers of another. Readers wrap every access to shared nodes in epoch_enter()/epoch_exit(). Writers unlink a
+ * node under their own lock and hand it to epoch_retire() instead of freeing it. A retired node
+ * is only reclaimed once the global epoch has advanced twice past the epoch it was retired in,
+ * which guarantees that no reader that could still hold a pointer to it is left.
+ *
+ * Types:
+ * - epoch_reclaim_fn: Callback that releases a retired pointer.
+ * - epoch_limbo_list: Pointers retired by one thread during one epoch.
+ * - epoch_thread_record: Per-thread reader state and limbo lists.
+ * - epoch_manager: Global epoch and thread records of one key store instance.
+ *
+ * Functions:
+ * - initialize_epoch_manager: Enables deferred reclamation.
+ * - cleanup_epoch_manager: Reclaims everything still retired and disables the manager.
+ * - epoch_enter / epoch_exit: Delimit a reader critical section (may be nested).
+ * - epoch_retire: Defers the release of a pointer until no reader can reach it.
+ * - epoch_try_reclaim: Advances the epoch if possible and reclaims the calling thread's limbo lists.
+ *
+ * Usage:
+ * 1. Initialize the key store's epoch manager before the first reader or writer runs.
+ * 2. Readers call epoch_enter/epoch_exit, writers call epoch_retire.
+ * 3. Clean up once no thread uses the protected structures anymore.
+ *
+ * @note While the manager is not initialized, epoch_enter/epoch_exit are no-ops and
+ *       epoch_retire releases the pointer immediately.
+ */
+
+#ifndef EPOCH_MANAGER_H
+#define EPOCH_MANAGER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <pthread.h>
+
+#define EPOCH_QUIESCENT ULONG_MAX // active_epoch of a thread outside any critical section
+#define EPOCH_LIMBO_LIST_COUNT 3 // Pointers from epoch e are safe once the global epoch reaches e + 2
+#define EPOCH_RECLAIM_INTERVAL 64 // Retires per thread between two reclamation attempts
+
+/**
+ * @typedef epoch_reclaim_fn
+ * @brief Releases a pointer that was retired with epoch_retire.
+ */
+typedef void (*epoch_reclaim_fn)(void *ptr, void *context);
+
+typedef struct
+{
+    void *ptr;
+    epoch_reclaim_fn reclaim_fn;
+    void *context; // Passed back to reclaim_fn, e.g. the pool the pointer belongs to
+} epoch_retired_entry;
+
+/**
+ * @struct epoch_limbo_list
+ * @brief Pointers retired by one thread while the global epoch had a given value.
+ */
+typedef struct
+{
+    epoch_retired_entry *entries;
+    size_t count;
+    size_t capacity;
+    unsigned long epoch; // Global epoch the entries were retired in
+} epoch_limbo_list;
+
+/**
+ * @struct epoch_thread_record
+ * @brief Per-thread epoch state, kept in a list of the manager that writers scan to advance the epoch.
+ * @note Records are reused by new threads once their owner has exited and are only freed by cleanup_epoch_manager.
+ */
+typedef struct epoch_thread_record
+{
+    atomic_ulong active_epoch; // Epoch observed on entry, or EPOCH_QUIESCENT outside critical sections
+    atomic_bool is_owned; // Set while a live thread uses this record
+    unsigned int nesting_depth; // Nested epoch_enter calls of the owning thread
+    unsigned int retire_count; // Retires since the record was claimed, drives EPOCH_RECLAIM_INTERVAL
+    epoch_limbo_list limbo_lists[EPOCH_LIMBO_LIST_COUNT];
+    struct epoch_thread_record *next; // Immutable once the record is published
+} epoch_thread_record;
+
+/**
+ * @struct epoch_manager
+ * @brief Epoch state of one key store instance.
+ * @note The calling thread's record is found through a pthread key of the manager, so a thread may use several managers at once.
+ */
+typedef struct epoch_manager
+{
+    _Atomic(epoch_thread_record*) thread_records; // Singly linked, records are only prepended
+    atomic_ulong global_epoch;
+    atomic_bool is_enabled;
+    pthread_key_t thread_record_key;
+} epoch_manager;
+
+/**
+ * @fn initialize_epoch_manager
+ * @brief Enables epoch-based reclamation.
+ * @param manager_ptr Pointer to the zero-initialized epoch manager.
+ * @return 0 on success (or if already initialized), -20 if manager_ptr is NULL, -11 if the thread-local key could not be created.
+ */
+int initialize_epoch_manager(epoch_manager *manager_ptr);
+
+/**
+ * @fn cleanup_epoch_manager
+ * @brief Reclaims every retired pointer, frees all thread records and disables the manager.
+ * @param manager_ptr Pointer to the epoch manager.
+ * @return 0 on success.
+ * @note No thread may be inside a critical section or retire pointers while this runs.
+ */
+int cleanup_epoch_manager(epoch_manager *manager_ptr);
+
+/**
+ * @fn is_epoch_manager_enabled
+ * @brief Returns whether retired pointers are currently deferred.
+ * @param manager_ptr Pointer to the epoch manager, NULL counts as disabled.
+ */
+bool is_epoch_manager_enabled(epoch_manager *manager_ptr);
+
+/**
+ * @fn epoch_enter
+ * @brief Enters a reader critical section; pointers loaded until epoch_exit stay valid.
+ * @note Calls may be nested, only the outermost pair publishes the thread's epoch.
+ */
+void epoch_enter(epoch_manager *manager_ptr);
+
+/**
+ * @fn epoch_exit
+ * @brief Leaves a reader critical section entered with epoch_enter.
+ */
+void epoch_exit(epoch_manager *manager_ptr);
+
+/**
+ * @fn epoch_retire
+ * @brief Defers the release of an unlinked pointer until no reader can still reach it.
+ *
+ * The pointer must already be unreachable for new readers. Every EPOCH_RECLAIM_INTERVAL
+ * retires, the calling thread tries to advance the epoch and reclaims its own limbo lists.
+ *
+ * @param manager_ptr Pointer to the epoch manager, NULL releases the pointer immediately.
+ * @param ptr The pointer to release.
+ * @param reclaim_fn The function that releases it.
+ * @param context Opaque argument passed to reclaim_fn.
+ * @return 0 on success, -20 on invalid arguments, -10 if the limbo list could not grow (the pointer is leaked).
+ * @note If the manager is not enabled, reclaim_fn is called immediately.
+ */
+int epoch_retire(epoch_manager *manager_ptr, void *ptr, epoch_reclaim_fn reclaim_fn, void *context);
+
+/**
+ * @fn epoch_try_reclaim
+ * @brief Tries to advance the global epoch and reclaims the calling thread's expired limbo lists.
+ * @param manager_ptr Pointer to the epoch manager.
+ * @return The number of pointers reclaimed.
+ */
+size_t epoch_try_reclaim(epoch_manager *manager_ptr);
+
+#endif // EPOCH_MANAGER_H
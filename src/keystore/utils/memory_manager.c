@@ -1,60 +1,131 @@
 #include "memory_manager.h"
 #include "core/type_definition.h"
 #include <math.h>
+#include <stdatomic.h>
+#include <string.h>
 
-#pragma region Private Global Variables
-static memory_pool g_list_pool = {0};
-static memory_pool g_tree_pool = {0};
-static memory_manager_config g_config = {0};
+#pragma region Private Type Definitions
+
+/**
+ * @struct memory_magazine
+ * @brief Free blocks of one pool cached by one thread.
+ *
+ * Only the owning thread pushes and pops blocks; count is also read by the statistics of other threads.
+ */
+typedef struct memory_magazine {
+    atomic_uint count; // Number of cached blocks
+    void *blocks[MEMORY_MAGAZINE_SIZE];
+} memory_magazine;
+
+/**
+ * @struct memory_magazine_set
+ * @brief The magazines one thread keeps for the pools of one memory manager.
+ *
+ * magazines[i] caches blocks of the pool whose magazine_index is i, so a magazine never changes pools.
+ */
+typedef struct memory_magazine_set {
+    memory_manager *manager_ptr; // Manager owning the set
+    struct memory_magazine_set *next; // Next set of the manager, guarded by magazine_lock
+    struct memory_magazine_set *prev; // Previous set of the manager, guarded by magazine_lock
+    memory_magazine magazines[MEMORY_MANAGER_POOL_COUNT];
+} memory_magazine_set;
 
 #pragma endregion
 
+#pragma region Private Global Variables
+static const size_t g_slab_class_sizes[MEMORY_SLAB_CLASS_COUNT] = { 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072 };
+
+#pragma endregion
 
 #pragma region Private Function Declarations
-static int _create_memory_pool(memory_pool *pool, size_t block_size);
-static void* _allocate_memory_from_pool(memory_pool *memory_pool);
-static void _free_memory_to_pool(memory_pool *memory_pool, void *ptr);
+static int _create_memory_pool(memory_pool *pool, size_t block_size, unsigned int initial_blocks, bool is_concurrency_enabled, unsigned int magazine_index);
+static void* _allocate_memory_from_pool(memory_manager *manager_ptr, memory_pool *memory_pool);
+static void _free_memory_to_pool(memory_manager *manager_ptr, memory_pool *memory_pool, void *ptr);
 static bool _is_pointer_from_pool (memory_pool *pool, void *ptr);
 static int _cleanup_memory_pool(memory_pool *pool);
+static int _grow_memory_pool(memory_pool *pool, unsigned int block_count);
+static void* _pop_block_from_pool(memory_pool *memory_pool);
+static bool _push_block_to_pool(memory_pool *memory_pool, void *ptr);
+static memory_magazine* _get_thread_magazine(memory_manager *manager_ptr, memory_pool *memory_pool);
+static void _release_thread_magazines(void *magazine_set);
+static void _add_pool_usage(memory_manager *manager_ptr, memory_pool *pool, memory_pool_usage *usage_out, memory_slab_class_usage *class_usage_out);
+static int _get_slab_class_index(const memory_manager *manager_ptr, size_t size);
 
 #pragma endregion
 
 #pragma region Public Function Definitions
-int initialize_memory_manager(const memory_manager_config config)
+int initialize_memory_manager(memory_manager *manager_ptr, const memory_manager_config config)
 {
+    if(manager_ptr == NULL) return -20; // Invalid parameter
+
     if(config.bucket_size == 0 || config.pre_allocation_factor <= 0 || config.pre_allocation_factor > 1) return -21; // Invalid configuration parameters error
 
-    g_config = config;
+    manager_ptr->config = config;
+    manager_ptr->is_magazine_key_created = false;
+    manager_ptr->magazine_sets = NULL;
+    if(config.is_concurrency_enabled) {
+        if(pthread_mutex_init(&manager_ptr->magazine_lock, NULL) != 0) return -11; // Mutex initialization failed
+        // Without a key, for example once the process ran out of them, the pools are shared under pool_lock
+        manager_ptr->is_magazine_key_created = (pthread_key_create(&manager_ptr->magazine_key, _release_thread_magazines) == 0);
+    }
+
     int pool_creation_result = 0;
+    unsigned int initial_blocks = (unsigned int)ceil(config.bucket_size * config.pre_allocation_factor);
 
-    if(config.allocate_list_pool)  pool_creation_result = _create_memory_pool(&g_list_pool, sizeof(list_node));
+    if(config.allocate_tree_pool)  pool_creation_result = _create_memory_pool(&manager_ptr->tree_pool, sizeof(tree_node), initial_blocks, config.is_concurrency_enabled, 0);
 
-    if(config.allocate_tree_pool)  pool_creation_result = _create_memory_pool(&g_tree_pool, sizeof(tree_node));
+    // Slab classes start small and grow with use, most stores only need a few of them
+    for(unsigned int i = 0; config.allocate_slab_pools && pool_creation_result == 0 && i < MEMORY_SLAB_CLASS_COUNT; ++i) {
+        pool_creation_result = _create_memory_pool(&manager_ptr->slab_pools[i], g_slab_class_sizes[i], MEMORY_SLAB_INITIAL_CHUNK_BYTES / g_slab_class_sizes[i], config.is_concurrency_enabled, i + 1);
+    }
 
-    if(pool_creation_result != 0) cleanup_memory_manager();
+    if(pool_creation_result != 0) cleanup_memory_manager(manager_ptr);
 
     return pool_creation_result;
 }
 
-int cleanup_memory_manager(void)
+int cleanup_memory_manager(memory_manager *manager_ptr)
 {
+    if(manager_ptr == NULL) return -20; // Invalid parameter
+
     int result = 0;
 
-    if(g_config.allocate_list_pool)  result = _cleanup_memory_pool(&g_list_pool);
+    // The cached blocks are released with the pool memory. Deleting the key first keeps an exiting thread
+    // from handing its set to _release_thread_magazines once the set is freed here.
+    if(manager_ptr->config.is_concurrency_enabled) {
+        pthread_mutex_lock(&manager_ptr->magazine_lock);
+        if(manager_ptr->is_magazine_key_created) pthread_key_delete(manager_ptr->magazine_key);
+        manager_ptr->is_magazine_key_created = false;
+
+        memory_magazine_set *magazine_set = manager_ptr->magazine_sets;
+        while(magazine_set != NULL) {
+            memory_magazine_set *next = magazine_set->next;
+            free(magazine_set);
+            magazine_set = next;
+        }
+        manager_ptr->magazine_sets = NULL;
+        pthread_mutex_unlock(&manager_ptr->magazine_lock);
+        pthread_mutex_destroy(&manager_ptr->magazine_lock);
+    }
+
+    if(manager_ptr->config.allocate_tree_pool)  result = _cleanup_memory_pool(&manager_ptr->tree_pool);
 
-    if(g_config.allocate_tree_pool)  result = _cleanup_memory_pool(&g_tree_pool);
+    for(unsigned int i = 0; manager_ptr->config.allocate_slab_pools && i < MEMORY_SLAB_CLASS_COUNT; ++i) {
+        result = _cleanup_memory_pool(&manager_ptr->slab_pools[i]);
+    }
 
-    g_config = (memory_manager_config){0}; // Reset config
+    manager_ptr->config = (memory_manager_config){0}; // Reset config
     return result;
 }
 
 
-void* allocate_memory_from_pool(memory_pool_type_t pool_type)
+void* allocate_memory_from_pool(memory_manager *manager_ptr, memory_pool_type_t pool_type)
 {
+    if(manager_ptr == NULL) return NULL; // No pools to allocate from
+
     switch(pool_type)
     {
-        case LIST_POOL: return _allocate_memory_from_pool(&g_list_pool);
-        case TREE_POOL: return _allocate_memory_from_pool(&g_tree_pool);
+        case TREE_POOL: return _allocate_memory_from_pool(manager_ptr, &manager_ptr->tree_pool);
         default: return NULL; // Unsupported pool type
     }
 }
@@ -64,16 +135,65 @@ void* allocate_memory(size_t size)
     return malloc(size);
 }
 
-void free_memory(void *ptr, memory_pool_type_t pool_type)
+void free_memory(memory_manager *manager_ptr, void *ptr, memory_pool_type_t pool_type)
 {
+    if(manager_ptr == NULL) pool_type = NO_POOL; // Without a manager the block can only come from the heap
+
     switch(pool_type)
     {
-        case LIST_POOL: _free_memory_to_pool(&g_list_pool, ptr); break;
-        case TREE_POOL: _free_memory_to_pool(&g_tree_pool, ptr); break;
+        case TREE_POOL: _free_memory_to_pool(manager_ptr, &manager_ptr->tree_pool, ptr); break;
         default: free(ptr); // Use standard free for unsupported pool types
     }
 }
 
+void* allocate_memory_from_slab(memory_manager *manager_ptr, size_t size)
+{
+    int class_index = _get_slab_class_index(manager_ptr, size);
+    return (class_index < 0) ? malloc(size) : _allocate_memory_from_pool(manager_ptr, &manager_ptr->slab_pools[class_index]);
+}
+
+void* reallocate_memory_from_slab(memory_manager *manager_ptr, void *ptr, size_t old_size, size_t new_size)
+{
+    if(ptr == NULL) return allocate_memory_from_slab(manager_ptr, new_size);
+    if(new_size == 0) return NULL; // Use free_memory_to_slab() to release a block
+
+    int old_class_index = _get_slab_class_index(manager_ptr, old_size);
+    int new_class_index = _get_slab_class_index(manager_ptr, new_size);
+    if(old_class_index < 0 && new_class_index < 0) return realloc(ptr, new_size); // Both sizes are heap sized
+    if(old_class_index == new_class_index) return ptr; // The block already fits
+
+    void *new_ptr = allocate_memory_from_slab(manager_ptr, new_size);
+    if(new_ptr == NULL) return NULL; // Handle allocation failure
+
+    memcpy(new_ptr, ptr, (old_size < new_size) ? old_size : new_size);
+    free_memory_to_slab(manager_ptr, ptr, old_size);
+    return new_ptr;
+}
+
+void free_memory_to_slab(memory_manager *manager_ptr, void *ptr, size_t size)
+{
+    if(ptr == NULL) return;
+
+    int class_index = _get_slab_class_index(manager_ptr, size);
+    if(class_index < 0) free(ptr);
+    else _free_memory_to_pool(manager_ptr, &manager_ptr->slab_pools[class_index], ptr);
+}
+
+int get_memory_manager_usage(memory_manager *manager_ptr, memory_pool_usage *usage_out)
+{
+    if(manager_ptr == NULL || usage_out == NULL) return -20; // Invalid parameter
+
+    *usage_out = (memory_pool_usage){0};
+    if(manager_ptr->config.is_concurrency_enabled) pthread_mutex_lock(&manager_ptr->magazine_lock);
+    _add_pool_usage(manager_ptr, &manager_ptr->tree_pool, usage_out, NULL);
+    for(unsigned int i = 0; i < MEMORY_SLAB_CLASS_COUNT; ++i) {
+        usage_out->slab_classes[i].block_size = g_slab_class_sizes[i];
+        _add_pool_usage(manager_ptr, &manager_ptr->slab_pools[i], usage_out, &usage_out->slab_classes[i]);
+    }
+    if(manager_ptr->config.is_concurrency_enabled) pthread_mutex_unlock(&manager_ptr->magazine_lock);
+    return 0;
+}
+
 void* reallocate_memory(void *ptr, size_t new_size)
 {
    
@@ -99,50 +219,80 @@ void* reallocate_memory(void *ptr, size_t new_size)
  * @fn _create_memory_pool
  * @brief Creates and initializes a memory pool with the specified block size.
  *
- * This function allocates memory for the pool based on the block size and
- * pre-allocation factor defined in the global configuration. It sets up
- * the necessary pointers and counters for managing the pool.
+ * This function allocates the first chunk of the pool with the given number of
+ * blocks. It sets up the necessary pointers and counters for managing the pool.
  *
  * @param pool Pointer to the memory_pool structure to be initialized.
  * @param block_size Size of each block in the pool.
+ * @param initial_blocks Number of blocks in the first chunk (at least one is allocated).
+ * @param is_concurrency_enabled Flag to guard the pool with pool_lock and thread magazines.
+ * @param magazine_index Index of the pool's magazine in the thread magazine sets of its manager.
  * @return 0 on success, or a negative error code on failure.
  */
-int _create_memory_pool(memory_pool *pool, size_t block_size)
+int _create_memory_pool(memory_pool *pool, size_t block_size, unsigned int initial_blocks, bool is_concurrency_enabled, unsigned int magazine_index)
 {
-    if(pool == NULL || block_size == 0 || g_config.pre_allocation_factor < 0) return -21; // Invalid parameters error
-
-    if(g_config.pre_allocation_factor == 0) return 0; // No pre-allocation requested
+    if(pool == NULL || block_size == 0) return -21; // Invalid parameters error
 
     pool->block_size = block_size;
-    pool->total_blocks = (int)ceil(g_config.bucket_size * g_config.pre_allocation_factor);
-    pool->available_blocks = pool->total_blocks;
+    pool->total_blocks = 0;
+    pool->available_blocks = 0;
     pool->reusable_blocks = 0;
+    pool->chunk_count = 0;
+    pool->free_block_list = NULL;
+    atomic_store(&pool->chunks, NULL);
     pool->is_initialized = false;
+    pool->is_concurrency_enabled = is_concurrency_enabled;
+    pool->magazine_index = magazine_index;
     
-    if(g_config.is_concurrency_enabled) 
+    if(pool->is_concurrency_enabled) 
     {
         if(pthread_mutex_init(&pool->pool_lock, NULL) != 0) return -11; // Mutex initialization failed
     }
 
-    // Allocate memory for the pool
-    pool->next_block_ptr = malloc(block_size * pool->total_blocks);
-    if(pool->next_block_ptr == NULL) return -10; // Memory allocation failed
-
-    // Allocate memory for the free block list
-    pool->free_block_list = (void **)malloc(sizeof(void *) * pool->total_blocks);
-    if(pool->free_block_list == NULL)
+    if(_grow_memory_pool(pool, initial_blocks > 0 ? initial_blocks : 1) != 0)
     {
-        free(pool->next_block_ptr);
-        pool->next_block_ptr = NULL;
+        if(pool->is_concurrency_enabled) pthread_mutex_destroy(&pool->pool_lock);
         return -10; // Memory allocation failed
     }
 
-    pool->pool_start_ptr = (char *)pool->next_block_ptr;
-    pool->pool_end_ptr = (char *)pool->next_block_ptr + (pool->block_size * pool->total_blocks);
     pool->is_initialized = true;
+    return 0; // Success
+}
 
 
-    return 0; // Success
+/**
+ * @fn _grow_memory_pool
+ * @brief Adds a chunk of blocks to the pool and makes it the chunk new blocks are carved from.
+ *
+ * The reusable block list is enlarged to hold every block of the pool, so a freed block
+ * can always be recycled.
+ *
+ * @param pool Pointer to the memory pool, locked by the caller if concurrency is enabled.
+ * @param block_count Number of blocks in the new chunk.
+ * @return 0 on success, -10 on allocation failure (the pool is left unchanged).
+ */
+int _grow_memory_pool(memory_pool *pool, unsigned int block_count)
+{
+    size_t alignment = _Alignof(max_align_t); // Blocks start as aligned as a malloc'd block
+    size_t header_size = (sizeof(memory_pool_chunk) + alignment - 1) / alignment * alignment;
+
+    void **free_block_list = realloc(pool->free_block_list, sizeof(void *) * (pool->total_blocks + block_count));
+    if(free_block_list == NULL) return -10; // Memory allocation failed
+    pool->free_block_list = free_block_list;
+
+    memory_pool_chunk *chunk = malloc(header_size + pool->block_size * block_count);
+    if(chunk == NULL) return -10; // Memory allocation failed
+
+    chunk->start_ptr = (char *)chunk + header_size;
+    chunk->end_ptr = chunk->start_ptr + pool->block_size * block_count;
+    chunk->next = atomic_load_explicit(&pool->chunks, memory_order_relaxed);
+    atomic_store_explicit(&pool->chunks, chunk, memory_order_release); // Publishes the chunk to lock-free membership checks
+
+    pool->next_block_ptr = chunk->start_ptr;
+    pool->available_blocks = block_count;
+    pool->total_blocks += block_count;
+    pool->chunk_count++;
+    return 0;
 }
 
 
@@ -150,86 +300,263 @@ int _create_memory_pool(memory_pool *pool, size_t block_size)
  * @fn _allocate_memory_from_pool
  * @brief Allocates a memory block from the specified memory pool.
  *
- * This function checks if there are reusable blocks available in the pool.
- * If so, it returns one of those blocks. If not, it checks if there are
- * available blocks in the pre-allocated pool. If the pool is exhausted,
- * it falls back to standard malloc().
+ * With concurrency enabled, the block is popped from the calling thread's magazine without
+ * locking; an empty magazine is first refilled with up to MEMORY_MAGAZINE_BATCH blocks under
+ * pool_lock. Otherwise a reusable block is returned if there is one, then a never-used block
+ * of the newest chunk. If the pool is exhausted, it grows by another chunk.
  *
+ * @param manager_ptr Pointer to the memory manager owning the pool.
  * @param memory_pool Pointer to the memory pool from which to allocate memory.
  * @return Pointer to the allocated memory block, or NULL if allocation fails.
  */
-void* _allocate_memory_from_pool(memory_pool *memory_pool)
+void* _allocate_memory_from_pool(memory_manager *manager_ptr, memory_pool *memory_pool)
 {
-    if(g_config.is_concurrency_enabled) pthread_mutex_lock(&memory_pool->pool_lock);
-
-    void* mem = NULL;
+    if(!memory_pool->is_initialized) return NULL;
+    if(!memory_pool->is_concurrency_enabled) return _pop_block_from_pool(memory_pool);
+
+    memory_magazine *magazine = _get_thread_magazine(manager_ptr, memory_pool);
+    if(magazine == NULL) {
+        pthread_mutex_lock(&memory_pool->pool_lock);
+        void *mem = _pop_block_from_pool(memory_pool);
+        pthread_mutex_unlock(&memory_pool->pool_lock);
+        return mem;
+    }
 
-    if(memory_pool->is_initialized)
-    {
-        if(memory_pool->reusable_blocks > 0)
-        {
-            mem = memory_pool->free_block_list[--memory_pool->reusable_blocks];
+    unsigned int count = atomic_load_explicit(&magazine->count, memory_order_relaxed);
+    if(count == 0) {
+        pthread_mutex_lock(&memory_pool->pool_lock);
+        while(count < MEMORY_MAGAZINE_BATCH) {
+            void *block = _pop_block_from_pool(memory_pool);
+            if(block == NULL) break;
+            magazine->blocks[count++] = block;
         }
-        else
-        {
-            if(memory_pool->available_blocks > 0) {
+        pthread_mutex_unlock(&memory_pool->pool_lock);
 
-                mem = memory_pool->next_block_ptr;
-                memory_pool->next_block_ptr = (char*)memory_pool->next_block_ptr + memory_pool->block_size; // Move pointer to next block
-                memory_pool->available_blocks--;
-            }
-            else
-            {
-                mem = malloc(memory_pool->block_size); // Fallback to standard malloc if pool is exhausted
-            }
-        }
+        if(count == 0) return NULL; // The pool could not grow
     }
 
-    if(g_config.is_concurrency_enabled) pthread_mutex_unlock(&memory_pool->pool_lock);
-    return mem;
+    atomic_store_explicit(&magazine->count, count - 1, memory_order_relaxed);
+    return magazine->blocks[count - 1];
 }
 
 /**
  * @fn _free_memory_to_pool
  * @brief Frees a memory block back to the specified memory pool.
  *
- * This function checks if the pointer belongs to the memory pool and if there is space
- * in the reusable block list. If both conditions are met, it adds the block back to the
- * pool for reuse. Otherwise, it falls back to standard free().
+ * Blocks from the pool's chunks are pushed to the calling thread's magazine without locking
+ * when concurrency is enabled; a full magazine first returns MEMORY_MAGAZINE_BATCH blocks
+ * to the pool under pool_lock. Otherwise the block is added back to the pool's reusable list.
+ * Blocks that are not from the pool are released with standard free().
  *
+ * @param manager_ptr Pointer to the memory manager owning the pool.
  * @param memory_pool Pointer to the memory pool to which the block should be returned.
  * @param ptr Pointer to the memory block to be freed.
  */
-void _free_memory_to_pool(memory_pool *memory_pool, void *ptr)
+void _free_memory_to_pool(memory_manager *manager_ptr, memory_pool *memory_pool, void *ptr)
 {
-    bool std_cleanup = true;
-
-    if(memory_pool->is_initialized)
-    {    
-        if(g_config.is_concurrency_enabled) pthread_mutex_lock(&memory_pool->pool_lock);
-        
-        if(_is_pointer_from_pool(memory_pool, ptr))
-        {
-           if(memory_pool->reusable_blocks < memory_pool->total_blocks)
-            {
-                memory_pool->free_block_list[memory_pool->reusable_blocks++] = ptr;
-                std_cleanup = false; // Successfully returned to pool
+    // Chunks are only ever added, so membership is checked without the lock
+    if(!memory_pool->is_initialized || !_is_pointer_from_pool(memory_pool, ptr)) {
+        free(ptr); // Fallback to standard free if not from pool
+        return;
+    }
+
+    // The reusable block list holds every block of the pool, so a push only fails on a double free
+    memory_magazine *magazine = memory_pool->is_concurrency_enabled ? _get_thread_magazine(manager_ptr, memory_pool) : NULL;
+
+    if(magazine != NULL) {
+        unsigned int count = atomic_load_explicit(&magazine->count, memory_order_relaxed);
+        if(count == MEMORY_MAGAZINE_SIZE) {
+            pthread_mutex_lock(&memory_pool->pool_lock);
+            while(count > MEMORY_MAGAZINE_SIZE - MEMORY_MAGAZINE_BATCH) {
+                _push_block_to_pool(memory_pool, magazine->blocks[--count]);
             }
+            pthread_mutex_unlock(&memory_pool->pool_lock);
+        }
+
+        magazine->blocks[count] = ptr;
+        atomic_store_explicit(&magazine->count, count + 1, memory_order_relaxed);
+    }
+    else if(memory_pool->is_concurrency_enabled) {
+        pthread_mutex_lock(&memory_pool->pool_lock);
+        _push_block_to_pool(memory_pool, ptr);
+        pthread_mutex_unlock(&memory_pool->pool_lock);
+    }
+    else {
+        _push_block_to_pool(memory_pool, ptr);
+    }
+}
+
+/**
+ * @fn _pop_block_from_pool
+ * @brief Takes a reusable block, else the next never-used block, growing the pool when it is exhausted.
+ *
+ * @param memory_pool Pointer to the memory pool, locked by the caller if concurrency is enabled.
+ * @return Pointer to the block, or NULL if the pool could not grow.
+ */
+void* _pop_block_from_pool(memory_pool *memory_pool)
+{
+    if(memory_pool->reusable_blocks > 0) return memory_pool->free_block_list[--memory_pool->reusable_blocks];
+
+    if(memory_pool->available_blocks == 0) {
+        unsigned int block_count = (memory_pool->total_blocks < MEMORY_POOL_MAX_CHUNK_BLOCKS) ? memory_pool->total_blocks : MEMORY_POOL_MAX_CHUNK_BLOCKS;
+        if(_grow_memory_pool(memory_pool, block_count) != 0) return NULL; // Allocation failed
+    }
+
+    void *mem = memory_pool->next_block_ptr;
+    memory_pool->next_block_ptr = (char*)memory_pool->next_block_ptr + memory_pool->block_size; // Move pointer to next block
+    memory_pool->available_blocks--;
+    return mem;
+}
+
+/**
+ * @fn _push_block_to_pool
+ * @brief Adds a block of the pool to its reusable block list.
+ *
+ * @param memory_pool Pointer to the memory pool, locked by the caller if concurrency is enabled.
+ * @param ptr Pointer to a block from the pool's range.
+ * @return true if the block was added, false if the list is full.
+ */
+bool _push_block_to_pool(memory_pool *memory_pool, void *ptr)
+{
+    if(memory_pool->reusable_blocks >= memory_pool->total_blocks) return false;
+
+    memory_pool->free_block_list[memory_pool->reusable_blocks++] = ptr;
+    return true;
+}
+
+/**
+ * @fn _get_thread_magazine
+ * @brief Returns the calling thread's magazine for a pool, creating the thread's magazine set on first use.
+ *
+ * The fast path is one thread-specific lookup in the manager's key. Every pool of the manager has
+ * its own magazine in the set, so alternating between pools or managers never flushes a magazine.
+ *
+ * @param manager_ptr Pointer to the memory manager owning the pool.
+ * @param memory_pool Pointer to the concurrent memory pool.
+ * @return Pointer to the magazine, or NULL if the manager has no key or the set could not be allocated.
+ */
+memory_magazine* _get_thread_magazine(memory_manager *manager_ptr, memory_pool *memory_pool)
+{
+    if(!manager_ptr->is_magazine_key_created) return NULL;
+
+    memory_magazine_set *magazine_set = pthread_getspecific(manager_ptr->magazine_key);
+    if(magazine_set == NULL) {
+        magazine_set = calloc(1, sizeof(memory_magazine_set));
+        if(magazine_set == NULL) return NULL;
+        magazine_set->manager_ptr = manager_ptr;
+
+        if(pthread_setspecific(manager_ptr->magazine_key, magazine_set) != 0) {
+            free(magazine_set);
+            return NULL;
         }
 
-        if(g_config.is_concurrency_enabled) pthread_mutex_unlock(&memory_pool->pool_lock);
+        pthread_mutex_lock(&manager_ptr->magazine_lock);
+        magazine_set->next = manager_ptr->magazine_sets;
+        if(manager_ptr->magazine_sets != NULL) manager_ptr->magazine_sets->prev = magazine_set;
+        manager_ptr->magazine_sets = magazine_set;
+        pthread_mutex_unlock(&manager_ptr->magazine_lock);
+    }
+
+    return &magazine_set->magazines[memory_pool->magazine_index];
+}
+
+/**
+ * @fn _release_thread_magazines
+ * @brief Thread-exit destructor returning the cached blocks of a magazine set to their pools.
+ *
+ * @param magazine_set The magazine set of the exiting thread, unlinked from its manager and freed.
+ */
+void _release_thread_magazines(void *magazine_set)
+{
+    memory_magazine_set *thread_set = magazine_set;
+    memory_manager *manager_ptr = thread_set->manager_ptr;
+
+    pthread_mutex_lock(&manager_ptr->magazine_lock);
+    memory_pool *pools[MEMORY_MANAGER_POOL_COUNT] = { &manager_ptr->tree_pool };
+    for(unsigned int i = 0; i < MEMORY_SLAB_CLASS_COUNT; ++i) pools[i + 1] = &manager_ptr->slab_pools[i];
+
+    for(unsigned int i = 0; i < MEMORY_MANAGER_POOL_COUNT; ++i) {
+        memory_magazine *magazine = &thread_set->magazines[i];
+        unsigned int count = atomic_load_explicit(&magazine->count, memory_order_relaxed);
+        if(count == 0) continue;
+
+        pthread_mutex_lock(&pools[i]->pool_lock);
+        while(count > 0) _push_block_to_pool(pools[i], magazine->blocks[--count]);
+        pthread_mutex_unlock(&pools[i]->pool_lock);
+    }
+
+    if(thread_set->prev != NULL) thread_set->prev->next = thread_set->next;
+    else manager_ptr->magazine_sets = thread_set->next;
+    if(thread_set->next != NULL) thread_set->next->prev = thread_set->prev;
+    pthread_mutex_unlock(&manager_ptr->magazine_lock);
+
+    free(thread_set);
+}
+
+/**
+ * @fn _add_pool_usage
+ * @brief Adds the reserved, used and cached bytes of one pool to a usage report.
+ *
+ * @param manager_ptr Pointer to the memory manager owning the pool, its magazine_lock is held if concurrency is enabled.
+ * @param pool Pointer to the memory pool.
+ * @param usage_out Pointer to the usage report to add to.
+ * @param class_usage_out Pointer to receive the block counts of a slab class pool, or NULL.
+ */
+void _add_pool_usage(memory_manager *manager_ptr, memory_pool *pool, memory_pool_usage *usage_out, memory_slab_class_usage *class_usage_out)
+{
+    if(!pool->is_initialized) return;
+
+    if(pool->is_concurrency_enabled) pthread_mutex_lock(&pool->pool_lock);
+
+    size_t cached_blocks = 0;
+    for(memory_magazine_set *magazine_set = manager_ptr->magazine_sets; magazine_set != NULL; magazine_set = magazine_set->next) {
+        cached_blocks += atomic_load_explicit(&magazine_set->magazines[pool->magazine_index].count, memory_order_relaxed);
     }
+    size_t free_blocks = (size_t)pool->available_blocks + pool->reusable_blocks + cached_blocks;
+    size_t used_blocks = (free_blocks < pool->total_blocks) ? pool->total_blocks - free_blocks : 0;
 
-    if(std_cleanup) free(ptr); // Fallback to standard free if not from pool or pool is full
+    usage_out->total_bytes += (size_t)pool->total_blocks * pool->block_size;
+    usage_out->used_bytes += used_blocks * pool->block_size;
+    usage_out->cached_bytes += cached_blocks * pool->block_size;
+
+    if(class_usage_out != NULL) {
+        class_usage_out->total_blocks = pool->total_blocks;
+        class_usage_out->used_blocks = (unsigned int)used_blocks;
+        class_usage_out->cached_blocks = (unsigned int)cached_blocks;
+    }
+
+    if(pool->is_concurrency_enabled) pthread_mutex_unlock(&pool->pool_lock);
 }
 
 
+/**
+ * @fn _get_slab_class_index
+ * @brief Maps an allocation size to the smallest slab class that fits it.
+ *
+ * Classes alternate between 2^n and 1.5 * 2^n bytes, so the index follows from the highest
+ * set bit of size - 1 and whether size exceeds the midpoint above that power of two.
+ *
+ * @param manager_ptr Pointer to the memory manager, may be NULL.
+ * @param size The allocation size in bytes.
+ * @return The class index, or -1 if the size must be served by the heap.
+ */
+int _get_slab_class_index(const memory_manager *manager_ptr, size_t size)
+{
+    if(manager_ptr == NULL || !manager_ptr->config.allocate_slab_pools || size > MEMORY_SLAB_MAX_BLOCK_SIZE) return -1;
+    if(size <= g_slab_class_sizes[0]) return 0;
+
+    int high_bit = 63 - __builtin_clzll((unsigned long long)(size - 1)); // 2^high_bit < size <= 2^(high_bit + 1)
+    size_t power = (size_t)1 << high_bit;
+    return (size <= power + power / 2) ? 2 * (high_bit - 4) + 1 : 2 * (high_bit - 3);
+}
+
 /**
  * @fn _is_pointer_from_pool
  * @brief Checks if a given pointer belongs to the specified memory pool.
  *
  * This function verifies whether the provided pointer falls within the memory range
- * allocated for the memory pool and aligns with the block size.
+ * of one of the pool's chunks and aligns with the block size. Chunks grow geometrically,
+ * so the walk is logarithmic in the pool size, and the newest (largest) chunk comes first.
  *
  * @param pool Pointer to the memory pool to check against.
  * @param ptr Pointer to the memory to be checked.
@@ -239,9 +566,11 @@ bool _is_pointer_from_pool (memory_pool *pool, void *ptr) {
     
     if(pool == NULL || ptr == NULL) return false;
     
-    if(ptr >= (void *)pool->pool_start_ptr && ptr < (void *)pool->pool_end_ptr) {
-        size_t offset = (char *)ptr - pool->pool_start_ptr;
-        return (offset % pool->block_size) == 0;
+    for(memory_pool_chunk *chunk = atomic_load_explicit(&pool->chunks, memory_order_acquire); chunk != NULL; chunk = chunk->next) {
+        if((char *)ptr >= chunk->start_ptr && (char *)ptr < chunk->end_ptr) {
+            size_t offset = (char *)ptr - chunk->start_ptr;
+            return (offset % pool->block_size) == 0;
+        }
     }
 
     return false;
@@ -263,11 +592,14 @@ int _cleanup_memory_pool(memory_pool *pool)
 
     if(!pool->is_initialized) return 0; // Nothing to clean up
 
-    if(pool->pool_start_ptr != NULL)
+    memory_pool_chunk *chunk = atomic_load(&pool->chunks);
+    while(chunk != NULL)
     {
-        free(pool->pool_start_ptr);
-        pool->pool_start_ptr = NULL;
+        memory_pool_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
     }
+    atomic_store(&pool->chunks, NULL);
 
     if(pool->free_block_list != NULL)
     {
@@ -281,9 +613,10 @@ int _cleanup_memory_pool(memory_pool *pool)
     pool->is_initialized = false;
     pool->available_blocks = 0;
     pool->next_block_ptr = NULL;
-    pool->pool_end_ptr = NULL;
+    pool->chunk_count = 0;
 
-    if(g_config.is_concurrency_enabled) pthread_mutex_destroy(&pool->pool_lock);
+    if(pool->is_concurrency_enabled) pthread_mutex_destroy(&pool->pool_lock);
+    pool->is_concurrency_enabled = false;
 
     return 0; // Success
 }
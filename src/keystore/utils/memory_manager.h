@@ -6,9 +6,12 @@
  * general memory allocation in the distributed keystore project.
  *
  * Types:
- * - memory_pool_type_t: Enum for memory pool selection (NONE, LIST_POOL, TREE_POOL).
+ * - memory_pool_type_t: Enum for memory pool selection (NONE, TREE_POOL).
  * - memory_pool: Structure for memory pool block management.
  * - memory_manager_config: Configuration for memory manager initialization.
+ * - memory_manager: The pools of one key store instance.
+ * - memory_pool_usage: Byte counts of the pools of a memory manager.
+ * - memory_slab_class_usage: Block counts of one slab size class.
  *
  * Functions:
  * - initialize_memory_manager: Sets up memory pools based on configuration.
@@ -16,11 +19,30 @@
  * - allocate_memory_from_pool: Allocates a block from a specified pool.
  * - allocate_memory: Allocates memory from the heap.
  * - free_memory: Frees memory, returning it to the pool if applicable.
+ * - allocate_memory_from_slab: Allocates a variable-sized block from the smallest fitting slab class.
+ * - reallocate_memory_from_slab: Resizes a slab block, in place if the size class does not change.
+ * - free_memory_to_slab: Returns a slab block to its size class.
+ * - get_memory_manager_usage: Reports how much of the pools is reserved, used and cached.
  *
  * Usage:
- * 1. Initialize the memory manager with memory_manager_config.
+ * 1. Initialize a zeroed memory_manager with memory_manager_config.
  * 2. Allocate and free memory using the provided functions.
  * 3. Clean up resources before program exit.
+ *
+ * Thread caches:
+ * With concurrency enabled, every thread keeps a magazine (a small stack of free blocks) per pool
+ * it uses. Allocations and frees are served from the magazine without locking; only when it runs
+ * empty or full is a batch of MEMORY_MAGAZINE_BATCH blocks moved from or to the shared pool under
+ * pool_lock. Each manager hands every thread its own set of magazines, one per pool, through a
+ * thread-specific key, so a thread working with many managers never moves a magazine between
+ * pools. A thread's magazines are returned to their pools when the thread exits.
+ *
+ * Slab:
+ * Variable-sized allocations (data nodes and value buffers) are served by MEMORY_SLAB_CLASS_COUNT
+ * pools whose block sizes step through powers of two and the midpoints between them (16, 24, 32,
+ * 48, ... 3072 bytes), so a block wastes less than a third of its size and no allocation pays a
+ * malloc header. Larger sizes, and managers without slab pools, use the heap. The size of a block
+ * is not stored: callers pass the size they allocated when they free or resize it.
  */
 
 
@@ -30,6 +52,15 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <stdatomic.h>
+
+#define MEMORY_MAGAZINE_SIZE 32 // Free blocks a thread caches per pool
+#define MEMORY_MAGAZINE_BATCH (MEMORY_MAGAZINE_SIZE / 2) // Blocks moved between a magazine and its pool at once
+#define MEMORY_MANAGER_POOL_COUNT (MEMORY_SLAB_CLASS_COUNT + 1) // Tree pool and slab pools of a manager, each with its own thread magazine
+#define MEMORY_POOL_MAX_CHUNK_BLOCKS 65536 // Upper bound of the blocks added by one pool growth
+#define MEMORY_SLAB_CLASS_COUNT 16 // Size classes from 16 to MEMORY_SLAB_MAX_BLOCK_SIZE bytes
+#define MEMORY_SLAB_MAX_BLOCK_SIZE 3072 // Largest allocation served by the slab, larger ones use the heap
+#define MEMORY_SLAB_INITIAL_CHUNK_BYTES 4096 // Size of the first chunk of every slab class
 
 
 /**
@@ -37,46 +68,105 @@
  * @brief Represents the type of memory pool used in the memory manager.
  *
  * This enumeration defines the available memory pool types:
- * @note - LIST_POOL: A memory pool based on a list structure.
  * @note - TREE_POOL: A memory pool based on a tree structure.
  */
 typedef enum memory_pool_type_t {
     NO_POOL,
-    LIST_POOL,
     TREE_POOL
 } memory_pool_type_t;
 
 
+/**
+ * @struct memory_pool_chunk
+ * @brief One contiguous allocation of blocks owned by a memory pool.
+ *
+ * The header is followed by the blocks. Chunks are only prepended, and never released
+ * before the pool is cleaned up, so the list can be walked without the pool lock.
+ */
+typedef struct memory_pool_chunk {
+    struct memory_pool_chunk *next; // Previously added chunk
+    char *start_ptr; // First block
+    char *end_ptr; // End of the last block
+} memory_pool_chunk;
+
 /**
  * @struct memory_pool
  * @brief Structure representing a memory pool for efficient memory management.
+ *
+ * The pool starts with one chunk of bucket_size * pre_allocation_factor blocks. Once every
+ * block is in use, it grows by another chunk as large as the whole pool (at most
+ * MEMORY_POOL_MAX_CHUNK_BLOCKS), so growth is geometric and every block stays recyclable.
  */
 typedef struct memory_pool {
     
     size_t block_size; // Size of each block
-    char* pool_start_ptr; // Pointer to the start of the pool memory
-    char* pool_end_ptr;   // Pointer to the end of the pool memory
-    void *next_block_ptr; // Pointer to the next available block
+    _Atomic(memory_pool_chunk *) chunks; // Most recently added chunk, the newest blocks are handed out from it
+    void *next_block_ptr; // Pointer to the next never-used block of the newest chunk
 
-    unsigned int total_blocks; // Total number of blocks in the pool
-    unsigned int available_blocks; // Number of blocks available for allocation
+    unsigned int total_blocks; // Total number of blocks in all chunks
+    unsigned int available_blocks; // Number of never-used blocks left in the newest chunk
     unsigned int reusable_blocks;  // Number of blocks available for reuse
+    unsigned int chunk_count; // Number of chunks
 
     void ** free_block_list; // Array of pointers to free blocks
     bool is_initialized; // Flag to indicate if the pool is initialized
+    bool is_concurrency_enabled; // Flag to indicate if pool_lock guards the pool
 
     pthread_mutex_t pool_lock; // Mutex for thread-safe access
+    unsigned int magazine_index; // Index of the magazine caching blocks of this pool in every thread's magazine set
 
 } memory_pool;
 
 typedef struct memory_manager_config {
     unsigned int bucket_size;
     double pre_allocation_factor;
-    bool allocate_list_pool;
     bool allocate_tree_pool;
     bool is_concurrency_enabled;
+    bool allocate_slab_pools; // Serve data nodes and value buffers from size-class pools instead of the heap
 } memory_manager_config;
 
+/**
+ * @struct memory_manager
+ * @brief The node pools of one key store instance.
+ *
+ * With concurrency enabled, magazine_key maps every thread that used the manager to its
+ * magazine set. The sets are owned by the manager: a thread's set is released when the thread
+ * exits, the remaining ones when the manager is cleaned up. If the key cannot be created,
+ * the pools are used under pool_lock without magazines.
+ */
+typedef struct memory_manager {
+    memory_manager_config config; // Configuration the pools were created with
+    memory_pool tree_pool; // Pool for tree nodes
+    memory_pool slab_pools[MEMORY_SLAB_CLASS_COUNT]; // Size-class pools, ordered by block size
+
+    pthread_key_t magazine_key; // Magazine set of the calling thread, valid if is_magazine_key_created
+    bool is_magazine_key_created; // Flag to indicate if the pools are fronted by thread magazines
+    pthread_mutex_t magazine_lock; // Guards magazine_sets, taken before any pool_lock
+    struct memory_magazine_set *magazine_sets; // Magazine sets of every thread that used the manager
+} memory_manager;
+
+/**
+ * @struct memory_slab_class_usage
+ * @brief Block counts of one slab size class.
+ */
+typedef struct memory_slab_class_usage {
+    size_t block_size; // Largest allocation served by the class
+    unsigned int total_blocks; // Blocks reserved by the class
+    unsigned int used_blocks; // Blocks handed out and not freed yet
+    unsigned int cached_blocks; // Free blocks held in thread magazines (not part of used_blocks)
+} memory_slab_class_usage;
+
+/**
+ * @struct memory_pool_usage
+ * @brief Byte counts of the pools of a memory manager.
+ */
+typedef struct memory_pool_usage {
+    size_t total_bytes; // Bytes reserved by the pools
+    size_t used_bytes; // Bytes of blocks handed out and not freed yet
+    size_t cached_bytes; // Bytes of free blocks held in thread magazines (not part of used_bytes)
+    memory_slab_class_usage slab_classes[MEMORY_SLAB_CLASS_COUNT]; // Occupancy of every slab size class, included in the byte counts
+} memory_pool_usage;
+
 /**
  * @fn initialize_memory_manager
  * @brief Initializes the memory manager with the specified configuration.
@@ -84,10 +174,11 @@ typedef struct memory_manager_config {
  * This function sets up the memory pools based on the provided configuration,
  * allocating necessary resources for efficient memory management.
  *
+ * @param manager_ptr Pointer to the zero-initialized memory manager to set up.
  * @param config The memory_manager_config structure containing initialization parameters.
  * @return 0 on success, or a negative error code on failure.
  */
-int initialize_memory_manager(const memory_manager_config config);
+int initialize_memory_manager(memory_manager *manager_ptr, const memory_manager_config config);
 
 
 /**
@@ -98,9 +189,12 @@ int initialize_memory_manager(const memory_manager_config config);
  * ensuring no memory leaks occur. It should be called before program termination
  * to properly release all memory managed by the memory manager.
  *
+ * @note Threads that used the manager and are still running keep no reference to its magazines,
+ *       but none of them may be exiting while the manager is cleaned up.
+ * @param manager_ptr Pointer to the memory manager to clean up.
  * @return 0 on success, or a negative error code on failure.
  */
-int cleanup_memory_manager(void);
+int cleanup_memory_manager(memory_manager *manager_ptr);
 
 
 /**
@@ -111,13 +205,14 @@ int cleanup_memory_manager(void);
  * performance and reduce fragmentation for frequent allocations.
  *
  * @note - If the specified pool type is unsupported, the function returns NULL.
- * @note - If the pool is exhausted, it falls back to standard malloc.
+ * @note - If the pool is exhausted, it grows by another chunk.
  * @note - The caller is responsible for freeing the allocated memory using free_memory().
  * @note - Ensure that the memory manager is initialized before calling this function.
- * @param pool_type The type of memory pool to allocate from (e.g., LIST_POOL, TREE_POOL).
+ * @param manager_ptr Pointer to the memory manager owning the pool.
+ * @param pool_type The type of memory pool to allocate from (e.g., TREE_POOL).
  * @return A pointer to the allocated memory block, or NULL if allocation fails.
  */
-void* allocate_memory_from_pool(memory_pool_type_t pool_type);
+void* allocate_memory_from_pool(memory_manager *manager_ptr, memory_pool_type_t pool_type);
 
 /**
  * @brief Allocates a block of memory of the given size.
@@ -151,11 +246,62 @@ void* reallocate_memory(void *ptr, size_t new_size);
  * Otherwise, it releases the memory back to the heap.
  *
  * @note - If the pool_type is unsupported, it uses standard free().
- * @note If the reused block list in the pool is full, it falls back to standard free().
- * @note - it uses standard free() if the pointer is not from the pool.
+ * @note - it uses standard free() if the pointer is not from any chunk of the pool.
+ * @param manager_ptr Pointer to the memory manager owning the pool, may be NULL for NO_POOL.
  * @param ptr Pointer to the memory block to free.
- * @param pool_type The type of memory pool the block was allocated from (LIST_POOL, TREE_POOL).
+ * @param pool_type The type of memory pool the block was allocated from (TREE_POOL).
+ */
+void free_memory(memory_manager *manager_ptr, void* ptr, memory_pool_type_t pool_type);
+
+/**
+ * @fn allocate_memory_from_slab
+ * @brief Allocates a block from the smallest slab size class that fits the requested size.
+ *
+ * @note - Sizes above MEMORY_SLAB_MAX_BLOCK_SIZE, and managers without slab pools, are served by the heap.
+ * @note - The block must be released with free_memory_to_slab() and the same size.
+ * @param manager_ptr Pointer to the memory manager owning the slab, may be NULL to use the heap.
+ * @param size Number of bytes to allocate.
+ * @return Pointer to the allocated block, or NULL if allocation fails.
+ */
+void* allocate_memory_from_slab(memory_manager *manager_ptr, size_t size);
+
+/**
+ * @fn reallocate_memory_from_slab
+ * @brief Resizes a block allocated with allocate_memory_from_slab().
+ *
+ * The block is kept if the new size falls into the same size class, otherwise a block of the
+ * new class is allocated, the contents are copied and the old block is freed.
+ *
+ * @param manager_ptr Pointer to the memory manager the block was allocated from, may be NULL.
+ * @param ptr Pointer to the block, NULL allocates a new block.
+ * @param old_size The size the block was allocated or last resized with.
+ * @param new_size The new size in bytes, must not be 0.
+ * @return Pointer to the resized block, or NULL if allocation fails (the old block is left unchanged).
+ */
+void* reallocate_memory_from_slab(memory_manager *manager_ptr, void *ptr, size_t old_size, size_t new_size);
+
+/**
+ * @fn free_memory_to_slab
+ * @brief Returns a block allocated with allocate_memory_from_slab() to its size class.
+ *
+ * @param manager_ptr Pointer to the memory manager the block was allocated from, may be NULL.
+ * @param ptr Pointer to the block to free.
+ * @param size The size the block was allocated or last resized with.
+ */
+void free_memory_to_slab(memory_manager *manager_ptr, void *ptr, size_t size);
+
+/**
+ * @fn get_memory_manager_usage
+ * @brief Reports the reserved, used and cached bytes of the pools of a memory manager.
+ *
+ * Blocks held in thread magazines are counted as free, so the figures are exact even
+ * while other threads have blocks cached. The byte counts include the slab pools, whose
+ * occupancy is also reported per size class.
+ *
+ * @param manager_ptr Pointer to the memory manager.
+ * @param usage_out Pointer to receive the byte counts.
+ * @return 0 on success, -20 on invalid input.
  */
-void free_memory(void* ptr, memory_pool_type_t pool_type);
+int get_memory_manager_usage(memory_manager *manager_ptr, memory_pool_usage *usage_out);
 
 #endif // MEMORY_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "core/key_store.h"
+#include "core/type_definition.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <time.h>
+#include <inttypes.h>
+
+
+#define DEFAULT_NUM_KEYS (1u << 22)
+#define NUM_LOOKUPS 1048576
+#define MAX_BATCH_SIZE 128
+#define KEY_SIZE 16
+#define VALUE_SIZE 32
+
+// The table holds millions of keys, far more than the caches, so every key of a batch pays for
+// cache misses on its bucket header, its chain and its value. A loop over get_key takes those
+// misses one after the other; get_keys overlaps the misses of the keys within a group.
+// The key count can be passed as the first argument.
+
+static inline uint64_t timespec_diff_ns(const struct timespec *start, const struct timespec *end) {
+    return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000ULL + (end->tv_nsec - start->tv_nsec);
+}
+
+// Returns the throughput in million keys per second of batched gets or sets of the given size
+static double time_batches(key_store *store, const char *key_storage, unsigned int num_keys, size_t batch_size, int is_set, int *failures) {
+    const char *keys[MAX_BATCH_SIZE];
+    key_store_value values[MAX_BATCH_SIZE];
+    int results[MAX_BATCH_SIZE];
+    unsigned char value[VALUE_SIZE];
+    memset(value, 's', sizeof(value));
+    unsigned int seed = (unsigned int)batch_size * 7919 + (unsigned int)is_set;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t done = 0; done < NUM_LOOKUPS; done += batch_size) {
+        for (size_t i = 0; i < batch_size; ++i) {
+            keys[i] = key_storage + (size_t)((unsigned int)rand_r(&seed) % num_keys) * KEY_SIZE;
+            values[i] = is_set ? (key_store_value){ value, sizeof(value) } : (key_store_value){0};
+        }
+
+        if (is_set) {
+            if (store_set_keys(store, keys, batch_size, values, results) != 0) (*failures)++;
+        } else {
+            if (store_get_keys(store, keys, batch_size, values, results) != 0) (*failures)++;
+            for (size_t i = 0; i < batch_size; ++i) free(values[i].data);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return NUM_LOOKUPS / ((double)timespec_diff_ns(&start, &end) / 1000.0);
+}
+
+// Returns the throughput in million keys per second of a plain loop over get_key
+static double time_single_gets(key_store *store, const char *key_storage, unsigned int num_keys, int *failures) {
+    unsigned int seed = 1;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t done = 0; done < NUM_LOOKUPS; ++done) {
+        key_store_value out = {0};
+        if (store_get_key(store, key_storage + (size_t)((unsigned int)rand_r(&seed) % num_keys) * KEY_SIZE, &out) != 0) (*failures)++;
+        free(out.data);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return NUM_LOOKUPS / ((double)timespec_diff_ns(&start, &end) / 1000.0);
+}
+
+int main(int argc, char **argv) {
+
+    unsigned int num_keys = (argc > 1) ? (unsigned int)strtoul(argv[1], NULL, 10) : DEFAULT_NUM_KEYS;
+    if (num_keys == 0) num_keys = DEFAULT_NUM_KEYS;
+
+    printf("Starting batch benchmark...\n");
+    printf("Keys: %u, keys per measurement: %d, value size: %d\n", num_keys, NUM_LOOKUPS, VALUE_SIZE);
+
+    key_store_config config = {
+        .bucket_size = 1024,
+        .pre_memory_allocation_factor = 1,
+        .is_concurrency_enabled = true,
+        .grow_load_factor = KEY_STORE_DEFAULT_GROW_LOAD_FACTOR,
+        .treeify_threshold = KEY_STORE_DEFAULT_TREEIFY_THRESHOLD,
+        .inline_value_threshold = KEY_STORE_DEFAULT_INLINE_VALUE_THRESHOLD
+    };
+
+    char *key_storage = malloc((size_t)num_keys * KEY_SIZE);
+    key_store *store = NULL;
+    if (key_storage == NULL || create_key_store(config, &store) != 0) {
+        printf("Failed to set up the key store.\n");
+        return 1;
+    }
+
+    int failures = 0;
+    unsigned char value[VALUE_SIZE];
+    memset(value, 'v', sizeof(value));
+    key_store_value kv = { value, sizeof(value) };
+    for (unsigned int i = 0; i < num_keys; ++i) {
+        char *key = key_storage + (size_t)i * KEY_SIZE;
+        snprintf(key, KEY_SIZE, "batch%u", i);
+        if (store_set_key(store, key, &kv) != 0) failures++;
+    }
+
+    keystore_stats stats = store_get_keystore_stats(store);
+    printf("Table: %u buckets, %.1f MB of nodes\n", stats.key_entries.total_buckets, (double)stats.memory_pool.memory_per_key_bytes * num_keys / (1024.0 * 1024.0));
+    printf("get_key loop: %.2f Mkeys/s\n", time_single_gets(store, key_storage, num_keys, &failures));
+    printf("%8s %16s %16s\n", "batch", "get (Mkeys/s)", "set (Mkeys/s)");
+
+    for (size_t batch_size = 1; batch_size <= MAX_BATCH_SIZE; batch_size *= 2) {
+        double get_rate = time_batches(store, key_storage, num_keys, batch_size, 0, &failures);
+        double set_rate = time_batches(store, key_storage, num_keys, batch_size, 1, &failures);
+        printf("%8zu %16.2f %16.2f\n", batch_size, get_rate, set_rate);
+    }
+
+    destroy_key_store(store);
+    free(key_storage);
+
+    printf("Failed batches: %d\n", failures);
+    printf("=================================\n");
+    printf("Result: %s\n", failures == 0 ? "PASS" : "FAIL");
+    printf("=================================\n");
+    return failures == 0 ? 0 : 1;
+}
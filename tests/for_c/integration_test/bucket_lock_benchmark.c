@@ -0,0 +1,195 @@
+#include "core/key_store.h"
+#include "core/type_definition.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <stdatomic.h>
+#include <time.h>
+#include <inttypes.h>
+
+
+#define MAX_THREADS 16
+#define NUM_KEYS 4096
+#define NUM_OPS_PER_THREAD 200000
+#define GET_PERCENT 90 // The remainder are sets
+#define ZIPF_EXPONENT 0.99 // YCSB's default skew, the hottest key draws about 1 in 9 accesses
+#define NUM_STRIPES 64 // Lock stripes of the striped variants (4 x 16 threads)
+#define INIT_BUCKET_SIZE (1u << 22) // Table size of the initialization comparison
+
+static atomic_int failed_ops = 0;
+static char keys[NUM_KEYS][16];
+static double zipf_cdf[NUM_KEYS];
+
+// A bucket lock setup under test
+typedef struct {
+    const char *name;
+    key_store_bucket_lock_t bucket_lock;
+    unsigned int stripes;
+} lock_variant;
+
+static const lock_variant variants[] = {
+    { "rwlock", KEY_STORE_BUCKET_LOCK_RWLOCK, 0 },
+    { "spin", KEY_STORE_BUCKET_LOCK_SPIN, 0 },
+    { "ticket", KEY_STORE_BUCKET_LOCK_TICKET, 0 },
+    { "rwlock/64", KEY_STORE_BUCKET_LOCK_RWLOCK, NUM_STRIPES },
+    { "spin/64", KEY_STORE_BUCKET_LOCK_SPIN, NUM_STRIPES },
+};
+#define NUM_VARIANTS (int)(sizeof(variants) / sizeof(variants[0]))
+
+// Thread context
+typedef struct {
+    key_store *store;
+    int thread_id;
+    unsigned int seed;
+    bool is_zipfian;
+} thread_ctx;
+
+// All threads share one key space, so unlike shard_scaling_benchmark they contend on the same
+// buckets: uniformly spread over the table, or concentrated on a few hot buckets under Zipf
+
+static inline uint64_t timespec_diff_ns(const struct timespec *start, const struct timespec *end) {
+    return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000ULL + (end->tv_nsec - start->tv_nsec);
+}
+
+static void build_zipf_cdf(void) {
+    double sum = 0;
+    for (int i = 0; i < NUM_KEYS; ++i) {
+        sum += 1.0 / pow(i + 1, ZIPF_EXPONENT);
+        zipf_cdf[i] = sum;
+    }
+    for (int i = 0; i < NUM_KEYS; ++i) zipf_cdf[i] /= sum;
+}
+
+static int next_key_index(thread_ctx *ctx) {
+    if (!ctx->is_zipfian) return rand_r(&ctx->seed) % NUM_KEYS;
+
+    double u = (double)rand_r(&ctx->seed) / ((double)RAND_MAX + 1.0);
+    int low = 0, high = NUM_KEYS - 1;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (zipf_cdf[mid] < u) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+void *thread_get_set(void *arg) {
+    thread_ctx *ctx = (thread_ctx *)arg;
+    unsigned char value[32];
+    memset(value, ctx->thread_id, sizeof(value));
+    key_store_value kv = { value, sizeof(value) };
+    unsigned char buffer[64];
+
+    for (int i = 0; i < NUM_OPS_PER_THREAD; ++i) {
+        const char *key = keys[next_key_index(ctx)];
+
+        if ((int)(rand_r(&ctx->seed) % 100) < GET_PERCENT) {
+            size_t value_size = 0;
+            if (store_get_key_into(ctx->store, key, buffer, sizeof(buffer), &value_size) != 0) atomic_fetch_add(&failed_ops, 1);
+        } else if (store_set_key(ctx->store, key, &kv) != 0) {
+            atomic_fetch_add(&failed_ops, 1);
+        }
+    }
+    return NULL;
+}
+
+// Returns the throughput in operations per second, or a negative value on failure
+static double run_benchmark(const lock_variant *variant, bool is_zipfian, int num_threads, unsigned long long *p99_lock_wait_ns_out) {
+    key_store_config config = {
+        .bucket_size = 1024, // Fixed size, so every lock type runs on the same table
+        .pre_memory_allocation_factor = 1,
+        .is_concurrency_enabled = true,
+        .bucket_lock = variant->bucket_lock,
+        .bucket_lock_stripes = variant->stripes
+    };
+
+    key_store *store = NULL;
+    if (create_key_store(config, &store) != 0) return -1.0;
+
+    unsigned char value[32] = {0};
+    key_store_value kv = { value, sizeof(value) };
+    for (int i = 0; i < NUM_KEYS; ++i) {
+        if (store_set_key(store, keys[i], &kv) != 0) atomic_fetch_add(&failed_ops, 1);
+    }
+
+    pthread_t threads[MAX_THREADS];
+    thread_ctx ctxs[MAX_THREADS];
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < num_threads; ++i) {
+        ctxs[i] = (thread_ctx){ store, i, (unsigned int)(i * 7919 + 1), is_zipfian };
+        pthread_create(&threads[i], NULL, thread_get_set, &ctxs[i]);
+    }
+    for (int i = 0; i < num_threads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *p99_lock_wait_ns_out = store_get_keystore_stats(store).latency.lock_wait.p99_ns; // 0 without operation counters
+    destroy_key_store(store);
+
+    double total_sec = timespec_diff_ns(&start, &end) / 1e9;
+    return (double)num_threads * NUM_OPS_PER_THREAD / total_sec;
+}
+
+int main() {
+
+    printf("Starting bucket lock benchmark...\n");
+
+    for (int i = 0; i < NUM_KEYS; ++i) snprintf(keys[i], sizeof(keys[i]), "key_%d", i);
+    build_zipf_cdf();
+
+    const char *distributions[] = { "uniform", "zipfian" };
+    int failures = 0;
+
+    // Creating a large table: per-bucket locks are initialized one by one, stripes once
+    printf("Table initialization, %u buckets\n", INIT_BUCKET_SIZE);
+    printf("%12s %14s %18s\n", "locks", "init (ms)", "table (MiB)");
+    for (int l = 0; l < NUM_VARIANTS; ++l) {
+        key_store_config config = { .bucket_size = INIT_BUCKET_SIZE, .pre_memory_allocation_factor = 0.01, .is_concurrency_enabled = true, .bucket_lock = variants[l].bucket_lock, .bucket_lock_stripes = variants[l].stripes };
+        key_store *store = NULL;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (create_key_store(config, &store) != 0) {
+            failures++;
+            continue;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        size_t table_bytes = store_get_keystore_stats(store).memory_pool.total_memory_bytes; // Buckets, their locks and the small preallocated node pools
+        destroy_key_store(store);
+        printf("%12s %14.1f %18.1f\n", variants[l].name, timespec_diff_ns(&start, &end) / 1e6, table_bytes / (1024.0 * 1024.0));
+    }
+
+    printf("\nOps per thread: %d (%d%% gets), shared keys: %d, zipf exponent: %.2f, 1024 buckets\n", NUM_OPS_PER_THREAD, GET_PERCENT, NUM_KEYS, ZIPF_EXPONENT);
+    printf("Throughput in ops/s, p99 bucket lock wait in ns in brackets; name/64 shares %d lock stripes\n", NUM_STRIPES);
+
+    for (int d = 0; d < 2; ++d) {
+        printf("\n%s access\n", distributions[d]);
+        printf("%8s", "threads");
+        for (int l = 0; l < NUM_VARIANTS; ++l) printf(" %24s", variants[l].name);
+        printf("\n");
+        for (int num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2) {
+            printf("%8d", num_threads);
+            for (int l = 0; l < NUM_VARIANTS; ++l) {
+                unsigned long long p99_lock_wait_ns = 0;
+                double throughput = run_benchmark(&variants[l], d == 1, num_threads, &p99_lock_wait_ns);
+                if (throughput < 0) failures++;
+                printf(" %14.0f [%7llu]", throughput, p99_lock_wait_ns);
+            }
+            printf("\n");
+        }
+    }
+
+    printf("Failed ops: %d\n", atomic_load(&failed_ops));
+    failures += atomic_load(&failed_ops);
+
+    printf("=================================\n");
+    printf("Result: %s\n", failures == 0 ? "PASS" : "FAIL");
+    printf("=================================\n");
+    return failures == 0 ? 0 : 1;
+}
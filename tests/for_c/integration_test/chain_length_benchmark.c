@@ -0,0 +1,93 @@
+#include "core/key_store.h"
+#include "core/type_definition.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <time.h>
+#include <inttypes.h>
+
+
+#define NUM_BUCKETS 16384
+#define MAX_CHAIN_LENGTH 16
+#define NUM_LOOKUPS 400000
+#define VALUE_SIZE 32
+
+// Growth and treeification are disabled, so every bucket of a table with NUM_BUCKETS * length keys
+// holds a chain of about that length. The table is larger than the caches, so each lookup mostly
+// pays the cache misses of walking one chain: hits stop at a random position, misses walk the whole chain.
+
+static inline uint64_t timespec_diff_ns(const struct timespec *start, const struct timespec *end) {
+    return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000ULL + (end->tv_nsec - start->tv_nsec);
+}
+
+// Returns the average nanoseconds per lookup, or a negative value on failure
+static double time_lookups(key_store *store, unsigned int key_count, int is_hit, unsigned int *seed, int *failures) {
+    char key[32];
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < NUM_LOOKUPS; ++i) {
+        unsigned int key_index = (unsigned int)rand_r(seed) % key_count;
+        snprintf(key, sizeof(key), is_hit ? "chain%u" : "absent%u", key_index);
+
+        key_store_value out = {0};
+        int result = store_get_key(store, key, &out);
+        if (result != (is_hit ? 0 : -41)) (*failures)++;
+        free(out.data);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double)timespec_diff_ns(&start, &end) / NUM_LOOKUPS;
+}
+
+int main() {
+
+    printf("Starting chain length benchmark...\n");
+    printf("Buckets: %d, lookups per chain length: %d, value size: %d\n", NUM_BUCKETS, NUM_LOOKUPS, VALUE_SIZE);
+    printf("%8s %10s %14s %14s %16s\n", "length", "keys", "hit (ns/op)", "miss (ns/op)", "memory/key (B)");
+
+    key_store_config config = {
+        .bucket_size = NUM_BUCKETS,
+        .pre_memory_allocation_factor = 1,
+        .is_concurrency_enabled = false,
+        .grow_load_factor = 0,
+        .shrink_load_factor = 0,
+        .treeify_threshold = 0,
+        .inline_value_threshold = KEY_STORE_DEFAULT_INLINE_VALUE_THRESHOLD
+    };
+
+    unsigned char value[VALUE_SIZE];
+    memset(value, 'v', sizeof(value));
+    key_store_value kv = { value, sizeof(value) };
+    char key[32];
+    int failures = 0;
+
+    for (unsigned int length = 1; length <= MAX_CHAIN_LENGTH; ++length) {
+        key_store *store = NULL;
+        if (create_key_store(config, &store) != 0) {
+            printf("Failed to create key store for chain length %u.\n", length);
+            return 1;
+        }
+
+        unsigned int key_count = NUM_BUCKETS * length;
+        for (unsigned int i = 0; i < key_count; ++i) {
+            snprintf(key, sizeof(key), "chain%u", i);
+            if (store_set_key(store, key, &kv) != 0) failures++;
+        }
+
+        unsigned int seed = length * 7919 + 1;
+        double hit_ns = time_lookups(store, key_count, 1, &seed, &failures);
+        double miss_ns = time_lookups(store, key_count, 0, &seed, &failures);
+        keystore_stats stats = store_get_keystore_stats(store);
+        printf("%8u %10u %14.1f %14.1f %16zu\n", length, key_count, hit_ns, miss_ns, stats.memory_pool.memory_per_key_bytes);
+
+        destroy_key_store(store);
+    }
+
+    printf("Failed ops: %d\n", failures);
+    printf("=================================\n");
+    printf("Result: %s\n", failures == 0 ? "PASS" : "FAIL");
+    printf("=================================\n");
+    return failures == 0 ? 0 : 1;
+}
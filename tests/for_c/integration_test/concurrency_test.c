@@ -12,12 +12,6 @@
 
 #define NUM_THREADS 1000
 #define NUM_KEYS_PER_THREAD 1000
-#define MAX_OPS (NUM_THREADS * NUM_KEYS_PER_THREAD)
-
-static uint64_t set_latencies_ns[MAX_OPS];
-static uint64_t get_latencies_ns[MAX_OPS];
-static atomic_int set_latency_idx = 0;
-static atomic_int get_latency_idx = 0;
 
 static atomic_int race_errors = 0;
 
@@ -48,56 +42,31 @@ void *thread_set_get(void *arg) {
         memset(value, ctx->thread_id, sizeof(value));
         kv.data_size = sizeof(value);
 
-        struct timespec t1, t2;
-        clock_gettime(CLOCK_MONOTONIC, &t1);
         int set_result = set_key(key, &kv);
-        clock_gettime(CLOCK_MONOTONIC, &t2);
         if(set_result != 0) {
             printf("[Thread %d] Failed to set key %s, due to %d\n", ctx->thread_id, key, set_result);
             atomic_fetch_add(&race_errors, 1);
-        } else {
-            int idx = atomic_fetch_add(&set_latency_idx, 1);
-            if (idx < MAX_OPS) set_latencies_ns[idx] = timespec_diff_ns(&t1, &t2);
         }
 
         key_store_value out = {0};
-        clock_gettime(CLOCK_MONOTONIC, &t1);
         int get_result = get_key(key, &out);
-        clock_gettime(CLOCK_MONOTONIC, &t2);
         if (get_result != 0) {
             printf("[Thread %d] Key missing after set (bucket-level concurrency) on key %s\n", ctx->thread_id, key);
             atomic_fetch_add(&race_errors, 1);
-        } else {
-            int idx = atomic_fetch_add(&get_latency_idx, 1);
-            if (idx < MAX_OPS) get_latencies_ns[idx] = timespec_diff_ns(&t1, &t2);
         }
         if (out.data) free((void *)out.data); // Use custom allocator if required by your API
     }
     return NULL;
 }
-// Helper to compare uint64_t for qsort
-static int cmp_uint64(const void *a, const void *b) {
-    uint64_t va = *(const uint64_t *)a, vb = *(const uint64_t *)b;
-    return (va > vb) - (va < vb);
-}
 
-void print_latency_report(const char *op, uint64_t *latencies, int count) {
-    if (count == 0) {
+// Prints the distribution the key store recorded for one histogram
+static void print_latency_report(const char *op, const latency_distribution_stats *latency) {
+    if (latency->sample_count == 0) {
         printf("No %s operations recorded.\n", op);
         return;
     }
-    // Copy and sort
-    uint64_t *tmp = malloc(count * sizeof(uint64_t));
-    memcpy(tmp, latencies, count * sizeof(uint64_t));
-    qsort(tmp, count, sizeof(uint64_t), cmp_uint64);
-    double avg = 0.0;
-    for (int i = 0; i < count; ++i) avg += tmp[i];
-    avg /= count;
-    uint64_t p50 = tmp[(int)(0.50 * count)];
-    uint64_t p95 = tmp[(int)(0.95 * count)];
-    uint64_t p99 = tmp[(int)(0.99 * count)];
-    printf("%s latency (ns): avg=%.0f, p50=%" PRIu64 ", p95=%" PRIu64 ", p99=%" PRIu64 "\n", op, avg, p50, p95, p99);
-    free(tmp);
+    printf("%s latency (ns): count=%lu, avg=%.0f, p50=%llu, p90=%llu, p99=%llu, p99.9=%llu, max=%llu\n", op, latency->sample_count, latency->mean_ns,
+           latency->p50_ns, latency->p90_ns, latency->p99_ns, latency->p999_ns, latency->max_ns);
 }
 
 
@@ -132,21 +101,21 @@ int main() {
     // --- Statistics ---
     keystore_stats stats = get_keystore_stats();
 
-    int set_count = atomic_load(&set_latency_idx);
-    int get_count = atomic_load(&get_latency_idx);
+    unsigned long total_ops = 2UL * NUM_THREADS * NUM_KEYS_PER_THREAD; // One set and one get per key
     uint64_t total_ns = timespec_diff_ns(&global_start, &global_end);
     double total_sec = total_ns / 1e9;
-    double throughput = (set_count + get_count) / total_sec;
+    double throughput = total_ops / total_sec;
 
     printf("Test scenario: Bucket-level concurrency with %d threads each setting/getting %d unique keys.\n", NUM_THREADS, NUM_KEYS_PER_THREAD);
     printf("==== Concurrency Test Report ====\n");
     printf("Total threads: %d\n", NUM_THREADS);
     printf("Number of keys per thread: %d\n", NUM_KEYS_PER_THREAD);
-    printf("Total ops: %d\n", set_count + get_count);
+    printf("Total ops: %lu\n", total_ops);
     printf("Total time: %.3fs\n", total_sec);
     printf("Throughput: %.2f ops/sec\n", throughput);
-    print_latency_report("SET", set_latencies_ns, set_count);
-    print_latency_report("GET", get_latencies_ns, get_count);
+    print_latency_report("SET", &stats.latency.set);
+    print_latency_report("GET", &stats.latency.get);
+    print_latency_report("Lock wait", &stats.latency.lock_wait);
     printf("\n-- Metadata --\n");
     printf("Init timestamp: %llu\n", (unsigned long long)stats.metadata.init_timestamp);
     printf("Last cleanup timestamp: %llu\n", (unsigned long long)stats.metadata.last_cleanup_timestamp);
@@ -0,0 +1,194 @@
+#include "core/key_store.h"
+#include "core/type_definition.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <stdatomic.h>
+#include <time.h>
+#include <inttypes.h>
+
+
+#define NUM_THREADS 128
+#define NUM_HOT_KEYS 64
+#define NUM_OPS_PER_THREAD 20000
+#define GET_PERCENT 70
+#define DELETE_PERCENT 15 // The remainder are sets
+#define BATCH_GET_SIZE 8
+
+static atomic_int corrupted_reads = 0;
+static atomic_int failed_ops = 0;
+static atomic_long get_hits = 0;
+static atomic_long get_misses = 0;
+static atomic_long deletes = 0;
+static atomic_long sets = 0;
+
+// Thread context
+typedef struct {
+    int thread_id;
+    unsigned int seed;
+} thread_ctx;
+
+// All threads hammer the same few keys, so gets constantly race with deletes of the node they found
+
+static inline uint64_t timespec_diff_ns(const struct timespec *start, const struct timespec *end) {
+    return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000ULL + (end->tv_nsec - start->tv_nsec);
+}
+
+// Every value of key i is (16 + i % 16) bytes long and filled with a single byte
+static size_t value_size_for_key(int key_index) {
+    return 16 + (size_t)(key_index % 16);
+}
+
+static int is_value_valid(int key_index, const key_store_value *value) {
+    if (value->data == NULL || value->data_size != value_size_for_key(key_index)) return 0;
+    for (size_t i = 1; i < value->data_size; ++i) {
+        if (value->data[i] != value->data[0]) return 0;
+    }
+    return 1;
+}
+
+void *thread_get_delete(void *arg) {
+    thread_ctx *ctx = (thread_ctx *)arg;
+    char key[32];
+    unsigned char value[32];
+
+    for (int i = 0; i < NUM_OPS_PER_THREAD; ++i) {
+        int key_index = rand_r(&ctx->seed) % NUM_HOT_KEYS;
+        int op = rand_r(&ctx->seed) % 100;
+        snprintf(key, sizeof(key), "hot%d", key_index);
+
+        if (op < GET_PERCENT && i % 4 == 0) {
+            // Every fourth get is a batch, its keys race with deletes and sets like single gets do
+            char batch_key_storage[BATCH_GET_SIZE][32];
+            const char *batch_keys[BATCH_GET_SIZE];
+            int batch_indices[BATCH_GET_SIZE];
+            key_store_value batch_out[BATCH_GET_SIZE] = {0};
+            int batch_results[BATCH_GET_SIZE];
+            for (int b = 0; b < BATCH_GET_SIZE; ++b) {
+                batch_indices[b] = (b == 0) ? key_index : rand_r(&ctx->seed) % NUM_HOT_KEYS;
+                snprintf(batch_key_storage[b], sizeof(batch_key_storage[b]), "hot%d", batch_indices[b]);
+                batch_keys[b] = batch_key_storage[b];
+            }
+            get_keys(batch_keys, BATCH_GET_SIZE, batch_out, batch_results);
+            for (int b = 0; b < BATCH_GET_SIZE; ++b) {
+                if (batch_results[b] == 0) {
+                    atomic_fetch_add(&get_hits, 1);
+                    if (!is_value_valid(batch_indices[b], &batch_out[b])) {
+                        printf("[Thread %d] Corrupted batched value for key %s (size %zu)\n", ctx->thread_id, batch_keys[b], batch_out[b].data_size);
+                        atomic_fetch_add(&corrupted_reads, 1);
+                    }
+                } else if (batch_results[b] == -41) {
+                    atomic_fetch_add(&get_misses, 1);
+                } else {
+                    atomic_fetch_add(&failed_ops, 1);
+                }
+                if (batch_out[b].data) free((void *)batch_out[b].data);
+            }
+        } else if (op < GET_PERCENT) {
+            key_store_value out = {0};
+            int get_result = get_key(key, &out);
+            if (get_result == 0) {
+                atomic_fetch_add(&get_hits, 1);
+                if (!is_value_valid(key_index, &out)) {
+                    printf("[Thread %d] Corrupted value for key %s (size %zu)\n", ctx->thread_id, key, out.data_size);
+                    atomic_fetch_add(&corrupted_reads, 1);
+                }
+            } else if (get_result == -41) {
+                atomic_fetch_add(&get_misses, 1);
+            } else {
+                atomic_fetch_add(&failed_ops, 1);
+            }
+            if (out.data) free((void *)out.data);
+        } else if (op < GET_PERCENT + DELETE_PERCENT) {
+            int delete_result = delete_key(key);
+            if (delete_result != 0 && delete_result != -41) atomic_fetch_add(&failed_ops, 1);
+            atomic_fetch_add(&deletes, 1);
+        } else {
+            memset(value, ctx->thread_id + i, sizeof(value));
+            key_store_value kv = { value, value_size_for_key(key_index) };
+            if (set_key(key, &kv) != 0) atomic_fetch_add(&failed_ops, 1);
+            atomic_fetch_add(&sets, 1);
+        }
+    }
+    return NULL;
+}
+
+static int run_scenario(const char *name, key_store_config config) {
+    atomic_store(&corrupted_reads, 0);
+    atomic_store(&failed_ops, 0);
+    atomic_store(&get_hits, 0);
+    atomic_store(&get_misses, 0);
+    atomic_store(&deletes, 0);
+    atomic_store(&sets, 0);
+
+    if (initialise_key_store_with_config(config) != 0) {
+        printf("Failed to initialize key store for scenario %s.\n", name);
+        return -1;
+    }
+
+    pthread_t threads[NUM_THREADS];
+    thread_ctx ctxs[NUM_THREADS];
+
+    struct timespec global_start, global_end;
+    clock_gettime(CLOCK_MONOTONIC, &global_start);
+
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        ctxs[i].thread_id = i;
+        ctxs[i].seed = (unsigned int)(i * 7919 + 1);
+        pthread_create(&threads[i], NULL, thread_get_delete, &ctxs[i]);
+    }
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &global_end);
+
+    keystore_stats stats = get_keystore_stats();
+    double total_sec = timespec_diff_ns(&global_start, &global_end) / 1e9;
+    long total_ops = (long)NUM_THREADS * NUM_OPS_PER_THREAD;
+
+    printf("==== Get/Delete Stress Report: %s ====\n", name);
+    printf("Threads: %d, hot keys: %d, ops per thread: %d\n", NUM_THREADS, NUM_HOT_KEYS, NUM_OPS_PER_THREAD);
+    printf("Total time: %.3fs\n", total_sec);
+    printf("Throughput: %.2f ops/sec\n", total_ops / total_sec);
+    printf("Get hits: %ld, get misses: %ld, deletes: %ld, sets: %ld\n", atomic_load(&get_hits), atomic_load(&get_misses), atomic_load(&deletes), atomic_load(&sets));
+    printf("Keys left: %u\n", stats.key_entries.total_keys);
+    printf("Corrupted reads: %d\n", atomic_load(&corrupted_reads));
+    printf("Failed ops: %d\n", atomic_load(&failed_ops));
+
+    cleanup_key_store();
+
+    int is_passed = atomic_load(&corrupted_reads) == 0 && atomic_load(&failed_ops) == 0 && stats.key_entries.total_keys <= NUM_HOT_KEYS;
+    printf("Result: %s\n\n", is_passed ? "PASS" : "FAIL");
+    return is_passed ? 0 : 1;
+}
+
+int main() {
+
+    printf("Starting get/delete stress test...\n");
+
+    key_store_config config = {
+        .bucket_size = 16,
+        .pre_memory_allocation_factor = 1,
+        .is_concurrency_enabled = true,
+        .grow_load_factor = KEY_STORE_DEFAULT_GROW_LOAD_FACTOR,
+        .shrink_load_factor = KEY_STORE_DEFAULT_SHRINK_LOAD_FACTOR,
+        .treeify_threshold = KEY_STORE_DEFAULT_TREEIFY_THRESHOLD
+    };
+
+    int failures = run_scenario("bucket locks with pinned data nodes", config);
+
+    config.is_lock_free_read_enabled = true;
+    failures += run_scenario("lock-free reads with epoch reclamation", config);
+
+    config.is_lock_free_read_enabled = false;
+    config.engine = KEY_STORE_ENGINE_SWISS;
+    failures += run_scenario("swiss table engine", config);
+
+    printf("=================================\n");
+    printf("Result: %s\n", failures == 0 ? "PASS" : "FAIL");
+    printf("=================================\n");
+    return failures == 0 ? 0 : 1;
+}
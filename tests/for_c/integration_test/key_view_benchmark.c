@@ -0,0 +1,112 @@
+#include "core/key_store.h"
+#include "core/type_definition.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <time.h>
+#include <inttypes.h>
+
+
+#define NUM_KEYS 256
+#define NUM_LOOKUPS 200000
+
+// Every lookup reads the first and last byte of the value, so the copied read pays for
+// allocating, copying and freeing the whole value, the read into a reused buffer only for the
+// copy, and the view only touches two bytes.
+
+static const size_t value_sizes[] = { 64, 1024, 4096, 16384, 65536 };
+
+typedef enum { READ_COPY, READ_INTO, READ_VIEW } read_mode_t;
+
+static unsigned char scratch[65536]; // Reused by every READ_INTO lookup
+
+static inline uint64_t timespec_diff_ns(const struct timespec *start, const struct timespec *end) {
+    return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000ULL + (end->tv_nsec - start->tv_nsec);
+}
+
+static int sum_ends(const unsigned char *data, size_t data_size, void *context) {
+    *(unsigned long *)context += data[0] + data[data_size - 1];
+    return 0;
+}
+
+// Returns the average nanoseconds per lookup in the given read mode
+static double time_lookups(key_store *store, read_mode_t mode, unsigned long *checksum, int *failures) {
+    unsigned int seed = 12345;
+    char key[32];
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < NUM_LOOKUPS; ++i) {
+        snprintf(key, sizeof(key), "view%u", (unsigned int)rand_r(&seed) % NUM_KEYS);
+        int result = 0;
+        if (mode == READ_VIEW) {
+            result = store_get_key_view(store, key, sum_ends, checksum);
+        } else if (mode == READ_INTO) {
+            size_t value_size = 0;
+            result = store_get_key_into(store, key, scratch, sizeof(scratch), &value_size);
+            if (result == 0) sum_ends(scratch, value_size, checksum);
+        } else {
+            key_store_value out = {0};
+            result = store_get_key(store, key, &out);
+            if (result == 0) sum_ends(out.data, out.data_size, checksum);
+            free(out.data);
+        }
+        if (result != 0) (*failures)++;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double)timespec_diff_ns(&start, &end) / NUM_LOOKUPS;
+}
+
+int main() {
+
+    printf("Starting key view benchmark...\n");
+    printf("Keys: %d, lookups per value size: %d\n", NUM_KEYS, NUM_LOOKUPS);
+    printf("%12s %14s %14s %14s\n", "value bytes", "copy (ns/op)", "into (ns/op)", "view (ns/op)");
+
+    key_store_config config = {
+        .bucket_size = NUM_KEYS,
+        .pre_memory_allocation_factor = 1,
+        .is_concurrency_enabled = true,
+        .grow_load_factor = KEY_STORE_DEFAULT_GROW_LOAD_FACTOR,
+        .treeify_threshold = KEY_STORE_DEFAULT_TREEIFY_THRESHOLD,
+        .inline_value_threshold = KEY_STORE_DEFAULT_INLINE_VALUE_THRESHOLD
+    };
+
+    char key[32];
+    int failures = 0;
+
+    for (size_t s = 0; s < sizeof(value_sizes) / sizeof(value_sizes[0]); ++s) {
+        size_t value_size = value_sizes[s];
+        unsigned char *value = malloc(value_size);
+        key_store *store = NULL;
+        if (value == NULL || create_key_store(config, &store) != 0) {
+            printf("Failed to set up the key store for %zu-byte values.\n", value_size);
+            return 1;
+        }
+
+        memset(value, 'v', value_size);
+        key_store_value kv = { value, value_size };
+        for (unsigned int i = 0; i < NUM_KEYS; ++i) {
+            snprintf(key, sizeof(key), "view%u", i);
+            if (store_set_key(store, key, &kv) != 0) failures++;
+        }
+
+        unsigned long copy_checksum = 0, into_checksum = 0, view_checksum = 0;
+        double copy_ns = time_lookups(store, READ_COPY, &copy_checksum, &failures);
+        double into_ns = time_lookups(store, READ_INTO, &into_checksum, &failures);
+        double view_ns = time_lookups(store, READ_VIEW, &view_checksum, &failures);
+        if (copy_checksum != into_checksum || copy_checksum != view_checksum) failures++;
+        printf("%12zu %14.1f %14.1f %14.1f\n", value_size, copy_ns, into_ns, view_ns);
+
+        destroy_key_store(store);
+        free(value);
+    }
+
+    printf("Failed ops: %d\n", failures);
+    printf("=================================\n");
+    printf("Result: %s\n", failures == 0 ? "PASS" : "FAIL");
+    printf("=================================\n");
+    return failures == 0 ? 0 : 1;
+}
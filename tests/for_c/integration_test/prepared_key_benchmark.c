@@ -0,0 +1,96 @@
+#include "core/key_store.h"
+#include "core/type_definition.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <time.h>
+#include <inttypes.h>
+
+
+#define NUM_KEYS 4096
+#define NUM_LOOKUPS 2000000
+#define VALUE_SIZE 16
+
+// The key set is small enough to stay in cache, so a lookup mostly pays for hashing the key,
+// walking a short chain and comparing and copying bytes. Prepared keys skip the hashing step.
+
+static const size_t key_sizes[] = { 8, 32, 256 };
+
+static inline uint64_t timespec_diff_ns(const struct timespec *start, const struct timespec *end) {
+    return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000ULL + (end->tv_nsec - start->tv_nsec);
+}
+
+// Returns the average nanoseconds per lookup, hashing every key or using its prepared hash
+static double time_lookups(key_store *store, unsigned char *keys, size_t key_size, key_store_prepared_key *prepared, int use_prepared, int *failures) {
+    unsigned int seed = 12345;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < NUM_LOOKUPS; ++i) {
+        unsigned int key_index = (unsigned int)rand_r(&seed) % NUM_KEYS;
+        key_store_value out = {0};
+        int result = use_prepared ? store_get_prepared_key(store, &prepared[key_index], &out) : store_get_key_n(store, keys + key_index * key_size, key_size, &out);
+        if (result != 0) (*failures)++;
+        free(out.data);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (double)timespec_diff_ns(&start, &end) / NUM_LOOKUPS;
+}
+
+int main() {
+
+    printf("Starting prepared key benchmark...\n");
+    printf("Keys: %d, lookups per key size: %d, value size: %d\n", NUM_KEYS, NUM_LOOKUPS, VALUE_SIZE);
+    printf("%10s %16s %16s %14s\n", "key bytes", "hashed (ns/op)", "prepared (ns/op)", "saved (ns/op)");
+
+    key_store_config config = {
+        .bucket_size = NUM_KEYS,
+        .pre_memory_allocation_factor = 1,
+        .is_concurrency_enabled = false,
+        .grow_load_factor = KEY_STORE_DEFAULT_GROW_LOAD_FACTOR,
+        .treeify_threshold = KEY_STORE_DEFAULT_TREEIFY_THRESHOLD,
+        .inline_value_threshold = KEY_STORE_DEFAULT_INLINE_VALUE_THRESHOLD
+    };
+
+    unsigned char value[VALUE_SIZE];
+    memset(value, 'v', sizeof(value));
+    key_store_value kv = { value, sizeof(value) };
+    key_store_prepared_key *prepared = malloc(NUM_KEYS * sizeof(key_store_prepared_key));
+    int failures = 0;
+
+    for (size_t s = 0; s < sizeof(key_sizes) / sizeof(key_sizes[0]); ++s) {
+        size_t key_size = key_sizes[s];
+        unsigned char *keys = malloc(NUM_KEYS * key_size);
+        key_store *store = NULL;
+        if (keys == NULL || prepared == NULL || create_key_store(config, &store) != 0) {
+            printf("Failed to set up the key store for %zu-byte keys.\n", key_size);
+            return 1;
+        }
+
+        // Random binary keys, the key index in the first bytes keeps them distinct
+        unsigned int seed = (unsigned int)key_size;
+        for (unsigned int i = 0; i < NUM_KEYS; ++i) {
+            unsigned char *key = keys + i * key_size;
+            for (size_t b = 0; b < key_size; ++b) key[b] = (unsigned char)rand_r(&seed);
+            memcpy(key, &i, sizeof(i));
+            if (store_prepare_key(store, key, key_size, &prepared[i]) != 0) failures++;
+            if (store_set_prepared_key(store, &prepared[i], &kv) != 0) failures++;
+        }
+
+        double hashed_ns = time_lookups(store, keys, key_size, prepared, 0, &failures);
+        double prepared_ns = time_lookups(store, keys, key_size, prepared, 1, &failures);
+        printf("%10zu %16.1f %16.1f %14.1f\n", key_size, hashed_ns, prepared_ns, hashed_ns - prepared_ns);
+
+        destroy_key_store(store);
+        free(keys);
+    }
+    free(prepared);
+
+    printf("Failed ops: %d\n", failures);
+    printf("=================================\n");
+    printf("Result: %s\n", failures == 0 ? "PASS" : "FAIL");
+    printf("=================================\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#include "core/key_store.h"
+#include "core/type_definition.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <stdatomic.h>
+#include <time.h>
+#include <inttypes.h>
+
+
+#define MAX_THREADS 64
+#define NUM_KEYS_PER_THREAD 512
+#define NUM_OPS_PER_THREAD 20000
+#define GET_PERCENT 80 // The remainder are sets
+#define NUM_SHARDS 64
+
+static atomic_int failed_ops = 0;
+
+// Thread context
+typedef struct {
+    key_store *store;
+    int thread_id;
+    unsigned int seed;
+} thread_ctx;
+
+// Every thread mixes gets and sets on its own key range, so the only contention left is
+// the one the store itself adds: shared counters, memory pool locks and bucket locks
+
+static inline uint64_t timespec_diff_ns(const struct timespec *start, const struct timespec *end) {
+    return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000ULL + (end->tv_nsec - start->tv_nsec);
+}
+
+void *thread_get_set(void *arg) {
+    thread_ctx *ctx = (thread_ctx *)arg;
+    char key[32];
+    unsigned char value[32];
+    memset(value, ctx->thread_id, sizeof(value));
+    key_store_value kv = { value, sizeof(value) };
+
+    for (int i = 0; i < NUM_OPS_PER_THREAD; ++i) {
+        int key_index = rand_r(&ctx->seed) % NUM_KEYS_PER_THREAD;
+        snprintf(key, sizeof(key), "T%d_K%d", ctx->thread_id, key_index);
+
+        if ((int)(rand_r(&ctx->seed) % 100) < GET_PERCENT) {
+            key_store_value out = {0};
+            int get_result = store_get_key(ctx->store, key, &out);
+            if (get_result != 0 && get_result != -41) atomic_fetch_add(&failed_ops, 1);
+            free(out.data);
+        } else if (store_set_key(ctx->store, key, &kv) != 0) {
+            atomic_fetch_add(&failed_ops, 1);
+        }
+    }
+    return NULL;
+}
+
+// Returns the throughput in operations per second, or a negative value on failure
+static double run_benchmark(key_store_config config, int num_threads) {
+    key_store *store = NULL;
+    if (create_key_store(config, &store) != 0) return -1.0;
+
+    pthread_t threads[MAX_THREADS];
+    thread_ctx ctxs[MAX_THREADS];
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < num_threads; ++i) {
+        ctxs[i] = (thread_ctx){ store, i, (unsigned int)(i * 7919 + 1) };
+        pthread_create(&threads[i], NULL, thread_get_set, &ctxs[i]);
+    }
+    for (int i = 0; i < num_threads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    destroy_key_store(store);
+
+    double total_sec = timespec_diff_ns(&start, &end) / 1e9;
+    return (double)num_threads * NUM_OPS_PER_THREAD / total_sec;
+}
+
+int main() {
+
+    printf("Starting shard scaling benchmark...\n");
+
+    key_store_config config = {
+        .bucket_size = 1024,
+        .pre_memory_allocation_factor = 1,
+        .is_concurrency_enabled = true,
+        .grow_load_factor = KEY_STORE_DEFAULT_GROW_LOAD_FACTOR,
+        .shrink_load_factor = KEY_STORE_DEFAULT_SHRINK_LOAD_FACTOR,
+        .treeify_threshold = KEY_STORE_DEFAULT_TREEIFY_THRESHOLD
+    };
+
+    key_store_config sharded_config = config;
+    sharded_config.shard_count = NUM_SHARDS;
+
+    key_store_config affinity_config = sharded_config;
+    affinity_config.is_thread_affinity_enabled = true; // Threads get home shards round-robin, 64 threads never share one
+
+    printf("Ops per thread: %d (%d%% gets), keys per thread: %d, shards: %d\n", NUM_OPS_PER_THREAD, GET_PERCENT, NUM_KEYS_PER_THREAD, NUM_SHARDS);
+    printf("%8s %18s %18s %18s\n", "threads", "single (ops/s)", "sharded (ops/s)", "affinity (ops/s)");
+
+    int failures = 0;
+    for (int num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2) {
+        double single = run_benchmark(config, num_threads);
+        double sharded = run_benchmark(sharded_config, num_threads);
+        double affinity = run_benchmark(affinity_config, num_threads);
+        if (single < 0 || sharded < 0 || affinity < 0) failures++;
+        printf("%8d %18.0f %18.0f %18.0f\n", num_threads, single, sharded, affinity);
+    }
+
+    printf("Failed ops: %d\n", atomic_load(&failed_ops));
+    failures += atomic_load(&failed_ops);
+
+    printf("=================================\n");
+    printf("Result: %s\n", failures == 0 ? "PASS" : "FAIL");
+    printf("=================================\n");
+    return failures == 0 ? 0 : 1;
+}
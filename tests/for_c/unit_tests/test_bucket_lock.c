@@ -0,0 +1,238 @@
+#include "unity.h"
+#include "bucket/bucket_lock.h"
+#include "bucket/hash_buckets.h"
+#include "core/key_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#define BUCKET_LOCK_TEST_THREADS 8
+#define BUCKET_LOCK_TEST_ITERATIONS 5000
+#define BUCKET_LOCK_TEST_KEYS 2000
+
+static const bucket_lock_type_t g_bucket_lock_types[] = { BUCKET_LOCK_RWLOCK, BUCKET_LOCK_SPIN, BUCKET_LOCK_TICKET };
+
+typedef struct {
+    bucket_lock lock;
+    bucket_lock_type_t lock_type;
+    unsigned long counter; // Only changed under the write lock
+    unsigned long torn_reads;
+} bucket_lock_test_state;
+
+typedef struct {
+    key_store *store_ptr;
+    int thread_index;
+} bucket_lock_store_worker_args;
+
+static void* _bucket_lock_counter_worker(void *arg) {
+    bucket_lock_test_state *state = (bucket_lock_test_state *)arg;
+    for (int i = 0; i < BUCKET_LOCK_TEST_ITERATIONS; ++i) {
+        if (i % 4 == 0) {
+            // Readers see the counter between increments of the same write section, never in the middle
+            acquire_bucket_lock(&state->lock, state->lock_type, false, NULL);
+            if (__atomic_load_n(&state->counter, __ATOMIC_RELAXED) % 2 != 0) __atomic_fetch_add(&state->torn_reads, 1, __ATOMIC_RELAXED);
+            release_bucket_lock(&state->lock, state->lock_type, false);
+        } else {
+            acquire_bucket_lock(&state->lock, state->lock_type, true, NULL);
+            __atomic_store_n(&state->counter, state->counter + 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&state->counter, state->counter + 1, __ATOMIC_RELAXED);
+            release_bucket_lock(&state->lock, state->lock_type, true);
+        }
+    }
+    return NULL;
+}
+
+static void* _bucket_lock_store_worker(void *arg) {
+    bucket_lock_store_worker_args *args = (bucket_lock_store_worker_args *)arg;
+    char key[32];
+    unsigned char data[8] = "locked";
+    key_store_value value = { data, sizeof(data) };
+    for (int i = 0; i < BUCKET_LOCK_TEST_KEYS; ++i) {
+        snprintf(key, sizeof(key), "bl_%d_%d", args->thread_index, i);
+        store_set_key(args->store_ptr, key, &value);
+        key_store_value value_out = {0};
+        if (store_get_key(args->store_ptr, key, &value_out) == 0) free(value_out.data);
+        if (i % 2 == 0) store_delete_key(args->store_ptr, key);
+    }
+    return NULL;
+}
+
+void test_bucket_locks_share_readers_and_exclude_writers(void) {
+    for (size_t t = 0; t < sizeof(g_bucket_lock_types) / sizeof(g_bucket_lock_types[0]); ++t) {
+        bucket_lock_type_t lock_type = g_bucket_lock_types[t];
+        pthread_rwlock_t rwlock;
+        bucket_lock lock;
+        TEST_ASSERT_EQUAL(0, initialise_bucket_lock(&lock, lock_type, &rwlock));
+
+        TEST_ASSERT_EQUAL(0, acquire_bucket_lock(&lock, lock_type, false, NULL));
+        TEST_ASSERT_EQUAL(0, try_acquire_bucket_lock(&lock, lock_type, false));
+        TEST_ASSERT_NOT_EQUAL(0, try_acquire_bucket_lock(&lock, lock_type, true));
+        TEST_ASSERT_EQUAL(0, release_bucket_lock(&lock, lock_type, false));
+        TEST_ASSERT_EQUAL(0, release_bucket_lock(&lock, lock_type, false));
+
+        TEST_ASSERT_EQUAL(0, try_acquire_bucket_lock(&lock, lock_type, true));
+        TEST_ASSERT_NOT_EQUAL(0, try_acquire_bucket_lock(&lock, lock_type, false));
+        TEST_ASSERT_NOT_EQUAL(0, try_acquire_bucket_lock(&lock, lock_type, true));
+        TEST_ASSERT_EQUAL(0, release_bucket_lock(&lock, lock_type, true));
+
+        TEST_ASSERT_EQUAL(0, acquire_bucket_lock(&lock, lock_type, true, NULL));
+        TEST_ASSERT_EQUAL(0, release_bucket_lock(&lock, lock_type, true));
+        destroy_bucket_lock(&lock, lock_type);
+    }
+}
+
+void test_ticket_lock_counters_wrap_around(void) {
+    bucket_lock lock;
+    TEST_ASSERT_EQUAL(0, initialise_bucket_lock(&lock, BUCKET_LOCK_TICKET, NULL));
+
+    // Run every 16-bit ticket field past its wrap-around point
+    for (unsigned int i = 0; i < 70000; ++i) {
+        bool is_exclusive = (i % 3 == 0);
+        TEST_ASSERT_EQUAL(0, acquire_bucket_lock(&lock, BUCKET_LOCK_TICKET, is_exclusive, NULL));
+        TEST_ASSERT_EQUAL(0, release_bucket_lock(&lock, BUCKET_LOCK_TICKET, is_exclusive));
+    }
+    TEST_ASSERT_EQUAL(0, try_acquire_bucket_lock(&lock, BUCKET_LOCK_TICKET, true));
+    TEST_ASSERT_EQUAL(0, release_bucket_lock(&lock, BUCKET_LOCK_TICKET, true));
+}
+
+void test_bucket_locks_serialize_concurrent_writers(void) {
+    for (size_t t = 0; t < sizeof(g_bucket_lock_types) / sizeof(g_bucket_lock_types[0]); ++t) {
+        pthread_rwlock_t rwlock;
+        bucket_lock_test_state state = { .lock_type = g_bucket_lock_types[t] };
+        TEST_ASSERT_EQUAL(0, initialise_bucket_lock(&state.lock, state.lock_type, &rwlock));
+
+        pthread_t threads[BUCKET_LOCK_TEST_THREADS];
+        for (int i = 0; i < BUCKET_LOCK_TEST_THREADS; ++i) pthread_create(&threads[i], NULL, _bucket_lock_counter_worker, &state);
+        for (int i = 0; i < BUCKET_LOCK_TEST_THREADS; ++i) pthread_join(threads[i], NULL);
+
+        TEST_ASSERT_EQUAL_UINT64(2UL * BUCKET_LOCK_TEST_THREADS * (BUCKET_LOCK_TEST_ITERATIONS - BUCKET_LOCK_TEST_ITERATIONS / 4), state.counter);
+        TEST_ASSERT_EQUAL_UINT64(0, state.torn_reads);
+        destroy_bucket_lock(&state.lock, state.lock_type);
+    }
+}
+
+void test_hash_bucket_lock_type_configuration(void) {
+    TEST_ASSERT_EQUAL_size_t(32, sizeof(hash_bucket)); // The rwlock lives beside the table, every lock type fits the bucket
+
+    hash_bucket_memory_pool pool = {0};
+    TEST_ASSERT_EQUAL(-20, configure_hash_bucket_lock_type(NULL, BUCKET_LOCK_SPIN));
+    TEST_ASSERT_EQUAL(-40, configure_hash_bucket_lock_type(&pool, BUCKET_LOCK_SPIN));
+    TEST_ASSERT_EQUAL(0, initialise_hash_buckets(&pool, 16, true, NULL));
+    TEST_ASSERT_EQUAL_UINT(sizeof(hash_bucket) + sizeof(pthread_rwlock_t), pool.block_size);
+    TEST_ASSERT_EQUAL(-21, configure_hash_bucket_lock_type(&pool, (bucket_lock_type_t)7));
+
+    TEST_ASSERT_EQUAL(0, configure_hash_bucket_lock_type(&pool, BUCKET_LOCK_TICKET));
+    TEST_ASSERT_NULL(pool.bucket_rwlocks_ptr);
+    TEST_ASSERT_EQUAL_UINT(sizeof(hash_bucket), pool.block_size);
+    TEST_ASSERT_EQUAL(0, configure_hash_bucket_lock_type(&pool, BUCKET_LOCK_RWLOCK));
+    TEST_ASSERT_NOT_NULL(pool.bucket_rwlocks_ptr);
+    TEST_ASSERT_EQUAL(0, configure_hash_bucket_lock_type(&pool, BUCKET_LOCK_SPIN));
+    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets(&pool));
+
+    TEST_ASSERT_EQUAL(0, initialise_hash_buckets(&pool, 16, false, NULL));
+    TEST_ASSERT_EQUAL(-21, configure_hash_bucket_lock_type(&pool, BUCKET_LOCK_SPIN)); // Buckets are not locked without concurrency
+    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets(&pool));
+
+    key_store *store_ptr = NULL;
+    key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 1, .bucket_lock = KEY_STORE_BUCKET_LOCK_SPIN };
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store_ptr));
+    config.is_concurrency_enabled = true;
+    config.engine = KEY_STORE_ENGINE_SWISS;
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store_ptr));
+    config.engine = KEY_STORE_ENGINE_CHAINED;
+    config.bucket_lock = (key_store_bucket_lock_t)7;
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store_ptr));
+}
+
+void test_hash_bucket_lock_stripes_configuration(void) {
+    TEST_ASSERT_EQUAL_size_t(BUCKET_LOCK_STRIPE_ALIGNMENT, sizeof(bucket_lock_stripe));
+
+    hash_bucket_memory_pool pool = {0};
+    TEST_ASSERT_EQUAL(-21, initialise_hash_buckets_with_lock_config(&pool, 16, true, (bucket_lock_config){ BUCKET_LOCK_SPIN, 3 }, NULL));
+    TEST_ASSERT_EQUAL(-21, initialise_hash_buckets_with_lock_config(&pool, 16, false, (bucket_lock_config){ BUCKET_LOCK_RWLOCK, 4 }, NULL));
+    TEST_ASSERT_EQUAL(-21, initialise_hash_buckets_with_lock_config(&pool, 16, false, (bucket_lock_config){ BUCKET_LOCK_TICKET, 0 }, NULL));
+    TEST_ASSERT_EQUAL(-21, initialise_hash_buckets_with_lock_config(&pool, 16, true, (bucket_lock_config){ (bucket_lock_type_t)7, 0 }, NULL));
+    TEST_ASSERT_FALSE(pool.is_initialized);
+
+    // Striped buckets carry no lock of their own
+    TEST_ASSERT_EQUAL(0, initialise_hash_buckets_with_lock_config(&pool, 64, true, (bucket_lock_config){ BUCKET_LOCK_RWLOCK, 8 }, NULL));
+    TEST_ASSERT_EQUAL_UINT(8, pool.lock_stripe_count);
+    TEST_ASSERT_NOT_NULL(pool.lock_stripes_ptr);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)pool.lock_stripes_ptr % BUCKET_LOCK_STRIPE_ALIGNMENT);
+    TEST_ASSERT_NULL(pool.bucket_rwlocks_ptr);
+    TEST_ASSERT_EQUAL_UINT(sizeof(hash_bucket), pool.block_size);
+    keystore_stats stats = {0};
+    get_hash_bucket_pool_stats(&pool, &stats);
+    TEST_ASSERT_EQUAL_size_t(64 * sizeof(hash_bucket) + 8 * sizeof(bucket_lock_stripe), stats.memory_pool.total_memory_bytes);
+
+    // The lock type of the stripes can still be changed
+    TEST_ASSERT_EQUAL(0, configure_hash_bucket_lock_type(&pool, BUCKET_LOCK_TICKET));
+    TEST_ASSERT_NULL(pool.bucket_rwlocks_ptr);
+    TEST_ASSERT_EQUAL(0, try_acquire_bucket_lock(&pool.lock_stripes_ptr[3].lock, BUCKET_LOCK_TICKET, true));
+    TEST_ASSERT_EQUAL(0, release_bucket_lock(&pool.lock_stripes_ptr[3].lock, BUCKET_LOCK_TICKET, true));
+    TEST_ASSERT_EQUAL(0, configure_hash_bucket_lock_type(&pool, BUCKET_LOCK_RWLOCK));
+    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets(&pool));
+
+    // More stripes than buckets are reduced to one stripe per bucket
+    TEST_ASSERT_EQUAL(0, initialise_hash_buckets_with_lock_config(&pool, 16, true, (bucket_lock_config){ BUCKET_LOCK_SPIN, 1024 }, NULL));
+    TEST_ASSERT_EQUAL_UINT(16, pool.lock_stripe_count);
+    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets(&pool));
+
+    key_store *store_ptr = NULL;
+    key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 1, .bucket_lock_stripes = 4 };
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store_ptr));
+    config.is_concurrency_enabled = true;
+    config.engine = KEY_STORE_ENGINE_SWISS;
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store_ptr));
+    config.engine = KEY_STORE_ENGINE_CHAINED;
+    config.bucket_lock_stripes = 6;
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store_ptr));
+    config.bucket_lock_stripes = KEY_STORE_MAX_BUCKET_LOCK_STRIPES * 2;
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store_ptr));
+}
+
+void test_key_store_with_each_bucket_lock_under_contention(void) {
+    const key_store_bucket_lock_t store_lock_types[] = { KEY_STORE_BUCKET_LOCK_RWLOCK, KEY_STORE_BUCKET_LOCK_SPIN, KEY_STORE_BUCKET_LOCK_TICKET };
+    for (size_t c = 0; c < 2 * sizeof(store_lock_types) / sizeof(store_lock_types[0]); ++c) {
+        size_t t = c / 2;
+        // A small table that keeps growing, so migrations take the bucket locks as well; every other run shares 4 lock stripes
+        key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 1, .is_concurrency_enabled = true,
+                                    .grow_load_factor = KEY_STORE_DEFAULT_GROW_LOAD_FACTOR, .bucket_lock = store_lock_types[t],
+                                    .bucket_lock_stripes = (c % 2 == 0) ? 0 : 4 };
+        key_store *store_ptr = NULL;
+        TEST_ASSERT_EQUAL(0, create_key_store(config, &store_ptr));
+
+        pthread_t threads[BUCKET_LOCK_TEST_THREADS];
+        bucket_lock_store_worker_args args[BUCKET_LOCK_TEST_THREADS];
+        for (int i = 0; i < BUCKET_LOCK_TEST_THREADS; ++i) {
+            args[i] = (bucket_lock_store_worker_args){ store_ptr, i };
+            pthread_create(&threads[i], NULL, _bucket_lock_store_worker, &args[i]);
+        }
+        for (int i = 0; i < BUCKET_LOCK_TEST_THREADS; ++i) pthread_join(threads[i], NULL);
+
+        keystore_stats stats = store_get_keystore_stats(store_ptr);
+        TEST_ASSERT_EQUAL_UINT(BUCKET_LOCK_TEST_THREADS * BUCKET_LOCK_TEST_KEYS / 2, stats.key_entries.total_keys);
+        TEST_ASSERT_TRUE(stats.key_entries.total_buckets > 16);
+
+        char key[32];
+        key_store_value value_out = {0};
+        snprintf(key, sizeof(key), "bl_%d_%d", BUCKET_LOCK_TEST_THREADS - 1, 1);
+        TEST_ASSERT_EQUAL(0, store_get_key(store_ptr, key, &value_out));
+        free(value_out.data);
+        snprintf(key, sizeof(key), "bl_%d_%d", 0, 0);
+        TEST_ASSERT_EQUAL(-41, store_get_key(store_ptr, key, &value_out));
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store_ptr));
+    }
+}
+
+int test_bucket_lock_suite(void) {
+    printf("Running bucket_lock tests...\n");
+    RUN_TEST(test_bucket_locks_share_readers_and_exclude_writers);
+    RUN_TEST(test_ticket_lock_counters_wrap_around);
+    RUN_TEST(test_bucket_locks_serialize_concurrent_writers);
+    RUN_TEST(test_hash_bucket_lock_type_configuration);
+    RUN_TEST(test_hash_bucket_lock_stripes_configuration);
+    RUN_TEST(test_key_store_with_each_bucket_lock_under_contention);
+    printf("Completed bucket_lock tests.\n");
+    return 0;
+}
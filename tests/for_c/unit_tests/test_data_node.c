@@ -1,6 +1,14 @@
 #include "unity.h"
 #include "core/data_node.h"
+#include "core/operation_counters.h"
 #include <string.h>
+#include <stdlib.h>
+
+static data_node_operation_counters _sum_node_counters(const sharded_data_node_operation_counters *counters_ptr) {
+    data_node_operation_counters sum;
+    sum_data_node_operation_counters(counters_ptr, &sum);
+    return sum;
+}
 
 void test_create_data_node(void) {
     const char *key = "mykey";
@@ -9,14 +17,14 @@ void test_create_data_node(void) {
     key_store_value value = { .data = data, .data_size = sizeof(data) };
 
     data_node *node = NULL;
-    int result = create_data_node(key, key_hash, &value, false, &node);
+    int result = create_data_node(NULL, NULL, key, strlen(key), key_hash, &value, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_EQUAL(0, result);
     TEST_ASSERT_NOT_NULL(node);
     TEST_ASSERT_EQUAL_STRING(key, node->key);
     TEST_ASSERT_EQUAL_UINT32(key_hash, node->key_hash);
     TEST_ASSERT_EQUAL_UINT8_ARRAY(data, node->data, sizeof(data));
     TEST_ASSERT_EQUAL(sizeof(data), node->data_size);
-    delete_data_node(node);
+    delete_data_node(NULL, node);
 }
 
 void test_update_data_node(void) {
@@ -26,122 +34,418 @@ void test_update_data_node(void) {
     key_store_value value = { .data = data, .data_size = sizeof(data) };
 
     data_node *node = NULL;
-    int result = create_data_node(key, key_hash, &value, false, &node);
+    int result = create_data_node(NULL, NULL, key, strlen(key), key_hash, &value, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_EQUAL(0, result);
     TEST_ASSERT_NOT_NULL(node);
 
     unsigned char new_data[] = "newval";
     key_store_value new_value = { .data = new_data, .data_size = sizeof(new_data) };
 
-    result = update_data_node(node, &new_value);
+    result = update_data_node(NULL, node, &new_value);
     TEST_ASSERT_EQUAL(0, result);
     TEST_ASSERT_EQUAL_UINT8_ARRAY(new_data, node->data, sizeof(new_data));
     TEST_ASSERT_EQUAL(sizeof(new_data), node->data_size);
-    delete_data_node(node);
+    delete_data_node(NULL, node);
 }
 
 void test_delete_data_node_null(void) {
-    int result = delete_data_node(NULL);
+    int result = delete_data_node(NULL, NULL);
     TEST_ASSERT_EQUAL(-20, result);
 }
 
 
 void test_create_data_node_null_params(void) {
     data_node *node = NULL;
-    int result = create_data_node(NULL, 0, NULL, false, &node);
+    int result = create_data_node(NULL, NULL, NULL, 0, 0, NULL, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_NOT_EQUAL(0, result);
     TEST_ASSERT_NULL(node);
 }
 
 void test_update_data_node_null_params(void) {
-    int result = update_data_node(NULL, NULL);
+    int result = update_data_node(NULL, NULL, NULL);
     TEST_ASSERT_EQUAL(-20, result);
 
     unsigned char data[] = "abc";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
     data_node *node = NULL;
-    int create_result = create_data_node("key", 1, &value, false, &node);
+    int create_result = create_data_node(NULL, NULL, "key", 3, 1, &value, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_EQUAL(0, create_result);
-    result = update_data_node(node, NULL);
+    result = update_data_node(NULL, node, NULL);
     TEST_ASSERT_EQUAL(-20, result);
-    delete_data_node(node);
+    delete_data_node(NULL, node);
 }
 
 void test_update_data_node_size_zero(void) {
     unsigned char data[] = "abc";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
     data_node *node = NULL;
-    int create_result = create_data_node("key", 1, &value, false, &node);
+    int create_result = create_data_node(NULL, NULL, "key", 3, 1, &value, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_EQUAL(0, create_result);
     unsigned char new_data[] = "";
     key_store_value new_value = { .data = new_data, .data_size = 0 };
-    int result = update_data_node(node, &new_value);
+    int result = update_data_node(NULL, node, &new_value);
     TEST_ASSERT_EQUAL(0, result);
-    delete_data_node(node);
+    delete_data_node(NULL, node);
 }
 
 void test_update_data_node_with_empty_data(void) {
     unsigned char data[] = "abc";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
     data_node *node = NULL;
-    int create_result = create_data_node("key", 1, &value, false, &node);
+    int create_result = create_data_node(NULL, NULL, "key", 3, 1, &value, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_EQUAL(0, create_result);
     unsigned char new_data[] = "";
     key_store_value new_value = { .data = new_data, .data_size = 0 };
-    int result = update_data_node(node, &new_value);
+    int result = update_data_node(NULL, node, &new_value);
     TEST_ASSERT_EQUAL(0, result);
-    delete_data_node(node);
+    delete_data_node(NULL, node);
 }
 
 void test_update_data_node_with_bigger_data(void) {
     unsigned char data[] = "abc";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
     data_node *node = NULL;
-    int create_result = create_data_node("key", 1, &value, false, &node);
+    int create_result = create_data_node(NULL, NULL, "key", 3, 1, &value, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_EQUAL(0, create_result);
     unsigned char new_data[] = "abcdefabcdef";
     key_store_value new_value = { .data = new_data, .data_size = sizeof(new_data) };
-    int result = update_data_node(node, &new_value);
+    int result = update_data_node(NULL, node, &new_value);
     TEST_ASSERT_EQUAL(0, result);
-    delete_data_node(node);
+    delete_data_node(NULL, node);
 }
 
 void test_update_data_node_with_smaller_data(void) {
     unsigned char data[] = "abcabcabc";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
     data_node *node = NULL;
-    int create_result = create_data_node("key", 1, &value, false, &node);
+    int create_result = create_data_node(NULL, NULL, "key", 3, 1, &value, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_EQUAL(0, create_result);
     unsigned char new_data[] = "ab";
     key_store_value new_value = { .data = new_data, .data_size = sizeof(new_data) };
-    int result = update_data_node(node, &new_value);
+    int result = update_data_node(NULL, node, &new_value);
     TEST_ASSERT_EQUAL(0, result);
-    delete_data_node(node);
+    delete_data_node(NULL, node);
 }
 
 void test_update_data_node_with_same_size_data(void) {
     unsigned char data[] = "abcabcabc";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
     data_node *node = NULL;
-    int create_result = create_data_node("key", 1, &value, false, &node);
+    int create_result = create_data_node(NULL, NULL, "key", 3, 1, &value, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_EQUAL(0, create_result);
     unsigned char new_data[] = "abcabcabc";
     key_store_value new_value = { .data = new_data, .data_size = sizeof(new_data) };
-    int result = update_data_node(node, &new_value);
+    int result = update_data_node(NULL, node, &new_value);
     TEST_ASSERT_EQUAL(0, result);
-    delete_data_node(node);
+    delete_data_node(NULL, node);
 }
 
 void test_delete_data_node_valid(void) {
     unsigned char data[] = "abc";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
     data_node *node = NULL;
-    int create_result = create_data_node("key", 1, &value, false, &node);
+    int create_result = create_data_node(NULL, NULL, "key", 3, 1, &value, DATA_NODE_SYNC_NONE, 0, &node);
     TEST_ASSERT_EQUAL(0, create_result);
-    int result = delete_data_node(node);
+    int result = delete_data_node(NULL, node);
     TEST_ASSERT_EQUAL(0, result);
 }
 
+void test_pin_and_unpin_data_node(void) {
+    unsigned char data[] = "value";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    data_node *node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, NULL, "pinned", 6, 1, &value, DATA_NODE_SYNC_MUTEX, 0, &node));
+    TEST_ASSERT_EQUAL_UINT(1, atomic_load(&node->ref_count));
+
+    sharded_data_node_operation_counters counters = {0};
+    TEST_ASSERT_EQUAL(0, pin_data_node(node));
+    TEST_ASSERT_EQUAL(0, unpin_data_node(&counters, node)); // Owner reference released, the pin keeps the node alive
+    TEST_ASSERT_EQUAL_UINT(1, atomic_load(&node->ref_count));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, node->data, sizeof(data));
+#if OPERATION_COUNTERS_ENABLED
+    TEST_ASSERT_EQUAL(0, _sum_node_counters(&counters).total_delete_ops);
+#endif
+
+    TEST_ASSERT_EQUAL(0, unpin_data_node(&counters, node)); // Last reference deletes the node
+#if OPERATION_COUNTERS_ENABLED
+    TEST_ASSERT_EQUAL(1, _sum_node_counters(&counters).total_delete_ops);
+#endif
+}
+
+void test_data_node_counters_are_per_owner(void) {
+    unsigned char data[] = "value";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    sharded_data_node_operation_counters first = {0};
+    sharded_data_node_operation_counters second = {0};
+
+    data_node *node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(&first, NULL, "counted", 7, 1, &value, DATA_NODE_SYNC_NONE, 0, &node));
+    TEST_ASSERT_EQUAL(-20, update_data_node(&second, node, NULL));
+    TEST_ASSERT_EQUAL(0, delete_data_node(&first, node));
+
+#if OPERATION_COUNTERS_ENABLED
+    TEST_ASSERT_EQUAL(1, _sum_node_counters(&first).total_create_ops);
+    TEST_ASSERT_EQUAL(1, _sum_node_counters(&first).total_delete_ops);
+    TEST_ASSERT_EQUAL(0, _sum_node_counters(&first).total_update_ops);
+    TEST_ASSERT_EQUAL(1, _sum_node_counters(&second).total_update_ops);
+    TEST_ASSERT_EQUAL(1, _sum_node_counters(&second).failed_update_ops);
+    TEST_ASSERT_EQUAL(1, _sum_node_counters(&second).error_code_counters[20]);
+#endif
+}
+
+void test_data_node_is_allocated_from_slab(void) {
+    memory_manager manager = {0};
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, (memory_manager_config){ .bucket_size = 4, .pre_allocation_factor = 1.0, .allocate_slab_pools = true }));
+    unsigned char data[10] = "small";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+
+    data_node *node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, &manager, "slab", 4, 1, &value, DATA_NODE_SYNC_NONE, 0, &node));
+    TEST_ASSERT_EQUAL_PTR(&manager, node->memory_manager_ptr);
+    memory_pool_usage usage = {0};
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_UINT(1, usage.slab_classes[0].used_blocks); // 10-byte value
+    size_t node_bytes = usage.used_bytes - 16;
+    TEST_ASSERT_TRUE(node_bytes >= sizeof(data_node) + sizeof("slab") && node_bytes < (sizeof(data_node) + sizeof("slab")) * 3 / 2);
+
+    unsigned char larger[100] = "larger";
+    key_store_value larger_value = { .data = larger, .data_size = sizeof(larger) };
+    TEST_ASSERT_EQUAL(0, update_data_node(NULL, node, &larger_value));
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_UINT(0, usage.slab_classes[0].used_blocks);
+    TEST_ASSERT_EQUAL_size_t(node_bytes + 128, usage.used_bytes);
+
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, get_data_from_node(NULL, node, &out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(larger, out.data, sizeof(larger));
+    free(out.data);
+
+    TEST_ASSERT_EQUAL(0, delete_data_node(NULL, node));
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(0, usage.used_bytes);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+static void _assert_node_value(data_node *node, const unsigned char *expected, size_t size) {
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, get_data_from_node(NULL, node, &out));
+    TEST_ASSERT_EQUAL_size_t(size, out.data_size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out.data, size);
+    free(out.data);
+}
+
+void test_small_value_is_stored_inline(void) {
+    memory_manager manager = {0};
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, (memory_manager_config){ .bucket_size = 4, .pre_allocation_factor = 1.0, .allocate_slab_pools = true }));
+    unsigned char small[10] = "inline";
+    unsigned char smaller[8] = "shrunk";
+    unsigned char grown[64] = "grown";
+    unsigned char large[100] = "out of line";
+    key_store_value small_value = { .data = small, .data_size = sizeof(small) };
+    key_store_value smaller_value = { .data = smaller, .data_size = sizeof(smaller) };
+    key_store_value grown_value = { .data = grown, .data_size = sizeof(grown) };
+    key_store_value large_value = { .data = large, .data_size = sizeof(large) };
+
+    data_node *node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, &manager, "inline", 6, 1, &small_value, DATA_NODE_SYNC_NONE, 64, &node));
+    unsigned char *inline_value = (unsigned char *)node->key + node->key_size + 1; // After the key and its terminator
+    TEST_ASSERT_EQUAL_PTR(inline_value, node->data);
+    TEST_ASSERT_EQUAL_UINT16(64, node->inline_value_capacity); // The whole threshold is reserved
+    memory_pool_usage usage = {0};
+    get_memory_manager_usage(&manager, &usage);
+    size_t node_bytes = usage.used_bytes; // The value shares the node's block
+    _assert_node_value(node, small, sizeof(small));
+
+    // Smaller and larger values within the threshold reuse the inline space
+    TEST_ASSERT_EQUAL(0, update_data_node(NULL, node, &smaller_value));
+    TEST_ASSERT_EQUAL_PTR(inline_value, node->data);
+    _assert_node_value(node, smaller, sizeof(smaller));
+    TEST_ASSERT_EQUAL(0, update_data_node(NULL, node, &grown_value));
+    TEST_ASSERT_EQUAL_PTR(inline_value, node->data);
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(node_bytes, usage.used_bytes);
+    _assert_node_value(node, grown, sizeof(grown));
+
+    // A value larger than the inline space moves out of line, and back once it fits again
+    TEST_ASSERT_EQUAL(0, update_data_node(NULL, node, &large_value));
+    TEST_ASSERT_TRUE(node->data != inline_value);
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(node_bytes + 128, usage.used_bytes);
+    _assert_node_value(node, large, sizeof(large));
+
+    TEST_ASSERT_EQUAL(0, update_data_node(NULL, node, &small_value));
+    TEST_ASSERT_EQUAL_PTR(inline_value, node->data);
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(node_bytes, usage.used_bytes);
+    _assert_node_value(node, small, sizeof(small));
+    TEST_ASSERT_EQUAL(0, delete_data_node(NULL, node));
+
+    // Values above the threshold are stored out of line from the start, and move inline once they shrink
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, &manager, "large", 5, 1, &large_value, DATA_NODE_SYNC_NONE, 64, &node));
+    TEST_ASSERT_EQUAL_UINT16(64, node->inline_value_capacity);
+    TEST_ASSERT_TRUE(node->data != (unsigned char *)node->key + node->key_size + 1);
+    TEST_ASSERT_EQUAL(0, update_data_node(NULL, node, &small_value));
+    TEST_ASSERT_EQUAL_PTR((unsigned char *)node->key + node->key_size + 1, node->data);
+    _assert_node_value(node, small, sizeof(small));
+    TEST_ASSERT_EQUAL(0, delete_data_node(NULL, node));
+
+    // Without a threshold nothing is reserved
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, &manager, "none", 4, 1, &small_value, DATA_NODE_SYNC_NONE, 0, &node));
+    TEST_ASSERT_EQUAL_UINT16(0, node->inline_value_capacity);
+    _assert_node_value(node, small, sizeof(small));
+    TEST_ASSERT_EQUAL(0, delete_data_node(NULL, node));
+
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(0, usage.used_bytes);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+void test_seqlock_node_drops_the_mutex(void) {
+    memory_manager manager = {0};
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, (memory_manager_config){ .bucket_size = 4, .pre_allocation_factor = 1.0, .allocate_slab_pools = true }));
+    unsigned char data[8] = {0};
+    key_store_value value = { data, sizeof(data) };
+    memory_pool_usage usage = {0};
+
+    data_node *mutex_node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, &manager, "sync", 4, 1, &value, DATA_NODE_SYNC_MUTEX, 16, &mutex_node));
+    get_memory_manager_usage(&manager, &usage);
+    size_t mutex_bytes = usage.used_bytes;
+
+    data_node *seqlock_node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, &manager, "sync", 4, 1, &value, DATA_NODE_SYNC_SEQLOCK, 16, &seqlock_node));
+    get_memory_manager_usage(&manager, &usage);
+    size_t seqlock_bytes = usage.used_bytes - mutex_bytes;
+    TEST_ASSERT_TRUE(seqlock_bytes < mutex_bytes); // Both are rounded up to their slab class
+
+    TEST_ASSERT_EQUAL(0, delete_data_node(NULL, mutex_node));
+    TEST_ASSERT_EQUAL(0, delete_data_node(NULL, seqlock_node));
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(0, usage.used_bytes);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+void test_seqlock_node_updates_in_place_only(void) {
+    sharded_data_node_operation_counters counters = {0};
+    unsigned char data[8];
+    memset(data, 'a', sizeof(data));
+    key_store_value value = { data, sizeof(data) };
+    data_node *node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(&counters, NULL, "seq", 3, 1, &value, DATA_NODE_SYNC_SEQLOCK, 16, &node));
+    TEST_ASSERT_EQUAL_UINT(0, atomic_load(&node->sequence));
+
+    // Inline values may change size within the reserved threshold, out-of-line values must keep their size
+    TEST_ASSERT_TRUE(can_update_data_node_in_place(node, sizeof(data)));
+    TEST_ASSERT_TRUE(can_update_data_node_in_place(node, 1));
+    TEST_ASSERT_TRUE(can_update_data_node_in_place(node, 16));
+    TEST_ASSERT_FALSE(can_update_data_node_in_place(node, 17));
+    TEST_ASSERT_FALSE(can_update_data_node_in_place(node, 0));
+
+    unsigned char new_data[5];
+    memset(new_data, 'b', sizeof(new_data));
+    key_store_value new_value = { new_data, sizeof(new_data) };
+    TEST_ASSERT_EQUAL(0, data_node_lock_wrapper(&counters, DATA_NODE_UPDATE, node, &new_value));
+    TEST_ASSERT_EQUAL_UINT(2, atomic_load(&node->sequence));
+
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, data_node_lock_wrapper(&counters, DATA_NODE_READ, node, &out));
+    TEST_ASSERT_EQUAL_size_t(sizeof(new_data), out.data_size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(new_data, out.data, sizeof(new_data));
+    free(out.data);
+    TEST_ASSERT_EQUAL_UINT(2, atomic_load(&node->sequence)); // Reads leave the sequence alone
+    TEST_ASSERT_EQUAL_UINT(0, _sum_node_counters(&counters).read_retry_ops);
+
+    // Growing past the inline capacity would move the value, the caller has to replace the node
+    unsigned char large[32] = {0};
+    key_store_value large_value = { large, sizeof(large) };
+    TEST_ASSERT_EQUAL(-43, data_node_lock_wrapper(&counters, DATA_NODE_UPDATE, node, &large_value));
+    TEST_ASSERT_EQUAL_UINT(2, atomic_load(&node->sequence));
+    TEST_ASSERT_EQUAL(0, delete_data_node(&counters, node));
+
+    // Out-of-line values are only updated in place when the size is unchanged
+    TEST_ASSERT_EQUAL(0, create_data_node(&counters, NULL, "seq", 3, 1, &large_value, DATA_NODE_SYNC_SEQLOCK, 16, &node));
+    TEST_ASSERT_TRUE(can_update_data_node_in_place(node, sizeof(large)));
+    TEST_ASSERT_FALSE(can_update_data_node_in_place(node, sizeof(large) - 1));
+    TEST_ASSERT_EQUAL(0, delete_data_node(&counters, node));
+
+    // Other modes can always update in place
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, NULL, "seq", 3, 1, &value, DATA_NODE_SYNC_MUTEX, 16, &node));
+    TEST_ASSERT_TRUE(can_update_data_node_in_place(node, 1024));
+    TEST_ASSERT_EQUAL(0, delete_data_node(NULL, node));
+}
+
+// Records where the viewed bytes live, so the test can tell they were not copied
+typedef struct {
+    const unsigned char *data;
+    size_t data_size;
+    int calls;
+} _node_view_record;
+
+static int _record_node_view(const unsigned char *data, size_t data_size, void *context) {
+    _node_view_record *record = context;
+    record->data = data;
+    record->data_size = data_size;
+    record->calls++;
+    return 7;
+}
+
+void test_view_data_node_borrows_the_value(void) {
+    sharded_data_node_operation_counters counters = {0};
+    unsigned char data[] = "viewed value";
+    key_store_value value = { data, sizeof(data) };
+    data_node_sync_t modes[] = { DATA_NODE_SYNC_NONE, DATA_NODE_SYNC_MUTEX, DATA_NODE_SYNC_SEQLOCK };
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+        data_node *node = NULL;
+        TEST_ASSERT_EQUAL(0, create_data_node(&counters, NULL, "view", 4, 1, &value, modes[m], 64, &node));
+
+        // The callback's result is passed through and it sees the node's own storage
+        _node_view_record record = {0};
+        TEST_ASSERT_EQUAL(7, data_node_view_wrapper(&counters, node, _record_node_view, &record, NULL));
+        TEST_ASSERT_EQUAL(1, record.calls);
+        TEST_ASSERT_EQUAL_PTR(node->data, record.data);
+        TEST_ASSERT_EQUAL_size_t(sizeof(data), record.data_size);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(data, record.data, sizeof(data));
+        TEST_ASSERT_EQUAL(0, delete_data_node(&counters, node));
+    }
+
+#if OPERATION_COUNTERS_ENABLED
+    TEST_ASSERT_EQUAL_UINT(3, _sum_node_counters(&counters).total_read_ops);
+    TEST_ASSERT_EQUAL_UINT(0, _sum_node_counters(&counters).read_retry_ops);
+#endif
+    TEST_ASSERT_EQUAL(-20, data_node_view_wrapper(&counters, NULL, _record_node_view, NULL, NULL));
+
+    data_node *node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(&counters, NULL, "view", 4, 1, &value, DATA_NODE_SYNC_NONE, 64, &node));
+    TEST_ASSERT_EQUAL(-20, data_node_view_wrapper(&counters, node, NULL, NULL, NULL));
+    TEST_ASSERT_EQUAL(0, delete_data_node(&counters, node));
+}
+
+void test_update_data_node_increments_version(void) {
+    unsigned char data[] = "v1";
+    unsigned char longer[] = "a longer value";
+    key_store_value value = { data, sizeof(data) };
+    key_store_value longer_value = { longer, sizeof(longer) };
+    data_node *node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, NULL, "ver", 3, 1, &value, DATA_NODE_SYNC_MUTEX, 8, &node));
+    TEST_ASSERT_EQUAL_UINT32(1, node->version);
+
+    // Inline, out-of-line and resized values all count as one update
+    TEST_ASSERT_EQUAL(0, data_node_lock_wrapper(NULL, DATA_NODE_UPDATE, node, &value));
+    TEST_ASSERT_EQUAL(0, data_node_lock_wrapper(NULL, DATA_NODE_UPDATE, node, &longer_value));
+    TEST_ASSERT_EQUAL(0, update_data_node(NULL, node, &value));
+    TEST_ASSERT_EQUAL_UINT32(4, node->version);
+
+    TEST_ASSERT_EQUAL(-20, update_data_node(NULL, node, NULL));
+    TEST_ASSERT_EQUAL_UINT32(4, node->version);
+    TEST_ASSERT_EQUAL(0, delete_data_node(NULL, node));
+}
+
+void test_pin_data_node_null(void) {
+    TEST_ASSERT_EQUAL(-20, pin_data_node(NULL));
+    TEST_ASSERT_EQUAL(-20, unpin_data_node(NULL, NULL));
+}
+
 int test_data_node_suite(void) {
     printf("Running data_node tests...\n");
     RUN_TEST(test_create_data_node);
@@ -155,6 +459,15 @@ int test_data_node_suite(void) {
     RUN_TEST(test_update_data_node_with_smaller_data);
     RUN_TEST(test_update_data_node_with_same_size_data);
     RUN_TEST(test_delete_data_node_valid);
+    RUN_TEST(test_pin_and_unpin_data_node);
+    RUN_TEST(test_data_node_counters_are_per_owner);
+    RUN_TEST(test_data_node_is_allocated_from_slab);
+    RUN_TEST(test_small_value_is_stored_inline);
+    RUN_TEST(test_seqlock_node_drops_the_mutex);
+    RUN_TEST(test_seqlock_node_updates_in_place_only);
+    RUN_TEST(test_view_data_node_borrows_the_value);
+    RUN_TEST(test_update_data_node_increments_version);
+    RUN_TEST(test_pin_data_node_null);
     printf("Completed data_node tests.\n");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "unity.h"
+#include "utils/epoch_manager.h"
+
+static int g_reclaimed_count = 0;
+
+static void _count_reclaim(void *ptr, void *context) {
+    (void)ptr;
+    if (context != NULL) (*(int *)context)++;
+    g_reclaimed_count++;
+}
+
+void test_retire_reclaims_immediately_when_disabled(void) {
+    int item = 0;
+    epoch_manager manager = {0};
+    g_reclaimed_count = 0;
+    TEST_ASSERT_FALSE(is_epoch_manager_enabled(&manager));
+    TEST_ASSERT_FALSE(is_epoch_manager_enabled(NULL));
+    TEST_ASSERT_EQUAL(0, epoch_retire(&manager, &item, _count_reclaim, NULL));
+    TEST_ASSERT_EQUAL(0, epoch_retire(NULL, &item, _count_reclaim, NULL));
+    TEST_ASSERT_EQUAL(2, g_reclaimed_count);
+}
+
+void test_retire_invalid_arguments(void) {
+    int item = 0;
+    TEST_ASSERT_EQUAL(-20, epoch_retire(NULL, NULL, _count_reclaim, NULL));
+    TEST_ASSERT_EQUAL(-20, epoch_retire(NULL, &item, NULL, NULL));
+    TEST_ASSERT_EQUAL(-20, initialize_epoch_manager(NULL));
+}
+
+void test_retire_is_deferred_while_in_critical_section(void) {
+    int item = 0;
+    g_reclaimed_count = 0;
+    epoch_manager manager = {0};
+    TEST_ASSERT_EQUAL(0, initialize_epoch_manager(&manager));
+    TEST_ASSERT_TRUE(is_epoch_manager_enabled(&manager));
+
+    epoch_enter(&manager);
+    TEST_ASSERT_EQUAL(0, epoch_retire(&manager, &item, _count_reclaim, NULL));
+    for (int i = 0; i < 4; ++i) epoch_try_reclaim(&manager);
+    TEST_ASSERT_EQUAL(0, g_reclaimed_count); // The epoch cannot move past a reader that is still inside
+    epoch_exit(&manager);
+
+    size_t reclaimed_count = 0;
+    for (int i = 0; i < 4; ++i) reclaimed_count += epoch_try_reclaim(&manager);
+    TEST_ASSERT_EQUAL(1, reclaimed_count);
+    TEST_ASSERT_EQUAL(1, g_reclaimed_count);
+    cleanup_epoch_manager(&manager);
+}
+
+void test_nested_critical_sections(void) {
+    int item = 0;
+    g_reclaimed_count = 0;
+    epoch_manager manager = {0};
+    initialize_epoch_manager(&manager);
+
+    epoch_enter(&manager);
+    epoch_enter(&manager);
+    epoch_retire(&manager, &item, _count_reclaim, NULL);
+    epoch_exit(&manager);
+    for (int i = 0; i < 4; ++i) epoch_try_reclaim(&manager);
+    TEST_ASSERT_EQUAL(0, g_reclaimed_count); // Still inside the outer section
+    epoch_exit(&manager);
+
+    for (int i = 0; i < 4; ++i) epoch_try_reclaim(&manager);
+    TEST_ASSERT_EQUAL(1, g_reclaimed_count);
+    cleanup_epoch_manager(&manager);
+}
+
+void test_cleanup_reclaims_pending_retires(void) {
+    int items[200];
+    g_reclaimed_count = 0;
+    epoch_manager manager = {0};
+    initialize_epoch_manager(&manager);
+
+    epoch_enter(&manager);
+    for (int i = 0; i < 200; ++i) TEST_ASSERT_EQUAL(0, epoch_retire(&manager, &items[i], _count_reclaim, NULL));
+    epoch_exit(&manager);
+
+    TEST_ASSERT_EQUAL(0, cleanup_epoch_manager(&manager));
+    TEST_ASSERT_EQUAL(200, g_reclaimed_count);
+    TEST_ASSERT_FALSE(is_epoch_manager_enabled(&manager));
+}
+
+void test_managers_reclaim_independently(void) {
+    int first_item = 0;
+    int second_item = 0;
+    int first_reclaimed = 0;
+    int second_reclaimed = 0;
+    epoch_manager first = {0};
+    epoch_manager second = {0};
+    TEST_ASSERT_EQUAL(0, initialize_epoch_manager(&first));
+    TEST_ASSERT_EQUAL(0, initialize_epoch_manager(&second));
+
+    // A reader inside the first manager does not hold back the second one
+    epoch_enter(&first);
+    TEST_ASSERT_EQUAL(0, epoch_retire(&first, &first_item, _count_reclaim, &first_reclaimed));
+    TEST_ASSERT_EQUAL(0, epoch_retire(&second, &second_item, _count_reclaim, &second_reclaimed));
+    for (int i = 0; i < 4; ++i) {
+        epoch_try_reclaim(&first);
+        epoch_try_reclaim(&second);
+    }
+    TEST_ASSERT_EQUAL(0, first_reclaimed);
+    TEST_ASSERT_EQUAL(1, second_reclaimed);
+    epoch_exit(&first);
+
+    TEST_ASSERT_EQUAL(0, cleanup_epoch_manager(&first));
+    TEST_ASSERT_EQUAL(1, first_reclaimed);
+    TEST_ASSERT_EQUAL(0, cleanup_epoch_manager(&second));
+}
+
+int test_epoch_manager_suite(void) {
+    printf("Running epoch_manager tests...\n");
+    RUN_TEST(test_retire_reclaims_immediately_when_disabled);
+    RUN_TEST(test_retire_invalid_arguments);
+    RUN_TEST(test_retire_is_deferred_while_in_critical_section);
+    RUN_TEST(test_nested_critical_sections);
+    RUN_TEST(test_cleanup_reclaims_pending_retires);
+    RUN_TEST(test_managers_reclaim_independently);
+    printf("Completed epoch_manager tests.\n");
+    return 0;
+}
@@ -1,7 +1,6 @@
 #include "unity.h"
 #include "bucket/hash_bucket_list.h"
 #include "core/data_node.h"
-#include "utils/memory_manager.h"
 #include <string.h>
 
 void test_insert_and_find_list_node(void) {
@@ -12,39 +11,38 @@ void test_insert_and_find_list_node(void) {
 
     key_store_value value = { .data = data, .data_size = data_size };
     data_node *dnode = NULL;
-    int create_result = create_data_node(key, key_hash, &value, false, &dnode);
+    int create_result = create_data_node(NULL, NULL, key, strlen(key), key_hash, &value, DATA_NODE_SYNC_NONE, 0, &dnode);
     TEST_ASSERT_EQUAL(0, create_result);
     TEST_ASSERT_NOT_NULL(dnode);
 
-    list_node *head = NULL;
-    list_node *new_node = create_new_list_node(key_hash, dnode);
-    int result = insert_list_node(&head, new_node);
+    atomic_list_node_ptr head = NULL;
+    int result = insert_list_node(&head, dnode);
     TEST_ASSERT_EQUAL(0, result);
 
-    list_node *found = find_list_node(head, key, key_hash);
+    data_node *found = find_list_node(head, key, strlen(key), key_hash);
     TEST_ASSERT_NOT_NULL(found);
-    TEST_ASSERT_EQUAL_PTR(dnode, found->data);
+    TEST_ASSERT_EQUAL_PTR(dnode, found);
 
     data_node *deleted_node = NULL;
-    int del_result = delete_list_node(&head, key, key_hash, &deleted_node);
+    int del_result = delete_list_node(&head, key, strlen(key), key_hash, &deleted_node);
     TEST_ASSERT_EQUAL(0, del_result);
 }
 
 void test_delete_list_node_not_found(void) {
-    list_node *head = NULL;
+    atomic_list_node_ptr head = NULL;
     data_node *deleted_node = NULL;
-    int result = delete_list_node(&head, "notfound", 99999, &deleted_node);
+    int result = delete_list_node(&head, "notfound", 8, 99999, &deleted_node);
     TEST_ASSERT_EQUAL(-41, result);
 }
 
 void test_find_list_node_not_found(void) {
-    list_node *head = NULL;
-    list_node *found = find_list_node(head, "notfound", 99999);
+    atomic_list_node_ptr head = NULL;
+    data_node *found = find_list_node(head, "notfound", 8, 99999);
     TEST_ASSERT_NULL(found);
 }
 
 void test_insert_multiple_nodes_and_find(void) {
-    list_node *head = NULL;
+    atomic_list_node_ptr head = NULL;
     const char *keys[] = {"key1", "key2", "key3"};
     uint32_t hashes[] = {111, 222, 333};
     unsigned char data[] = "value";
@@ -54,20 +52,19 @@ void test_insert_multiple_nodes_and_find(void) {
     for (int i = 0; i < 3; ++i) {
         key_store_value value = { .data = data, .data_size = data_size };
         nodes[i] = NULL;
-        int create_result = create_data_node(keys[i], hashes[i], &value, false, &nodes[i]);
+        int create_result = create_data_node(NULL, NULL, keys[i], strlen(keys[i]), hashes[i], &value, DATA_NODE_SYNC_NONE, 0, &nodes[i]);
         TEST_ASSERT_EQUAL(0, create_result);
         TEST_ASSERT_NOT_NULL_MESSAGE(nodes[i], "Failed to create data node");
-        list_node *new_node = create_new_list_node(hashes[i], nodes[i]);
-        int result = insert_list_node(&head, new_node);
+        int result = insert_list_node(&head, nodes[i]);
         TEST_ASSERT_EQUAL(0, result);
     }
 
     for (int i = 0; i < 3; ++i) {
         char msg[64];
         snprintf(msg, sizeof(msg), "find_list_node should find node with key '%s' and hash %d.", keys[i], hashes[i]);
-        list_node *found = find_list_node(head, keys[i], hashes[i]);
+        data_node *found = find_list_node(head, keys[i], strlen(keys[i]), hashes[i]);
         TEST_ASSERT_NOT_NULL_MESSAGE(found, msg);
-        TEST_ASSERT_EQUAL_PTR(nodes[i], found->data);
+        TEST_ASSERT_EQUAL_PTR(nodes[i], found);
     }
 
     // Cleanup
@@ -75,13 +72,13 @@ void test_insert_multiple_nodes_and_find(void) {
         char msg[64];
         data_node *deleted_node = NULL;
         snprintf(msg, sizeof(msg), "delete_list_node should delete node with key '%s' and hash %d.", keys[i], hashes[i]);
-        int result = delete_list_node(&head, keys[i], hashes[i], &deleted_node);
+        int result = delete_list_node(&head, keys[i], strlen(keys[i]), hashes[i], &deleted_node);
         TEST_ASSERT_EQUAL(0, result);
     }
 }
 
 void test_delete_head_and_middle_node(void) {
-    list_node *head = NULL;
+    atomic_list_node_ptr head = NULL;
     const char *key1 = "head";
     const char *key2 = "middle";
     uint32_t hash1 = 1, hash2 = 2;
@@ -91,29 +88,27 @@ void test_delete_head_and_middle_node(void) {
         key_store_value value = { .data = data, .data_size = data_size };
         data_node *node1 = NULL;
         data_node *node2 = NULL;
-        int create_result1 = create_data_node(key1, hash1, &value, false, &node1);
-        int create_result2 = create_data_node(key2, hash2, &value, false, &node2);
+        int create_result1 = create_data_node(NULL, NULL, key1, strlen(key1), hash1, &value, DATA_NODE_SYNC_NONE, 0, &node1);
+        int create_result2 = create_data_node(NULL, NULL, key2, strlen(key2), hash2, &value, DATA_NODE_SYNC_NONE, 0, &node2);
         TEST_ASSERT_EQUAL(0, create_result1);
         TEST_ASSERT_EQUAL(0, create_result2);
-        list_node *new_node2 = create_new_list_node(hash2, node2); // middle
-        int result = insert_list_node(&head, new_node2);
+        int result = insert_list_node(&head, node2); // middle
         TEST_ASSERT_EQUAL(0, result);
-        list_node *new_node1 = create_new_list_node(hash1, node1); // head
-        result = insert_list_node(&head, new_node1);
+        result = insert_list_node(&head, node1); // head
         TEST_ASSERT_EQUAL(0, result);
         // Delete head
         data_node *deleted_node1 = NULL;
-        result = delete_list_node(&head, key1, hash1, &deleted_node1);
+        result = delete_list_node(&head, key1, strlen(key1), hash1, &deleted_node1);
         TEST_ASSERT_EQUAL(0, result);
         // Delete middle
         data_node *deleted_node2 = NULL;
-        result = delete_list_node(&head, key2, hash2, &deleted_node2);
+        result = delete_list_node(&head, key2, strlen(key2), hash2, &deleted_node2);
         TEST_ASSERT_EQUAL(0, result);
 }
 
 void test_insert_null_data(void) {
-    list_node *head = NULL;
-    list_node *null_node = NULL;
+    atomic_list_node_ptr head = NULL;
+    data_node *null_node = NULL;
     int result = insert_list_node(&head, null_node);
     TEST_ASSERT_EQUAL(-20, result);
 }
@@ -125,20 +120,19 @@ void test_insert_large_key(void) {
     uint32_t hash = 123456;
     unsigned char data[] = "large";
     size_t data_size = sizeof(data);
-    list_node *head = NULL;
+    atomic_list_node_ptr head = NULL;
 
     key_store_value value = { .data = data, .data_size = data_size };
     data_node *dnode = NULL;
-    int create_result = create_data_node(key, hash, &value, false, &dnode);
+    int create_result = create_data_node(NULL, NULL, key, strlen(key), hash, &value, DATA_NODE_SYNC_NONE, 0, &dnode);
     TEST_ASSERT_EQUAL(0, create_result);
     TEST_ASSERT_NOT_NULL(dnode);
-    list_node *new_node = create_new_list_node(hash, dnode);
-    int result = insert_list_node(&head, new_node);
+    int result = insert_list_node(&head, dnode);
     TEST_ASSERT_EQUAL(0, result);
-    list_node *found = find_list_node(head, key, hash);
+    data_node *found = find_list_node(head, key, strlen(key), hash);
     TEST_ASSERT_NOT_NULL(found);
     data_node *deleted_node = NULL;
-    delete_list_node(&head, key, hash, &deleted_node);
+    delete_list_node(&head, key, strlen(key), hash, &deleted_node);
 }
 
 void test_delete_single_node_list(void) {
@@ -146,17 +140,16 @@ void test_delete_single_node_list(void) {
     uint32_t hash = 1;
     unsigned char data[] = "one";
     size_t data_size = sizeof(data);
-    list_node *head = NULL;
+    atomic_list_node_ptr head = NULL;
     key_store_value value = { .data = data, .data_size = data_size };
     data_node *dnode = NULL;
-    int create_result = create_data_node(key, hash, &value, false, &dnode);
+    int create_result = create_data_node(NULL, NULL, key, strlen(key), hash, &value, DATA_NODE_SYNC_NONE, 0, &dnode);
     TEST_ASSERT_EQUAL(0, create_result);
     TEST_ASSERT_NOT_NULL(dnode);
-    list_node *new_node = create_new_list_node(hash, dnode);
-    int result = insert_list_node(&head, new_node);
+    int result = insert_list_node(&head, dnode);
     TEST_ASSERT_EQUAL(0, result);
     data_node *deleted_node = NULL;
-    result = delete_list_node(&head, key, hash, &deleted_node);
+    result = delete_list_node(&head, key, strlen(key), hash, &deleted_node);
     TEST_ASSERT_EQUAL(0, result);
 }
 
@@ -165,24 +158,71 @@ void test_repeated_insert_delete(void) {
     uint32_t hash = 99;
     unsigned char data[] = "val";
     size_t data_size = sizeof(data);
-    list_node *head = NULL;
+    atomic_list_node_ptr head = NULL;
     for (int i = 0; i < 10; ++i) {
           key_store_value value = { .data = data, .data_size = data_size };
           data_node *dnode = NULL;
-          int create_result = create_data_node(key, hash, &value, false, &dnode);
+          int create_result = create_data_node(NULL, NULL, key, strlen(key), hash, &value, DATA_NODE_SYNC_NONE, 0, &dnode);
           TEST_ASSERT_EQUAL(0, create_result);
           TEST_ASSERT_NOT_NULL(dnode);
-          list_node *new_node = create_new_list_node(hash, dnode);
-          int result = insert_list_node(&head, new_node);
+          int result = insert_list_node(&head, dnode);
           TEST_ASSERT_EQUAL(0, result);
           data_node *deleted_node = NULL;
-          result = delete_list_node(&head, key, hash, &deleted_node);
+          result = delete_list_node(&head, key, strlen(key), hash, &deleted_node);
           TEST_ASSERT_EQUAL(0, result);
     }
 }
 
+void test_replace_list_node_keeps_chain(void) {
+    atomic_list_node_ptr head = NULL;
+    const char *keys[] = {"tail", "middle", "head"};
+    unsigned char data[] = "value";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+
+    data_node *nodes[3];
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_EQUAL(0, create_data_node(NULL, NULL, keys[i], strlen(keys[i]), 7, &value, DATA_NODE_SYNC_NONE, 0, &nodes[i]));
+        TEST_ASSERT_EQUAL(0, insert_list_node(&head, nodes[i]));
+    }
+
+    // The replacement takes over the old node's position and link, readers standing on the old node can still walk on
+    data_node *replacement = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, NULL, "middle", 6, 7, &value, DATA_NODE_SYNC_NONE, 0, &replacement));
+    TEST_ASSERT_EQUAL_PTR(nodes[1], replace_list_node(&head, "middle", 6, 7, replacement));
+    TEST_ASSERT_EQUAL_PTR(replacement, nodes[2]->next);
+    TEST_ASSERT_EQUAL_PTR(nodes[0], replacement->next);
+    TEST_ASSERT_EQUAL_PTR(nodes[0], nodes[1]->next);
+    TEST_ASSERT_EQUAL_PTR(replacement, find_list_node(head, "middle", 6, 7));
+    TEST_ASSERT_NULL(replace_list_node(&head, "absent", 6, 7, nodes[1]));
+    delete_data_node(NULL, nodes[1]);
+
+    TEST_ASSERT_EQUAL(0, delete_all_list_nodes(&(bucket_node_context){0}, head));
+}
+
+void test_find_list_node_compares_binary_keys(void) {
+    // Same hash, keys only differ after an embedded zero byte or in their length
+    const char first[] = {'u', 0, 'a'};
+    const char second[] = {'u', 0, 'b'};
+    unsigned char data[] = "v";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    data_node *first_node = NULL;
+    data_node *second_node = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, NULL, first, sizeof(first), 7, &value, DATA_NODE_SYNC_NONE, 0, &first_node));
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, NULL, second, sizeof(second), 7, &value, DATA_NODE_SYNC_NONE, 0, &second_node));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(first), first_node->key_size);
+
+    atomic_list_node_ptr head = NULL;
+    TEST_ASSERT_EQUAL(0, insert_list_node(&head, first_node));
+    TEST_ASSERT_EQUAL(0, insert_list_node(&head, second_node));
+    TEST_ASSERT_EQUAL_PTR(first_node, find_list_node(head, first, sizeof(first), 7));
+    TEST_ASSERT_EQUAL_PTR(second_node, find_list_node(head, second, sizeof(second), 7));
+    TEST_ASSERT_NULL(find_list_node(head, first, 2, 7)); // Prefix of both keys
+    TEST_ASSERT_NULL(find_list_node(head, "u", 1, 7));
+
+    TEST_ASSERT_EQUAL(0, delete_all_list_nodes(&(bucket_node_context){0}, head));
+}
+
 int test_hash_bucket_list_suite(void) {
-    initialize_memory_manager((memory_manager_config){ .bucket_size = 10, .pre_allocation_factor = 1.0, .allocate_list_pool = true, .allocate_tree_pool = false });
     printf("Running hash_bucket_list tests...\n");
     RUN_TEST(test_insert_and_find_list_node);
     RUN_TEST(test_delete_list_node_not_found);
@@ -193,7 +233,8 @@ int test_hash_bucket_list_suite(void) {
     RUN_TEST(test_insert_large_key);
     RUN_TEST(test_delete_single_node_list);
     RUN_TEST(test_repeated_insert_delete);
+    RUN_TEST(test_replace_list_node_keeps_chain);
+    RUN_TEST(test_find_list_node_compares_binary_keys);
     printf("Completed hash_bucket_list tests.\n");
-    cleanup_memory_manager();
     return 0;
 }   
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "unity.h"
+#include "bucket/hash_bucket_tree.h"
+#include "bucket/hash_bucket_list.h"
+#include "core/data_node.h"
+#include "utils/memory_manager.h"
+#include <string.h>
+
+static memory_manager g_tree_test_memory_manager;
+static const bucket_node_context g_tree_test_context = { .memory_manager_ptr = &g_tree_test_memory_manager };
+
+// Returns the black height of the subtree, or -1 if a red-black or ordering property is violated
+static int _tree_black_height(tree_node *node) {
+    if (node == NULL) return 1;
+    if (node->color == RED && ((node->left && node->left->color == RED) || (node->right && node->right->color == RED))) return -1;
+    if (node->left && (node->left->parent != node || node->left->key_hash > node->key_hash)) return -1;
+    if (node->right && (node->right->parent != node || node->right->key_hash < node->key_hash)) return -1;
+    int left_height = _tree_black_height(node->left);
+    int right_height = _tree_black_height(node->right);
+    if (left_height < 0 || left_height != right_height) return -1;
+    return left_height + (node->color == BLACK ? 1 : 0);
+}
+
+static data_node* _create_tree_test_data_node(const char *key, uint32_t key_hash) {
+    unsigned char data[] = "value";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    data_node *dnode = NULL;
+    TEST_ASSERT_EQUAL(0, create_data_node(NULL, NULL, key, strlen(key), key_hash, &value, DATA_NODE_SYNC_NONE, 0, &dnode));
+    return dnode;
+}
+
+void test_insert_and_find_tree_node(void) {
+    tree_node *root = NULL;
+    data_node *dnode = _create_tree_test_data_node("testkey", 12345);
+    TEST_ASSERT_EQUAL(0, insert_tree_node(&root, create_new_tree_node(&g_tree_test_context, 12345, dnode)));
+    TEST_ASSERT_EQUAL(BLACK, root->color);
+
+    tree_node *found = find_tree_node(root, "testkey", 7, 12345);
+    TEST_ASSERT_NOT_NULL(found);
+    TEST_ASSERT_EQUAL_PTR(dnode, found->data);
+
+    data_node *deleted_node = NULL;
+    TEST_ASSERT_EQUAL(0, delete_tree_node(&g_tree_test_context, &root, "testkey", 7, 12345, &deleted_node));
+    TEST_ASSERT_EQUAL_PTR(dnode, deleted_node);
+    TEST_ASSERT_NULL(root);
+    delete_data_node(NULL, deleted_node);
+}
+
+void test_delete_tree_node_not_found(void) {
+    tree_node *root = NULL;
+    data_node *deleted_node = NULL;
+    TEST_ASSERT_EQUAL(-41, delete_tree_node(&g_tree_test_context, &root, "notfound", 8, 99999, &deleted_node));
+    TEST_ASSERT_EQUAL(-21, delete_tree_node(&g_tree_test_context, &root, NULL, 0, 99999, &deleted_node));
+    TEST_ASSERT_NULL(find_tree_node(root, "notfound", 8, 99999));
+}
+
+void test_insert_null_and_duplicate_tree_node(void) {
+    tree_node *root = NULL;
+    TEST_ASSERT_EQUAL(-20, insert_tree_node(&root, NULL));
+
+    data_node *dnode = _create_tree_test_data_node("dup", 7);
+    TEST_ASSERT_EQUAL(0, insert_tree_node(&root, create_new_tree_node(&g_tree_test_context, 7, dnode)));
+    tree_node *duplicate = create_new_tree_node(&g_tree_test_context, 7, dnode);
+    TEST_ASSERT_EQUAL(-42, insert_tree_node(&root, duplicate));
+    free_memory(&g_tree_test_memory_manager, duplicate, TREE_POOL);
+
+    delete_all_tree_nodes(&g_tree_test_context, root);
+}
+
+void test_tree_orders_colliding_hashes_by_key(void) {
+    // Every key shares the same hash, so the tree must fall back to the key for ordering
+    tree_node *root = NULL;
+    char key[16];
+    for (int i = 0; i < 32; ++i) {
+        snprintf(key, sizeof(key), "collide%d", i);
+        TEST_ASSERT_EQUAL(0, insert_tree_node(&root, create_new_tree_node(&g_tree_test_context, 42, _create_tree_test_data_node(key, 42))));
+    }
+    TEST_ASSERT_TRUE(_tree_black_height(root) > 0);
+
+    for (int i = 0; i < 32; ++i) {
+        snprintf(key, sizeof(key), "collide%d", i);
+        tree_node *found = find_tree_node(root, key, strlen(key), 42);
+        TEST_ASSERT_NOT_NULL(found);
+        TEST_ASSERT_EQUAL_STRING(key, found->data->key);
+    }
+    TEST_ASSERT_NULL(find_tree_node(root, "collide32", 9, 42));
+
+    delete_all_tree_nodes(&g_tree_test_context, root);
+}
+
+void test_tree_stays_balanced_under_insert_and_delete(void) {
+    tree_node *root = NULL;
+    char key[16];
+    // Ascending hashes are the worst case for an unbalanced tree
+    for (uint32_t i = 0; i < 256; ++i) {
+        snprintf(key, sizeof(key), "k%u", i);
+        TEST_ASSERT_EQUAL(0, insert_tree_node(&root, create_new_tree_node(&g_tree_test_context, i, _create_tree_test_data_node(key, i))));
+    }
+    int black_height = _tree_black_height(root);
+    TEST_ASSERT_TRUE(black_height > 0);
+    TEST_ASSERT_TRUE(black_height <= 9); // log2(256) + 1
+
+    // Delete every other key, checking the invariants after each removal
+    for (uint32_t i = 0; i < 256; i += 2) {
+        snprintf(key, sizeof(key), "k%u", i);
+        data_node *deleted_node = NULL;
+        TEST_ASSERT_EQUAL(0, delete_tree_node(&g_tree_test_context, &root, key, strlen(key), i, &deleted_node));
+        delete_data_node(NULL, deleted_node);
+        TEST_ASSERT_TRUE(_tree_black_height(root) > 0);
+        TEST_ASSERT_EQUAL(BLACK, root->color);
+    }
+
+    for (uint32_t i = 0; i < 256; ++i) {
+        snprintf(key, sizeof(key), "k%u", i);
+        tree_node *found = find_tree_node(root, key, strlen(key), i);
+        if (i % 2 == 0) TEST_ASSERT_NULL(found);
+        else TEST_ASSERT_NOT_NULL(found);
+    }
+
+    delete_all_tree_nodes(&g_tree_test_context, root);
+}
+
+void test_convert_list_to_tree_and_back(void) {
+    atomic_list_node_ptr head = NULL;
+    char key[16];
+    for (uint32_t i = 0; i < 16; ++i) {
+        snprintf(key, sizeof(key), "conv%u", i);
+        TEST_ASSERT_EQUAL(0, insert_list_node(&head, _create_tree_test_data_node(key, i % 4)));
+    }
+
+    tree_node *root = NULL;
+    TEST_ASSERT_EQUAL(0, convert_list_to_tree(&g_tree_test_context, &head, &root));
+    TEST_ASSERT_NULL(head);
+    TEST_ASSERT_TRUE(_tree_black_height(root) > 0);
+
+    data_node *converted_head = NULL;
+    TEST_ASSERT_EQUAL(0, convert_tree_to_list(&g_tree_test_context, &root, &converted_head));
+    TEST_ASSERT_NULL(root);
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        snprintf(key, sizeof(key), "conv%u", i);
+        TEST_ASSERT_NOT_NULL(find_list_node(converted_head, key, strlen(key), i % 4));
+    }
+
+    delete_all_list_nodes(&g_tree_test_context, converted_head);
+}
+
+int test_hash_bucket_tree_suite(void) {
+    initialize_memory_manager(&g_tree_test_memory_manager, (memory_manager_config){ .bucket_size = 64, .pre_allocation_factor = 1.0, .allocate_tree_pool = true });
+    printf("Running hash_bucket_tree tests...\n");
+    RUN_TEST(test_insert_and_find_tree_node);
+    RUN_TEST(test_delete_tree_node_not_found);
+    RUN_TEST(test_insert_null_and_duplicate_tree_node);
+    RUN_TEST(test_tree_orders_colliding_hashes_by_key);
+    RUN_TEST(test_tree_stays_balanced_under_insert_and_delete);
+    RUN_TEST(test_convert_list_to_tree_and_back);
+    printf("Completed hash_bucket_tree tests.\n");
+    cleanup_memory_manager(&g_tree_test_memory_manager);
+    return 0;
+}
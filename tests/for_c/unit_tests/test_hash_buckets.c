@@ -2,131 +2,590 @@
 #include "bucket/hash_buckets.h"
 #include "bucket/hash_bucket_list.h"
 #include "core/data_node.h"
+#include "core/operation_counters.h"
 #include "utils/memory_manager.h"
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <math.h>
 
-
+static memory_manager g_buckets_test_memory_manager;
+static hash_bucket_memory_pool g_test_pool;
 
 void test_initialise_and_cleanup_hash_buckets(void) {
-    TEST_ASSERT_EQUAL(-21, initialise_hash_buckets(0, false)); // Not power of two
-    TEST_ASSERT_EQUAL(0, initialise_hash_buckets(8, false));
-    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets());
+    TEST_ASSERT_EQUAL(-21, initialise_hash_buckets(&g_test_pool, 0, false, &g_buckets_test_memory_manager)); // Not power of two
+    TEST_ASSERT_EQUAL(0, initialise_hash_buckets(&g_test_pool, 8, false, &g_buckets_test_memory_manager));
+    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets(&g_test_pool));
 }
 
 void test_get_hash_bucket_and_initialization(void) {
-    initialise_hash_buckets(4, false);
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
     for (unsigned int i = 0; i < 4; ++i) {
-        hash_bucket *bucket = get_hash_bucket(i);
+        hash_bucket *bucket = get_hash_bucket(&g_test_pool, i);
         TEST_ASSERT_NOT_NULL(bucket);
         TEST_ASSERT_TRUE(bucket->is_initialized);
     }
-    cleanup_hash_buckets();
+    cleanup_hash_buckets(&g_test_pool);
 }
 
 void test_get_hash_bucket_out_of_bounds(void) {
-    initialise_hash_buckets(2, false);
-    hash_bucket *bucket = get_hash_bucket(2); // Out of bounds
+    initialise_hash_buckets(&g_test_pool, 2, false, &g_buckets_test_memory_manager);
+    hash_bucket *bucket = get_hash_bucket(&g_test_pool, 2); // Out of bounds
     TEST_ASSERT_NULL(bucket);
-    cleanup_hash_buckets();
+    cleanup_hash_buckets(&g_test_pool);
 }
 
 void test_add_and_find_node_in_bucket(void) {
-    initialise_hash_buckets(2, false);
+    initialise_hash_buckets(&g_test_pool, 2, false, &g_buckets_test_memory_manager);
     unsigned char data[] = "data";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
-    TEST_ASSERT_EQUAL_MESSAGE(0, upsert_node_to_bucket(0, "key1", 123, &value), "Failed to add node to bucket");
+    TEST_ASSERT_EQUAL_MESSAGE(0, upsert_node_to_bucket(&g_test_pool, "key1", 4, 123, &value), "Failed to add node to bucket");
     key_store_value out = {0};
-    TEST_ASSERT_EQUAL_MESSAGE(0, find_node_in_bucket(0, "key1", 123, &out), "Failed to find node in bucket");
+    TEST_ASSERT_EQUAL_MESSAGE(0, find_node_in_bucket(&g_test_pool, "key1", 4, 123, &out), "Failed to find node in bucket");
     TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(data, out.data, sizeof(data), "Data mismatch");
     free(out.data);
-    cleanup_hash_buckets();
+    cleanup_hash_buckets(&g_test_pool);
 }
 
-void test_add_node_to_invalid_bucket(void) {
-    initialise_hash_buckets(2, false);
+void test_add_node_to_uninitialised_buckets(void) {
     unsigned char data[] = "data2";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
-    TEST_ASSERT_EQUAL(-40, upsert_node_to_bucket(5, "key2", 456, &value)); // Out of bounds
-    cleanup_hash_buckets();
+    TEST_ASSERT_EQUAL(-40, upsert_node_to_bucket(&g_test_pool, "key2", 4, 456, &value)); // Buckets not initialised
 }
 
 void test_delete_node_from_bucket(void) {
-    initialise_hash_buckets(2, false);
+    initialise_hash_buckets(&g_test_pool, 2, false, &g_buckets_test_memory_manager);
     unsigned char data[] = "data3";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
-    upsert_node_to_bucket(1, "key3", 789, &value);
-    TEST_ASSERT_EQUAL(0, delete_node_from_bucket(1, "key3", 789));
+    upsert_node_to_bucket(&g_test_pool, "key3", 4, 789, &value);
+    TEST_ASSERT_EQUAL(0, delete_node_from_bucket(&g_test_pool, "key3", 4, 789));
     key_store_value out = {0};
-    TEST_ASSERT_EQUAL(-41, find_node_in_bucket(1, "key3", 789, &out));
-    cleanup_hash_buckets();
+    TEST_ASSERT_EQUAL(-41, find_node_in_bucket(&g_test_pool, "key3", 4, 789, &out));
+    cleanup_hash_buckets(&g_test_pool);
 }
 
-void test_delete_node_from_invalid_bucket(void) {
-    initialise_hash_buckets(2, false);
-    TEST_ASSERT_EQUAL(-40, delete_node_from_bucket(3, "keyX", 999)); // Out of bounds
-    cleanup_hash_buckets();
+void test_delete_node_from_uninitialised_buckets(void) {
+    TEST_ASSERT_EQUAL(-40, delete_node_from_bucket(&g_test_pool, "keyX", 4, 999)); // Buckets not initialised
 }
 
 void test_repeated_initialise_and_cleanup(void) {
     // Repeated initialisation and cleanup
-    TEST_ASSERT_EQUAL(0, initialise_hash_buckets(4, false));
-    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets());
+    TEST_ASSERT_EQUAL(0, initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager));
+    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets(&g_test_pool));
     // Cleanup again should fail
-    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets());
+    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets(&g_test_pool));
     // Re-initialise after cleanup
-    TEST_ASSERT_EQUAL(0, initialise_hash_buckets(8, false));
-    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets());
+    TEST_ASSERT_EQUAL(0, initialise_hash_buckets(&g_test_pool, 8, false, &g_buckets_test_memory_manager));
+    TEST_ASSERT_EQUAL(0, cleanup_hash_buckets(&g_test_pool));
 }
 
 void test_add_null_node(void) {
-    initialise_hash_buckets(2, false);
+    initialise_hash_buckets(&g_test_pool, 2, false, &g_buckets_test_memory_manager);
     // Add node with NULL value
-    TEST_ASSERT_EQUAL(-20, upsert_node_to_bucket(1, "key", 123, NULL));
-    cleanup_hash_buckets();
+    TEST_ASSERT_EQUAL(-20, upsert_node_to_bucket(&g_test_pool, "key", 3, 123, NULL));
+    cleanup_hash_buckets(&g_test_pool);
 }
 
 void test_find_node_null_key(void) {
-    initialise_hash_buckets(2, false);
+    initialise_hash_buckets(&g_test_pool, 2, false, &g_buckets_test_memory_manager);
     key_store_value out = {0};
     // Find node with NULL key
-    TEST_ASSERT_EQUAL(-20, find_node_in_bucket(1, NULL, 123, &out));
-    cleanup_hash_buckets();
+    TEST_ASSERT_EQUAL(-20, find_node_in_bucket(&g_test_pool, NULL, 0, 123, &out));
+    cleanup_hash_buckets(&g_test_pool);
 }
 
 void test_delete_node_null_key(void) {
-    initialise_hash_buckets(2, false);
+    initialise_hash_buckets(&g_test_pool, 2, false, &g_buckets_test_memory_manager);
     // Delete node with NULL key
-    TEST_ASSERT_EQUAL(-20, delete_node_from_bucket(1, NULL, 123));
-    cleanup_hash_buckets();
+    TEST_ASSERT_EQUAL(-20, delete_node_from_bucket(&g_test_pool, NULL, 0, 123));
+    cleanup_hash_buckets(&g_test_pool);
 }
 
 void test_add_node_after_cleanup(void) {
-    initialise_hash_buckets(2, false);
-    cleanup_hash_buckets();
+    initialise_hash_buckets(&g_test_pool, 2, false, &g_buckets_test_memory_manager);
+    cleanup_hash_buckets(&g_test_pool);
     // Try to add node after cleanup
     unsigned char data[] = "dataX";
     key_store_value value = { .data = data, .data_size = sizeof(data) };
-    TEST_ASSERT_EQUAL(-40, upsert_node_to_bucket(1, "keyX", 321, &value));
+    TEST_ASSERT_EQUAL(-40, upsert_node_to_bucket(&g_test_pool, "keyX", 4, 321, &value));
+}
+
+void test_configure_hash_bucket_resize_invalid(void) {
+    TEST_ASSERT_EQUAL(-40, configure_hash_bucket_resize(&g_test_pool, 1.0, 0.0)); // Not initialised
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    TEST_ASSERT_EQUAL(-21, configure_hash_bucket_resize(&g_test_pool, -1.0, 0.0));
+    TEST_ASSERT_EQUAL(-21, configure_hash_bucket_resize(&g_test_pool, 1.0, 0.5)); // Halved table would grow again
+    TEST_ASSERT_EQUAL(0, configure_hash_bucket_resize(&g_test_pool, 1.0, 0.25));
+    cleanup_hash_buckets(&g_test_pool);
+}
+
+void test_hash_buckets_grow_incrementally(void) {
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    configure_hash_bucket_resize(&g_test_pool, 1.0, 0.0);
+    unsigned char data[] = "grow";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    char key[16];
+    for (uint32_t i = 0; i < 64; ++i) {
+        snprintf(key, sizeof(key), "grow%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, key, strlen(key), i * 2654435761u, &value));
+    }
+    TEST_ASSERT_TRUE(get_hash_bucket_count(&g_test_pool) >= 64);
+    // Every key remains reachable, whether or not its old bucket has been drained yet
+    for (uint32_t i = 0; i < 64; ++i) {
+        snprintf(key, sizeof(key), "grow%u", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, key, strlen(key), i * 2654435761u, &out));
+        free(out.data);
+    }
+    keystore_stats stats = {0};
+    get_hash_bucket_pool_stats(&g_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT(64, stats.key_entries.total_keys);
+    cleanup_hash_buckets(&g_test_pool);
+}
+
+void test_hash_buckets_shrink_incrementally(void) {
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    configure_hash_bucket_resize(&g_test_pool, 1.0, 0.25);
+    unsigned char data[] = "shrink";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    char key[16];
+    for (uint32_t i = 0; i < 64; ++i) {
+        snprintf(key, sizeof(key), "shrink%u", i);
+        upsert_node_to_bucket(&g_test_pool, key, strlen(key), i * 2654435761u, &value);
+    }
+    unsigned int grown_count = get_hash_bucket_count(&g_test_pool);
+    for (uint32_t i = 0; i < 60; ++i) {
+        snprintf(key, sizeof(key), "shrink%u", i);
+        TEST_ASSERT_EQUAL(0, delete_node_from_bucket(&g_test_pool, key, strlen(key), i * 2654435761u));
+    }
+    TEST_ASSERT_TRUE(get_hash_bucket_count(&g_test_pool) < grown_count);
+    TEST_ASSERT_TRUE(get_hash_bucket_count(&g_test_pool) >= 4); // Never below the initial size
+    for (uint32_t i = 60; i < 64; ++i) {
+        snprintf(key, sizeof(key), "shrink%u", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, key, strlen(key), i * 2654435761u, &out));
+        free(out.data);
+    }
+    cleanup_hash_buckets(&g_test_pool);
+}
+
+void test_configure_hash_bucket_tree_invalid(void) {
+    TEST_ASSERT_EQUAL(-40, configure_hash_bucket_tree(&g_test_pool, 8)); // Not initialised
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    TEST_ASSERT_EQUAL(-21, configure_hash_bucket_tree(&g_test_pool, 1)); // Would never untreeify
+    TEST_ASSERT_EQUAL(0, configure_hash_bucket_tree(&g_test_pool, 0));
+    TEST_ASSERT_EQUAL(0, configure_hash_bucket_tree(&g_test_pool, 8));
+    cleanup_hash_buckets(&g_test_pool);
+}
+
+void test_colliding_bucket_treeifies_and_untreeifies(void) {
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    configure_hash_bucket_tree(&g_test_pool, 8);
+    unsigned char data[] = "tree";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    char key[16];
+    // All keys hash to bucket 1
+    for (uint32_t i = 0; i < 32; ++i) {
+        snprintf(key, sizeof(key), "tree%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, key, strlen(key), (i << 2) | 1, &value));
+    }
+    hash_bucket *bucket = get_hash_bucket(&g_test_pool, 1);
+    TEST_ASSERT_EQUAL(BUCKET_TREE, bucket->type);
+    TEST_ASSERT_EQUAL_UINT(32, bucket->count);
+
+    for (uint32_t i = 0; i < 32; ++i) {
+        snprintf(key, sizeof(key), "tree%u", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, key, strlen(key), (i << 2) | 1, &out));
+        free(out.data);
+    }
+
+    // Updating an existing key in a tree bucket does not add a node
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "tree0", 5, 1, &value));
+    TEST_ASSERT_EQUAL_UINT(32, bucket->count);
+
+    for (uint32_t i = 0; i < 29; ++i) {
+        snprintf(key, sizeof(key), "tree%u", i);
+        TEST_ASSERT_EQUAL(0, delete_node_from_bucket(&g_test_pool, key, strlen(key), (i << 2) | 1));
+    }
+    TEST_ASSERT_EQUAL(BUCKET_LIST, bucket->type); // Below half the threshold
+    for (uint32_t i = 29; i < 32; ++i) {
+        snprintf(key, sizeof(key), "tree%u", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, key, strlen(key), (i << 2) | 1, &out));
+        free(out.data);
+    }
+    cleanup_hash_buckets(&g_test_pool);
+}
+
+void test_tree_buckets_survive_incremental_resize(void) {
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    configure_hash_bucket_resize(&g_test_pool, 1.0, 0.0);
+    configure_hash_bucket_tree(&g_test_pool, 4);
+    unsigned char data[] = "split";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    char key[16];
+    // Hashes share their low bits but differ above them, so tree buckets are split while the table grows
+    for (uint32_t i = 0; i < 48; ++i) {
+        snprintf(key, sizeof(key), "split%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, key, strlen(key), (i << 2) | 2, &value));
+    }
+    TEST_ASSERT_TRUE(get_hash_bucket_count(&g_test_pool) > 4);
+    for (uint32_t i = 0; i < 48; ++i) {
+        snprintf(key, sizeof(key), "split%u", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, key, strlen(key), (i << 2) | 2, &out));
+        free(out.data);
+    }
+    keystore_stats stats = {0};
+    get_hash_bucket_pool_stats(&g_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT(48, stats.key_entries.total_keys);
+    cleanup_hash_buckets(&g_test_pool);
+}
+
+static void* _concurrent_upsert_worker(void *arg) {
+    unsigned char *data = arg;
+    key_store_value value = { .data = data, .data_size = 1 };
+    char key[16];
+    for (uint32_t i = 0; i < 256; ++i) {
+        snprintf(key, sizeof(key), "race%u", i);
+        upsert_node_to_bucket(&g_test_pool, key, strlen(key), i, &value);
+    }
+    return NULL;
+}
+
+void test_concurrent_upserts_do_not_duplicate_keys(void) {
+    // The suite's memory manager is single-threaded, this test uses a thread-safe one of its own
+    memory_manager memory = {0};
+    memory_manager_config memory_config = { .bucket_size = 256, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = true };
+    initialize_memory_manager(&memory, memory_config);
+    initialise_hash_buckets(&g_test_pool, 16, true, &memory);
+    pthread_t threads[8];
+    unsigned char thread_data[8];
+    for (int i = 0; i < 8; ++i) {
+        thread_data[i] = (unsigned char)('a' + i);
+        pthread_create(&threads[i], NULL, _concurrent_upsert_worker, &thread_data[i]);
+    }
+    for (int i = 0; i < 8; ++i) pthread_join(threads[i], NULL);
+
+    // Every thread upserted the same 256 keys, so each key must be stored exactly once
+    keystore_stats stats = {0};
+    get_hash_bucket_pool_stats(&g_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT(256, stats.key_entries.total_keys);
+    cleanup_hash_buckets(&g_test_pool);
+    cleanup_memory_manager(&memory);
+}
+
+// Recomputes the occupancy figures with a full scan, as the statistics did before the histogram
+static void _scan_bucket_occupancy(hash_bucket_memory_pool *pool_ptr, unsigned int *total_keys_out, unsigned int *nonempty_out, unsigned int *max_out, double *sum_squares_out) {
+    *total_keys_out = 0;
+    *nonempty_out = 0;
+    *max_out = 0;
+    *sum_squares_out = 0.0;
+    for (unsigned int i = 0; i < pool_ptr->total_blocks + pool_ptr->old_total_blocks; ++i) {
+        hash_bucket *bucket_ptr = (i < pool_ptr->total_blocks) ? &pool_ptr->hash_buckets_ptr[i] : &pool_ptr->old_hash_buckets_ptr[i - pool_ptr->total_blocks];
+        if (!bucket_ptr->is_initialized || atomic_load(&bucket_ptr->is_migrated) || bucket_ptr->count == 0) continue;
+        *total_keys_out += bucket_ptr->count;
+        *nonempty_out += 1;
+        if (bucket_ptr->count > *max_out) *max_out = bucket_ptr->count;
+        *sum_squares_out += (double)bucket_ptr->count * bucket_ptr->count;
+    }
+}
+
+static void _assert_occupancy_matches_scan(hash_bucket_memory_pool *pool_ptr) {
+    unsigned int total_keys, nonempty, max_keys;
+    double sum_squares;
+    _scan_bucket_occupancy(pool_ptr, &total_keys, &nonempty, &max_keys, &sum_squares);
+
+    keystore_stats stats = {0};
+    get_hash_bucket_pool_stats(pool_ptr, &stats);
+    TEST_ASSERT_EQUAL_UINT(total_keys, stats.key_entries.total_keys);
+    TEST_ASSERT_EQUAL_UINT(nonempty, stats.key_entries.nonempty_buckets);
+    TEST_ASSERT_EQUAL_UINT(max_keys, stats.key_entries.max_keys_in_bucket);
+    TEST_ASSERT_EQUAL_UINT(stats.key_entries.total_buckets, stats.key_entries.nonempty_buckets + stats.key_entries.empty_buckets);
+    if (nonempty > 0) {
+        double avg = (double)total_keys / nonempty;
+        double expected_stddev = sqrt(fmax(sum_squares / nonempty - avg * avg, 0.0));
+        TEST_ASSERT_TRUE(fabs(expected_stddev - stats.key_entries.stddev_keys_per_bucket) < 1e-9);
+    }
+}
+
+void test_bucket_occupancy_stats_are_incremental(void) {
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    unsigned char data[] = "occupancy";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+
+    // Hashes 0, 4 and 8 share bucket 0, hash 1 lands alone in bucket 1: bucket counts {3, 1}
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "a", 1, 0, &value));
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "b", 1, 4, &value));
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "c", 1, 8, &value));
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "d", 1, 1, &value));
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "a", 1, 0, &value)); // Update, no count change
+
+    keystore_stats stats = {0};
+    get_hash_bucket_pool_stats(&g_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT(4, stats.key_entries.total_keys);
+    TEST_ASSERT_EQUAL_UINT(2, stats.key_entries.total_buckets); // Lazily initialized buckets only
+    TEST_ASSERT_EQUAL_UINT(2, stats.key_entries.nonempty_buckets);
+    TEST_ASSERT_EQUAL_UINT(3, stats.key_entries.max_keys_in_bucket);
+    TEST_ASSERT_EQUAL_UINT(1, stats.key_entries.min_keys_in_bucket);
+    TEST_ASSERT_TRUE(stats.key_entries.median_keys_per_bucket == 2.0);
+    TEST_ASSERT_TRUE(stats.key_entries.stddev_keys_per_bucket == 1.0);
+    TEST_ASSERT_EQUAL_UINT(1, stats.collisions.collision_buckets);
+    TEST_ASSERT_EQUAL_UINT(2, stats.collisions.highest_collision_in_bucket);
+    TEST_ASSERT_TRUE(stats.collisions.avg_collisions_per_nonempty_bucket == 2.0);
+
+    TEST_ASSERT_EQUAL(0, delete_node_from_bucket(&g_test_pool, "d", 1, 1));
+    TEST_ASSERT_EQUAL(-41, delete_node_from_bucket(&g_test_pool, "d", 1, 1));
+    get_hash_bucket_pool_stats(&g_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT(3, stats.key_entries.total_keys);
+    TEST_ASSERT_EQUAL_UINT(1, stats.key_entries.nonempty_buckets);
+    TEST_ASSERT_EQUAL_UINT(1, stats.key_entries.empty_buckets);
+    TEST_ASSERT_TRUE(stats.key_entries.median_keys_per_bucket == 3.0);
+    cleanup_hash_buckets(&g_test_pool);
+
+    // Buckets holding more keys than the exact slots are counted per power of two, totals stay exact
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    char key[16];
+    for (uint32_t i = 0; i < KEY_STORE_OCCUPANCY_EXACT_SLOTS + 8; ++i) {
+        snprintf(key, sizeof(key), "full%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, key, strlen(key), i * 4, &value));
+    }
+    get_hash_bucket_pool_stats(&g_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT(KEY_STORE_OCCUPANCY_EXACT_SLOTS + 8, stats.key_entries.total_keys);
+    TEST_ASSERT_EQUAL_UINT(KEY_STORE_OCCUPANCY_EXACT_SLOTS + 8, stats.key_entries.max_keys_in_bucket);
+    TEST_ASSERT_TRUE(stats.key_entries.stddev_keys_per_bucket == 0.0);
+    cleanup_hash_buckets(&g_test_pool);
+}
+
+void test_bucket_occupancy_stats_count_overflow_buckets(void) {
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    configure_hash_bucket_tree(&g_test_pool, 8);
+    unsigned char data[] = "overflow";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    char key[16];
+
+    // Tree buckets of 100 and 70 keys share the [64, 128) overflow slot, bucket 2 holds a single key
+    for (uint32_t i = 0; i < 100; ++i) {
+        snprintf(key, sizeof(key), "big%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, key, strlen(key), i << 2, &value));
+    }
+    for (uint32_t i = 0; i < 70; ++i) {
+        snprintf(key, sizeof(key), "mid%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, key, strlen(key), (i << 2) | 1, &value));
+    }
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "one", 3, 2, &value));
+    TEST_ASSERT_EQUAL(BUCKET_TREE, get_hash_bucket(&g_test_pool, 0)->type);
+
+    keystore_stats stats = {0};
+    get_hash_bucket_pool_stats(&g_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT(171, stats.key_entries.total_keys);
+    TEST_ASSERT_EQUAL_UINT(100, stats.key_entries.max_keys_in_bucket);
+    TEST_ASSERT_EQUAL_UINT(1, stats.key_entries.min_keys_in_bucket);
+    TEST_ASSERT_TRUE(stats.key_entries.median_keys_per_bucket == 85.0); // Average of the overflow slot
+    TEST_ASSERT_EQUAL_UINT(2, stats.collisions.collision_buckets);
+    TEST_ASSERT_EQUAL_UINT(99, stats.collisions.highest_collision_in_bucket);
+    _assert_occupancy_matches_scan(&g_test_pool);
+
+    // The fullest bucket drops back to the exact slots, the one left in the overflow slot is reported exactly
+    for (uint32_t i = 0; i < 40; ++i) {
+        snprintf(key, sizeof(key), "big%u", i);
+        TEST_ASSERT_EQUAL(0, delete_node_from_bucket(&g_test_pool, key, strlen(key), i << 2));
+    }
+    get_hash_bucket_pool_stats(&g_test_pool, &stats);
+    TEST_ASSERT_EQUAL_UINT(70, stats.key_entries.max_keys_in_bucket);
+    TEST_ASSERT_TRUE(stats.key_entries.median_keys_per_bucket == 60.0);
+    TEST_ASSERT_EQUAL_UINT(69, stats.collisions.highest_collision_in_bucket);
+    _assert_occupancy_matches_scan(&g_test_pool);
+    cleanup_hash_buckets(&g_test_pool);
+}
+
+void test_bucket_occupancy_follows_incremental_resize(void) {
+    memory_manager memory = {0};
+    memory_manager_config memory_config = { .bucket_size = 256, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = true };
+    initialize_memory_manager(&memory, memory_config);
+    initialise_hash_buckets(&g_test_pool, 4, true, &memory);
+    configure_hash_bucket_resize(&g_test_pool, 1.0, 0.25);
+    unsigned char data[] = "resize";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    char key[16];
+
+    // Checked after every operation, so states with a partly drained old table are covered
+    for (uint32_t i = 0; i < 200; ++i) {
+        snprintf(key, sizeof(key), "occ%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, key, strlen(key), i * 2654435761u, &value));
+        _assert_occupancy_matches_scan(&g_test_pool);
+    }
+    for (uint32_t i = 0; i < 190; ++i) {
+        snprintf(key, sizeof(key), "occ%u", i);
+        TEST_ASSERT_EQUAL(0, delete_node_from_bucket(&g_test_pool, key, strlen(key), i * 2654435761u));
+        _assert_occupancy_matches_scan(&g_test_pool);
+    }
+    cleanup_hash_buckets(&g_test_pool);
+    cleanup_memory_manager(&memory);
+}
+
+static unsigned int _count_initialized_buckets(hash_bucket *hash_buckets_ptr, unsigned int total_blocks) {
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < total_blocks; ++i) count += hash_buckets_ptr[i].is_initialized ? 1 : 0;
+    return count;
+}
+
+void test_resize_initializes_new_buckets_on_migration(void) {
+    memory_manager memory = {0};
+    memory_manager_config memory_config = { .bucket_size = 64, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = true };
+    initialize_memory_manager(&memory, memory_config);
+    initialise_hash_buckets(&g_test_pool, 4, true, &memory);
+    configure_hash_bucket_resize(&g_test_pool, 1.0, 0.25);
+    TEST_ASSERT_EQUAL_UINT(4, atomic_load(&g_test_pool.grow_key_threshold));
+    TEST_ASSERT_EQUAL_UINT(0, atomic_load(&g_test_pool.shrink_key_threshold)); // Already at the initial size
+    unsigned char data[] = "lazy";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    char key[16];
+
+    // The fifth key crosses the threshold, the new table starts out without any initialized bucket
+    for (uint32_t i = 0; i < 5; ++i) {
+        snprintf(key, sizeof(key), "lazy%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, key, strlen(key), i, &value));
+    }
+    TEST_ASSERT_EQUAL_UINT(8, get_hash_bucket_count(&g_test_pool));
+    TEST_ASSERT_NOT_NULL(g_test_pool.old_hash_buckets_ptr);
+    TEST_ASSERT_EQUAL_UINT(0, _count_initialized_buckets(g_test_pool.hash_buckets_ptr, 8));
+    TEST_ASSERT_EQUAL_UINT(8, atomic_load(&g_test_pool.grow_key_threshold));
+    TEST_ASSERT_EQUAL_UINT(2, atomic_load(&g_test_pool.shrink_key_threshold));
+
+    // An operation drains the key's old bucket and the one at the migration cursor, initializing their two targets each
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, "lazy1", 5, 1, &out));
+    free(out.data);
+    TEST_ASSERT_EQUAL_UINT(4, _count_initialized_buckets(g_test_pool.hash_buckets_ptr, 8));
+    TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, "lazy3", 5, 3, &out));
+    free(out.data);
+    TEST_ASSERT_EQUAL_UINT(6, _count_initialized_buckets(g_test_pool.hash_buckets_ptr, 8));
+    TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, "lazy2", 5, 2, &out));
+    free(out.data);
+    TEST_ASSERT_EQUAL_UINT(8, _count_initialized_buckets(g_test_pool.hash_buckets_ptr, 8));
+    TEST_ASSERT_NULL(g_test_pool.old_hash_buckets_ptr);
+
+    // Shrinking drains sibling buckets together into their shared target
+    for (uint32_t i = 0; i < 4; ++i) {
+        snprintf(key, sizeof(key), "lazy%u", i);
+        TEST_ASSERT_EQUAL(0, delete_node_from_bucket(&g_test_pool, key, strlen(key), i));
+    }
+    TEST_ASSERT_EQUAL_UINT(4, get_hash_bucket_count(&g_test_pool));
+    TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, "lazy4", 5, 4, &out));
+    free(out.data);
+    TEST_ASSERT_TRUE(atomic_load(&g_test_pool.old_hash_buckets_ptr[0].is_migrated));
+    TEST_ASSERT_TRUE(atomic_load(&g_test_pool.old_hash_buckets_ptr[4].is_migrated));
+    _assert_occupancy_matches_scan(&g_test_pool);
+    cleanup_hash_buckets(&g_test_pool);
+    cleanup_memory_manager(&memory);
+}
+
+void test_lock_free_reads_do_not_drive_resize(void) {
+    memory_manager memory = {0};
+    memory_manager_config memory_config = { .bucket_size = 64, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = true };
+    initialize_memory_manager(&memory, memory_config);
+    epoch_manager epoch = {0};
+    TEST_ASSERT_EQUAL(0, initialize_epoch_manager(&epoch));
+    initialise_hash_buckets(&g_test_pool, 4, true, &memory);
+    configure_hash_bucket_resize(&g_test_pool, 1.0, 0.25);
+    TEST_ASSERT_EQUAL(0, configure_hash_bucket_lock_free_read(&g_test_pool, &epoch));
+    unsigned char data[] = "reader";
+    key_store_value value = { .data = data, .data_size = sizeof(data) };
+    char key[16];
+
+    for (uint32_t i = 0; i < 5; ++i) {
+        snprintf(key, sizeof(key), "reader%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, key, strlen(key), i, &value));
+    }
+    TEST_ASSERT_NOT_NULL(g_test_pool.old_hash_buckets_ptr);
+
+    // Readers find the keys in whichever table holds them, the resize stays where the writers left it
+    key_store_value out = {0};
+    for (uint32_t i = 0; i < 5; ++i) {
+        snprintf(key, sizeof(key), "reader%u", i);
+        TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, key, strlen(key), i, &out));
+        TEST_ASSERT_EQUAL_STRING("reader", (char *)out.data);
+        free(out.data);
+    }
+    TEST_ASSERT_EQUAL(-41, find_node_in_bucket(&g_test_pool, "missing", 7, 6, &out));
+    TEST_ASSERT_EQUAL_UINT(0, atomic_load(&g_test_pool.migrated_blocks));
+    TEST_ASSERT_NOT_NULL(g_test_pool.old_hash_buckets_ptr);
+
+    // A writer finishes the resize, readers then use the new table alone
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "reader1", 7, 1, &value));
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "reader3", 7, 3, &value));
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "reader2", 7, 2, &value));
+    TEST_ASSERT_NULL(g_test_pool.old_hash_buckets_ptr);
+    TEST_ASSERT_EQUAL(0, find_node_in_bucket(&g_test_pool, "reader4", 7, 4, &out));
+    free(out.data);
+
+    cleanup_hash_buckets(&g_test_pool);
+    cleanup_epoch_manager(&epoch);
+    cleanup_memory_manager(&memory);
+}
+
+void test_hash_bucket_pools_are_independent(void) {
+    hash_bucket_memory_pool other_pool = {0};
+    initialise_hash_buckets(&g_test_pool, 4, false, &g_buckets_test_memory_manager);
+    TEST_ASSERT_EQUAL(0, initialise_hash_buckets(&other_pool, 4, false, &g_buckets_test_memory_manager));
+    unsigned char first[] = "first";
+    unsigned char second[] = "second";
+    key_store_value first_value = { first, sizeof(first) };
+    key_store_value second_value = { second, sizeof(second) };
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&g_test_pool, "shared", 6, 7, &first_value));
+    TEST_ASSERT_EQUAL(0, upsert_node_to_bucket(&other_pool, "shared", 6, 7, &second_value));
+    TEST_ASSERT_EQUAL(0, delete_node_from_bucket(&g_test_pool, "shared", 6, 7));
+
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(-41, find_node_in_bucket(&g_test_pool, "shared", 6, 7, &out));
+    TEST_ASSERT_EQUAL(0, find_node_in_bucket(&other_pool, "shared", 6, 7, &out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(second, out.data, sizeof(second));
+    free(out.data);
+
+#if OPERATION_COUNTERS_ENABLED
+    data_node_operation_counters node_counters;
+    sum_data_node_operation_counters(&g_test_pool.data_node_counters, &node_counters);
+    TEST_ASSERT_EQUAL_UINT(1, node_counters.total_delete_ops);
+    sum_data_node_operation_counters(&other_pool.data_node_counters, &node_counters);
+    TEST_ASSERT_EQUAL_UINT(0, node_counters.total_delete_ops);
+#endif
+    TEST_ASSERT_EQUAL(-20, initialise_hash_buckets(NULL, 4, false, &g_buckets_test_memory_manager));
+    cleanup_hash_buckets(&g_test_pool);
+    cleanup_hash_buckets(&other_pool);
 }
 
 int test_hash_buckets_suite(void) {
     
     printf("Running hash_buckets tests...\n");
-    initialize_memory_manager((memory_manager_config){ .bucket_size = 10, .pre_allocation_factor = 1.0, .allocate_list_pool = true, .allocate_tree_pool = false, .is_concurrency_enabled = false });
+    initialize_memory_manager(&g_buckets_test_memory_manager, (memory_manager_config){ .bucket_size = 10, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = false });
     RUN_TEST(test_initialise_and_cleanup_hash_buckets);
     RUN_TEST(test_get_hash_bucket_and_initialization);
     RUN_TEST(test_get_hash_bucket_out_of_bounds);
     RUN_TEST(test_add_and_find_node_in_bucket);
-    RUN_TEST(test_add_node_to_invalid_bucket);
+    RUN_TEST(test_add_node_to_uninitialised_buckets);
     RUN_TEST(test_delete_node_from_bucket);
-    RUN_TEST(test_delete_node_from_invalid_bucket);
+    RUN_TEST(test_delete_node_from_uninitialised_buckets);
     RUN_TEST(test_repeated_initialise_and_cleanup);
     RUN_TEST(test_add_null_node);
     RUN_TEST(test_find_node_null_key);
     RUN_TEST(test_delete_node_null_key);
     RUN_TEST(test_add_node_after_cleanup);
-    cleanup_memory_manager();
+    RUN_TEST(test_configure_hash_bucket_resize_invalid);
+    RUN_TEST(test_hash_buckets_grow_incrementally);
+    RUN_TEST(test_hash_buckets_shrink_incrementally);
+    RUN_TEST(test_bucket_occupancy_stats_are_incremental);
+    RUN_TEST(test_bucket_occupancy_stats_count_overflow_buckets);
+    RUN_TEST(test_bucket_occupancy_follows_incremental_resize);
+    RUN_TEST(test_resize_initializes_new_buckets_on_migration);
+    RUN_TEST(test_lock_free_reads_do_not_drive_resize);
+    RUN_TEST(test_configure_hash_bucket_tree_invalid);
+    RUN_TEST(test_colliding_bucket_treeifies_and_untreeifies);
+    RUN_TEST(test_tree_buckets_survive_incremental_resize);
+    RUN_TEST(test_concurrent_upserts_do_not_duplicate_keys);
+    RUN_TEST(test_hash_bucket_pools_are_independent);
+    cleanup_memory_manager(&g_buckets_test_memory_manager);
     printf("hash_buckets tests completed.\n");
     return 0;
 }
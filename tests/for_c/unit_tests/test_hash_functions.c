@@ -28,37 +28,37 @@
 void test_murmurhash_basic(void) {
     const char *key = "testkey";
     uint32_t seed = 42;
-    uint32_t hash = hash_function_murmur_32(key, seed);
+    uint32_t hash = hash_function_murmur_32(key, strlen(key), seed);
     TEST_ASSERT_NOT_EQUAL(0, hash);
-    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, seed));
+    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, strlen(key), seed));
 }
 
 void test_murmurhash_empty_string(void) {
     const char *key = "";
     uint32_t seed = 42;
-    uint32_t hash = hash_function_murmur_32(key, seed);
-    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, seed));
+    uint32_t hash = hash_function_murmur_32(key, strlen(key), seed);
+    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, strlen(key), seed));
 }
 
 void test_murmurhash_different_keys(void) {
     const char *key1 = "key1";
     const char *key2 = "key2";
     uint32_t seed = 42;
-    uint32_t hash1 = hash_function_murmur_32(key1, seed);
-    uint32_t hash2 = hash_function_murmur_32(key2, seed);
+    uint32_t hash1 = hash_function_murmur_32(key1, strlen(key1), seed);
+    uint32_t hash2 = hash_function_murmur_32(key2, strlen(key2), seed);
     TEST_ASSERT_NOT_EQUAL(hash1, hash2);
 }
 
 void test_murmurhash_different_seeds(void) {
     const char *key = "testkey";
-    uint32_t hash1 = hash_function_murmur_32(key, 1);
-    uint32_t hash2 = hash_function_murmur_32(key, 2);
+    uint32_t hash1 = hash_function_murmur_32(key, strlen(key), 1);
+    uint32_t hash2 = hash_function_murmur_32(key, strlen(key), 2);
     TEST_ASSERT_NOT_EQUAL(hash1, hash2);
 }
 
 void test_murmurhash_null_key(void) {
     uint32_t seed = 42;
-    uint32_t hash = hash_function_murmur_32(NULL, seed);
+    uint32_t hash = hash_function_murmur_32(NULL, 0, seed);
     TEST_ASSERT_EQUAL(UINT32_MAX, hash); // Now returns UINT32_MAX for error
 }
 
@@ -67,15 +67,15 @@ void test_murmurhash_long_string(void) {
     memset(key, 'A', sizeof(key) - 1);
     key[sizeof(key) - 1] = '\0';
     uint32_t seed = 123;
-    uint32_t hash = hash_function_murmur_32(key, seed);
+    uint32_t hash = hash_function_murmur_32(key, strlen(key), seed);
     TEST_ASSERT_NOT_EQUAL(0, hash);
-    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, seed));
+    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, strlen(key), seed));
 }
 
 void test_murmurhash_seed_zero(void) {
     const char *key = "seedzero";
-    uint32_t hash1 = hash_function_murmur_32(key, 0);
-    uint32_t hash2 = hash_function_murmur_32(key, 0);
+    uint32_t hash1 = hash_function_murmur_32(key, strlen(key), 0);
+    uint32_t hash2 = hash_function_murmur_32(key, strlen(key), 0);
     TEST_ASSERT_EQUAL(hash1, hash2);
     TEST_ASSERT_NOT_EQUAL(0, hash1);
 }
@@ -83,25 +83,25 @@ void test_murmurhash_seed_zero(void) {
 void test_murmurhash_single_char(void) {
     const char *key = "A";
     uint32_t seed = 99;
-    uint32_t hash = hash_function_murmur_32(key, seed);
+    uint32_t hash = hash_function_murmur_32(key, strlen(key), seed);
     TEST_ASSERT_NOT_EQUAL(0, hash);
-    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, seed));
+    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, strlen(key), seed));
 }
 
 // Additional tests for improved coverage
 
 void test_murmurhash_max_seed(void) {
     const char *key = "maxseed";
-    uint32_t hash1 = hash_function_murmur_32(key, UINT32_MAX);
-    uint32_t hash2 = hash_function_murmur_32(key, UINT32_MAX);
+    uint32_t hash1 = hash_function_murmur_32(key, strlen(key), UINT32_MAX);
+    uint32_t hash2 = hash_function_murmur_32(key, strlen(key), UINT32_MAX);
     TEST_ASSERT_EQUAL(hash1, hash2);
     TEST_ASSERT_NOT_EQUAL(0, hash1);
 }
 
 void test_murmurhash_min_seed(void) {
     const char *key = "minseed";
-    uint32_t hash1 = hash_function_murmur_32(key, 0);
-    uint32_t hash2 = hash_function_murmur_32(key, 0);
+    uint32_t hash1 = hash_function_murmur_32(key, strlen(key), 0);
+    uint32_t hash2 = hash_function_murmur_32(key, strlen(key), 0);
     TEST_ASSERT_EQUAL(hash1, hash2);
     TEST_ASSERT_NOT_EQUAL(0, hash1);
 }
@@ -109,18 +109,18 @@ void test_murmurhash_min_seed(void) {
 void test_murmurhash_special_chars(void) {
     const char *key = "!@#$%^&*()_+-=[]{}|;':,.<>/?";
     uint32_t seed = 12345;
-    uint32_t hash = hash_function_murmur_32(key, seed);
+    uint32_t hash = hash_function_murmur_32(key, strlen(key), seed);
     TEST_ASSERT_NOT_EQUAL(0, hash);
-    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, seed));
+    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, strlen(key), seed));
 }
 
 void test_murmurhash_unicode(void) {
     // UTF-8 encoded string
     const char *key = "测试🌟";
     uint32_t seed = 9876;
-    uint32_t hash = hash_function_murmur_32(key, seed);
+    uint32_t hash = hash_function_murmur_32(key, strlen(key), seed);
     TEST_ASSERT_NOT_EQUAL(0, hash);
-    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, seed));
+    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, strlen(key), seed));
 }
 
 void test_murmurhash_repeated_chars(void) {
@@ -128,9 +128,9 @@ void test_murmurhash_repeated_chars(void) {
     memset(key, 'B', sizeof(key) - 1);
     key[sizeof(key) - 1] = '\0';
     uint32_t seed = 555;
-    uint32_t hash = hash_function_murmur_32(key, seed);
+    uint32_t hash = hash_function_murmur_32(key, strlen(key), seed);
     TEST_ASSERT_NOT_EQUAL(0, hash);
-    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, seed));
+    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key, strlen(key), seed));
 }
 
 void test_murmurhash_binary_data(void) {
@@ -141,9 +141,9 @@ void test_murmurhash_binary_data(void) {
     char key_str[9];
     memcpy(key_str, key, 8);
     key_str[8] = '\0';
-    uint32_t hash = hash_function_murmur_32(key_str, seed);
+    uint32_t hash = hash_function_murmur_32(key_str, strlen(key_str), seed);
     TEST_ASSERT_NOT_EQUAL(0, hash);
-    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key_str, seed));
+    TEST_ASSERT_EQUAL(hash, hash_function_murmur_32(key_str, strlen(key_str), seed));
 }
 
 int test_hash_functions_suite(void) {
@@ -1,8 +1,11 @@
 
 #include "unity.h"
 #include "core/key_store.h"
+#include "core/operation_counters.h"
+#include "hash/hash_functions.h"
 #include <string.h>
 #include <limits.h>
+#include <pthread.h>
 
 // Helper for freeing key_store_value
 static void free_key_store_value(key_store_value *value) {
@@ -246,6 +249,1025 @@ void test_set_get_multiple_keys(void) {
 
 
 
+void test_initialise_key_store_with_config(void) {
+    key_store_config invalid = { .bucket_size = 8, .pre_memory_allocation_factor = 0.5, .grow_load_factor = 1.0, .shrink_load_factor = 0.75 };
+    TEST_ASSERT_EQUAL(-21, initialise_key_store_with_config(invalid));
+    key_store_config config = { .bucket_size = 8, .pre_memory_allocation_factor = 0.5, .grow_load_factor = 2.0, .shrink_load_factor = 0.5 };
+    TEST_ASSERT_EQUAL(0, initialise_key_store_with_config(config));
+    cleanup_key_store();
+}
+
+void test_table_grows_with_keys(void) {
+    initialise_key_store(8, 0.5, false);
+    char key[16];
+    unsigned char val[4] = {1, 2, 3, 4};
+    key_store_value v = {val, sizeof(val)};
+    for(int i=0; i<1000; ++i) {
+        snprintf(key, sizeof(key), "g%d", i);
+        TEST_ASSERT_EQUAL(0, set_key(key, &v));
+    }
+    for(int i=0; i<1000; ++i) {
+        snprintf(key, sizeof(key), "g%d", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, get_key(key, &out));
+        free_key_store_value(&out);
+    }
+    keystore_stats stats = get_keystore_stats();
+    TEST_ASSERT_EQUAL_UINT(1000, stats.key_entries.total_keys);
+    TEST_ASSERT_TRUE(stats.key_entries.avg_keys_per_nonempty_bucket < 4.0);
+    cleanup_key_store();
+}
+
+void test_lock_free_read_requires_concurrency(void) {
+    key_store_config config = { .bucket_size = 8, .pre_memory_allocation_factor = 0.5, .grow_load_factor = 1.0, .is_lock_free_read_enabled = true };
+    TEST_ASSERT_EQUAL(-21, initialise_key_store_with_config(config));
+}
+
+// Stores the address of the viewed value in context
+static int _view_data_address(const unsigned char *data, size_t data_size, void *context) {
+    (void)data_size;
+    *(const unsigned char **)context = data;
+    return 0;
+}
+
+void test_lock_free_read_set_get_delete(void) {
+    key_store_config config = { .bucket_size = 8, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 8, .is_lock_free_read_enabled = true };
+    TEST_ASSERT_EQUAL(0, initialise_key_store_with_config(config));
+    char key[16];
+    unsigned char val[4] = {1, 2, 3, 4};
+    key_store_value v = {val, sizeof(val)};
+    for(int i=0; i<500; ++i) {
+        snprintf(key, sizeof(key), "lf%d", i);
+        TEST_ASSERT_EQUAL(0, set_key(key, &v));
+    }
+
+    // A value of the same size is written in place under the node's sequence counter
+    const unsigned char *storage_before = NULL, *storage_after = NULL;
+    unsigned char same_size_val[4] = {5, 6, 7, 8};
+    key_store_value ssv = {same_size_val, sizeof(same_size_val)};
+    TEST_ASSERT_EQUAL(0, get_key_view("lf5", _view_data_address, &storage_before));
+    TEST_ASSERT_EQUAL(0, set_key("lf5", &ssv));
+    TEST_ASSERT_EQUAL(0, get_key_view("lf5", _view_data_address, &storage_after));
+    TEST_ASSERT_EQUAL_PTR(storage_before, storage_after);
+
+    // Other sizes replace the data node, the new value must be visible to the next read
+    unsigned char new_val[2] = {9, 9};
+    key_store_value nv = {new_val, sizeof(new_val)};
+    TEST_ASSERT_EQUAL(0, set_key("lf7", &nv));
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, get_key("lf7", &out));
+    TEST_ASSERT_EQUAL_UINT(sizeof(new_val), out.data_size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(new_val, out.data, sizeof(new_val));
+    free_key_store_value(&out);
+    TEST_ASSERT_EQUAL(0, get_key("lf5", &out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(same_size_val, out.data, sizeof(same_size_val));
+    free_key_store_value(&out);
+
+    for(int i=0; i<500; i += 2) {
+        snprintf(key, sizeof(key), "lf%d", i);
+        TEST_ASSERT_EQUAL(0, delete_key(key));
+    }
+    for(int i=0; i<500; ++i) {
+        snprintf(key, sizeof(key), "lf%d", i);
+        TEST_ASSERT_EQUAL(i % 2 == 0 ? -41 : 0, get_key(key, &out));
+        free_key_store_value(&out);
+    }
+    TEST_ASSERT_EQUAL_UINT(250, get_keystore_stats().key_entries.total_keys);
+    cleanup_key_store();
+}
+
+static void* _lock_free_reader_worker(void *arg) {
+    (void)arg;
+    char key[16];
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 256; ++i) {
+            snprintf(key, sizeof(key), "rw%d", i);
+            key_store_value out = {0};
+            // A key is either missing or holds a complete 8-byte value with identical bytes
+            if (get_key(key, &out) == 0) {
+                if (out.data_size != 8 || memcmp(out.data, out.data + 4, 4) != 0) *(int *)arg = 1;
+                free_key_store_value(&out);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void* _lock_free_writer_worker(void *arg) {
+    unsigned char fill = *(unsigned char *)arg;
+    char key[16];
+    unsigned char val[8];
+    key_store_value v = {val, sizeof(val)};
+    for (int round = 0; round < 20; ++round) {
+        memset(val, fill + round, sizeof(val));
+        for (int i = 0; i < 256; ++i) {
+            snprintf(key, sizeof(key), "rw%d", i);
+            if ((i + round) % 3 == 0) delete_key(key);
+            else set_key(key, &v);
+        }
+    }
+    return NULL;
+}
+
+void test_lock_free_reads_with_concurrent_writers(void) {
+    key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 8, .is_lock_free_read_enabled = true };
+    TEST_ASSERT_EQUAL(0, initialise_key_store_with_config(config));
+    pthread_t readers[4], writers[2];
+    int torn_read[4] = {0};
+    unsigned char fills[2] = {'a', 'A'};
+    for (int i = 0; i < 4; ++i) pthread_create(&readers[i], NULL, _lock_free_reader_worker, &torn_read[i]);
+    for (int i = 0; i < 2; ++i) pthread_create(&writers[i], NULL, _lock_free_writer_worker, &fills[i]);
+    for (int i = 0; i < 2; ++i) pthread_join(writers[i], NULL);
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(readers[i], NULL);
+        TEST_ASSERT_EQUAL(0, torn_read[i]);
+    }
+    cleanup_key_store();
+}
+
+void test_swiss_engine_set_get_delete(void) {
+    key_store_config config = { .bucket_size = 8, .pre_memory_allocation_factor = 0.5, .engine = KEY_STORE_ENGINE_SWISS };
+    TEST_ASSERT_EQUAL(0, initialise_key_store_with_config(config));
+    char key[16];
+    unsigned char val[4] = {1, 2, 3, 4};
+    key_store_value v = {val, sizeof(val)};
+    for(int i=0; i<1000; ++i) {
+        snprintf(key, sizeof(key), "sw%d", i);
+        TEST_ASSERT_EQUAL(0, set_key(key, &v));
+    }
+    for(int i=0; i<1000; i += 2) {
+        snprintf(key, sizeof(key), "sw%d", i);
+        TEST_ASSERT_EQUAL(0, delete_key(key));
+    }
+    for(int i=0; i<1000; ++i) {
+        snprintf(key, sizeof(key), "sw%d", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(i % 2 == 0 ? -41 : 0, get_key(key, &out));
+        free_key_store_value(&out);
+    }
+    TEST_ASSERT_EQUAL_UINT(500, get_keystore_stats().key_entries.total_keys);
+    cleanup_key_store();
+}
+
+void test_swiss_engine_invalid_config(void) {
+    key_store_config config = { .bucket_size = 8, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .is_lock_free_read_enabled = true, .engine = KEY_STORE_ENGINE_SWISS };
+    TEST_ASSERT_EQUAL(-21, initialise_key_store_with_config(config));
+    config.is_lock_free_read_enabled = false;
+    config.engine = (key_store_engine_t)42;
+    TEST_ASSERT_EQUAL(-21, initialise_key_store_with_config(config));
+}
+
+void test_key_store_instances_are_independent(void) {
+    key_store_config config = { .bucket_size = 8, .pre_memory_allocation_factor = 0.5 };
+    key_store *first = NULL;
+    key_store *second = NULL;
+    TEST_ASSERT_EQUAL(0, create_key_store(config, &first));
+    config.engine = KEY_STORE_ENGINE_SWISS;
+    TEST_ASSERT_EQUAL(0, create_key_store(config, &second));
+
+    unsigned char first_data[] = "first";
+    unsigned char second_data[] = "second value";
+    key_store_value first_value = {first_data, sizeof(first_data)};
+    key_store_value second_value = {second_data, sizeof(second_data)};
+    TEST_ASSERT_EQUAL(0, store_set_key(first, "shared", &first_value));
+    TEST_ASSERT_EQUAL(0, store_set_key(second, "shared", &second_value));
+    TEST_ASSERT_EQUAL(0, store_set_key(second, "only_second", &second_value));
+
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, store_get_key(first, "shared", &out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(first_data, out.data, sizeof(first_data));
+    free_key_store_value(&out);
+    TEST_ASSERT_EQUAL(-41, store_get_key(first, "only_second", &out));
+
+    TEST_ASSERT_EQUAL(0, store_delete_key(first, "shared"));
+    TEST_ASSERT_EQUAL(0, store_get_key(second, "shared", &out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(second_data, out.data, sizeof(second_data));
+    free_key_store_value(&out);
+
+    TEST_ASSERT_EQUAL_UINT(0, store_get_keystore_stats(first).key_entries.total_keys);
+    TEST_ASSERT_EQUAL_UINT(2, store_get_keystore_stats(second).key_entries.total_keys);
+    TEST_ASSERT_EQUAL(-40, get_key("shared", &out)); // The default instance is not initialized
+
+    TEST_ASSERT_EQUAL(0, destroy_key_store(first));
+    TEST_ASSERT_EQUAL(0, store_get_key(second, "only_second", &out));
+    free_key_store_value(&out);
+    TEST_ASSERT_EQUAL(0, destroy_key_store(second));
+}
+
+void test_key_store_instances_invalid_arguments(void) {
+    key_store_config config = { .bucket_size = 8, .pre_memory_allocation_factor = 0.5 };
+    key_store *store = NULL;
+    TEST_ASSERT_EQUAL(-20, create_key_store(config, NULL));
+    config.bucket_size = 6;
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store));
+    TEST_ASSERT_NULL(store);
+    TEST_ASSERT_EQUAL(-20, destroy_key_store(NULL));
+
+    unsigned char data[] = "v";
+    key_store_value value = {data, sizeof(data)};
+    TEST_ASSERT_EQUAL(-20, store_set_key(NULL, "k", &value));
+    TEST_ASSERT_EQUAL(-20, store_get_key(NULL, "k", &value));
+    TEST_ASSERT_EQUAL(-20, store_delete_key(NULL, "k"));
+    TEST_ASSERT_EQUAL_UINT(0, store_get_keystore_stats(NULL).key_entries.total_buckets);
+}
+
+static void* _instance_owner_worker(void *arg) {
+    int *result = arg;
+    key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 1.0, .is_concurrency_enabled = true, .is_lock_free_read_enabled = true };
+    key_store *store = NULL;
+    if (create_key_store(config, &store) != 0) {
+        *result = -1;
+        return NULL;
+    }
+    char key[16];
+    unsigned char data = (unsigned char)*result;
+    key_store_value value = {&data, 1};
+    for (int i = 0; i < 2000; ++i) {
+        snprintf(key, sizeof(key), "k%d", i % 128);
+        if (i % 4 == 3) store_delete_key(store, key);
+        else store_set_key(store, key, &value);
+        key_store_value out = {0};
+        if (store_get_key(store, key, &out) == 0) {
+            if (out.data_size != 1 || out.data[0] != data) *result = -1;
+            free_key_store_value(&out);
+        }
+    }
+    destroy_key_store(store);
+    return NULL;
+}
+
+void test_key_store_instances_on_separate_threads(void) {
+    pthread_t threads[4];
+    int results[4];
+    for (int i = 0; i < 4; ++i) {
+        results[i] = i + 1;
+        pthread_create(&threads[i], NULL, _instance_owner_worker, &results[i]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+        TEST_ASSERT_EQUAL(i + 1, results[i]);
+    }
+}
+
+void test_sharded_key_store_set_get_delete(void) {
+    key_store_config config = { .bucket_size = 64, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = KEY_STORE_DEFAULT_GROW_LOAD_FACTOR, .treeify_threshold = KEY_STORE_DEFAULT_TREEIFY_THRESHOLD, .shard_count = 8 };
+    TEST_ASSERT_EQUAL(0, initialise_key_store_with_config(config));
+    char key[16];
+    unsigned char val[4] = {1, 2, 3, 4};
+    key_store_value v = {val, sizeof(val)};
+    for(int i=0; i<2000; ++i) {
+        snprintf(key, sizeof(key), "sh%d", i);
+        TEST_ASSERT_EQUAL(0, set_key(key, &v));
+    }
+    for(int i=0; i<2000; i += 4) {
+        snprintf(key, sizeof(key), "sh%d", i);
+        TEST_ASSERT_EQUAL(0, delete_key(key));
+    }
+    for(int i=0; i<2000; ++i) {
+        snprintf(key, sizeof(key), "sh%d", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(i % 4 == 0 ? -41 : 0, get_key(key, &out));
+        free_key_store_value(&out);
+    }
+
+    // Statistics are summed over the shards
+    keystore_stats stats = get_keystore_stats();
+    TEST_ASSERT_EQUAL_UINT(1500, stats.key_entries.total_keys);
+#if OPERATION_COUNTERS_ENABLED
+    TEST_ASSERT_EQUAL_UINT(2000, stats.data_node_counters.total_create_ops);
+    TEST_ASSERT_EQUAL_UINT(500, stats.data_node_counters.total_delete_ops);
+#endif
+    TEST_ASSERT_EQUAL_UINT(stats.key_entries.total_buckets, stats.key_entries.nonempty_buckets + stats.key_entries.empty_buckets);
+    TEST_ASSERT_TRUE(stats.key_entries.total_buckets >= 64);
+    TEST_ASSERT_EQUAL(-43, set_thread_home_shard(0)); // Keys are routed by hash
+    cleanup_key_store();
+}
+
+void test_sharded_key_store_invalid_config(void) {
+    key_store_config config = { .bucket_size = 8, .pre_memory_allocation_factor = 0.5, .shard_count = 3 };
+    TEST_ASSERT_EQUAL(-21, initialise_key_store_with_config(config));
+    config.shard_count = KEY_STORE_MAX_SHARD_COUNT * 2;
+    TEST_ASSERT_EQUAL(-21, initialise_key_store_with_config(config));
+    TEST_ASSERT_EQUAL(-40, set_thread_home_shard(0));
+
+    // More shards than buckets leaves one bucket per shard
+    config.shard_count = 16;
+    config.is_concurrency_enabled = true; // Initializes every bucket up front
+    TEST_ASSERT_EQUAL(0, initialise_key_store_with_config(config));
+    TEST_ASSERT_EQUAL_UINT(16, get_keystore_stats().key_entries.total_buckets);
+    cleanup_key_store();
+}
+
+typedef struct {
+    key_store *store;
+    unsigned int home_shard;
+    int result;
+} home_shard_thread_args;
+
+static void* _home_shard_worker(void *arg) {
+    home_shard_thread_args *args = arg;
+    args->result = store_set_thread_home_shard(args->store, args->home_shard);
+    unsigned char data = (unsigned char)args->home_shard;
+    key_store_value value = {&data, 1};
+    if (args->result == 0) args->result = store_set_key(args->store, "per_thread", &value);
+
+    key_store_value out = {0};
+    if (args->result == 0) args->result = store_get_key(args->store, "per_thread", &out);
+    if (args->result == 0 && (out.data_size != 1 || out.data[0] != data)) args->result = -1;
+    free_key_store_value(&out);
+    return NULL;
+}
+
+void test_thread_affinity_partitions_keys_by_thread(void) {
+    key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .shard_count = 4, .is_thread_affinity_enabled = true };
+    key_store *store = NULL;
+    TEST_ASSERT_EQUAL(0, create_key_store(config, &store));
+    TEST_ASSERT_EQUAL(-20, store_set_thread_home_shard(store, 4));
+    TEST_ASSERT_EQUAL(-20, store_set_thread_home_shard(NULL, 0));
+
+    // Threads bound to different shards each see their own copy of the key
+    pthread_t threads[4];
+    home_shard_thread_args args[4];
+    for (int i = 0; i < 4; ++i) {
+        args[i] = (home_shard_thread_args){ store, (unsigned int)i, 0 };
+        pthread_create(&threads[i], NULL, _home_shard_worker, &args[i]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+        TEST_ASSERT_EQUAL(0, args[i].result);
+    }
+    TEST_ASSERT_EQUAL_UINT(4, store_get_keystore_stats(store).key_entries.total_keys);
+
+    TEST_ASSERT_EQUAL(0, store_set_thread_home_shard(store, 2));
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, store_get_key(store, "per_thread", &out));
+    TEST_ASSERT_EQUAL_UINT8(2, out.data[0]);
+    free_key_store_value(&out);
+    TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+}
+
+void test_stats_report_slab_class_occupancy(void) {
+    key_store_config config = { .bucket_size = 64, .pre_memory_allocation_factor = 1, .grow_load_factor = 0, .shard_count = 4 };
+    unsigned char data[40] = {0};
+    key_store_value value = { data, sizeof(data) };
+    char key[16];
+    for (key_store_engine_t engine = KEY_STORE_ENGINE_CHAINED; engine <= KEY_STORE_ENGINE_SWISS; ++engine) {
+        config.engine = engine;
+        key_store *store = NULL;
+        TEST_ASSERT_EQUAL(0, create_key_store(config, &store));
+        for (int i = 0; i < 300; ++i) {
+            snprintf(key, sizeof(key), "slab%d", i);
+            TEST_ASSERT_EQUAL(0, store_set_key(store, key, &value));
+        }
+
+        // Every key holds a data node block and a 40-byte value block from the 48-byte class
+        memory_pool_stats memory = store_get_keystore_stats(store).memory_pool;
+        unsigned int used_blocks = 0;
+        for (unsigned int i = 0; i < MEMORY_SLAB_CLASS_COUNT; ++i) {
+            used_blocks += memory.slab_classes[i].used_blocks;
+            TEST_ASSERT_TRUE(memory.slab_classes[i].used_blocks <= memory.slab_classes[i].total_blocks);
+        }
+        TEST_ASSERT_EQUAL_UINT(600, used_blocks);
+        TEST_ASSERT_EQUAL_UINT(300, memory.slab_classes[3].used_blocks);
+        TEST_ASSERT_EQUAL_size_t(48, memory.slab_classes[3].block_size);
+        TEST_ASSERT_TRUE(memory.memory_per_key_bytes >= 48 + sizeof(data_node));
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+}
+
+void test_inline_values_switch_representation(void) {
+    key_store_config config = { .bucket_size = 64, .pre_memory_allocation_factor = 1, .inline_value_threshold = DATA_NODE_MAX_INLINE_VALUE_SIZE + 1 };
+    key_store *store = NULL;
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store));
+
+    unsigned char small[32];
+    unsigned char large[200];
+    memset(small, 's', sizeof(small));
+    memset(large, 'l', sizeof(large));
+    key_store_value small_value = { small, sizeof(small) };
+    key_store_value large_value = { large, sizeof(large) };
+    char key[16];
+    config.inline_value_threshold = KEY_STORE_DEFAULT_INLINE_VALUE_THRESHOLD;
+    for (key_store_engine_t engine = KEY_STORE_ENGINE_CHAINED; engine <= KEY_STORE_ENGINE_SWISS; ++engine) {
+        config.engine = engine;
+        TEST_ASSERT_EQUAL(0, create_key_store(config, &store));
+        for (int i = 0; i < 100; ++i) {
+            snprintf(key, sizeof(key), "inline%d", i);
+            TEST_ASSERT_EQUAL(0, store_set_key(store, key, &small_value));
+        }
+
+        // Inline values need no block of their own
+        unsigned int used_blocks = 0;
+        memory_pool_stats memory = store_get_keystore_stats(store).memory_pool;
+        for (unsigned int i = 0; i < MEMORY_SLAB_CLASS_COUNT; ++i) used_blocks += memory.slab_classes[i].used_blocks;
+        TEST_ASSERT_EQUAL_UINT(100, used_blocks);
+
+        for (int i = 0; i < 100; i += 2) {
+            snprintf(key, sizeof(key), "inline%d", i);
+            TEST_ASSERT_EQUAL(0, store_set_key(store, key, &large_value));
+        }
+        for (int i = 0; i < 100; ++i) {
+            snprintf(key, sizeof(key), "inline%d", i);
+            key_store_value out = {0};
+            TEST_ASSERT_EQUAL(0, store_get_key(store, key, &out));
+            TEST_ASSERT_EQUAL_size_t(i % 2 == 0 ? sizeof(large) : sizeof(small), out.data_size);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(i % 2 == 0 ? large : small, out.data, out.data_size);
+            free_key_store_value(&out);
+        }
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+}
+
+static void* _seqlock_reader_worker(void *arg) {
+    key_store *store = *(key_store **)arg;
+    char key[16];
+    int torn_read = 0;
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 128; ++i) {
+            snprintf(key, sizeof(key), "sq%d", i);
+            key_store_value out = {0};
+            // Writers store values of 1 to 40 identical bytes, a read must never mix two of them
+            if (store_get_key(store, key, &out) == 0) {
+                for (size_t b = 1; b < out.data_size; ++b) {
+                    if (out.data[b] != out.data[0]) torn_read = 1;
+                }
+                free_key_store_value(&out);
+            }
+        }
+    }
+    return (void *)(intptr_t)torn_read;
+}
+
+static void* _seqlock_writer_worker(void *arg) {
+    key_store *store = *(key_store **)arg;
+    char key[16];
+    unsigned char val[40];
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 128; ++i) {
+            snprintf(key, sizeof(key), "sq%d", i);
+            // Sizes alternate between in-place updates and ones that replace the node
+            key_store_value v = { val, (i + round) % 5 == 0 ? sizeof(val) : (size_t)(1 + (i + round) % 16) };
+            memset(val, 'a' + round, sizeof(val));
+            store_set_key(store, key, &v);
+        }
+    }
+    return NULL;
+}
+
+void test_seqlock_node_sync(void) {
+    key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .grow_load_factor = 1.0, .treeify_threshold = 8, .node_sync = KEY_STORE_NODE_SYNC_SEQLOCK };
+    key_store *store = NULL;
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store)); // Needs concurrency
+    config.node_sync = (key_store_node_sync_t)7;
+    config.is_concurrency_enabled = true;
+    TEST_ASSERT_EQUAL(-21, create_key_store(config, &store));
+
+    config.node_sync = KEY_STORE_NODE_SYNC_SEQLOCK;
+    for (key_store_engine_t engine = KEY_STORE_ENGINE_CHAINED; engine <= KEY_STORE_ENGINE_SWISS; ++engine) {
+        config.engine = engine;
+        TEST_ASSERT_EQUAL(0, create_key_store(config, &store));
+        _seqlock_writer_worker(&store); // Readers find every key even if they run before the writers
+        pthread_t readers[3], writers[2];
+        for (int i = 0; i < 3; ++i) pthread_create(&readers[i], NULL, _seqlock_reader_worker, &store);
+        for (int i = 0; i < 2; ++i) pthread_create(&writers[i], NULL, _seqlock_writer_worker, &store);
+        for (int i = 0; i < 2; ++i) pthread_join(writers[i], NULL);
+        for (int i = 0; i < 3; ++i) {
+            void *torn_read = NULL;
+            pthread_join(readers[i], &torn_read);
+            TEST_ASSERT_NULL(torn_read);
+        }
+
+        keystore_stats stats = store_get_keystore_stats(store);
+        TEST_ASSERT_EQUAL_UINT(128, stats.key_entries.total_keys);
+#if OPERATION_COUNTERS_ENABLED
+        TEST_ASSERT_TRUE(stats.data_node_counters.total_read_ops > 0);
+        TEST_ASSERT_TRUE(stats.data_node_counters.avg_read_latency_ns > 0);
+#endif
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+}
+
+void test_seqlock_nodes_use_less_memory(void) {
+    key_store_config config = { .bucket_size = 64, .pre_memory_allocation_factor = 1, .is_concurrency_enabled = true, .grow_load_factor = 1.0 };
+    unsigned char data[8] = {0};
+    key_store_value value = { data, sizeof(data) };
+    char key[16];
+    size_t memory_per_key[2] = {0};
+    for (int i = 0; i < 2; ++i) {
+        config.node_sync = i == 0 ? KEY_STORE_NODE_SYNC_MUTEX : KEY_STORE_NODE_SYNC_SEQLOCK;
+        key_store *store = NULL;
+        TEST_ASSERT_EQUAL(0, create_key_store(config, &store));
+        for (int k = 0; k < 200; ++k) {
+            snprintf(key, sizeof(key), "mem%d", k);
+            TEST_ASSERT_EQUAL(0, store_set_key(store, key, &value));
+        }
+        memory_per_key[i] = store_get_keystore_stats(store).memory_pool.memory_per_key_bytes;
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+    TEST_ASSERT_TRUE(memory_per_key[1] < memory_per_key[0]);
+}
+
+void test_binary_keys(void) {
+    key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .grow_load_factor = 1.0, .treeify_threshold = 8, .inline_value_threshold = KEY_STORE_DEFAULT_INLINE_VALUE_THRESHOLD };
+    unsigned char uuid[16];
+    unsigned char data[4] = {1, 2, 3, 4};
+    key_store_value value = { data, sizeof(data) };
+    for (key_store_engine_t engine = KEY_STORE_ENGINE_CHAINED; engine <= KEY_STORE_ENGINE_SWISS; ++engine) {
+        config.engine = engine;
+        key_store *store = NULL;
+        TEST_ASSERT_EQUAL(0, create_key_store(config, &store));
+
+        // Keys full of zero bytes that only differ in their last byte
+        for (int i = 0; i < 200; ++i) {
+            memset(uuid, 0, sizeof(uuid));
+            uuid[15] = (unsigned char)i;
+            data[0] = (unsigned char)i;
+            TEST_ASSERT_EQUAL(0, store_set_key_n(store, uuid, sizeof(uuid), &value));
+        }
+        for (int i = 0; i < 200; ++i) {
+            memset(uuid, 0, sizeof(uuid));
+            uuid[15] = (unsigned char)i;
+            key_store_value out = {0};
+            TEST_ASSERT_EQUAL(0, store_get_key_n(store, uuid, sizeof(uuid), &out));
+            TEST_ASSERT_EQUAL_UINT8((unsigned char)i, out.data[0]);
+            free_key_store_value(&out);
+            TEST_ASSERT_EQUAL(-41, store_get_key_n(store, uuid, sizeof(uuid) - 1, &out)); // A prefix is another key
+        }
+        TEST_ASSERT_EQUAL_UINT(200, store_get_keystore_stats(store).key_entries.total_keys);
+
+        // String keys are binary keys without their terminator
+        TEST_ASSERT_EQUAL(0, store_set_key(store, "abc", &value));
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, store_get_key_n(store, "abc", 3, &out));
+        free_key_store_value(&out);
+        TEST_ASSERT_EQUAL(-41, store_get_key_n(store, "abc", 4, &out));
+        TEST_ASSERT_EQUAL(0, store_delete_key_n(store, "abc", 3));
+        TEST_ASSERT_EQUAL(-41, store_get_key(store, "abc", &out));
+
+        memset(uuid, 0, sizeof(uuid));
+        TEST_ASSERT_EQUAL(0, store_delete_key_n(store, uuid, sizeof(uuid)));
+        TEST_ASSERT_EQUAL(-41, store_delete_key_n(store, uuid, sizeof(uuid)));
+        TEST_ASSERT_EQUAL(-20, store_set_key_n(store, uuid, 0, &value));
+        TEST_ASSERT_EQUAL(-20, store_get_key_n(store, NULL, 4, &out));
+        TEST_ASSERT_EQUAL(-20, store_delete_key_n(NULL, uuid, sizeof(uuid)));
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+
+    TEST_ASSERT_EQUAL(0, initialise_key_store(8, 0.5, false));
+    const char key[] = {'k', 0, 'k'};
+    TEST_ASSERT_EQUAL(0, set_key_n(key, sizeof(key), &value));
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, get_key_n(key, sizeof(key), &out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, out.data, sizeof(data));
+    free_key_store_value(&out);
+    TEST_ASSERT_EQUAL(-41, get_key("k", &out));
+    TEST_ASSERT_EQUAL(0, delete_key_n(key, sizeof(key)));
+    cleanup_key_store();
+}
+
+void test_prepared_keys(void) {
+    key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .grow_load_factor = 1.0, .treeify_threshold = 8, .shard_count = 4, .hash_seed = 1234 };
+    unsigned char data[4] = {1, 2, 3, 4};
+    key_store_value value = { data, sizeof(data) };
+    char key[16];
+    for (key_store_engine_t engine = KEY_STORE_ENGINE_CHAINED; engine <= KEY_STORE_ENGINE_SWISS; ++engine) {
+        config.engine = engine;
+        key_store *store = NULL;
+        TEST_ASSERT_EQUAL(0, create_key_store(config, &store));
+
+        // Prepared keys and plain keys address the same entries
+        key_store_prepared_key prepared[100];
+        char keys[100][16];
+        for (int i = 0; i < 100; ++i) {
+            snprintf(keys[i], sizeof(keys[i]), "prep%d", i);
+            TEST_ASSERT_EQUAL(0, store_prepare_key(store, keys[i], strlen(keys[i]), &prepared[i]));
+            TEST_ASSERT_EQUAL(0, store_set_prepared_key(store, &prepared[i], &value));
+        }
+        for (int i = 0; i < 100; ++i) {
+            key_store_value out = {0};
+            TEST_ASSERT_EQUAL(0, store_get_key(store, keys[i], &out));
+            free_key_store_value(&out);
+            TEST_ASSERT_EQUAL(0, store_get_prepared_key(store, &prepared[i], &out));
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(data, out.data, sizeof(data));
+            free_key_store_value(&out);
+        }
+        TEST_ASSERT_EQUAL(0, store_delete_prepared_key(store, &prepared[7]));
+        TEST_ASSERT_EQUAL(-41, store_delete_key(store, "prep7"));
+
+        // A caller-computed hash must match the store's seed
+        snprintf(key, sizeof(key), "prep42");
+        uint32_t key_hash = hash_function_murmur_32(key, strlen(key), config.hash_seed);
+        key_store_prepared_key hashed;
+        TEST_ASSERT_EQUAL(0, store_prepare_key_with_hash(store, key, strlen(key), key_hash, &hashed));
+        TEST_ASSERT_EQUAL_UINT32(prepared[42].key_hash, hashed.key_hash);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, store_get_prepared_key(store, &hashed, &out));
+        free_key_store_value(&out);
+        TEST_ASSERT_EQUAL(-20, store_prepare_key_with_hash(store, key, strlen(key), key_hash + 1, &hashed)); // Debug builds verify the hash
+
+        TEST_ASSERT_EQUAL(-20, store_prepare_key(store, key, 0, &hashed));
+        TEST_ASSERT_EQUAL(-20, store_prepare_key(store, key, strlen(key), NULL));
+        TEST_ASSERT_EQUAL(-20, store_get_prepared_key(store, NULL, &out));
+        TEST_ASSERT_EQUAL(-20, store_set_prepared_key(store, &(key_store_prepared_key){ NULL, 3, 0 }, &value));
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+
+    TEST_ASSERT_EQUAL(0, initialise_key_store(8, 0.5, false));
+    key_store_prepared_key prepared;
+    TEST_ASSERT_EQUAL(0, prepare_key("global", 6, &prepared));
+    TEST_ASSERT_EQUAL(0, set_prepared_key(&prepared, &value));
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, get_prepared_key(&prepared, &out));
+    free_key_store_value(&out);
+    TEST_ASSERT_EQUAL(0, delete_prepared_key(&prepared));
+    TEST_ASSERT_EQUAL(-41, get_key("global", &out));
+    cleanup_key_store();
+}
+
+// Returns 1 if the viewed value equals the expected one in context, 0 otherwise
+static int _view_matches(const unsigned char *data, size_t data_size, void *context) {
+    const key_store_value *expected = context;
+    return data_size == expected->data_size && memcmp(data, expected->data, data_size) == 0;
+}
+
+void test_key_views(void) {
+    key_store_config configs[] = {
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .grow_load_factor = 1.0, .treeify_threshold = 8 },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 8, .shard_count = 2 },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 8, .is_lock_free_read_enabled = true },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 8, .node_sync = KEY_STORE_NODE_SYNC_SEQLOCK },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .engine = KEY_STORE_ENGINE_SWISS },
+    };
+    unsigned char data[] = "a value read in place";
+    key_store_value value = { data, sizeof(data) };
+    unsigned char other[] = "other";
+    key_store_value other_value = { other, sizeof(other) };
+    char key[16];
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); ++c) {
+        key_store *store = NULL;
+        TEST_ASSERT_EQUAL(0, create_key_store(configs[c], &store));
+        for (int i = 0; i < 200; ++i) {
+            snprintf(key, sizeof(key), "view%d", i);
+            TEST_ASSERT_EQUAL(0, store_set_key(store, key, &value));
+        }
+
+        for (int i = 0; i < 200; ++i) {
+            snprintf(key, sizeof(key), "view%d", i);
+            TEST_ASSERT_EQUAL(1, store_get_key_view(store, key, _view_matches, &value));
+            TEST_ASSERT_EQUAL(0, store_get_key_view_n(store, key, strlen(key), _view_matches, &other_value));
+        }
+
+        // Views see updates, whether the value changed in place or moved to a new node
+        TEST_ASSERT_EQUAL(0, store_set_key(store, "view3", &other_value));
+        key_store_prepared_key prepared;
+        TEST_ASSERT_EQUAL(0, store_prepare_key(store, "view3", 5, &prepared));
+        TEST_ASSERT_EQUAL(1, store_get_prepared_key_view(store, &prepared, _view_matches, &other_value));
+
+        TEST_ASSERT_EQUAL(-41, store_get_key_view(store, "missing", _view_matches, &value));
+        TEST_ASSERT_EQUAL(-20, store_get_key_view(store, "view1", NULL, NULL));
+        TEST_ASSERT_EQUAL(-20, store_get_key_view(store, NULL, _view_matches, &value));
+
+        keystore_stats stats = store_get_keystore_stats(store);
+#if OPERATION_COUNTERS_ENABLED
+        TEST_ASSERT_TRUE(stats.data_node_counters.total_read_ops >= 401);
+#endif
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+
+    TEST_ASSERT_EQUAL(0, initialise_key_store(8, 0.5, false));
+    TEST_ASSERT_EQUAL(0, set_key("global", &value));
+    TEST_ASSERT_EQUAL(1, get_key_view("global", _view_matches, &value));
+    TEST_ASSERT_EQUAL(1, get_key_view_n("global", 6, _view_matches, &value));
+    key_store_prepared_key prepared;
+    TEST_ASSERT_EQUAL(0, prepare_key("global", 6, &prepared));
+    TEST_ASSERT_EQUAL(1, get_prepared_key_view(&prepared, _view_matches, &value));
+    cleanup_key_store();
+    TEST_ASSERT_EQUAL(-40, get_key_view("global", _view_matches, &value));
+}
+
+void test_get_key_into_caller_buffer(void) {
+    key_store_config config = { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 8 };
+    unsigned char data[] = "copied into a caller buffer";
+    key_store_value value = { data, sizeof(data) };
+    for (key_store_engine_t engine = KEY_STORE_ENGINE_CHAINED; engine <= KEY_STORE_ENGINE_SWISS; ++engine) {
+        config.engine = engine;
+        key_store *store = NULL;
+        TEST_ASSERT_EQUAL(0, create_key_store(config, &store));
+        TEST_ASSERT_EQUAL(0, store_set_key(store, "into", &value));
+
+        // A large enough buffer receives the value and its size
+        unsigned char buffer[64];
+        size_t value_size = 0;
+        TEST_ASSERT_EQUAL(0, store_get_key_into(store, "into", buffer, sizeof(buffer), &value_size));
+        TEST_ASSERT_EQUAL_size_t(sizeof(data), value_size);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(data, buffer, sizeof(data));
+
+        // A small buffer is left alone and the required size is reported
+        memset(buffer, 0, sizeof(buffer));
+        value_size = 0;
+        TEST_ASSERT_EQUAL(-22, store_get_key_into_n(store, "into", 4, buffer, 8, &value_size));
+        TEST_ASSERT_EQUAL_size_t(sizeof(data), value_size);
+        TEST_ASSERT_EACH_EQUAL_UINT8(0, buffer, sizeof(buffer));
+        TEST_ASSERT_EQUAL(-22, store_get_key_into(store, "into", NULL, 0, &value_size));
+        TEST_ASSERT_EQUAL_size_t(sizeof(data), value_size);
+
+        key_store_prepared_key prepared;
+        TEST_ASSERT_EQUAL(0, store_prepare_key(store, "into", 4, &prepared));
+        TEST_ASSERT_EQUAL(0, store_get_prepared_key_into(store, &prepared, buffer, sizeof(data), &value_size));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(data, buffer, sizeof(data));
+
+        // Size and existence queries copy nothing
+        value_size = 0;
+        TEST_ASSERT_EQUAL(0, store_get_value_size(store, "into", &value_size));
+        TEST_ASSERT_EQUAL_size_t(sizeof(data), value_size);
+        TEST_ASSERT_EQUAL(0, store_get_value_size_n(store, "into", 4, &value_size));
+        TEST_ASSERT_EQUAL(0, store_exists_key(store, "into"));
+        TEST_ASSERT_EQUAL(0, store_exists_key_n(store, "into", 4));
+        TEST_ASSERT_EQUAL(-41, store_exists_key(store, "missing"));
+        TEST_ASSERT_EQUAL(-41, store_get_value_size(store, "missing", &value_size));
+        TEST_ASSERT_EQUAL(-41, store_get_key_into(store, "missing", buffer, sizeof(buffer), &value_size));
+
+        TEST_ASSERT_EQUAL(-20, store_get_key_into(store, "into", buffer, sizeof(buffer), NULL));
+        TEST_ASSERT_EQUAL(-20, store_get_key_into(store, "into", NULL, 8, &value_size));
+        TEST_ASSERT_EQUAL(-20, store_get_value_size(store, "into", NULL));
+        TEST_ASSERT_EQUAL(-20, store_exists_key(store, NULL));
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+
+    TEST_ASSERT_EQUAL(0, initialise_key_store(8, 0.5, false));
+    TEST_ASSERT_EQUAL(0, set_key("global", &value));
+    unsigned char buffer[64];
+    size_t value_size = 0;
+    TEST_ASSERT_EQUAL(0, get_key_into("global", buffer, sizeof(buffer), &value_size));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, buffer, sizeof(data));
+    TEST_ASSERT_EQUAL(0, get_key_into_n("global", 6, buffer, sizeof(buffer), &value_size));
+    key_store_prepared_key prepared;
+    TEST_ASSERT_EQUAL(0, prepare_key("global", 6, &prepared));
+    TEST_ASSERT_EQUAL(-22, get_prepared_key_into(&prepared, buffer, 1, &value_size));
+    TEST_ASSERT_EQUAL(0, exists_key("global"));
+    TEST_ASSERT_EQUAL(0, exists_key_n("global", 6));
+    TEST_ASSERT_EQUAL(0, get_value_size("global", &value_size));
+    TEST_ASSERT_EQUAL(0, get_value_size_n("global", 6, &value_size));
+    TEST_ASSERT_EQUAL_size_t(sizeof(data), value_size);
+    TEST_ASSERT_EQUAL(0, delete_key("global"));
+    TEST_ASSERT_EQUAL(-41, exists_key("global"));
+    cleanup_key_store();
+}
+
+void test_batched_get_and_set(void) {
+    key_store_config configs[] = {
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .grow_load_factor = 1.0, .treeify_threshold = 4 },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 4, .shard_count = 4 },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 4, .is_lock_free_read_enabled = true },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 4, .node_sync = KEY_STORE_NODE_SYNC_SEQLOCK },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .engine = KEY_STORE_ENGINE_SWISS, .shard_count = 2 },
+    };
+    enum { BATCH_KEYS = 100 };
+    char key_storage[BATCH_KEYS][16];
+    const char *keys[BATCH_KEYS];
+    unsigned char data[BATCH_KEYS][4];
+    key_store_value values[BATCH_KEYS];
+    int results[BATCH_KEYS];
+    for (int i = 0; i < BATCH_KEYS; ++i) {
+        snprintf(key_storage[i], sizeof(key_storage[i]), "batch%d", i);
+        keys[i] = key_storage[i];
+        memcpy(data[i], &i, sizeof(int));
+        values[i] = (key_store_value){ data[i], sizeof(data[i]) };
+    }
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); ++c) {
+        key_store *store = NULL;
+        TEST_ASSERT_EQUAL(0, create_key_store(configs[c], &store));
+
+        // The batch spans several groups and grows the table while it is stored
+        TEST_ASSERT_EQUAL(0, store_set_keys(store, keys, BATCH_KEYS, values, results));
+        for (int i = 0; i < BATCH_KEYS; ++i) TEST_ASSERT_EQUAL(0, results[i]);
+        keystore_stats stats = store_get_keystore_stats(store);
+        TEST_ASSERT_EQUAL_UINT(BATCH_KEYS, stats.key_entries.total_keys);
+
+        key_store_value out[BATCH_KEYS] = {0};
+        TEST_ASSERT_EQUAL(0, store_get_keys(store, keys, BATCH_KEYS, out, results));
+        for (int i = 0; i < BATCH_KEYS; ++i) {
+            TEST_ASSERT_EQUAL(0, results[i]);
+            TEST_ASSERT_EQUAL_size_t(sizeof(data[i]), out[i].data_size);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(data[i], out[i].data, sizeof(data[i]));
+            free_key_store_value(&out[i]);
+        }
+
+        // Batches agree with the single-key API, a repeated key keeps its last value
+        const char *mixed_keys[] = { "batch3", "missing", "batch5", NULL, "batch3" };
+        unsigned char first[] = "first", last[] = "last";
+        key_store_value mixed_values[] = { { first, sizeof(first) }, { first, sizeof(first) }, { first, sizeof(first) }, { first, sizeof(first) }, { last, sizeof(last) } };
+        int mixed_results[5];
+        TEST_ASSERT_EQUAL(-20, store_set_keys(store, mixed_keys, 5, mixed_values, mixed_results));
+        TEST_ASSERT_EQUAL(0, mixed_results[0]);
+        TEST_ASSERT_EQUAL(-20, mixed_results[3]);
+        key_store_value single = {0};
+        TEST_ASSERT_EQUAL(0, store_get_key(store, "batch3", &single));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(last, single.data, sizeof(last));
+        free_key_store_value(&single);
+        TEST_ASSERT_EQUAL(0, store_delete_key(store, "missing"));
+
+        key_store_value mixed_out[5] = {0};
+        TEST_ASSERT_EQUAL(-41, store_get_keys(store, mixed_keys, 5, mixed_out, mixed_results));
+        TEST_ASSERT_EQUAL(0, mixed_results[0]);
+        TEST_ASSERT_EQUAL(-41, mixed_results[1]);
+        TEST_ASSERT_EQUAL(0, mixed_results[2]);
+        TEST_ASSERT_EQUAL(-20, mixed_results[3]);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(last, mixed_out[0].data, sizeof(last));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(first, mixed_out[2].data, sizeof(first));
+        for (int i = 0; i < 5; ++i) free_key_store_value(&mixed_out[i]);
+
+        key_store_prepared_key prepared[BATCH_KEYS];
+        for (int i = 0; i < BATCH_KEYS; ++i) TEST_ASSERT_EQUAL(0, store_prepare_key(store, keys[i], strlen(keys[i]), &prepared[i]));
+        TEST_ASSERT_EQUAL(0, store_set_prepared_keys(store, prepared, BATCH_KEYS, values, results));
+        TEST_ASSERT_EQUAL(0, store_get_prepared_keys(store, prepared, BATCH_KEYS, out, results));
+        for (int i = 0; i < BATCH_KEYS; ++i) {
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(data[i], out[i].data, sizeof(data[i]));
+            free_key_store_value(&out[i]);
+        }
+
+        TEST_ASSERT_EQUAL(0, store_get_keys(store, keys, 0, out, results));
+        TEST_ASSERT_EQUAL(-20, store_get_keys(store, NULL, 1, out, results));
+        TEST_ASSERT_EQUAL(-20, store_set_keys(store, keys, 1, values, NULL));
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+
+    TEST_ASSERT_EQUAL(0, initialise_key_store(8, 0.5, false));
+    TEST_ASSERT_EQUAL(0, set_keys(keys, 20, values, results));
+    key_store_value out[20] = {0};
+    TEST_ASSERT_EQUAL(0, get_keys(keys, 20, out, results));
+    for (int i = 0; i < 20; ++i) free_key_store_value(&out[i]);
+    key_store_prepared_key prepared[2];
+    TEST_ASSERT_EQUAL(0, prepare_key("batch0", 6, &prepared[0]));
+    TEST_ASSERT_EQUAL(0, prepare_key("batch1", 6, &prepared[1]));
+    TEST_ASSERT_EQUAL(0, set_prepared_keys(prepared, 2, values, results));
+    TEST_ASSERT_EQUAL(0, get_prepared_keys(prepared, 2, out, results));
+    for (int i = 0; i < 2; ++i) free_key_store_value(&out[i]);
+    cleanup_key_store();
+}
+
+static key_store *g_rmw_store = NULL;
+
+// Doubles every byte of the value, or aborts with the int pointed to by context if it is non-zero
+static int _double_bytes(const unsigned char *data, size_t data_size, uint32_t version, key_store_value *new_value_out, void *context) {
+    (void)version;
+    static unsigned char doubled[16];
+    if (*(int *)context != 0) return *(int *)context;
+    if (data == NULL || data_size > sizeof(doubled)) return -41;
+    for (size_t i = 0; i < data_size; ++i) doubled[i] = (unsigned char)(data[i] * 2);
+    *new_value_out = (key_store_value){ doubled, data_size };
+    return 0;
+}
+
+static void* _rmw_increment_worker(void *arg) {
+    (void)arg;
+    for (int i = 0; i < 1000; ++i) store_incr_key(g_rmw_store, "shared_counter", 1, NULL);
+    return NULL;
+}
+
+void test_read_modify_write_operations(void) {
+    key_store_config configs[] = {
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .grow_load_factor = 1.0, .treeify_threshold = 4 },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 4, .shard_count = 2, .inline_value_threshold = 8 },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 4, .is_lock_free_read_enabled = true },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .grow_load_factor = 1.0, .treeify_threshold = 4, .node_sync = KEY_STORE_NODE_SYNC_SEQLOCK },
+        { .bucket_size = 16, .pre_memory_allocation_factor = 0.5, .is_concurrency_enabled = true, .engine = KEY_STORE_ENGINE_SWISS, .node_sync = KEY_STORE_NODE_SYNC_SEQLOCK },
+    };
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); ++c) {
+        key_store *store = NULL;
+        TEST_ASSERT_EQUAL(0, create_key_store(configs[c], &store));
+
+        // Counters are created on first use and stay int64_t values
+        int64_t counter = 0;
+        TEST_ASSERT_EQUAL(0, store_incr_key(store, "counter", 5, &counter));
+        TEST_ASSERT_EQUAL_INT64(5, counter);
+        TEST_ASSERT_EQUAL(0, store_incr_key(store, "counter", -2, &counter));
+        TEST_ASSERT_EQUAL_INT64(3, counter);
+        TEST_ASSERT_EQUAL(0, store_decr_key(store, "counter", 10, &counter));
+        TEST_ASSERT_EQUAL_INT64(-7, counter);
+        TEST_ASSERT_EQUAL(0, store_decr_key(store, "counter", INT64_MIN, NULL));
+        key_store_value stored = {0};
+        TEST_ASSERT_EQUAL(0, store_get_key(store, "counter", &stored));
+        TEST_ASSERT_EQUAL_size_t(sizeof(int64_t), stored.data_size);
+        memcpy(&counter, stored.data, sizeof(counter));
+        TEST_ASSERT_EQUAL_INT64((int64_t)((uint64_t)-7 - (uint64_t)INT64_MIN), counter);
+        free_key_store_value(&stored);
+
+        unsigned char text[] = "abc";
+        key_store_value text_value = { text, 3 };
+        TEST_ASSERT_EQUAL(0, store_set_key(store, "text", &text_value));
+        TEST_ASSERT_EQUAL(-23, store_incr_key(store, "text", 1, NULL));
+
+        // Append and prepend grow the value, whether it stays inline, moves out of line or replaces a seqlock node
+        unsigned char suffix[] = "defghijk", prefix[] = "<";
+        key_store_value suffix_value = { suffix, 8 }, prefix_value = { prefix, 1 };
+        TEST_ASSERT_EQUAL(0, store_append_key(store, "text", &suffix_value));
+        TEST_ASSERT_EQUAL(0, store_prepend_key(store, "text", &prefix_value));
+        TEST_ASSERT_EQUAL(0, store_get_key(store, "text", &stored));
+        TEST_ASSERT_EQUAL_size_t(12, stored.data_size);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY("<abcdefghijk", stored.data, 12);
+        free_key_store_value(&stored);
+        TEST_ASSERT_EQUAL(-41, store_append_key(store, "missing", &suffix_value));
+        TEST_ASSERT_EQUAL(-41, store_exists_key(store, "missing"));
+        TEST_ASSERT_EQUAL(-20, store_append_key(store, "text", NULL));
+
+        // Compare-and-swap on the value bytes
+        unsigned char swapped[] = "swapped";
+        key_store_value swapped_value = { swapped, sizeof(swapped) };
+        TEST_ASSERT_EQUAL(-49, store_compare_and_swap_key(store, "text", &text_value, &swapped_value));
+        key_store_value expected = { (unsigned char *)"<abcdefghijk", 12 };
+        TEST_ASSERT_EQUAL(0, store_compare_and_swap_key(store, "text", &expected, &swapped_value));
+        TEST_ASSERT_EQUAL(-49, store_compare_and_swap_key(store, "text", &expected, &swapped_value));
+        TEST_ASSERT_EQUAL(-41, store_compare_and_swap_key(store, "missing", &expected, &swapped_value));
+
+        // Versions start at 1 and grow with every update, whatever path stored the value
+        uint32_t version = 0, new_version = 0;
+        TEST_ASSERT_EQUAL(0, store_set_key(store, "versioned", &text_value));
+        TEST_ASSERT_EQUAL(0, store_get_key_versioned(store, "versioned", NULL, &version));
+        TEST_ASSERT_EQUAL_UINT32(1, version);
+        TEST_ASSERT_EQUAL(0, store_set_key(store, "versioned", &swapped_value));
+        TEST_ASSERT_EQUAL(0, store_append_key(store, "versioned", &suffix_value));
+        keystore_stats before = store_get_keystore_stats(store);
+        TEST_ASSERT_EQUAL(0, store_get_key_versioned(store, "versioned", &stored, &version));
+        TEST_ASSERT_EQUAL_UINT32(3, version);
+        TEST_ASSERT_EQUAL_size_t(sizeof(swapped) + 8, stored.data_size);
+        free_key_store_value(&stored);
+
+        // Reading the version is a read, it does not update the node
+        keystore_stats after = store_get_keystore_stats(store);
+#if OPERATION_COUNTERS_ENABLED
+        TEST_ASSERT_EQUAL_UINT(before.data_node_counters.total_update_ops, after.data_node_counters.total_update_ops);
+        TEST_ASSERT_EQUAL_UINT(before.data_node_counters.total_read_ops + 1, after.data_node_counters.total_read_ops);
+#endif
+
+        TEST_ASSERT_EQUAL(-49, store_compare_version_and_set_key(store, "versioned", version - 1, &text_value, &new_version));
+        TEST_ASSERT_EQUAL(0, store_compare_version_and_set_key(store, "versioned", version, &text_value, &new_version));
+        TEST_ASSERT_EQUAL_UINT32(version + 1, new_version);
+        TEST_ASSERT_EQUAL(-49, store_compare_version_and_set_key(store, "versioned", 0, &text_value, NULL));
+        TEST_ASSERT_EQUAL(-41, store_compare_version_and_set_key(store, "created", 1, &text_value, NULL));
+        TEST_ASSERT_EQUAL(0, store_compare_version_and_set_key(store, "created", 0, &text_value, &new_version));
+        TEST_ASSERT_EQUAL_UINT32(1, new_version);
+        TEST_ASSERT_EQUAL(0, store_delete_key(store, "created"));
+        TEST_ASSERT_EQUAL(-41, store_get_key_versioned(store, "created", NULL, &version));
+
+        // Generic callbacks may keep the value, replace it or abort with their own result
+        int abort_result = 0;
+        TEST_ASSERT_EQUAL(0, store_update_key_with(store, "versioned", _double_bytes, &abort_result));
+        TEST_ASSERT_EQUAL(0, store_get_key(store, "versioned", &stored));
+        TEST_ASSERT_EQUAL_UINT8('a' * 2 % 256, stored.data[0]);
+        free_key_store_value(&stored);
+        abort_result = 7;
+        TEST_ASSERT_EQUAL(7, store_update_key_with_n(store, "versioned", 9, _double_bytes, &abort_result));
+        TEST_ASSERT_EQUAL(-20, store_update_key_with(store, "versioned", NULL, NULL));
+
+        keystore_stats stats = store_get_keystore_stats(store);
+        TEST_ASSERT_EQUAL_UINT(3, stats.key_entries.total_keys);
+
+        // Concurrent increments are never lost
+        if (configs[c].is_concurrency_enabled) {
+            g_rmw_store = store;
+            pthread_t threads[4];
+            for (int i = 0; i < 4; ++i) pthread_create(&threads[i], NULL, _rmw_increment_worker, NULL);
+            for (int i = 0; i < 4; ++i) pthread_join(threads[i], NULL);
+            TEST_ASSERT_EQUAL(0, store_incr_key(store, "shared_counter", 0, &counter));
+            TEST_ASSERT_EQUAL_INT64(4000, counter);
+        }
+
+        TEST_ASSERT_EQUAL(0, destroy_key_store(store));
+    }
+
+    TEST_ASSERT_EQUAL(0, initialise_key_store(8, 0.5, false));
+    int64_t counter = 0;
+    TEST_ASSERT_EQUAL(0, incr_key("hits", 2, &counter));
+    TEST_ASSERT_EQUAL(0, decr_key("hits", 1, &counter));
+    TEST_ASSERT_EQUAL_INT64(1, counter);
+    unsigned char part[] = "xy";
+    key_store_value part_value = { part, 2 };
+    TEST_ASSERT_EQUAL(0, set_key("global", &part_value));
+    TEST_ASSERT_EQUAL(0, append_key("global", &part_value));
+    TEST_ASSERT_EQUAL(0, prepend_key("global", &part_value));
+    key_store_value expected = { (unsigned char *)"xyxyxy", 6 };
+    TEST_ASSERT_EQUAL(0, compare_and_swap_key("global", &expected, &part_value));
+    uint32_t version = 0;
+    TEST_ASSERT_EQUAL(0, get_key_versioned("global", NULL, &version));
+    TEST_ASSERT_EQUAL_UINT32(4, version);
+    TEST_ASSERT_EQUAL(0, compare_version_and_set_key("global", version, &part_value, NULL));
+    int abort_result = 0;
+    TEST_ASSERT_EQUAL(0, update_key_with("global", _double_bytes, &abort_result));
+    TEST_ASSERT_EQUAL(0, update_key_with_n("global", 6, _double_bytes, &abort_result));
+    key_store_prepared_key prepared;
+    TEST_ASSERT_EQUAL(0, prepare_key("global", 6, &prepared));
+    TEST_ASSERT_EQUAL(0, update_prepared_key_with(&prepared, _double_bytes, &abort_result));
+    key_store_value stored = {0};
+    TEST_ASSERT_EQUAL(0, get_key("global", &stored));
+    TEST_ASSERT_EQUAL_UINT8((unsigned char)('x' * 8), stored.data[0]);
+    free_key_store_value(&stored);
+    cleanup_key_store();
+}
+
 int test_key_store_suite(void) {
     printf("Running key_store tests...\n");
     RUN_TEST(test_set_binary_data);
@@ -266,6 +1288,29 @@ int test_key_store_suite(void) {
     RUN_TEST(test_many_keys);
     RUN_TEST(test_null_and_zero_data);
     RUN_TEST(test_set_get_multiple_keys);
+    RUN_TEST(test_initialise_key_store_with_config);
+    RUN_TEST(test_table_grows_with_keys);
+    RUN_TEST(test_lock_free_read_requires_concurrency);
+    RUN_TEST(test_lock_free_read_set_get_delete);
+    RUN_TEST(test_lock_free_reads_with_concurrent_writers);
+    RUN_TEST(test_swiss_engine_set_get_delete);
+    RUN_TEST(test_swiss_engine_invalid_config);
+    RUN_TEST(test_key_store_instances_are_independent);
+    RUN_TEST(test_key_store_instances_invalid_arguments);
+    RUN_TEST(test_key_store_instances_on_separate_threads);
+    RUN_TEST(test_sharded_key_store_set_get_delete);
+    RUN_TEST(test_sharded_key_store_invalid_config);
+    RUN_TEST(test_thread_affinity_partitions_keys_by_thread);
+    RUN_TEST(test_stats_report_slab_class_occupancy);
+    RUN_TEST(test_inline_values_switch_representation);
+    RUN_TEST(test_seqlock_node_sync);
+    RUN_TEST(test_seqlock_nodes_use_less_memory);
+    RUN_TEST(test_binary_keys);
+    RUN_TEST(test_prepared_keys);
+    RUN_TEST(test_key_views);
+    RUN_TEST(test_get_key_into_caller_buffer);
+    RUN_TEST(test_batched_get_and_set);
+    RUN_TEST(test_read_modify_write_operations);
     printf("Completed key_store tests.\n");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "unity.h"
+#include "core/latency_histogram.h"
+#include "core/key_store.h"
+#include "core/operation_counters.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define LATENCY_TEST_THREADS 4
+#define LATENCY_TEST_OPS 2000
+
+static key_store *g_latency_store = NULL;
+
+static void* _contend_on_one_key_worker(void *arg) {
+    (void)arg;
+    unsigned char data[] = "contended";
+    key_store_value value = { data, sizeof(data) };
+    for (int i = 0; i < LATENCY_TEST_OPS; ++i) store_set_key(g_latency_store, "hot", &value);
+    return NULL;
+}
+
+void test_latency_buckets_bound_the_error(void) {
+    TEST_ASSERT_EQUAL_UINT(0, get_latency_bucket_index(0));
+    TEST_ASSERT_EQUAL_UINT(15, get_latency_bucket_index(15));
+    TEST_ASSERT_EQUAL_UINT(LATENCY_HISTOGRAM_BUCKET_COUNT - 1, get_latency_bucket_index(~0ULL));
+
+    unsigned int previous_index = 0;
+    for (unsigned long long latency_ns = 1; latency_ns < (1ULL << 34); latency_ns = latency_ns * 3 / 2 + 1) {
+        unsigned int index = get_latency_bucket_index(latency_ns);
+        unsigned long long upper_bound = get_latency_bucket_upper_bound(index);
+        TEST_ASSERT_TRUE(index < LATENCY_HISTOGRAM_BUCKET_COUNT);
+        TEST_ASSERT_TRUE(index >= previous_index);
+        TEST_ASSERT_TRUE(upper_bound >= latency_ns);
+        TEST_ASSERT_TRUE(upper_bound - latency_ns <= latency_ns / 16);
+        if (index > 0) TEST_ASSERT_TRUE(get_latency_bucket_upper_bound(index - 1) < latency_ns);
+        previous_index = index;
+    }
+}
+
+void test_latency_percentiles_from_known_samples(void) {
+#if !OPERATION_COUNTERS_ENABLED
+    TEST_IGNORE_MESSAGE("Latencies are not recorded without operation counters");
+#endif
+    sharded_latency_histograms *histograms = calloc(1, sizeof(sharded_latency_histograms));
+    TEST_ASSERT_NOT_NULL(histograms);
+
+    // 1000 samples of 1..1000 us: p50 = 500 us, p90 = 900 us, p99 = 990 us, p99.9 = 999 us
+    for (unsigned long long i = 1; i <= 1000; ++i) record_latency(histograms, KEY_STORE_LATENCY_GET, i * 1000);
+    record_latency(histograms, KEY_STORE_LATENCY_SET, 7);
+
+    operation_latency_stats stats;
+    summarize_latency_histograms(histograms, &stats);
+    TEST_ASSERT_EQUAL_UINT(1000, stats.get.sample_count);
+    TEST_ASSERT_TRUE(stats.get.mean_ns == 500500.0);
+    TEST_ASSERT_EQUAL_UINT64(1000000, stats.get.max_ns);
+    TEST_ASSERT_UINT64_WITHIN(500000 / 16, 500000, stats.get.p50_ns);
+    TEST_ASSERT_UINT64_WITHIN(900000 / 16, 900000, stats.get.p90_ns);
+    TEST_ASSERT_UINT64_WITHIN(990000 / 16, 990000, stats.get.p99_ns);
+    TEST_ASSERT_UINT64_WITHIN(999000 / 16, 999000, stats.get.p999_ns);
+    TEST_ASSERT_TRUE(stats.get.p999_ns <= stats.get.max_ns);
+
+    // Small latencies are exact
+    TEST_ASSERT_EQUAL_UINT(1, stats.set.sample_count);
+    TEST_ASSERT_EQUAL_UINT64(7, stats.set.p50_ns);
+    TEST_ASSERT_EQUAL_UINT64(7, stats.set.p999_ns);
+    TEST_ASSERT_EQUAL_UINT(0, stats.remove.sample_count);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.remove.p99_ns);
+
+    summarize_latency_histograms(NULL, &stats);
+    TEST_ASSERT_EQUAL_UINT(0, stats.get.sample_count);
+    record_latency(NULL, KEY_STORE_LATENCY_GET, 1); // Ignored
+    free(histograms);
+}
+
+void test_store_stats_report_operation_latencies(void) {
+    key_store_config config = { .bucket_size = 64, .pre_memory_allocation_factor = 1, .is_concurrency_enabled = true };
+    TEST_ASSERT_EQUAL(0, create_key_store(config, &g_latency_store));
+
+    unsigned char data[] = "timed";
+    key_store_value value = { data, sizeof(data) };
+    key_store_value value_out = {0};
+    TEST_ASSERT_EQUAL(0, store_set_key(g_latency_store, "a", &value));
+    TEST_ASSERT_EQUAL(0, store_set_key(g_latency_store, "b", &value));
+    TEST_ASSERT_EQUAL(0, store_get_key(g_latency_store, "a", &value_out));
+    free(value_out.data);
+    TEST_ASSERT_EQUAL(-41, store_get_key(g_latency_store, "missing", &value_out));
+    TEST_ASSERT_EQUAL(0, store_delete_key(g_latency_store, "b"));
+
+    pthread_t threads[LATENCY_TEST_THREADS];
+    for (int i = 0; i < LATENCY_TEST_THREADS; ++i) pthread_create(&threads[i], NULL, _contend_on_one_key_worker, NULL);
+    for (int i = 0; i < LATENCY_TEST_THREADS; ++i) pthread_join(threads[i], NULL);
+
+    keystore_stats stats = store_get_keystore_stats(g_latency_store);
+#if OPERATION_COUNTERS_ENABLED
+    TEST_ASSERT_EQUAL_UINT(2 + LATENCY_TEST_THREADS * LATENCY_TEST_OPS, stats.latency.set.sample_count);
+    TEST_ASSERT_EQUAL_UINT(2, stats.latency.get.sample_count); // Misses are timed too
+    TEST_ASSERT_EQUAL_UINT(1, stats.latency.remove.sample_count);
+    TEST_ASSERT_TRUE(stats.latency.set.max_ns > 0);
+    TEST_ASSERT_TRUE(stats.latency.set.p50_ns <= stats.latency.set.p99_ns);
+    TEST_ASSERT_TRUE(stats.latency.set.p99_ns <= stats.latency.set.max_ns);
+
+    // Every bucket lock acquisition is recorded, uncontended ones as 0 ns waits
+    TEST_ASSERT_TRUE(stats.latency.lock_wait.sample_count >= 5 + LATENCY_TEST_THREADS * LATENCY_TEST_OPS);
+#endif
+
+    TEST_ASSERT_EQUAL(0, destroy_key_store(g_latency_store));
+    g_latency_store = NULL;
+}
+
+int test_latency_histogram_suite(void) {
+    printf("Running latency_histogram tests...\n");
+    RUN_TEST(test_latency_buckets_bound_the_error);
+    RUN_TEST(test_latency_percentiles_from_known_samples);
+    RUN_TEST(test_store_stats_report_operation_latencies);
+    printf("Completed latency_histogram tests.\n");
+    return 0;
+}
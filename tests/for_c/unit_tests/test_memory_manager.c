@@ -2,124 +2,363 @@
 #include "utils/memory_manager.h"
 #include <stdlib.h>
 #include <stdbool.h>
+#include <pthread.h>
 
 void test_initialize_memory_manager_valid_config(void) {
-    memory_manager_config config = { .bucket_size = 10, .pre_allocation_factor = 0.5, .allocate_list_pool = true, .allocate_tree_pool = false, .is_concurrency_enabled = false };
-    TEST_ASSERT_EQUAL(0, initialize_memory_manager(config));
-    TEST_ASSERT_EQUAL(0, cleanup_memory_manager());
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 10, .pre_allocation_factor = 0.5, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
 }
 
 void test_initialize_memory_manager_invalid_config(void) {
-    memory_manager_config config1 = { .bucket_size = 0, .pre_allocation_factor = 0.5, .allocate_list_pool = true, .allocate_tree_pool = false, .is_concurrency_enabled = false };
-    TEST_ASSERT_EQUAL(-21, initialize_memory_manager(config1));
-    memory_manager_config config2 = { .bucket_size = 10, .pre_allocation_factor = 0.0, .allocate_list_pool = true, .allocate_tree_pool = false, .is_concurrency_enabled = false };
-    TEST_ASSERT_EQUAL(-21, initialize_memory_manager(config2));
-    memory_manager_config config3 = { .bucket_size = 10, .pre_allocation_factor = 1.5, .allocate_list_pool = true, .allocate_tree_pool = false, .is_concurrency_enabled = false };
-    TEST_ASSERT_EQUAL(-21, initialize_memory_manager(config3));
+    memory_manager manager = {0};
+    memory_manager_config config1 = { .bucket_size = 0, .pre_allocation_factor = 0.5, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL(-21, initialize_memory_manager(&manager, config1));
+    memory_manager_config config2 = { .bucket_size = 10, .pre_allocation_factor = 0.0, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL(-21, initialize_memory_manager(&manager, config2));
+    memory_manager_config config3 = { .bucket_size = 10, .pre_allocation_factor = 1.5, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL(-21, initialize_memory_manager(&manager, config3));
 }
 
-void test_allocate_and_free_from_list_pool(void) {
-    memory_manager_config config = { .bucket_size = 5, .pre_allocation_factor = 1.0, .allocate_list_pool = true, .allocate_tree_pool = false, .is_concurrency_enabled = false };
-    int result = initialize_memory_manager(config);
+void test_allocate_and_free_beyond_initial_chunk(void) {
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 5, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    int result = initialize_memory_manager(&manager, config);
     TEST_ASSERT_EQUAL_MESSAGE(0, result, "Failed to initialize memory manager");
     void *ptrs[5];
     for(int i = 0; i < 5; ++i) {
-        ptrs[i] = allocate_memory_from_pool(LIST_POOL);
-        TEST_ASSERT_NOT_NULL_MESSAGE(ptrs[i], "Failed to allocate memory from list pool");
+        ptrs[i] = allocate_memory_from_pool(&manager, TREE_POOL);
+        TEST_ASSERT_NOT_NULL_MESSAGE(ptrs[i], "Failed to allocate memory from pool");
     }
 
-    // Pool exhausted, should fallback to malloc
-    void *extra = allocate_memory_from_pool(LIST_POOL);
-    TEST_ASSERT_NOT_NULL_MESSAGE(extra, "Failed to allocate extra memory from list pool");
+    // Pool exhausted, should grow by another chunk
+    void *extra = allocate_memory_from_pool(&manager, TREE_POOL);
+    TEST_ASSERT_NOT_NULL_MESSAGE(extra, "Failed to allocate extra memory from a new chunk");
+    TEST_ASSERT_EQUAL(2, manager.tree_pool.chunk_count);
+    TEST_ASSERT_EQUAL(10, manager.tree_pool.total_blocks);
     // Free all pool pointers
     for(int i = 0; i < 5; ++i) {
-        free_memory(ptrs[i], LIST_POOL);
+        free_memory(&manager, ptrs[i], TREE_POOL);
     }
-    // Free malloc fallback
-    free_memory(extra, LIST_POOL);
-    result = cleanup_memory_manager();
+    // Blocks of the new chunk are recycled too
+    free_memory(&manager, extra, TREE_POOL);
+    TEST_ASSERT_EQUAL(6, manager.tree_pool.reusable_blocks);
+    result = cleanup_memory_manager(&manager);
     TEST_ASSERT_EQUAL_MESSAGE(0, result, "Failed to cleanup memory manager");
 }
 
 void test_allocate_and_free_from_tree_pool(void) {
-    memory_manager_config config = { .bucket_size = 3, .pre_allocation_factor = 1.0, .allocate_list_pool = false, .allocate_tree_pool = true, .is_concurrency_enabled = false };
-    TEST_ASSERT_EQUAL_MESSAGE(0, initialize_memory_manager(config), "Failed to initialize memory manager");
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 3, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL_MESSAGE(0, initialize_memory_manager(&manager, config), "Failed to initialize memory manager");
     void *ptrs[3];
     for(int i = 0; i < 3; ++i) {
-        ptrs[i] = allocate_memory_from_pool(TREE_POOL);
+        ptrs[i] = allocate_memory_from_pool(&manager, TREE_POOL);
         TEST_ASSERT_NOT_NULL_MESSAGE(ptrs[i], "Failed to allocate memory from tree pool");
     }
-    void *extra = allocate_memory_from_pool(TREE_POOL);
+    void *extra = allocate_memory_from_pool(&manager, TREE_POOL);
     TEST_ASSERT_NOT_NULL_MESSAGE(extra, "Failed to allocate extra memory from tree pool");
     for(int i = 0; i < 3; ++i) {
-        free_memory(ptrs[i], TREE_POOL);
+        free_memory(&manager, ptrs[i], TREE_POOL);
     }
-    free_memory(extra, TREE_POOL);
-    TEST_ASSERT_EQUAL_MESSAGE(0, cleanup_memory_manager(), "Failed to cleanup memory manager");
+    free_memory(&manager, extra, TREE_POOL);
+    TEST_ASSERT_EQUAL_MESSAGE(0, cleanup_memory_manager(&manager), "Failed to cleanup memory manager");
 }
 
 void test_free_invalid_pointer(void) {
-    memory_manager_config config = { .bucket_size = 2, .pre_allocation_factor = 1.0, .allocate_list_pool = true, .allocate_tree_pool = false, .is_concurrency_enabled = false };
-    TEST_ASSERT_EQUAL(0, initialize_memory_manager(config));
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 2, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
     int *invalid_ptr = malloc(sizeof(int));
     // Should fallback to standard free
-    free_memory(invalid_ptr, LIST_POOL);
-    TEST_ASSERT_EQUAL(0, cleanup_memory_manager());
+    free_memory(&manager, invalid_ptr, TREE_POOL);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
 }
 
 void test_double_free(void) {
-    memory_manager_config config = { .bucket_size = 2, .pre_allocation_factor = 1.0, .allocate_list_pool = true, .allocate_tree_pool = false, .is_concurrency_enabled = false };
-    TEST_ASSERT_EQUAL(0, initialize_memory_manager(config));
-    void *ptr = allocate_memory_from_pool(LIST_POOL);
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 2, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+    void *ptr = allocate_memory_from_pool(&manager, TREE_POOL);
     TEST_ASSERT_NOT_NULL(ptr);
-    free_memory(ptr, LIST_POOL);
+    free_memory(&manager, ptr, TREE_POOL);
     // Double free: should fallback to standard free or handle gracefully
-    free_memory(ptr, LIST_POOL);
-    TEST_ASSERT_EQUAL(0, cleanup_memory_manager());
+    free_memory(&manager, ptr, TREE_POOL);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
 }
 
 void test_allocate_memory_heap(void) {
     void *ptr = allocate_memory(128);
     TEST_ASSERT_NOT_NULL(ptr);
-    free_memory(ptr, NO_POOL);
+    free_memory(NULL, ptr, NO_POOL);
 }
 
 void test_initialize_memory_manager_both_pools(void) {
-    memory_manager_config config = { .bucket_size = 4, .pre_allocation_factor = 1.0, .allocate_list_pool = true, .allocate_tree_pool = true, .is_concurrency_enabled = false };
-    TEST_ASSERT_EQUAL(0, initialize_memory_manager(config));
-    void *list_ptr = allocate_memory_from_pool(LIST_POOL);
-    void *tree_ptr = allocate_memory_from_pool(TREE_POOL);
-    TEST_ASSERT_NOT_NULL(list_ptr);
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 4, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = false, .allocate_slab_pools = true };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+    void *slab_ptr = allocate_memory_from_slab(&manager, 24);
+    void *tree_ptr = allocate_memory_from_pool(&manager, TREE_POOL);
+    TEST_ASSERT_NOT_NULL(slab_ptr);
     TEST_ASSERT_NOT_NULL(tree_ptr);
-    free_memory(list_ptr, LIST_POOL);
-    free_memory(tree_ptr, TREE_POOL);
-    TEST_ASSERT_EQUAL(0, cleanup_memory_manager());
+    free_memory_to_slab(&manager, slab_ptr, 24);
+    free_memory(&manager, tree_ptr, TREE_POOL);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
 }
 
 void test_cleanup_without_initialization(void) {
+    memory_manager manager = {0};
     // Should handle cleanup gracefully even if not initialized
-    TEST_ASSERT_EQUAL(0, cleanup_memory_manager());
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
 }
 
 void test_allocate_memory_from_uninitialized_pool(void) {
+    memory_manager manager = {0};
     // Try to allocate from pool before initialization
-    void *ptr = allocate_memory_from_pool(LIST_POOL);
+    void *ptr = allocate_memory_from_pool(&manager, TREE_POOL);
     TEST_ASSERT_NULL(ptr);
 }
 
 void test_free_null_pointer(void) {
-    memory_manager_config config = { .bucket_size = 2, .pre_allocation_factor = 1.0, .allocate_list_pool = true, .allocate_tree_pool = false, .is_concurrency_enabled = false };
-    TEST_ASSERT_EQUAL(0, initialize_memory_manager(config));
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 2, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
     // Should handle NULL pointer gracefully
-    free_memory(NULL, LIST_POOL);
-    TEST_ASSERT_EQUAL(0, cleanup_memory_manager());
+    free_memory(&manager, NULL, TREE_POOL);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+void test_memory_managers_are_independent(void) {
+    memory_manager first = {0};
+    memory_manager second = {0};
+    memory_manager_config config = { .bucket_size = 1, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&first, config));
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&second, config));
+
+    void *first_ptr = allocate_memory_from_pool(&first, TREE_POOL);
+    void *second_ptr = allocate_memory_from_pool(&second, TREE_POOL);
+    TEST_ASSERT_NOT_NULL(first_ptr);
+    TEST_ASSERT_NOT_NULL(second_ptr);
+    TEST_ASSERT_TRUE(first_ptr != second_ptr);
+
+    // Each manager hands out blocks from its own pool only
+    free_memory(&first, first_ptr, TREE_POOL);
+    TEST_ASSERT_EQUAL_PTR(first_ptr, allocate_memory_from_pool(&first, TREE_POOL));
+    free_memory(&first, first_ptr, TREE_POOL);
+    free_memory(&second, second_ptr, TREE_POOL);
+
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&first));
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&second));
+    TEST_ASSERT_EQUAL(-20, initialize_memory_manager(NULL, config));
+    TEST_ASSERT_NULL(allocate_memory_from_pool(NULL, TREE_POOL));
+}
+
+void test_concurrent_pool_reuses_blocks_from_thread_magazine(void) {
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 64, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = true };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+
+    void *ptr = allocate_memory_from_pool(&manager, TREE_POOL);
+    TEST_ASSERT_NOT_NULL(ptr);
+    memory_pool_usage usage = {0};
+    TEST_ASSERT_EQUAL(0, get_memory_manager_usage(&manager, &usage));
+    TEST_ASSERT_EQUAL_size_t(manager.tree_pool.block_size, usage.used_bytes);
+    TEST_ASSERT_EQUAL_size_t(64 * manager.tree_pool.block_size, usage.total_bytes);
+
+    // The first allocation refilled the magazine with a batch, the rest of it is cached
+    TEST_ASSERT_EQUAL_size_t((MEMORY_MAGAZINE_BATCH - 1) * manager.tree_pool.block_size, usage.cached_bytes);
+    TEST_ASSERT_EQUAL(64 - MEMORY_MAGAZINE_BATCH, manager.tree_pool.available_blocks);
+
+    free_memory(&manager, ptr, TREE_POOL);
+    TEST_ASSERT_EQUAL_PTR(ptr, allocate_memory_from_pool(&manager, TREE_POOL)); // Served from the magazine
+    free_memory(&manager, ptr, TREE_POOL);
+
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(0, usage.used_bytes);
+    TEST_ASSERT_EQUAL(-20, get_memory_manager_usage(NULL, &usage));
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+static void* _magazine_worker(void *arg) {
+    memory_manager *manager = arg;
+    void *ptrs[100];
+    for (int round = 0; round < 50; ++round) {
+        for (int i = 0; i < 100; ++i) ptrs[i] = allocate_memory_from_pool(manager, TREE_POOL);
+        for (int i = 0; i < 100; ++i) free_memory(manager, ptrs[i], TREE_POOL);
+    }
+    return NULL;
+}
+
+void test_thread_magazines_are_returned_on_exit(void) {
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 1024, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = true };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+
+    pthread_t threads[4];
+    for (int i = 0; i < 4; ++i) pthread_create(&threads[i], NULL, _magazine_worker, &manager);
+    for (int i = 0; i < 4; ++i) pthread_join(threads[i], NULL);
+
+    // Every block was freed and the exited threads gave their cached blocks back
+    memory_pool_usage usage = {0};
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(0, usage.used_bytes);
+    TEST_ASSERT_EQUAL_size_t(0, usage.cached_bytes);
+    TEST_ASSERT_EQUAL(1024, manager.tree_pool.available_blocks + manager.tree_pool.reusable_blocks);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+void test_thread_magazine_is_detached_on_cleanup(void) {
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 32, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = true };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+    free_memory(&manager, allocate_memory_from_pool(&manager, TREE_POOL), TREE_POOL);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+
+    // The same manager re-created at the same address must not see blocks of the released pool
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+    char *ptr = allocate_memory_from_pool(&manager, TREE_POOL);
+    memory_pool_chunk *chunk = atomic_load(&manager.tree_pool.chunks);
+    TEST_ASSERT_TRUE(ptr >= chunk->start_ptr && ptr < chunk->end_ptr);
+    free_memory(&manager, ptr, TREE_POOL);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+void test_alternating_managers_keep_their_thread_magazines(void) {
+    memory_manager managers[4] = {0};
+    memory_manager_config config = { .bucket_size = 32, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .allocate_slab_pools = true, .is_concurrency_enabled = true };
+    for (int m = 0; m < 4; ++m) TEST_ASSERT_EQUAL(0, initialize_memory_manager(&managers[m], config));
+
+    // Every manager gives the thread its own magazines, so switching managers never hands a magazine back to a pool
+    void *ptrs[4];
+    for (int round = 0; round < 8; ++round) {
+        for (int m = 0; m < 4; ++m) ptrs[m] = allocate_memory_from_slab(&managers[m], 16);
+        for (int m = 0; m < 4; ++m) free_memory_to_slab(&managers[m], ptrs[m], 16);
+        for (int m = 0; m < 4; ++m) free_memory(&managers[m], allocate_memory_from_pool(&managers[m], TREE_POOL), TREE_POOL);
+    }
+
+    for (int m = 0; m < 4; ++m) {
+        memory_pool_usage usage = {0};
+        get_memory_manager_usage(&managers[m], &usage);
+        TEST_ASSERT_EQUAL_size_t(0, usage.used_bytes);
+        TEST_ASSERT_EQUAL_size_t(MEMORY_MAGAZINE_BATCH * (managers[m].slab_pools[0].block_size + managers[m].tree_pool.block_size), usage.cached_bytes);
+        // Only the first refill of each magazine touched its pool, nothing was flushed back to it
+        TEST_ASSERT_EQUAL(0, managers[m].slab_pools[0].reusable_blocks);
+        TEST_ASSERT_EQUAL(0, managers[m].tree_pool.reusable_blocks);
+    }
+
+    for (int m = 0; m < 4; ++m) TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&managers[m]));
+}
+
+void test_pool_grows_geometrically_and_recycles_every_block(void) {
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 4, .pre_allocation_factor = 1.0, .allocate_tree_pool = true, .is_concurrency_enabled = false };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+
+    static void *ptrs[5000];
+    for (int i = 0; i < 5000; ++i) {
+        ptrs[i] = allocate_memory_from_pool(&manager, TREE_POOL);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    TEST_ASSERT_TRUE(manager.tree_pool.total_blocks >= 5000);
+    TEST_ASSERT_TRUE(manager.tree_pool.chunk_count <= 12); // 4, 4, 8, 16, ... doubles up to 8192 blocks
+
+    for (int i = 0; i < 5000; ++i) free_memory(&manager, ptrs[i], TREE_POOL);
+    TEST_ASSERT_EQUAL(5000, manager.tree_pool.reusable_blocks);
+
+    // Reallocating the same number of blocks needs no further chunk
+    unsigned int chunk_count = manager.tree_pool.chunk_count;
+    for (int i = 0; i < 5000; ++i) ptrs[i] = allocate_memory_from_pool(&manager, TREE_POOL);
+    TEST_ASSERT_EQUAL(chunk_count, manager.tree_pool.chunk_count);
+
+    memory_pool_usage usage = {0};
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(5000 * manager.tree_pool.block_size, usage.used_bytes);
+    TEST_ASSERT_EQUAL_size_t((size_t)manager.tree_pool.total_blocks * manager.tree_pool.block_size, usage.total_bytes);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+static unsigned int _used_slab_blocks(memory_manager *manager_ptr, unsigned int class_index) {
+    memory_pool_usage usage = {0};
+    get_memory_manager_usage(manager_ptr, &usage);
+    return usage.slab_classes[class_index].used_blocks;
+}
+
+void test_slab_serves_sizes_from_smallest_fitting_class(void) {
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 4, .pre_allocation_factor = 1.0, .allocate_slab_pools = true };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+
+    size_t sizes[] = { 1, 16, 17, 24, 25, 100, 1537, 3072 };
+    unsigned int classes[] = { 0, 0, 1, 1, 2, 6, 14, 15 };
+    void *blocks[8];
+    for (int i = 0; i < 8; ++i) {
+        blocks[i] = allocate_memory_from_slab(&manager, sizes[i]);
+        TEST_ASSERT_NOT_NULL(blocks[i]);
+        memset(blocks[i], 0xAB, sizes[i]);
+    }
+    for (int i = 0; i < 8; ++i) TEST_ASSERT_TRUE(_used_slab_blocks(&manager, classes[i]) > 0);
+    TEST_ASSERT_EQUAL_UINT(2, _used_slab_blocks(&manager, 0));
+    TEST_ASSERT_EQUAL_UINT(2, _used_slab_blocks(&manager, 1));
+
+    // Sizes above the largest class come from the heap
+    void *large = allocate_memory_from_slab(&manager, MEMORY_SLAB_MAX_BLOCK_SIZE + 1);
+    TEST_ASSERT_NOT_NULL(large);
+    memory_pool_usage usage = {0};
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_size_t(128, usage.slab_classes[6].block_size);
+    TEST_ASSERT_EQUAL_size_t(16 + 16 + 24 + 24 + 32 + 128 + 2048 + 3072, usage.used_bytes);
+    free_memory_to_slab(&manager, large, MEMORY_SLAB_MAX_BLOCK_SIZE + 1);
+
+    for (int i = 0; i < 8; ++i) free_memory_to_slab(&manager, blocks[i], sizes[i]);
+    for (unsigned int i = 0; i < MEMORY_SLAB_CLASS_COUNT; ++i) TEST_ASSERT_EQUAL_UINT(0, _used_slab_blocks(&manager, i));
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+void test_slab_reallocation_keeps_contents(void) {
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 4, .pre_allocation_factor = 1.0, .allocate_slab_pools = true };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+
+    char *block = allocate_memory_from_slab(&manager, 20);
+    memcpy(block, "slab contents", 14);
+    TEST_ASSERT_EQUAL_PTR(block, reallocate_memory_from_slab(&manager, block, 20, 24)); // Same class, kept in place
+
+    char *grown = reallocate_memory_from_slab(&manager, block, 24, 5000); // Moves to the heap
+    TEST_ASSERT_NOT_NULL(grown);
+    TEST_ASSERT_EQUAL_STRING("slab contents", grown);
+    TEST_ASSERT_EQUAL_UINT(0, _used_slab_blocks(&manager, 1));
+
+    char *shrunk = reallocate_memory_from_slab(&manager, grown, 5000, 100);
+    TEST_ASSERT_EQUAL_STRING("slab contents", shrunk);
+    TEST_ASSERT_EQUAL_UINT(1, _used_slab_blocks(&manager, 6));
+    free_memory_to_slab(&manager, shrunk, 100);
+    TEST_ASSERT_EQUAL_UINT(0, _used_slab_blocks(&manager, 6));
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
+}
+
+void test_slab_without_slab_pools_uses_heap(void) {
+    memory_manager manager = {0};
+    memory_manager_config config = { .bucket_size = 4, .pre_allocation_factor = 1.0, .allocate_tree_pool = true };
+    TEST_ASSERT_EQUAL(0, initialize_memory_manager(&manager, config));
+
+    void *block = allocate_memory_from_slab(&manager, 32);
+    void *heap_block = allocate_memory_from_slab(NULL, 32);
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_NOT_NULL(heap_block);
+    memory_pool_usage usage = {0};
+    get_memory_manager_usage(&manager, &usage);
+    TEST_ASSERT_EQUAL_UINT(0, usage.slab_classes[2].total_blocks);
+    free_memory_to_slab(&manager, block, 32);
+    free_memory_to_slab(NULL, heap_block, 32);
+    TEST_ASSERT_EQUAL(0, cleanup_memory_manager(&manager));
 }
 
 int test_memory_manager_suite(void) {
     printf("Running Memory Manager Tests...\n");
     RUN_TEST(test_initialize_memory_manager_valid_config);
     RUN_TEST(test_initialize_memory_manager_invalid_config);
-    RUN_TEST(test_allocate_and_free_from_list_pool);
+    RUN_TEST(test_allocate_and_free_beyond_initial_chunk);
     RUN_TEST(test_allocate_and_free_from_tree_pool);
     RUN_TEST(test_free_invalid_pointer);
     RUN_TEST(test_double_free);
@@ -128,6 +367,15 @@ int test_memory_manager_suite(void) {
     RUN_TEST(test_cleanup_without_initialization);
     RUN_TEST(test_allocate_memory_from_uninitialized_pool);
     RUN_TEST(test_free_null_pointer);
+    RUN_TEST(test_memory_managers_are_independent);
+    RUN_TEST(test_concurrent_pool_reuses_blocks_from_thread_magazine);
+    RUN_TEST(test_thread_magazines_are_returned_on_exit);
+    RUN_TEST(test_thread_magazine_is_detached_on_cleanup);
+    RUN_TEST(test_alternating_managers_keep_their_thread_magazines);
+    RUN_TEST(test_pool_grows_geometrically_and_recycles_every_block);
+    RUN_TEST(test_slab_serves_sizes_from_smallest_fitting_class);
+    RUN_TEST(test_slab_reallocation_keeps_contents);
+    RUN_TEST(test_slab_without_slab_pools_uses_heap);
     printf("Memory manager tests completed.\n");
     return 0;
 }
@@ -0,0 +1,100 @@
+#include "unity.h"
+#include "core/operation_counters.h"
+#include "core/data_node.h"
+#include "core/key_store.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#define COUNTER_TEST_THREADS 8
+#define COUNTER_TEST_OPS 20000
+
+static sharded_data_node_operation_counters g_shared_node_counters;
+static key_store *g_counter_store = NULL;
+
+static void* _count_failed_updates_worker(void *arg) {
+    unsigned int *shard_out = (unsigned int *)arg;
+    *shard_out = get_operation_counter_shard_index();
+    for (int i = 0; i < COUNTER_TEST_OPS; ++i) update_data_node(&g_shared_node_counters, NULL, NULL); // Counted as a failed update with -20
+    return NULL;
+}
+
+static void* _count_store_sets_worker(void *arg) {
+    int thread_id = *(int *)arg;
+    char key[32];
+    unsigned char data[] = "counted";
+    key_store_value value = { data, sizeof(data) };
+    for (int i = 0; i < COUNTER_TEST_OPS / 10; ++i) {
+        snprintf(key, sizeof(key), "c%d_%d", thread_id, i % 64);
+        store_set_key(g_counter_store, key, &value);
+    }
+    return NULL;
+}
+
+void test_counter_shards_are_cache_line_aligned(void) {
+    TEST_ASSERT_EQUAL_size_t(0, sizeof(bucket_operation_counter_shard) % KEY_STORE_COUNTER_SHARD_ALIGNMENT);
+    TEST_ASSERT_EQUAL_size_t(0, sizeof(data_node_operation_counter_shard) % KEY_STORE_COUNTER_SHARD_ALIGNMENT);
+    TEST_ASSERT_EQUAL_size_t(0, offsetof(hash_bucket_memory_pool, operation_counters) % KEY_STORE_COUNTER_SHARD_ALIGNMENT);
+    TEST_ASSERT_EQUAL_size_t(0, offsetof(hash_bucket_memory_pool, data_node_counters) % KEY_STORE_COUNTER_SHARD_ALIGNMENT);
+
+    unsigned int shard = get_operation_counter_shard_index();
+    TEST_ASSERT_TRUE(shard < KEY_STORE_COUNTER_SHARD_COUNT);
+    TEST_ASSERT_EQUAL_UINT(shard, get_operation_counter_shard_index()); // A thread keeps its shard
+}
+
+void test_concurrent_counts_are_exact(void) {
+    memset(&g_shared_node_counters, 0, sizeof(g_shared_node_counters));
+    pthread_t threads[COUNTER_TEST_THREADS];
+    unsigned int shards[COUNTER_TEST_THREADS];
+    for (int i = 0; i < COUNTER_TEST_THREADS; ++i) pthread_create(&threads[i], NULL, _count_failed_updates_worker, &shards[i]);
+    for (int i = 0; i < COUNTER_TEST_THREADS; ++i) pthread_join(threads[i], NULL);
+
+#if OPERATION_COUNTERS_ENABLED
+    data_node_operation_counters sum;
+    sum_data_node_operation_counters(&g_shared_node_counters, &sum);
+    TEST_ASSERT_EQUAL_UINT(COUNTER_TEST_THREADS * COUNTER_TEST_OPS, sum.total_update_ops);
+    TEST_ASSERT_EQUAL_UINT(COUNTER_TEST_THREADS * COUNTER_TEST_OPS, sum.failed_update_ops);
+    TEST_ASSERT_EQUAL_UINT(COUNTER_TEST_THREADS * COUNTER_TEST_OPS, sum.error_code_counters[20]);
+    TEST_ASSERT_EQUAL_UINT(0, sum.total_read_ops);
+#endif
+
+    // Threads are assigned shards round-robin, so up to KEY_STORE_COUNTER_SHARD_COUNT threads started together never share one
+    for (int i = 0; i < COUNTER_TEST_THREADS; ++i) {
+        TEST_ASSERT_TRUE(shards[i] < KEY_STORE_COUNTER_SHARD_COUNT);
+#if OPERATION_COUNTERS_ENABLED
+        TEST_ASSERT_EQUAL_UINT(COUNTER_TEST_OPS, g_shared_node_counters.shards[shards[i]].counters.total_update_ops);
+#endif
+    }
+}
+
+void test_store_stats_sum_counter_shards(void) {
+    key_store_config config = { .bucket_size = 64, .pre_memory_allocation_factor = 1, .is_concurrency_enabled = true };
+    TEST_ASSERT_EQUAL(0, create_key_store(config, &g_counter_store));
+
+    pthread_t threads[COUNTER_TEST_THREADS];
+    int thread_ids[COUNTER_TEST_THREADS];
+    for (int i = 0; i < COUNTER_TEST_THREADS; ++i) {
+        thread_ids[i] = i;
+        pthread_create(&threads[i], NULL, _count_store_sets_worker, &thread_ids[i]);
+    }
+    for (int i = 0; i < COUNTER_TEST_THREADS; ++i) pthread_join(threads[i], NULL);
+
+    keystore_stats stats = store_get_keystore_stats(g_counter_store);
+#if OPERATION_COUNTERS_ENABLED
+    TEST_ASSERT_EQUAL_UINT(COUNTER_TEST_THREADS * COUNTER_TEST_OPS / 10, stats.operation_counters.total_add_ops);
+    TEST_ASSERT_EQUAL_UINT(0, stats.operation_counters.failed_add_ops);
+#endif
+    TEST_ASSERT_EQUAL_UINT(COUNTER_TEST_THREADS * 64, stats.key_entries.total_keys);
+    TEST_ASSERT_EQUAL(0, destroy_key_store(g_counter_store));
+    g_counter_store = NULL;
+}
+
+int test_operation_counters_suite(void) {
+    printf("Running operation_counters tests...\n");
+    RUN_TEST(test_counter_shards_are_cache_line_aligned);
+    RUN_TEST(test_concurrent_counts_are_exact);
+    RUN_TEST(test_store_stats_sum_counter_shards);
+    printf("Completed operation_counters tests.\n");
+    return 0;
+}
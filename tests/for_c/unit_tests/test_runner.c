@@ -1,10 +1,16 @@
 #include "unity.h"
 #include "test_hash_functions.c"
 #include "test_data_node.c"
+#include "test_operation_counters.c"
+#include "test_latency_histogram.c"
 #include "test_hash_bucket_list.c"
+#include "test_hash_bucket_tree.c"
+#include "test_bucket_lock.c"
 #include "test_hash_buckets.c"
+#include "test_swiss_table.c"
 #include "test_key_store.c"
 #include "test_memory_manager.c"
+#include "test_epoch_manager.c"
 
 void setUp(void) {}
 void tearDown(void) {}
@@ -13,9 +19,15 @@ int main(void) {
     UNITY_BEGIN();
     test_hash_functions_suite();
     test_memory_manager_suite();
+    test_epoch_manager_suite();
     test_data_node_suite();
+    test_operation_counters_suite();
+    test_latency_histogram_suite();
     test_hash_bucket_list_suite();
+    test_hash_bucket_tree_suite();
+    test_bucket_lock_suite();
     test_hash_buckets_suite();
+    test_swiss_table_suite();
     test_key_store_suite();
     return UNITY_END();
 }
@@ -0,0 +1,238 @@
+#include "unity.h"
+#include "bucket/swiss_table.h"
+#include "core/data_node.h"
+#include "core/operation_counters.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+static void _free_swiss_value(key_store_value *value) {
+    free(value->data);
+    value->data = NULL;
+    value->data_size = 0;
+}
+
+void test_initialise_swiss_table_invalid_capacity(void) {
+    swiss_table table = {0};
+    TEST_ASSERT_EQUAL(-21, initialise_swiss_table(&table, 0, false, NULL));
+    TEST_ASSERT_EQUAL(-21, initialise_swiss_table(&table, 24, false, NULL));
+    TEST_ASSERT_EQUAL(0, initialise_swiss_table(&table, 4, false, NULL)); // Raised to one group
+    TEST_ASSERT_EQUAL(0, cleanup_swiss_table(&table));
+}
+
+void test_swiss_table_not_initialized(void) {
+    swiss_table table = {0};
+    unsigned char data[] = "v";
+    key_store_value value = { data, sizeof(data) };
+    TEST_ASSERT_EQUAL(-40, upsert_node_to_swiss_table(&table, "k", 1, 1, &value));
+    TEST_ASSERT_EQUAL(-40, find_node_in_swiss_table(&table, "k", 1, 1, &value));
+    TEST_ASSERT_EQUAL(-40, delete_node_from_swiss_table(&table, "k", 1, 1));
+}
+
+void test_swiss_table_upsert_find_delete(void) {
+    swiss_table table = {0};
+    TEST_ASSERT_EQUAL(0, initialise_swiss_table(&table, 16, false, NULL));
+    unsigned char data[] = "value";
+    key_store_value value = { data, sizeof(data) };
+    TEST_ASSERT_EQUAL(0, upsert_node_to_swiss_table(&table, "key", 3, 12345, &value));
+
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, find_node_in_swiss_table(&table, "key", 3, 12345, &out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, out.data, sizeof(data));
+    _free_swiss_value(&out);
+
+    unsigned char new_data[] = "longer value";
+    key_store_value new_value = { new_data, sizeof(new_data) };
+    TEST_ASSERT_EQUAL(0, upsert_node_to_swiss_table(&table, "key", 3, 12345, &new_value));
+    TEST_ASSERT_EQUAL(0, find_node_in_swiss_table(&table, "key", 3, 12345, &out));
+    TEST_ASSERT_EQUAL(sizeof(new_data), out.data_size);
+    _free_swiss_value(&out);
+
+    TEST_ASSERT_EQUAL(-41, find_node_in_swiss_table(&table, "other", 5, 12345, &out)); // Same hash, different key
+    TEST_ASSERT_EQUAL(0, delete_node_from_swiss_table(&table, "key", 3, 12345));
+    TEST_ASSERT_EQUAL(-41, delete_node_from_swiss_table(&table, "key", 3, 12345));
+    TEST_ASSERT_EQUAL(-41, find_node_in_swiss_table(&table, "key", 3, 12345, &out));
+    TEST_ASSERT_EQUAL(-20, find_node_in_swiss_table(&table, NULL, 0, 12345, &out));
+    cleanup_swiss_table(&table);
+}
+
+void test_swiss_table_grows_and_keeps_keys(void) {
+    swiss_table table = {0};
+    TEST_ASSERT_EQUAL(0, initialise_swiss_table(&table, 16, false, NULL));
+    char key[16];
+    unsigned char data[4] = {1, 2, 3, 4};
+    key_store_value value = { data, sizeof(data) };
+    for (uint32_t i = 0; i < 5000; ++i) {
+        snprintf(key, sizeof(key), "s%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_swiss_table(&table, key, strlen(key), i * 2654435761u, &value));
+    }
+    for (uint32_t i = 0; i < 5000; ++i) {
+        snprintf(key, sizeof(key), "s%u", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, find_node_in_swiss_table(&table, key, strlen(key), i * 2654435761u, &out));
+        _free_swiss_value(&out);
+    }
+
+    keystore_stats stats = {0};
+    get_swiss_table_stats(&table, &stats);
+    TEST_ASSERT_EQUAL_UINT(5000, stats.key_entries.total_keys);
+    TEST_ASSERT_TRUE(stats.key_entries.total_buckets * SWISS_TABLE_GROUP_SIZE * 7 / 8 >= 5000);
+    TEST_ASSERT_TRUE(stats.memory_pool.memory_utilization_percent <= 87.5);
+    cleanup_swiss_table(&table);
+}
+
+void test_swiss_table_probes_past_full_groups(void) {
+    swiss_table table = {0};
+    // Every key has the same hash, so all of them share a home group and tag and must spill into later groups
+    TEST_ASSERT_EQUAL(0, initialise_swiss_table(&table, 64, false, NULL));
+    char key[16];
+    unsigned char data[] = "x";
+    key_store_value value = { data, sizeof(data) };
+    for (int i = 0; i < 40; ++i) {
+        snprintf(key, sizeof(key), "c%d", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_swiss_table(&table, key, strlen(key), 77, &value));
+    }
+
+    keystore_stats stats = {0};
+    get_swiss_table_stats(&table, &stats);
+    TEST_ASSERT_EQUAL_UINT(40, stats.key_entries.total_keys);
+    TEST_ASSERT_EQUAL_UINT(24, stats.collisions.collision_buckets); // Only the first group's 16 keys sit at home
+    TEST_ASSERT_TRUE(stats.collisions.highest_collision_in_bucket >= 2);
+
+    // Deleting keys from the full home group leaves tombstones, the spilled keys must stay reachable
+    for (int i = 0; i < 16; ++i) {
+        snprintf(key, sizeof(key), "c%d", i);
+        TEST_ASSERT_EQUAL(0, delete_node_from_swiss_table(&table, key, strlen(key), 77));
+    }
+    for (int i = 16; i < 40; ++i) {
+        snprintf(key, sizeof(key), "c%d", i);
+        key_store_value out = {0};
+        TEST_ASSERT_EQUAL(0, find_node_in_swiss_table(&table, key, strlen(key), 77, &out));
+        _free_swiss_value(&out);
+    }
+
+    // Reinserting reuses the tombstones instead of growing the table
+    for (int i = 0; i < 16; ++i) {
+        snprintf(key, sizeof(key), "c%d", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_swiss_table(&table, key, strlen(key), 77, &value));
+    }
+    get_swiss_table_stats(&table, &stats);
+    TEST_ASSERT_EQUAL_UINT(40, stats.key_entries.total_keys);
+    TEST_ASSERT_EQUAL_UINT(4, stats.key_entries.total_buckets);
+    cleanup_swiss_table(&table);
+}
+
+void test_swiss_table_churn_does_not_grow(void) {
+    swiss_table table = {0};
+    // Repeated insert/delete of distinct keys only creates tombstones, which are purged by same-size rehashes
+    TEST_ASSERT_EQUAL(0, initialise_swiss_table(&table, 64, false, NULL));
+    char key[16];
+    unsigned char data[] = "x";
+    key_store_value value = { data, sizeof(data) };
+    for (uint32_t i = 0; i < 2000; ++i) {
+        snprintf(key, sizeof(key), "t%u", i);
+        TEST_ASSERT_EQUAL(0, upsert_node_to_swiss_table(&table, key, strlen(key), i * 2654435761u, &value));
+        TEST_ASSERT_EQUAL(0, delete_node_from_swiss_table(&table, key, strlen(key), i * 2654435761u));
+    }
+    keystore_stats stats = {0};
+    get_swiss_table_stats(&table, &stats);
+    TEST_ASSERT_EQUAL_UINT(0, stats.key_entries.total_keys);
+    TEST_ASSERT_EQUAL_UINT(4, stats.key_entries.total_buckets);
+    cleanup_swiss_table(&table);
+}
+
+static swiss_table *g_shared_table = NULL;
+
+static void* _swiss_upsert_delete_worker(void *arg) {
+    swiss_table *table_ptr = g_shared_table;
+    int thread_id = *(int *)arg;
+    char key[16];
+    unsigned char data[8];
+    memset(data, thread_id, sizeof(data));
+    key_store_value value = { data, sizeof(data) };
+    for (uint32_t i = 0; i < 2000; ++i) {
+        snprintf(key, sizeof(key), "p%u", i % 256);
+        uint32_t key_hash = (i % 256) * 2654435761u;
+        if (i % 3 == 0) {
+            delete_node_from_swiss_table(table_ptr, key, strlen(key), key_hash);
+        } else {
+            upsert_node_to_swiss_table(table_ptr, key, strlen(key), key_hash, &value);
+        }
+        key_store_value out = {0};
+        if (find_node_in_swiss_table(table_ptr, key, strlen(key), key_hash, &out) == 0) {
+            if (out.data_size != sizeof(data)) *(int *)arg = -1;
+            _free_swiss_value(&out);
+        }
+    }
+    return NULL;
+}
+
+void test_swiss_table_concurrent_operations(void) {
+    swiss_table table = {0};
+    TEST_ASSERT_EQUAL(0, initialise_swiss_table(&table, 16, true, NULL));
+    g_shared_table = &table;
+    pthread_t threads[8];
+    int thread_ids[8];
+    for (int i = 0; i < 8; ++i) {
+        thread_ids[i] = i + 1;
+        pthread_create(&threads[i], NULL, _swiss_upsert_delete_worker, &thread_ids[i]);
+    }
+    for (int i = 0; i < 8; ++i) {
+        pthread_join(threads[i], NULL);
+        TEST_ASSERT_NOT_EQUAL(-1, thread_ids[i]);
+    }
+
+    keystore_stats stats = {0};
+    get_swiss_table_stats(&table, &stats);
+    TEST_ASSERT_TRUE(stats.key_entries.total_keys <= 256);
+    cleanup_swiss_table(&table);
+}
+
+void test_swiss_tables_are_independent(void) {
+    swiss_table table = {0};
+    swiss_table other = {0};
+    TEST_ASSERT_EQUAL(0, initialise_swiss_table(&table, 16, false, NULL));
+    TEST_ASSERT_EQUAL(0, initialise_swiss_table(&other, 16, false, NULL));
+    unsigned char first[] = "first";
+    unsigned char second[] = "second value";
+    key_store_value first_value = { first, sizeof(first) };
+    key_store_value second_value = { second, sizeof(second) };
+    TEST_ASSERT_EQUAL(0, upsert_node_to_swiss_table(&table, "key", 3, 1, &first_value));
+    TEST_ASSERT_EQUAL(0, upsert_node_to_swiss_table(&other, "key", 3, 1, &second_value));
+
+    key_store_value out = {0};
+    TEST_ASSERT_EQUAL(0, find_node_in_swiss_table(&table, "key", 3, 1, &out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(first, out.data, sizeof(first));
+    _free_swiss_value(&out);
+
+    TEST_ASSERT_EQUAL(0, delete_node_from_swiss_table(&table, "key", 3, 1));
+    TEST_ASSERT_EQUAL(0, find_node_in_swiss_table(&other, "key", 3, 1, &out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(second, out.data, sizeof(second));
+    _free_swiss_value(&out);
+
+#if OPERATION_COUNTERS_ENABLED
+    data_node_operation_counters node_counters;
+    sum_data_node_operation_counters(&table.data_node_counters, &node_counters);
+    TEST_ASSERT_EQUAL_UINT(1, node_counters.total_create_ops);
+    TEST_ASSERT_EQUAL_UINT(1, node_counters.total_delete_ops);
+    sum_data_node_operation_counters(&other.data_node_counters, &node_counters);
+    TEST_ASSERT_EQUAL_UINT(0, node_counters.total_delete_ops);
+#endif
+    TEST_ASSERT_EQUAL(-20, initialise_swiss_table(NULL, 16, false, NULL));
+    cleanup_swiss_table(&table);
+    cleanup_swiss_table(&other);
+}
+
+int test_swiss_table_suite(void) {
+    printf("Running swiss_table tests...\n");
+    RUN_TEST(test_initialise_swiss_table_invalid_capacity);
+    RUN_TEST(test_swiss_table_not_initialized);
+    RUN_TEST(test_swiss_table_upsert_find_delete);
+    RUN_TEST(test_swiss_table_grows_and_keeps_keys);
+    RUN_TEST(test_swiss_table_probes_past_full_groups);
+    RUN_TEST(test_swiss_table_churn_does_not_grow);
+    RUN_TEST(test_swiss_table_concurrent_operations);
+    RUN_TEST(test_swiss_tables_are_independent);
+    printf("Completed swiss_table tests.\n");
+    return 0;
+}